@@ -80,6 +80,33 @@ namespace af
                         const int dim, const double nanval);
 #endif
 
+#if AF_API_VERSION >= 39
+    /**
+       C++ Interface for selecting the algorithm used to add floating point
+       values in \ref sum, \ref mean and \ref var
+
+       \param[in] type is the summation algorithm. \ref AF_SUMMATION_KAHAN
+                  and \ref AF_SUMMATION_PAIRWISE are more accurate than the
+                  default when many values are added but are slower.
+
+       \ingroup reduce_func_sum
+
+       \note The setting applies to all the arrays in the process. Backends
+             that do not implement a compensated summation ignore it.
+    */
+    AFAPI void setSummationType(const summationType type);
+
+    /**
+       C++ Interface for getting the algorithm used to add floating point
+       values in \ref sum, \ref mean and \ref var
+
+       \return the summation algorithm set by \ref setSummationType
+
+       \ingroup reduce_func_sum
+    */
+    AFAPI summationType getSummationType();
+#endif
+
     /**
        C++ Interface for product of elements in an array
 
@@ -687,6 +714,30 @@ extern "C" {
     AFAPI af_err af_sum_all_array(af_array *out, const af_array in);
 #endif
 
+#if AF_API_VERSION >= 39
+    /**
+       C Interface for selecting the algorithm used to add floating point
+       values in \ref af_sum, \ref af_mean and \ref af_var
+
+       \param[in] type is the summation algorithm
+       \return \ref AF_SUCCESS if the execution completes properly
+
+       \ingroup reduce_func_sum
+    */
+    AFAPI af_err af_set_summation_type(const af_summation_type type);
+
+    /**
+       C Interface for getting the algorithm used to add floating point
+       values in \ref af_sum, \ref af_mean and \ref af_var
+
+       \param[out] type will contain the summation algorithm
+       \return \ref AF_SUCCESS if the execution completes properly
+
+       \ingroup reduce_func_sum
+    */
+    AFAPI af_err af_get_summation_type(af_summation_type *type);
+#endif
+
 #if AF_API_VERSION >= 31
     /**
        C Interface for sum of elements in an array while replacing nans
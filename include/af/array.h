@@ -1462,6 +1462,10 @@ namespace af
     ///
     /// Evaluate multiple arrays simultaneously
     ///
+    /// The arrays may have different types and sizes. The arrays of the same
+    /// size are written by a single kernel, which computes the expressions
+    /// they share only once.
+    ///
     AFAPI void eval(int num, array **arrays);
 #endif
 
@@ -1667,6 +1671,10 @@ extern "C" {
 #if AF_API_VERSION >= 34
     /**
        Evaluate multiple arrays together
+
+       The arrays may have different types and sizes. The arrays of the same
+       size are written by a single kernel, which computes the expressions
+       they share only once.
     */
     AFAPI af_err af_eval_multiple(const int num, af_array *arrays);
 #endif
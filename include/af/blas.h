@@ -46,6 +46,11 @@ namespace af
               \ref AF_MAT_CTRANS.
         \note \p optRhs can only be \ref AF_MAT_NONE.
 
+        \note <b> The following applies for Sparse-Sparse matrix multiplication.</b>
+        \note Both inputs must be of \ref AF_STORAGE_CSR format and the
+              returned array is a sparse array of \ref AF_STORAGE_CSR format.
+        \note \p optLhs and \p optRhs can only be \ref AF_MAT_NONE.
+
         \ingroup blas_func_matmul
 
      */
@@ -302,6 +307,11 @@ extern "C" {
               \ref AF_MAT_CTRANS.
         \note \p optRhs can only be \ref AF_MAT_NONE.
 
+        \note <b> The following applies for Sparse-Sparse matrix multiplication.</b>
+        \note Both inputs must be of \ref AF_STORAGE_CSR format and the
+              returned array is a sparse array of \ref AF_STORAGE_CSR format.
+        \note \p optLhs and \p optRhs can only be \ref AF_MAT_NONE.
+
         \ingroup blas_func_matmul
      */
     AFAPI af_err af_matmul( af_array *out ,
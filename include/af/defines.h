@@ -546,6 +546,27 @@ typedef enum {
 } af_conv_gradient_type;
 #endif
 
+#if AF_API_VERSION >= 39
+typedef enum {
+    AF_SUMMATION_DEFAULT  = 0, ///< Fastest summation of the backend
+    AF_SUMMATION_PAIRWISE = 1, ///< Pairwise summation of blocks of values
+    AF_SUMMATION_KAHAN    = 2  ///< Kahan-Neumaier compensated summation
+} af_summation_type;
+
+typedef enum {
+    AF_QUANTILE_LINEAR   = 0, ///< Linear interpolation of the two closest
+    AF_QUANTILE_LOWER    = 1, ///< The lower of the two closest values
+    AF_QUANTILE_HIGHER   = 2, ///< The higher of the two closest values
+    AF_QUANTILE_NEAREST  = 3, ///< The closest value, ties go to the even one
+    AF_QUANTILE_MIDPOINT = 4  ///< The mean of the two closest values
+} af_quantile_method;
+
+typedef enum {
+    AF_BILATERAL_EXACT = 0, ///< Weights every pixel of the filter window
+    AF_BILATERAL_GRID  = 1  ///< Approximation on a downsampled bilateral grid
+} af_bilateral_method;
+#endif
+
 #ifdef __cplusplus
 namespace af
 {
@@ -601,6 +622,11 @@ namespace af
     typedef af_inverse_deconv_algo inverseDeconvAlgo;
     typedef af_conv_gradient_type convGradientType;
 #endif
+#if AF_API_VERSION >= 39
+    typedef af_summation_type summationType;
+    typedef af_quantile_method quantileMethod;
+    typedef af_bilateral_method bilateralMethod;
+#endif
 }
 
 #endif
@@ -258,6 +258,23 @@ namespace af
     AFAPI void deviceMemInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                              size_t *lock_bytes, size_t *lock_buffers);
 
+#if AF_API_VERSION >= 39
+    /// \brief Gets information about the fragmentation of the memory cache
+    ///
+    /// \param[out] unused_bytes the bytes of the buffers in use beyond the
+    ///                          sizes that were requested
+    /// \param[out] free_bytes the bytes held by cached buffers
+    /// \param[out] free_buffers the number of cached buffers
+    /// \param[out] largest_free_bytes the size of the largest cached buffer
+    ///
+    /// \note Works only with the default memory manager - throws if a custom
+    /// memory manager is set.
+    AFAPI void deviceMemFragmentationInfo(size_t *unused_bytes,
+                                          size_t *free_bytes,
+                                          size_t *free_buffers,
+                                          size_t *largest_free_bytes);
+#endif
+
 #if AF_API_VERSION >= 33
     ///
     /// Prints buffer details from the ArrayFire Device Manager
@@ -459,6 +476,27 @@ extern "C" {
     AFAPI af_err af_device_mem_info(size_t *alloc_bytes, size_t *alloc_buffers,
                                     size_t *lock_bytes, size_t *lock_buffers);
 
+#if AF_API_VERSION >= 39
+    /**
+       Get the fragmentation of the memory cache from the memory manager
+
+       \param[out] unused_bytes the bytes of the buffers in use beyond the
+                   sizes that were requested
+       \param[out] free_bytes the bytes held by cached buffers
+       \param[out] free_buffers the number of cached buffers
+       \param[out] largest_free_bytes the size of the largest cached buffer
+
+       Works only with the default memory manager - returns an error if a
+       custom memory manager is set.
+
+       \ingroup device_func_mem
+    */
+    AFAPI af_err af_device_mem_fragmentation_info(size_t *unused_bytes,
+                                                  size_t *free_bytes,
+                                                  size_t *free_buffers,
+                                                  size_t *largest_free_bytes);
+#endif
+
 #if AF_API_VERSION >= 33
     /**
        Prints buffer details from the ArrayFire Device Manager.
@@ -619,6 +657,25 @@ extern "C" {
 
 #endif
 
+#if AF_API_VERSION >= 39
+    /**
+       Loads or compiles the kernels listed in a kernel manifest
+
+       The kernels compiled at runtime by a process are appended to the file
+       named by the AF_JIT_KERNEL_MANIFEST environment variable. Passing this
+       file to this function in a later run loads the kernels from the kernel
+       cache directory, or compiles them if they are not there, before they
+       are first used. The kernels are built concurrently for the active
+       device.
+
+       \param[in] manifest The path of the kernel manifest
+       \returns AF_SUCCESS if the kernels are ready. AF_ERR_ARG if manifest
+                is NULL or the file cannot be read as a kernel manifest.
+       \ingroup device_func_mem
+    */
+    AFAPI af_err af_warmup_kernels(const char *manifest);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
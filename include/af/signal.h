@@ -761,14 +761,28 @@ AFAPI array medfilt2(const array& in, const dim_t wind_length = 3, const dim_t w
 /**
    C++ Interface for setting plan cache size
 
-   This function doesn't do anything if called when CPU backend is active. The plans associated with
-   the most recently used array sizes are cached.
+   The plans associated with the most recently used array sizes are cached.
 
    \param[in] cacheSize is the number of plans that shall be cached
 */
 AFAPI void setFFTPlanCacheSize(size_t cacheSize);
 #endif
 
+#if AF_API_VERSION >= 39
+/**
+   C++ Interface for setting the number of threads used by a transform
+
+   Only the CPU backend uses this setting. Small transforms are executed on
+   a single thread.
+
+   \param[in] numThreads is the maximum number of threads of a transform.
+              0 uses all of the threads of the CPU backend.
+
+   \ingroup signal_func_fft
+*/
+AFAPI void setFFTNumThreads(unsigned numThreads);
+#endif
+
 }
 #endif
 
@@ -1600,8 +1614,7 @@ AFAPI af_err af_iir(af_array *y, const af_array b, const af_array a, const af_ar
 /**
    C Interface for setting plan cache size
 
-   This function doesn't do anything if called when CPU backend is active. The plans associated with
-   the most recently used array sizes are cached.
+   The plans associated with the most recently used array sizes are cached.
 
    \param[in] cache_size is the number of plans that shall be cached
 
@@ -1610,6 +1623,22 @@ AFAPI af_err af_iir(af_array *y, const af_array b, const af_array a, const af_ar
 AFAPI af_err af_set_fft_plan_cache_size(size_t cache_size);
 #endif
 
+#if AF_API_VERSION >= 39
+/**
+   C Interface for setting the number of threads used by a transform
+
+   Only the CPU backend uses this setting. Small transforms are executed on
+   a single thread.
+
+   \param[in] num_threads is the maximum number of threads of a transform.
+              0 uses all of the threads of the CPU backend.
+   \return    \ref AF_SUCCESS if the execution completes properly
+
+   \ingroup signal_func_fft
+*/
+AFAPI af_err af_set_fft_num_threads(const unsigned num_threads);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
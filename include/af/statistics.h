@@ -186,6 +186,27 @@ AFAPI array cov(const array &X, const array &Y, const af_var_bias bias);
 */
 AFAPI array median(const array& in, const dim_t dim=-1);
 
+#if AF_API_VERSION >= 39
+/**
+   C++ Interface for quantiles
+
+   \param[in] in is the input array
+   \param[in] probs is a vector of the probabilities in [0, 1] of the
+              quantiles
+   \param[in] dim the dimension along which the quantiles are extracted
+   \param[in] method decides how the quantiles between two values are
+              computed
+   \return    the quantiles of the input array along dimension \p dim. The
+              dimension \p dim of the output has one element per probability.
+
+   \ingroup stat_func_quantile
+
+   \note \p dim is -1 by default. -1 denotes the first non-singleton dimension.
+*/
+AFAPI array quantile(const array& in, const array& probs, const dim_t dim=-1,
+                     const quantileMethod method=AF_QUANTILE_LINEAR);
+#endif
+
 /**
    C++ Interface for mean of all elements
 
@@ -514,6 +535,28 @@ AFAPI af_err af_cov_v2(af_array *out, const af_array X, const af_array Y,
 */
 AFAPI af_err af_median(af_array* out, const af_array in, const dim_t dim);
 
+#if AF_API_VERSION >= 39
+/**
+   C Interface for quantiles
+
+   \param[out] out will contain the quantiles of the input array along
+               dimension \p dim
+   \param[in] in is the input array
+   \param[in] probs is a vector of the probabilities in [0, 1] of the
+              quantiles
+   \param[in] dim the dimension along which the quantiles are extracted
+   \param[in] method decides how the quantiles between two values are
+              computed
+   \return     \ref AF_SUCCESS if the operation is successful,
+   otherwise an appropriate error code is returned.
+
+   \ingroup stat_func_quantile
+*/
+AFAPI af_err af_quantile(af_array* out, const af_array in,
+                         const af_array probs, const dim_t dim,
+                         const af_quantile_method method);
+#endif
+
 /**
    C Interface for mean of all elements
 
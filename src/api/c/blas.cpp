@@ -39,6 +39,12 @@ static inline af_array sparseMatmul(const af_array lhs, const af_array rhs,
         matmul<T>(getSparseArray<T>(lhs), getArray<T>(rhs), optLhs, optRhs));
 }
 
+template<typename T>
+static inline af_array sparseSparseMatmul(const af_array lhs,
+                                          const af_array rhs) {
+    return getHandle(matmul<T>(getSparseArray<T>(lhs), getSparseArray<T>(rhs)));
+}
+
 template<typename T>
 static inline void gemm(af_array *out, af_mat_prop optLhs, af_mat_prop optRhs,
                         const T *alpha, const af_array lhs, const af_array rhs,
@@ -58,16 +64,43 @@ af_err af_sparse_matmul(af_array *out, const af_array lhs, const af_array rhs,
                         const af_mat_prop optLhs, const af_mat_prop optRhs) {
     try {
         const SparseArrayBase lhsBase = getSparseArrayBase(lhs);
-        const ArrayInfo &rhsInfo      = getInfo(rhs);
+        const ArrayInfo &rhsInfo      = getInfo(rhs, false);
 
-        ARG_ASSERT(2,
-                   lhsBase.isSparse() == true && rhsInfo.isSparse() == false);
+        ARG_ASSERT(1, lhsBase.isSparse() == true);
 
         af_dtype lhs_type = lhsBase.getType();
         af_dtype rhs_type = rhsInfo.getType();
 
         ARG_ASSERT(1, lhsBase.getStorage() == AF_STORAGE_CSR);
 
+        if (rhsInfo.isSparse()) {
+            const SparseArrayBase rhsBase = getSparseArrayBase(rhs);
+            ARG_ASSERT(2, rhsBase.getStorage() == AF_STORAGE_CSR);
+
+            if (optLhs != AF_MAT_NONE || optRhs != AF_MAT_NONE) {
+                AF_ERROR(
+                    "Using this property is not yet supported in sparse-sparse "
+                    "matmul",
+                    AF_ERR_NOT_SUPPORTED);
+            }
+
+            TYPE_ASSERT(lhs_type == rhs_type);
+            DIM_ASSERT(1, lhsBase.dims()[1] == rhsBase.dims()[0]);
+
+            af_array output = 0;
+            switch (lhs_type) {
+                case f32: output = sparseSparseMatmul<float>(lhs, rhs); break;
+                case c32: output = sparseSparseMatmul<cfloat>(lhs, rhs); break;
+                case f64: output = sparseSparseMatmul<double>(lhs, rhs); break;
+                case c64:
+                    output = sparseSparseMatmul<cdouble>(lhs, rhs);
+                    break;
+                default: TYPE_ERROR(1, lhs_type);
+            }
+            std::swap(*out, output);
+            return AF_SUCCESS;
+        }
+
         if (!(optLhs == AF_MAT_NONE || optLhs == AF_MAT_TRANS ||
               optLhs == AF_MAT_CTRANS)) {  // Note the ! operator.
             AF_ERROR(
@@ -215,7 +248,7 @@ af_err af_matmul(af_array *out, const af_array lhs, const af_array rhs,
                  const af_mat_prop optLhs, const af_mat_prop optRhs) {
     try {
         const ArrayInfo &lhsInfo = getInfo(lhs, false, true);
-        const ArrayInfo &rhsInfo = getInfo(rhs, true, true);
+        const ArrayInfo &rhsInfo = getInfo(rhs, !lhsInfo.isSparse(), true);
 
         if (lhsInfo.isSparse()) {
             return af_sparse_matmul(out, lhs, rhs, optLhs, optRhs);
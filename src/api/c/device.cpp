@@ -11,6 +11,7 @@
 #include <backend.hpp>
 #include <common/err_common.hpp>
 #include <common/half.hpp>
+#include <common/kernel_manifest.hpp>
 #include <common/util.hpp>
 #include <handle.hpp>
 #include <platform.hpp>
@@ -29,12 +30,14 @@
 
 using af::dim4;
 using common::half;
+using common::readKernelManifest;
+using common::warmupKernels;
 using detail::Array;
 using detail::cdouble;
 using detail::cfloat;
-using detail::createEmptyArray;
 using detail::devprop;
 using detail::evalFlag;
+using detail::EvalGroup;
 using detail::getActiveDeviceId;
 using detail::getBackend;
 using detail::getDeviceCount;
@@ -302,52 +305,35 @@ af_err af_eval(af_array arr) {
 }
 
 template<typename T>
-static inline void evalMultiple(int num, af_array* arrayPtrs) {
-    Array<T> empty = createEmptyArray<T>(dim4());
-    std::vector<Array<T>*> arrays(num, &empty);
-
-    for (int i = 0; i < num; i++) {
-        arrays[i] = reinterpret_cast<Array<T>*>(arrayPtrs[i]);
-    }
-
-    evalMultiple<T>(arrays);
+static inline void addToEvalGroup(EvalGroup& group, af_array arr) {
+    group.add(getArray<T>(arr));
 }
 
 af_err af_eval_multiple(int num, af_array* arrays) {
     try {
-        const ArrayInfo& info = getInfo(arrays[0]);
-        af_dtype type         = info.getType();
-        const dim4& dims      = info.dims();
-
-        for (int i = 1; i < num; i++) {
-            const ArrayInfo& currInfo = getInfo(arrays[i]);
-
-            // FIXME: This needs to be removed when new functionality is added
-            if (type != currInfo.getType()) {
-                AF_ERROR("All arrays must be of same type", AF_ERR_TYPE);
-            }
-
-            if (dims != currInfo.dims()) {
-                AF_ERROR("All arrays must be of same size", AF_ERR_SIZE);
+        // The arrays may have different types and sizes. The ones with the
+        // same size are written by one kernel.
+        EvalGroup group;
+        for (int i = 0; i < num; i++) {
+            const af_dtype type = getInfo(arrays[i]).getType();
+            switch (type) {
+                case f32: addToEvalGroup<float>(group, arrays[i]); break;
+                case f64: addToEvalGroup<double>(group, arrays[i]); break;
+                case c32: addToEvalGroup<cfloat>(group, arrays[i]); break;
+                case c64: addToEvalGroup<cdouble>(group, arrays[i]); break;
+                case s32: addToEvalGroup<int>(group, arrays[i]); break;
+                case u32: addToEvalGroup<uint>(group, arrays[i]); break;
+                case u8: addToEvalGroup<uchar>(group, arrays[i]); break;
+                case b8: addToEvalGroup<char>(group, arrays[i]); break;
+                case s64: addToEvalGroup<intl>(group, arrays[i]); break;
+                case u64: addToEvalGroup<uintl>(group, arrays[i]); break;
+                case s16: addToEvalGroup<short>(group, arrays[i]); break;
+                case u16: addToEvalGroup<ushort>(group, arrays[i]); break;
+                case f16: addToEvalGroup<half>(group, arrays[i]); break;
+                default: TYPE_ERROR(0, type);
             }
         }
-
-        switch (type) {
-            case f32: evalMultiple<float>(num, arrays); break;
-            case f64: evalMultiple<double>(num, arrays); break;
-            case c32: evalMultiple<cfloat>(num, arrays); break;
-            case c64: evalMultiple<cdouble>(num, arrays); break;
-            case s32: evalMultiple<int>(num, arrays); break;
-            case u32: evalMultiple<uint>(num, arrays); break;
-            case u8: evalMultiple<uchar>(num, arrays); break;
-            case b8: evalMultiple<char>(num, arrays); break;
-            case s64: evalMultiple<intl>(num, arrays); break;
-            case u64: evalMultiple<uintl>(num, arrays); break;
-            case s16: evalMultiple<short>(num, arrays); break;
-            case u16: evalMultiple<ushort>(num, arrays); break;
-            case f16: evalMultiple<half>(num, arrays); break;
-            default: TYPE_ERROR(0, type);
-        }
+        group.run();
     }
     CATCHALL;
 
@@ -407,3 +393,12 @@ af_err af_set_kernel_cache_directory(const char* path, int override_env) {
     CATCHALL
     return AF_SUCCESS;
 }
+
+af_err af_warmup_kernels(const char* manifest) {
+    try {
+        ARG_ASSERT(manifest != nullptr, 0);
+        warmupKernels(readKernelManifest(manifest));
+    }
+    CATCHALL
+    return AF_SUCCESS;
+}
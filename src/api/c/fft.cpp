@@ -296,3 +296,11 @@ af_err af_set_fft_plan_cache_size(size_t cache_size) {
     CATCHALL;
     return AF_SUCCESS;
 }
+
+af_err af_set_fft_num_threads(const unsigned num_threads) {
+    try {
+        detail::setFFTNumThreads(num_threads);
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
@@ -9,10 +9,39 @@
 
 #include <jit_test_api.h>
 
+#include <Array.hpp>
 #include <backend.hpp>
 #include <common/err_common.hpp>
+#include <common/half.hpp>
+#include <common/jit/Node.hpp>
+#include <handle.hpp>
 #include <platform.hpp>
 
+#include <vector>
+
+using common::half;
+using common::Node;
+using common::Node_ids;
+using common::Node_map_t;
+using common::Node_ptr;
+using detail::cdouble;
+using detail::cfloat;
+using detail::intl;
+using detail::uchar;
+using detail::uint;
+using detail::uintl;
+using detail::ushort;
+
+template<typename T>
+static int getJitNodeCount(const af_array in) {
+    Node_ptr node = getArray<T>(in).getNode();
+    Node_map_t node_map;
+    std::vector<Node *> full_nodes;
+    std::vector<Node_ids> full_ids;
+    node->getNodesMap(node_map, full_nodes, full_ids);
+    return static_cast<int>(full_nodes.size());
+}
+
 af_err af_get_max_jit_len(int *jitLen) {
     *jitLen = detail::getMaxJitSize();
     return AF_SUCCESS;
@@ -26,3 +55,27 @@ af_err af_set_max_jit_len(const int maxJitLen) {
     CATCHALL;
     return AF_SUCCESS;
 }
+
+af_err af_get_jit_node_count(int *count, const af_array in) {
+    try {
+        const af_dtype type = getInfo(in).getType();
+        switch (type) {
+            case f32: *count = getJitNodeCount<float>(in); break;
+            case f64: *count = getJitNodeCount<double>(in); break;
+            case c32: *count = getJitNodeCount<cfloat>(in); break;
+            case c64: *count = getJitNodeCount<cdouble>(in); break;
+            case s32: *count = getJitNodeCount<int>(in); break;
+            case u32: *count = getJitNodeCount<uint>(in); break;
+            case s64: *count = getJitNodeCount<intl>(in); break;
+            case u64: *count = getJitNodeCount<uintl>(in); break;
+            case s16: *count = getJitNodeCount<short>(in); break;
+            case u16: *count = getJitNodeCount<ushort>(in); break;
+            case u8: *count = getJitNodeCount<uchar>(in); break;
+            case b8: *count = getJitNodeCount<char>(in); break;
+            case f16: *count = getJitNodeCount<half>(in); break;
+            default: TYPE_ERROR(1, type);
+        }
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
@@ -13,6 +13,8 @@
 
 #ifdef __cplusplus
 namespace af {
+class array;
+
 /// Get the maximum jit tree length for active backend
 ///
 /// \returns the maximum length of jit tree from root to any leaf
@@ -23,6 +25,14 @@ AFAPI int getMaxJitLen(void);
 /// \param[in] jit_len is the maximum length of jit tree from root to any
 /// leaf
 AFAPI void setMaxJitLen(const int jitLen);
+
+/// Get the number of distinct nodes in the jit tree of an array
+///
+/// \param[in] in is the array
+///
+/// \returns the number of nodes that are evaluated for \p in. Nodes that
+/// compute the same values are counted once.
+AFAPI int getJitNodeCount(const array &in);
 }  // namespace af
 #endif  //__cplusplus
 
@@ -46,6 +56,15 @@ AFAPI af_err af_get_max_jit_len(int *jit_len);
 /// \returns Always returns AF_SUCCESS
 AFAPI af_err af_set_max_jit_len(const int jit_len);
 
+/// Get the number of distinct nodes in the jit tree of an array
+///
+/// \param[out] count is the number of nodes that are evaluated for \p in.
+/// Nodes that compute the same values are counted once.
+/// \param[in] in is the array
+///
+/// \returns \ref AF_SUCCESS if the count is returned
+AFAPI af_err af_get_jit_node_count(int *count, const af_array in);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,7 +39,7 @@ af_err af_match_template(af_array* out, const af_array search_img,
                          const af_array template_img,
                          const af_match_type m_type) {
     try {
-        ARG_ASSERT(3, (m_type >= AF_SAD && m_type <= AF_LSSD));
+        ARG_ASSERT(3, (m_type >= AF_SAD && m_type <= AF_ZNCC));
 
         const ArrayInfo& sInfo = getInfo(search_img);
         const ArrayInfo& tInfo = getInfo(template_img);
@@ -10,9 +10,10 @@
 #include <backend.hpp>
 #include <common/cast.hpp>
 #include <common/err_common.hpp>
+#include <copy.hpp>
 #include <handle.hpp>
+#include <kth_element.hpp>
 #include <math.hpp>
-#include <sort.hpp>
 #include <af/arith.h>
 #include <af/data.h>
 #include <af/defines.h>
@@ -20,13 +21,25 @@
 #include <af/index.h>
 #include <af/statistics.h>
 
+#include <vector>
+
 using af::dim4;
 using detail::Array;
+using detail::copyData;
 using detail::division;
+using detail::kth_element;
 using detail::uchar;
 using detail::uint;
 using detail::ushort;
-using std::sort;
+using std::vector;
+
+// The rank of the middle element, and the rank of the element after it if
+// there is an even number of elements
+static vector<dim_t> medianRanks(const dim_t nElems) {
+    vector<dim_t> ranks = {(nElems - 1) / 2};
+    if (nElems % 2 == 0) { ranks.push_back(nElems / 2); }
+    return ranks;
+}
 
 template<typename T>
 static double median(const af_array& in) {
@@ -36,48 +49,17 @@ static double median(const af_array& in) {
 
     af_array temp = 0;
     AF_CHECK(af_moddims(&temp, in, 1, dims.get()));
-    const Array<T>& input = getArray<T>(temp);
-
-    // Shortcut cases for 1 or 2 elements
-    if (nElems == 1) {
-        T result;
-        AF_CHECK(af_get_data_ptr((void*)&result, in));
-        return result;
-    }
-    if (nElems == 2) {
-        T result[2];
-        AF_CHECK(af_get_data_ptr((void*)&result, in));
-        return division(
-            (static_cast<double>(result[0]) + static_cast<double>(result[1])),
-            2.0);
-    }
-
-    double mid       = static_cast<double>(nElems + 1) / 2.0;
-    af_seq mdSpan[1] = {af_make_seq(mid - 1, mid, 1)};
-
-    Array<T> sortedArr = sort<T>(input, 0, true);
+    const Array<T> input = getArray<T>(temp);
 
-    af_array sarrHandle = getHandle<T>(sortedArr);
-
-    double result;
-    T resPtr[2];
-    af_array res = 0;
-    AF_CHECK(af_index(&res, sarrHandle, 1, mdSpan));
-    AF_CHECK(af_get_data_ptr((void*)&resPtr, res));
-
-    AF_CHECK(af_release_array(res));
-    AF_CHECK(af_release_array(sarrHandle));
+    Array<T> middle = kth_element<T>(input, medianRanks(nElems), 0);
     AF_CHECK(af_release_array(temp));
 
-    if (nElems % 2 == 1) {
-        result = resPtr[0];
-    } else {
-        result = division(
-            static_cast<double>(resPtr[0]) + static_cast<double>(resPtr[1]),
-            2.0);
-    }
+    T resPtr[2];
+    copyData(resPtr, middle);
 
-    return result;
+    if (nElems % 2 == 1) { return resPtr[0]; }
+    return division(
+        static_cast<double>(resPtr[0]) + static_cast<double>(resPtr[1]), 2.0);
 }
 
 template<typename T>
@@ -90,67 +72,59 @@ static af_array median(const af_array& in, const dim_t dim) {
         return getHandle<T>(result);
     }
 
-    Array<T> sortedIn = sort<T>(input, dim, true);
-
     size_t dimLength = input.dims()[dim];
-    double mid       = static_cast<double>(dimLength + 1) / 2.0;
-    af_array left    = 0;
+    Array<T> middle  = kth_element<T>(input, medianRanks(dimLength), dim);
 
-    af_seq slices[4] = {af_span, af_span, af_span, af_span};
-    slices[dim]      = af_make_seq(mid - 1.0, mid - 1.0, 1.0);
-
-    af_array sortedIn_handle = getHandle<T>(sortedIn);
-    AF_CHECK(af_index(&left, sortedIn_handle, input.ndims(), slices));
-
-    af_array out = nullptr;
+    af_array middle_handle = getHandle<T>(middle);
     if (dimLength % 2 == 1) {
-        // mid-1 is our guy
-        if (input.isFloating()) {
-            AF_CHECK(af_release_array(sortedIn_handle));
-            return left;
-        }
+        // The only element is our guy
+        if (input.isFloating()) { return middle_handle; }
 
         // Return as floats for consistency
         af_array out;
-        AF_CHECK(af_cast(&out, left, f32));
-        AF_CHECK(af_release_array(left));
-        AF_CHECK(af_release_array(sortedIn_handle));
+        AF_CHECK(af_cast(&out, middle_handle, f32));
+        AF_CHECK(af_release_array(middle_handle));
         return out;
-    } else {
-        // ((mid-1)+mid)/2 is our guy
-        dim4 dims      = input.dims();
-        af_array right = 0;
-        slices[dim]    = af_make_seq(mid, mid, 1.0);
-
-        AF_CHECK(af_index(&right, sortedIn_handle, dims.ndims(), slices));
-
-        af_array sumarr = 0;
-        af_array carr   = 0;
-
-        dim4 cdims = dims;
-        cdims[dim] = 1;
-        AF_CHECK(af_constant(&carr, 0.5, cdims.ndims(), cdims.get(),
-                             input.isDouble() ? f64 : f32));
-
-        if (!input.isFloating()) {
-            af_array lleft, rright;
-            AF_CHECK(af_cast(&lleft, left, f32));
-            AF_CHECK(af_cast(&rright, right, f32));
-            AF_CHECK(af_release_array(left));
-            AF_CHECK(af_release_array(right));
-            left  = lleft;
-            right = rright;
-        }
+    }
 
-        AF_CHECK(af_add(&sumarr, left, right, false));
-        AF_CHECK(af_mul(&out, sumarr, carr, false));
+    // The mean of the two elements is our guy
+    dim4 dims        = input.dims();
+    af_array left    = 0;
+    af_array right   = 0;
+    af_seq slices[4] = {af_span, af_span, af_span, af_span};
+
+    slices[dim] = af_make_seq(0.0, 0.0, 1.0);
+    AF_CHECK(af_index(&left, middle_handle, dims.ndims(), slices));
+    slices[dim] = af_make_seq(1.0, 1.0, 1.0);
+    AF_CHECK(af_index(&right, middle_handle, dims.ndims(), slices));
+
+    af_array out    = nullptr;
+    af_array sumarr = 0;
+    af_array carr   = 0;
 
+    dim4 cdims = dims;
+    cdims[dim] = 1;
+    AF_CHECK(af_constant(&carr, 0.5, cdims.ndims(), cdims.get(),
+                         input.isDouble() ? f64 : f32));
+
+    if (!input.isFloating()) {
+        af_array lleft, rright;
+        AF_CHECK(af_cast(&lleft, left, f32));
+        AF_CHECK(af_cast(&rright, right, f32));
         AF_CHECK(af_release_array(left));
         AF_CHECK(af_release_array(right));
-        AF_CHECK(af_release_array(sumarr));
-        AF_CHECK(af_release_array(carr));
-        AF_CHECK(af_release_array(sortedIn_handle));
+        left  = lleft;
+        right = rright;
     }
+
+    AF_CHECK(af_add(&sumarr, left, right, false));
+    AF_CHECK(af_mul(&out, sumarr, carr, false));
+
+    AF_CHECK(af_release_array(left));
+    AF_CHECK(af_release_array(right));
+    AF_CHECK(af_release_array(sumarr));
+    AF_CHECK(af_release_array(carr));
+    AF_CHECK(af_release_array(middle_handle));
     return out;
 }
 
@@ -30,6 +30,7 @@ using common::half;
 using detail::cdouble;
 using detail::cfloat;
 using detail::createDeviceDataArray;
+using detail::deviceMemoryFragmentationInfo;
 using detail::deviceMemoryInfo;
 using detail::getActiveDeviceId;
 using detail::getDeviceCount;
@@ -359,6 +360,18 @@ af_err af_device_mem_info(size_t *alloc_bytes, size_t *alloc_buffers,
     return AF_SUCCESS;
 }
 
+af_err af_device_mem_fragmentation_info(size_t *unused_bytes,
+                                        size_t *free_bytes,
+                                        size_t *free_buffers,
+                                        size_t *largest_free_bytes) {
+    try {
+        deviceMemoryFragmentationInfo(unused_bytes, free_bytes, free_buffers,
+                                      largest_free_bytes);
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
+
 af_err af_set_mem_step_size(const size_t step_bytes) {
     try {
         detail::setMemStepSize(step_bytes);
@@ -792,6 +805,17 @@ void MemoryManagerFunctionWrapper::usageInfo(size_t * /*alloc_bytes*/,
         AF_ERR_NOT_SUPPORTED);
 }
 
+void MemoryManagerFunctionWrapper::fragmentationInfo(
+    size_t * /*unused_bytes*/, size_t * /*free_bytes*/,
+    size_t * /*free_buffers*/, size_t * /*largest_free_bytes*/) {
+    // The public memory manager API has no way to report the fragmentation
+    // of a custom memory manager's cache
+    AF_ERROR(
+        "Device memory fragmentation info not supported "
+        "for custom memory manager",
+        AF_ERR_NOT_SUPPORTED);
+}
+
 float MemoryManagerFunctionWrapper::getMemoryPressure() {
     float out;
     AF_CHECK(getMemoryManager(handle_).get_memory_pressure_fn(handle_, &out));
@@ -38,6 +38,9 @@ class MemoryManagerFunctionWrapper final
     void printInfo(const char *msg, const int device) override;
     void usageInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                    size_t *lock_bytes, size_t *lock_buffers) override;
+    void fragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                           size_t *free_buffers,
+                           size_t *largest_free_bytes) override;
     void userLock(const void *ptr) override;
     void userUnlock(const void *ptr) override;
     bool isUserLocked(const void *ptr) override;
@@ -67,7 +67,15 @@ af_array morph<char>(const af_array &input, const af_array &mask,
     const Array<float> se = castArray<float>(mask);
     const dim4 &seDims    = se.dims();
 
-    if (seDims[0] <= fftMethodThreshold) {
+#if defined(AF_CPU)
+    // Flat rectangles are filtered in time independent of their size
+    const bool useFFT = seDims[0] > fftMethodThreshold &&
+                        !detail::isRectangularMask(se);
+#else
+    const bool useFFT = seDims[0] > fftMethodThreshold;
+#endif  // defined(AF_CPU)
+
+    if (!useFFT) {
         auto out =
             morph(getArray<char>(input), castArray<char>(mask), isDilation);
         return getHandle(out);
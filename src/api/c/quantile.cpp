@@ -0,0 +1,194 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <arith.hpp>
+#include <backend.hpp>
+#include <common/cast.hpp>
+#include <common/err_common.hpp>
+#include <copy.hpp>
+#include <handle.hpp>
+#include <kth_element.hpp>
+#include <lookup.hpp>
+#include <tile.hpp>
+#include <af/defines.h>
+#include <af/dim4.hpp>
+#include <af/statistics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using af::dim4;
+using common::cast;
+using detail::arithOp;
+using detail::Array;
+using detail::copyData;
+using detail::createHostDataArray;
+using detail::kth_element;
+using detail::lookup;
+using detail::tile;
+using detail::uchar;
+using detail::uint;
+using detail::ushort;
+using std::vector;
+
+namespace {
+
+/// The quantile p of n values is computed from the two elements around the
+/// position (n - 1) * p of the sorted values
+struct QuantileRanks {
+    vector<dim_t> lower;    // The rank of the element below the position
+    vector<dim_t> upper;    // The rank of the element above the position
+    vector<double> weight;  // The weight of the upper element
+};
+
+QuantileRanks quantileRanks(const vector<double>& probs, const dim_t n,
+                            const af_quantile_method method) {
+    QuantileRanks ranks;
+    for (double p : probs) {
+        const double h = static_cast<double>(n - 1) * p;
+        dim_t lo       = static_cast<dim_t>(std::floor(h));
+        dim_t hi       = std::min(lo + 1, n - 1);
+        double w       = h - static_cast<double>(lo);
+        if (w == 0.0) { hi = lo; }
+
+        switch (method) {
+            case AF_QUANTILE_LINEAR: break;
+            case AF_QUANTILE_LOWER: hi = lo; break;
+            case AF_QUANTILE_HIGHER: lo = hi; break;
+            case AF_QUANTILE_NEAREST:
+                // nearbyint rounds the ties to the even rank
+                lo = hi = static_cast<dim_t>(std::nearbyint(h));
+                break;
+            case AF_QUANTILE_MIDPOINT: w = (lo == hi) ? 0.0 : 0.5; break;
+        }
+        if (lo == hi) { w = 0.0; }
+
+        ranks.lower.push_back(lo);
+        ranks.upper.push_back(hi);
+        ranks.weight.push_back(w);
+    }
+    return ranks;
+}
+
+// Returns the positions of \p ranks in \p sorted along \p dim
+Array<uint> rankIndices(const vector<dim_t>& ranks,
+                        const vector<dim_t>& sorted) {
+    vector<uint> idx(ranks.size());
+    for (size_t i = 0; i < ranks.size(); i++) {
+        idx[i] = static_cast<uint>(
+            std::lower_bound(sorted.begin(), sorted.end(), ranks[i]) -
+            sorted.begin());
+    }
+    return createHostDataArray<uint>(dim4(static_cast<dim_t>(idx.size())),
+                                     idx.data());
+}
+
+template<typename T, typename To>
+af_array quantile(const af_array in, const vector<double>& probs,
+                  const dim_t dim, const af_quantile_method method) {
+    const Array<T> input = getArray<T>(in);
+    const dim_t n        = input.dims()[dim];
+    QuantileRanks ranks  = quantileRanks(probs, n, method);
+
+    // All the elements needed by the quantiles are selected in one pass
+    vector<dim_t> selected(ranks.lower);
+    selected.insert(selected.end(), ranks.upper.begin(), ranks.upper.end());
+    std::sort(selected.begin(), selected.end());
+    selected.erase(std::unique(selected.begin(), selected.end()),
+                   selected.end());
+
+    Array<To> values = cast<To>(kth_element<T>(input, selected, dim));
+    Array<To> lower =
+        lookup<To, uint>(values, rankIndices(ranks.lower, selected), dim);
+
+    bool interpolate = std::any_of(ranks.weight.begin(), ranks.weight.end(),
+                                   [](double w) { return w != 0.0; });
+    if (!interpolate) { return getHandle(lower); }
+
+    Array<To> upper =
+        lookup<To, uint>(values, rankIndices(ranks.upper, selected), dim);
+
+    const dim4 odims = lower.dims();
+    dim4 wdims(1);
+    dim4 tileDims = odims;
+    wdims[dim]    = odims[dim];
+    tileDims[dim] = 1;
+    vector<To> hweight(ranks.weight.begin(), ranks.weight.end());
+    Array<To> weight =
+        tile<To>(createHostDataArray<To>(wdims, hweight.data()), tileDims);
+
+    // lower + (upper - lower) * weight
+    Array<To> diff = arithOp<To, af_sub_t>(upper, lower, odims);
+    Array<To> step = arithOp<To, af_mul_t>(diff, weight, odims);
+    return getHandle(arithOp<To, af_add_t>(lower, step, odims));
+}
+
+vector<double> getProbabilities(const af_array probs) {
+    const ArrayInfo& info = getInfo(probs);
+    vector<double> out(info.elements());
+    if (info.getType() == f64) {
+        copyData(out.data(), getArray<double>(probs));
+    } else {
+        vector<float> hprobs(info.elements());
+        copyData(hprobs.data(), getArray<float>(probs));
+        std::copy(hprobs.begin(), hprobs.end(), out.begin());
+    }
+    return out;
+}
+
+}  // namespace
+
+af_err af_quantile(af_array* out, const af_array in, const af_array probs,
+                   const dim_t dim, const af_quantile_method method) {
+    try {
+        ARG_ASSERT(3, (dim >= 0 && dim < 4));
+        ARG_ASSERT(4, (method >= AF_QUANTILE_LINEAR &&
+                       method <= AF_QUANTILE_MIDPOINT));
+
+        const ArrayInfo& info  = getInfo(in);
+        const ArrayInfo& pinfo = getInfo(probs);
+        ARG_ASSERT(1, info.elements() > 0);
+        ARG_ASSERT(2, pinfo.elements() > 0 && pinfo.isVector());
+        ARG_ASSERT(2, pinfo.isRealFloating() && !pinfo.isHalf());
+
+        vector<double> hprobs = getProbabilities(probs);
+        for (double p : hprobs) { ARG_ASSERT(2, p >= 0.0 && p <= 1.0); }
+
+        af_array output = 0;
+        af_dtype type   = info.getType();
+        switch (type) {
+            case f64:
+                output = quantile<double, double>(in, hprobs, dim, method);
+                break;
+            case f32:
+                output = quantile<float, float>(in, hprobs, dim, method);
+                break;
+            case s32:
+                output = quantile<int, float>(in, hprobs, dim, method);
+                break;
+            case u32:
+                output = quantile<uint, float>(in, hprobs, dim, method);
+                break;
+            case s16:
+                output = quantile<short, float>(in, hprobs, dim, method);
+                break;
+            case u16:
+                output = quantile<ushort, float>(in, hprobs, dim, method);
+                break;
+            case u8:
+                output = quantile<uchar, float>(in, hprobs, dim, method);
+                break;
+            default: TYPE_ERROR(1, type);
+        }
+        std::swap(*out, output);
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
@@ -10,6 +10,7 @@
 #include <backend.hpp>
 #include <common/err_common.hpp>
 #include <common/half.hpp>
+#include <common/summation.hpp>
 #include <copy.hpp>
 #include <handle.hpp>
 #include <ireduce.hpp>
@@ -456,6 +457,26 @@ af_err af_product(af_array *out, const af_array in, const int dim) {
     return reduce_promote<af_mul_t>(out, in, dim);
 }
 
+af_err af_set_summation_type(const af_summation_type type) {
+    try {
+        ARG_ASSERT(0, type == AF_SUMMATION_DEFAULT ||
+                          type == AF_SUMMATION_PAIRWISE ||
+                          type == AF_SUMMATION_KAHAN);
+        common::setSummationType(type);
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
+
+af_err af_get_summation_type(af_summation_type *type) {
+    try {
+        ARG_ASSERT(0, type != nullptr);
+        *type = common::getSummationType();
+    }
+    CATCHALL;
+    return AF_SUCCESS;
+}
+
 af_err af_sum_nan(af_array *out, const af_array in, const int dim,
                   const double nanval) {
     return reduce_promote<af_add_t>(out, in, dim, true, nanval);
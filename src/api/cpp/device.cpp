@@ -161,6 +161,14 @@ void deviceMemInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                                 lock_buffers));
 }
 
+void deviceMemFragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                size_t *free_buffers,
+                                size_t *largest_free_bytes) {
+    AF_THROW(af_device_mem_fragmentation_info(unused_bytes, free_bytes,
+                                              free_buffers,
+                                              largest_free_bytes));
+}
+
 void setMemStepSize(const size_t step_bytes) {
     AF_THROW(af_set_mem_step_size(step_bytes));
 }
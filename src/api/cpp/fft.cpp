@@ -264,4 +264,8 @@ FFT_REAL(3)
 void setFFTPlanCacheSize(size_t cacheSize) {
     AF_THROW(af_set_fft_plan_cache_size(cacheSize));
 }
+
+void setFFTNumThreads(unsigned numThreads) {
+    AF_THROW(af_set_fft_num_threads(numThreads));
+}
 }  // namespace af
@@ -8,6 +8,7 @@
  ********************************************************/
 
 #include <jit_test_api.h>
+#include <af/array.h>
 #include "error.hpp"
 
 namespace af {
@@ -18,4 +19,10 @@ int getMaxJitLen(void) {
 }
 
 void setMaxJitLen(const int jitLen) { AF_THROW(af_set_max_jit_len(jitLen)); }
+
+int getJitNodeCount(const array &in) {
+    int retVal = 0;
+    AF_THROW(af_get_jit_node_count(&retVal, in.get()));
+    return retVal;
+}
 }  // namespace af
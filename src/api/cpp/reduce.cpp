@@ -44,6 +44,16 @@ void sumByKey(array &keys_out, array &vals_out, const array &keys,
     vals_out = array(ovals);
 }
 
+void setSummationType(const summationType type) {
+    AF_THROW(af_set_summation_type(type));
+}
+
+summationType getSummationType() {
+    af_summation_type type = AF_SUMMATION_DEFAULT;
+    AF_THROW(af_get_summation_type(&type));
+    return type;
+}
+
 array product(const array &in, const int dim) {
     af_array out = 0;
     AF_THROW(af_product(&out, in.get(), getFNSD(dim, in.dims())));
@@ -30,6 +30,14 @@ ALGO_HAPI_DEF(af_diff2)
 
 #undef ALGO_HAPI_DEF
 
+af_err af_set_summation_type(const af_summation_type type) {
+    CALL(af_set_summation_type, type);
+}
+
+af_err af_get_summation_type(af_summation_type *type) {
+    CALL(af_get_summation_type, type);
+}
+
 #define ALGO_HAPI_DEF_BYKEY(af_func)                                          \
     af_err af_func(af_array *keys_out, af_array *vals_out,                    \
                    const af_array keys, const af_array vals, const int dim) { \
@@ -119,6 +119,14 @@ af_err af_device_mem_info(size_t *alloc_bytes, size_t *alloc_buffers,
          lock_buffers);
 }
 
+af_err af_device_mem_fragmentation_info(size_t *unused_bytes,
+                                        size_t *free_bytes,
+                                        size_t *free_buffers,
+                                        size_t *largest_free_bytes) {
+    CALL(af_device_mem_fragmentation_info, unused_bytes, free_bytes,
+         free_buffers, largest_free_bytes);
+}
+
 af_err af_print_mem_info(const char *msg, const int device_id) {
     CALL(af_print_mem_info, msg, device_id);
 }
@@ -187,3 +195,7 @@ af_err af_set_kernel_cache_directory(const char *path, int override_eval) {
 af_err af_get_kernel_cache_directory(size_t *length, char *path) {
     CALL(af_get_kernel_cache_directory, length, path);
 }
+
+af_err af_warmup_kernels(const char *manifest) {
+    CALL(af_warmup_kernels, manifest);
+}
@@ -137,6 +137,14 @@ af_err af_bilateral(af_array *out, const af_array in, const float spatial_sigma,
     CALL(af_bilateral, out, in, spatial_sigma, chromatic_sigma, isColor);
 }
 
+af_err af_bilateral_v2(af_array *out, const af_array in,
+                       const float spatial_sigma, const float chromatic_sigma,
+                       const bool isColor, const af_bilateral_method method) {
+    CHECK_ARRAYS(in);
+    CALL(af_bilateral_v2, out, in, spatial_sigma, chromatic_sigma, isColor,
+         method);
+}
+
 af_err af_mean_shift(af_array *out, const af_array in,
                      const float spatial_sigma, const float chromatic_sigma,
                      const unsigned iter, const bool is_color) {
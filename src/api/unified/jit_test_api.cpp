@@ -16,3 +16,8 @@ af_err af_get_max_jit_len(int *jitLen) { CALL(af_get_max_jit_len, jitLen); }
 af_err af_set_max_jit_len(const int jitLen) {
     CALL(af_set_max_jit_len, jitLen);
 }
+
+af_err af_get_jit_node_count(int *count, const af_array in) {
+    CHECK_ARRAYS(in);
+    CALL(af_get_jit_node_count, count, in);
+}
@@ -82,6 +82,10 @@ af_err af_set_fft_plan_cache_size(size_t cache_size) {
     CALL(af_set_fft_plan_cache_size, cache_size);
 }
 
+af_err af_set_fft_num_threads(const unsigned num_threads) {
+    CALL(af_set_fft_num_threads, num_threads);
+}
+
 #define FFT_HAPI_DEF(af_func)                               \
     af_err af_func(af_array in, const double norm_factor) { \
         CHECK_ARRAYS(in);                                   \
@@ -62,6 +62,12 @@ af_err af_median(af_array *out, const af_array in, const dim_t dim) {
     CALL(af_median, out, in, dim);
 }
 
+af_err af_quantile(af_array *out, const af_array in, const af_array probs,
+                   const dim_t dim, const af_quantile_method method) {
+    CHECK_ARRAYS(in, probs);
+    CALL(af_quantile, out, in, probs, dim, method);
+}
+
 af_err af_mean_all(double *real, double *imag, const af_array in) {
     CHECK_ARRAYS(in);
     CALL(af_mean_all, real, imag, in);
@@ -33,6 +33,9 @@ class AllocatorInterface {
     virtual size_t getMaxMemorySize(int id)       = 0;
     virtual void *nativeAlloc(const size_t bytes) = 0;
     virtual void nativeFree(void *ptr)            = 0;
+    // The alignment of the pieces a buffer from nativeAlloc may be split
+    // into, or 0 if the buffers are opaque handles that cannot be offset
+    virtual size_t getSplitAlignment() { return 0; }
     virtual spdlog::logger *getLogger() final { return this->logger.get(); }
 
    protected:
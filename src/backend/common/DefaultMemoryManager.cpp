@@ -18,12 +18,15 @@
 
 #include <algorithm>
 #include <cstdio>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
 
 using std::max;
+using std::min;
 using std::move;
+using std::pair;
 using std::stoi;
 using std::string;
 using std::vector;
@@ -35,6 +38,93 @@ DefaultMemoryManager::getCurrentMemoryInfo() {
     return memory[this->getActiveDeviceId()];
 }
 
+pair<void *, size_t> DefaultMemoryManager::takeFreeBuffer(
+    DefaultMemoryManager::memory_info &current, size_t bytes) {
+    // The free buffers never hold empty vectors, so the first size that is
+    // large enough has the best fitting buffer
+    auto iter = current.free_map.lower_bound(bytes);
+    if (iter == current.free_map.end()) { return {nullptr, 0}; }
+
+    // Keep a large buffer for a large allocation instead of wasting it,
+    // unless the rest of the buffer can be split off and cached on its own
+    const size_t buffer_bytes = iter->first;
+    const size_t unused_bytes = buffer_bytes - bytes;
+    size_t piece_bytes        = buffer_bytes;
+    if (unused_bytes * 100 > buffer_bytes * this->max_waste_percent) {
+        const size_t alignment = this->getSplitAlignment();
+        if (alignment == 0) { return {nullptr, 0}; }
+        piece_bytes = min(buffer_bytes, divup(bytes, alignment) * alignment);
+    }
+
+    char *ptr = static_cast<char *>(iter->second.back());
+    iter->second.pop_back();
+    if (iter->second.empty()) { current.free_map.erase(iter); }
+
+    auto piece = current.split_map.find(ptr);
+    if (piece != current.split_map.end()) { piece->second.free = false; }
+
+    if (piece_bytes < buffer_bytes) {
+        if (piece == current.split_map.end()) {
+            split_info info = {ptr, buffer_bytes, buffer_bytes, false};
+            piece           = current.split_map.emplace(ptr, info).first;
+        }
+        split_info rest = {piece->second.parent, piece->second.parent_bytes,
+                           buffer_bytes - piece_bytes, true};
+        piece->second.bytes = piece_bytes;
+        current.split_map.emplace(ptr + piece_bytes, rest);
+        current.free_map[rest.bytes].emplace_back(ptr + piece_bytes);
+        current.total_buffers++;
+        current.split_buffers++;
+    }
+    return {ptr, piece_bytes};
+}
+
+void DefaultMemoryManager::addFreeBuffer(
+    DefaultMemoryManager::memory_info &current, void *ptr, size_t bytes) {
+    auto piece = current.split_map.find(static_cast<char *>(ptr));
+    if (piece != current.split_map.end()) {
+        char *parent = piece->second.parent;
+
+        auto next = std::next(piece);
+        if (next != current.split_map.end() && next->second.free &&
+            next->second.parent == parent) {
+            removeFreeBuffer(current, next->first, next->second.bytes);
+            piece->second.bytes += next->second.bytes;
+            current.split_map.erase(next);
+            current.total_buffers--;
+        }
+
+        if (piece != current.split_map.begin()) {
+            auto prev = std::prev(piece);
+            if (prev->second.free && prev->second.parent == parent) {
+                removeFreeBuffer(current, prev->first, prev->second.bytes);
+                prev->second.bytes += piece->second.bytes;
+                current.split_map.erase(piece);
+                piece = prev;
+                current.total_buffers--;
+            }
+        }
+
+        piece->second.free = true;
+        ptr                = piece->first;
+        bytes              = piece->second.bytes;
+
+        // The buffer is whole again once all of its pieces are merged
+        if (bytes == piece->second.parent_bytes) {
+            current.split_map.erase(piece);
+        }
+    }
+    current.free_map[bytes].emplace_back(ptr);
+}
+
+void DefaultMemoryManager::removeFreeBuffer(
+    DefaultMemoryManager::memory_info &current, void *ptr, size_t bytes) {
+    auto iter            = current.free_map.find(bytes);
+    vector<void *> &ptrs = iter->second;
+    ptrs.erase(std::find(begin(ptrs), end(ptrs), ptr));
+    if (ptrs.empty()) { current.free_map.erase(iter); }
+}
+
 void DefaultMemoryManager::cleanDeviceMemoryManager(int device) {
     if (this->debug_mode) { return; }
 
@@ -50,18 +140,24 @@ void DefaultMemoryManager::cleanDeviceMemoryManager(int device) {
         if (current.total_buffers == current.lock_buffers) { return; }
         free_ptrs.reserve(current.free_map.size());
 
+        // The free pieces of a split buffer stay cached until the rest of
+        // the buffer is unlocked, because only the whole buffer can be freed
+        free_t split_free_map;
         for (auto &kv : current.free_map) {
-            size_t num_ptrs = kv.second.size();
-            // Free memory by pushing the last element into the free_ptrs
-            // vector which will be freed once outside of the lock
-            // for (auto ptr : kv.second) { free_ptrs.emplace_back(pair); }
-            std::move(begin(kv.second), end(kv.second),
-                      back_inserter(free_ptrs));
-            current.total_bytes -= num_ptrs * kv.first;
-            bytes_freed += num_ptrs * kv.first;
-            current.total_buffers -= num_ptrs;
+            // Free memory by pushing the pointers into the free_ptrs vector
+            // which will be freed once outside of the lock
+            for (void *ptr : kv.second) {
+                if (current.split_map.count(static_cast<char *>(ptr))) {
+                    split_free_map[kv.first].emplace_back(ptr);
+                    continue;
+                }
+                free_ptrs.emplace_back(ptr);
+                current.total_bytes -= kv.first;
+                bytes_freed += kv.first;
+                current.total_buffers--;
+            }
         }
-        current.free_map.clear();
+        current.free_map = move(split_free_map);
     }
 
     AF_TRACE("GC: Clearing {} buffers {}", free_ptrs.size(),
@@ -74,6 +170,7 @@ DefaultMemoryManager::DefaultMemoryManager(int num_devices,
                                            unsigned max_buffers, bool debug)
     : mem_step_size(1024)
     , max_buffers(max_buffers)
+    , max_waste_percent(MAX_WASTE_PERCENT)
     , debug_mode(debug)
     , memory(num_devices) {
     // Check for environment variables
@@ -86,6 +183,12 @@ DefaultMemoryManager::DefaultMemoryManager(int num_devices,
     // Max Buffer count
     env_var = getEnvVar("AF_MAX_BUFFERS");
     if (!env_var.empty()) { this->max_buffers = max(1, stoi(env_var)); }
+
+    // Largest unused percentage of a reused buffer
+    env_var = getEnvVar("AF_MEM_MAX_WASTE");
+    if (!env_var.empty()) {
+        this->max_waste_percent = min(100, max(0, stoi(env_var)));
+    }
 }
 
 void DefaultMemoryManager::initialize() { this->setMaxMemorySize(); }
@@ -157,7 +260,7 @@ void *DefaultMemoryManager::alloc(bool user_lock, const unsigned ndims,
 
     if (bytes > 0) {
         memory_info &current = this->getCurrentMemoryInfo();
-        locked_info info     = {!user_lock, user_lock, alloc_bytes};
+        locked_info info     = {!user_lock, user_lock, alloc_bytes, 0};
 
         // There is no memory cache in debug mode
         if (!this->debug_mode) {
@@ -176,17 +279,16 @@ void *DefaultMemoryManager::alloc(bool user_lock, const unsigned ndims,
             }
 
             lock_guard_t lock(this->memory_mutex);
-            auto free_buffer_iter = current.free_map.find(alloc_bytes);
-            if (free_buffer_iter != current.free_map.end() &&
-                !free_buffer_iter->second.empty()) {
-                // Delete existing buffer info and underlying event
-                // Set to existing in from free map
-                vector<void *> &free_buffer_vector = free_buffer_iter->second;
-                ptr                                = free_buffer_vector.back();
-                free_buffer_vector.pop_back();
+            auto free_buffer = takeFreeBuffer(current, alloc_bytes);
+            if (free_buffer.first) {
+                ptr                     = free_buffer.first;
+                info.bytes              = free_buffer.second;
+                info.unused_bytes       = free_buffer.second - alloc_bytes;
                 current.locked_map[ptr] = info;
-                current.lock_bytes += alloc_bytes;
+                current.lock_bytes += info.bytes;
                 current.lock_buffers++;
+                current.unused_bytes += info.unused_bytes;
+                current.reused_buffers++;
             }
         }
 
@@ -208,6 +310,7 @@ void *DefaultMemoryManager::alloc(bool user_lock, const unsigned ndims,
             current.locked_map[ptr] = info;
             current.lock_bytes += alloc_bytes;
             current.lock_buffers++;
+            current.allocated_buffers++;
         }
     }
 
@@ -256,6 +359,7 @@ void DefaultMemoryManager::unlock(void *ptr, bool user_unlock) {
         size_t bytes = locked_buffer_info.bytes;
         current.lock_bytes -= locked_buffer_info.bytes;
         current.lock_buffers--;
+        current.unused_bytes -= locked_buffer_info.unused_bytes;
 
         if (this->debug_mode) {
             // Just free memory in debug mode
@@ -265,7 +369,7 @@ void DefaultMemoryManager::unlock(void *ptr, bool user_unlock) {
                 current.total_bytes -= locked_buffer_info.bytes;
             }
         } else {
-            current.free_map[bytes].emplace_back(ptr);
+            addFreeBuffer(current, ptr, bytes);
         }
         current.locked_map.erase(locked_buffer_iter);
     }
@@ -324,6 +428,23 @@ void DefaultMemoryManager::printInfo(const char *msg, const int device) {
     }
 
     printf("---------------------------------------------------------\n");
+
+    // Fragmentation of the cache: how much of the locked memory was not
+    // requested, and how much memory sits in free buffers
+    const size_t free_bytes   = current.total_bytes - current.lock_bytes;
+    const size_t free_buffers = current.total_buffers - current.lock_buffers;
+    printf("Unused in locked buffers: %s (%.1f%% of locked)\n",
+           bytesToString(current.unused_bytes).c_str(),
+           current.lock_bytes == 0
+               ? 0.0
+               : 100.0 * static_cast<double>(current.unused_bytes) /
+                     static_cast<double>(current.lock_bytes));
+    printf("Free buffers: %zu holding %s\n", free_buffers,
+           bytesToString(free_bytes).c_str());
+    printf("Allocations: %zu reused, %zu new, %zu split\n",
+           current.reused_buffers, current.allocated_buffers,
+           current.split_buffers);
+    printf("---------------------------------------------------------\n");
 }
 
 void DefaultMemoryManager::usageInfo(size_t *alloc_bytes, size_t *alloc_buffers,
@@ -336,6 +457,23 @@ void DefaultMemoryManager::usageInfo(size_t *alloc_bytes, size_t *alloc_buffers,
     if (lock_buffers) { *lock_buffers = current.lock_buffers; }
 }
 
+void DefaultMemoryManager::fragmentationInfo(size_t *unused_bytes,
+                                             size_t *free_bytes,
+                                             size_t *free_buffers,
+                                             size_t *largest_free_bytes) {
+    const memory_info &current = this->getCurrentMemoryInfo();
+    lock_guard_t lock(this->memory_mutex);
+    if (unused_bytes) { *unused_bytes = current.unused_bytes; }
+    if (free_bytes) { *free_bytes = current.total_bytes - current.lock_bytes; }
+    if (free_buffers) {
+        *free_buffers = current.total_buffers - current.lock_buffers;
+    }
+    if (largest_free_bytes) {
+        *largest_free_bytes =
+            current.free_map.empty() ? 0 : current.free_map.rbegin()->first;
+    }
+}
+
 void DefaultMemoryManager::userLock(const void *ptr) {
     memory_info &current = this->getCurrentMemoryInfo();
 
@@ -345,7 +483,8 @@ void DefaultMemoryManager::userLock(const void *ptr) {
     if (locked_iter != current.locked_map.end()) {
         locked_iter->second.user_lock = true;
     } else {
-        locked_info info = {false, true, 100};  // This number is not relevant
+        // The size is not relevant
+        locked_info info = {false, true, 100, 0};
 
         current.locked_map[const_cast<void *>(ptr)] = info;
     }
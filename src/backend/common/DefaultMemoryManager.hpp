@@ -13,7 +13,9 @@
 #include <common/defines.hpp>
 
 #include <functional>
+#include <map>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace common {
@@ -21,11 +23,16 @@ namespace common {
 constexpr unsigned MAX_BUFFERS = 1000;
 constexpr size_t ONE_GB        = 1 << 30;
 
+/// The default largest percentage of a cached buffer that may go unused when
+/// it is reused for a smaller allocation
+constexpr unsigned MAX_WASTE_PERCENT = 25;
+
 using uptr_t = std::unique_ptr<void, std::function<void(void *)>>;
 
 class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
     size_t mem_step_size;
     unsigned max_buffers;
+    unsigned max_waste_percent;
 
     bool debug_mode;
 
@@ -33,20 +40,43 @@ class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
         bool manager_lock;
         bool user_lock;
         size_t bytes;
+        // The bytes of the buffer beyond the size that was requested
+        size_t unused_bytes;
     };
 
     using locked_t = typename std::unordered_map<void *, locked_info>;
-    using free_t   = std::unordered_map<size_t, std::vector<void *>>;
+    // The free buffers are ordered by size so an allocation can take the
+    // smallest cached buffer that is large enough
+    using free_t = std::map<size_t, std::vector<void *>>;
+
+    // A piece of a cached buffer that was split so a small allocation could
+    // use part of a large buffer. The buffer is only freed once all of its
+    // pieces are free and merged back together.
+    struct split_info {
+        char *parent;
+        size_t parent_bytes;
+        size_t bytes;
+        bool free;
+    };
+
+    // The pieces are ordered by address, so the neighbours of a piece in the
+    // same buffer are next to it
+    using split_t = std::map<char *, split_info>;
 
     struct memory_info {
         locked_t locked_map;
         free_t free_map;
+        split_t split_map;
 
         size_t max_bytes;
         size_t total_bytes;
         size_t total_buffers;
         size_t lock_bytes;
         size_t lock_buffers;
+        size_t unused_bytes;
+        size_t reused_buffers;
+        size_t allocated_buffers;
+        size_t split_buffers;
 
         memory_info()
             // Calling getMaxMemorySize() here calls the virtual function
@@ -55,7 +85,11 @@ class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
             , total_bytes(0)
             , total_buffers(0)
             , lock_bytes(0)
-            , lock_buffers(0) {}
+            , lock_buffers(0)
+            , unused_bytes(0)
+            , reused_buffers(0)
+            , allocated_buffers(0)
+            , split_buffers(0) {}
 
         memory_info(memory_info &other)  = delete;
         memory_info(memory_info &&other) = default;
@@ -65,6 +99,20 @@ class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
 
     memory_info &getCurrentMemoryInfo();
 
+    /// Removes the best fitting free buffer for an allocation of \p bytes
+    /// from the cache of \p current and returns it along with its size. A
+    /// buffer that would mostly go unused is split if the allocator allows
+    /// it. Returns a null pointer if no cached buffer fits.
+    std::pair<void *, size_t> takeFreeBuffer(memory_info &current,
+                                             size_t bytes);
+
+    /// Caches the free buffer \p ptr of \p bytes, after merging it with the
+    /// free pieces next to it if it is a piece of a split buffer
+    void addFreeBuffer(memory_info &current, void *ptr, size_t bytes);
+
+    /// Removes the free buffer \p ptr of \p bytes from the cache
+    void removeFreeBuffer(memory_info &current, void *ptr, size_t bytes);
+
    public:
     DefaultMemoryManager(int num_devices, unsigned max_buffers, bool debug);
 
@@ -89,9 +137,11 @@ class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
     /// Returns a pointer of size at least long
     ///
     /// This funciton will return a memory location of at least \p size
-    /// bytes. If there is already a free buffer available, it will use
-    /// that buffer. Otherwise, it will allocate a new buffer using the
-    /// nativeAlloc function.
+    /// bytes. If there is a free buffer that is large enough, and not so
+    /// large that more than max_waste_percent of it would go unused, the
+    /// smallest such buffer is used. A larger buffer is split when the
+    /// allocator has a split alignment. Otherwise, it will allocate a new
+    /// buffer using the nativeAlloc function.
     void *alloc(bool user_lock, const unsigned ndims, dim_t *dims,
                 const unsigned element_size) override;
 
@@ -110,6 +160,9 @@ class DefaultMemoryManager final : public common::memory::MemoryManagerBase {
     void printInfo(const char *msg, const int device) override;
     void usageInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                    size_t *lock_bytes, size_t *lock_buffers) override;
+    void fragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                           size_t *free_buffers,
+                           size_t *largest_free_bytes) override;
     void userLock(const void *ptr) override;
     void userUnlock(const void *ptr) override;
     bool isUserLocked(const void *ptr) override;
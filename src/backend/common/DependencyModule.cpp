@@ -92,12 +92,18 @@ namespace common {
 DependencyModule::DependencyModule(const char* plugin_file_name,
                                    const char** paths)
     : handle(nullptr), logger(common::loggerFactory("platform")) {
-    // TODO(umar): Implement handling of non-standard paths
-    UNUSED(paths);
     if (plugin_file_name) {
         auto fileNames = libNames(plugin_file_name, "");
-        AF_TRACE("Attempting to load: {}", fileNames[0]);
-        handle = loadLibrary(fileNames[0].c_str());
+        for (const char** path = paths; path && *path && !handle; path++) {
+            const string fileName =
+                string(*path) + AF_PATH_SEPARATOR + fileNames[0];
+            AF_TRACE("Attempting to load: {}", fileName);
+            handle = loadLibrary(fileName.c_str());
+        }
+        if (!handle) {
+            AF_TRACE("Attempting to load: {}", fileNames[0]);
+            handle = loadLibrary(fileNames[0].c_str());
+        }
         if (handle) {
             AF_TRACE("Found: {}", fileNames[0]);
         } else {
@@ -41,8 +41,8 @@ class DependencyModule {
     /// Loads the library \p plugin_file_name from the \p paths locations
     /// \param plugin_file_name  The name of the library without any prefix or
     ///                          extensions
-    /// \param paths             The locations to search for the libraries if
-    ///                          not found in standard locations
+    /// \param paths             A null terminated list of locations that
+    ///                          are searched before the standard locations
     DependencyModule(const char* plugin_file_name,
                      const char** paths = nullptr);
 
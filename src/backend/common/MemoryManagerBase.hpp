@@ -48,6 +48,9 @@ class MemoryManagerBase {
     virtual void printInfo(const char *msg, const int device)        = 0;
     virtual void usageInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                            size_t *lock_bytes, size_t *lock_buffers) = 0;
+    virtual void fragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                   size_t *free_buffers,
+                                   size_t *largest_free_bytes)       = 0;
     virtual void userLock(const void *ptr)                           = 0;
     virtual void userUnlock(const void *ptr)                         = 0;
     virtual bool isUserLocked(const void *ptr)                       = 0;
@@ -63,6 +66,7 @@ class MemoryManagerBase {
     size_t getMaxMemorySize(int id) { return nmi_->getMaxMemorySize(id); }
     void *nativeAlloc(const size_t bytes) { return nmi_->nativeAlloc(bytes); }
     void nativeFree(void *ptr) { nmi_->nativeFree(ptr); }
+    size_t getSplitAlignment() { return nmi_->getSplitAlignment(); }
     virtual spdlog::logger *getLogger() final { return nmi_->getLogger(); }
     virtual void setAllocator(std::unique_ptr<AllocatorInterface> nmi) {
         nmi_ = std::move(nmi);
@@ -114,6 +114,10 @@ class BufferNodeBase : public common::Node {
         }
         return false;
     }
+
+    bool isSameOperation(const common::Node &other) const noexcept final {
+        return *this == other;
+    }
 };
 
 }  // namespace common
@@ -28,5 +28,10 @@ class ModdimNode : public NaryNode {
     virtual std::unique_ptr<Node> clone() noexcept final {
         return std::make_unique<ModdimNode>(*this);
     }
+
+    bool isSameOperation(const Node& other) const noexcept final {
+        return NaryNode::isSameOperation(other) &&
+               m_new_shape == static_cast<const ModdimNode&>(other).m_new_shape;
+    }
 };
 }  // namespace common
@@ -16,6 +16,7 @@
 
 #include <nonstd/span.hpp>
 #include <array>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -73,6 +74,13 @@ class NaryNode : public Node {
         return std::make_unique<NaryNode>(*this);
     }
 
+    bool isSameOperation(const Node &other) const noexcept override {
+        if (!Node::isSameOperation(other)) { return false; }
+        const NaryNode &nary = static_cast<const NaryNode &>(other);
+        return m_num_children == nary.m_num_children &&
+               std::strcmp(m_op_str, nary.m_op_str) == 0;
+    }
+
     void genKerName(std::string &kerString,
                     const common::Node_ids &ids) const final {
         // Make the dec representation of enum part of the Kernel name
@@ -116,16 +124,9 @@ common::Node_ptr createNaryNode(
             return ptr;
         }
         case kJITHeuristics::TreeHeight:
-        case kJITHeuristics::KernelParameterSize: {
-            int max_height_index = 0;
-            int max_height       = 0;
-            for (int i = 0; i < N; i++) {
-                if (max_height < childNodes[i]->getHeight()) {
-                    max_height_index = i;
-                    max_height       = childNodes[i]->getHeight();
-                }
-            }
-            children[max_height_index]->eval();
+        case kJITHeuristics::KernelParameterSize:
+        case kJITHeuristics::WorkingSet: {
+            children[detail::selectJitEvalNode<Ti>(nodes)]->eval();
             return createNaryNode<Ti, N>(odims, createNode, move(children));
         }
         case kJITHeuristics::MemoryPressure: {
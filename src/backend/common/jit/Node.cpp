@@ -22,20 +22,43 @@ namespace common {
 int Node::getNodesMap(Node_map_t &node_map, vector<Node *> &full_nodes,
                       vector<Node_ids> &full_ids) {
     auto iter = node_map.find(this);
-    if (iter == node_map.end()) {
-        Node_ids ids{};
+    if (iter != node_map.end()) { return iter->second; }
 
-        for (int i = 0; i < kMaxChildren && m_children[i] != nullptr; i++) {
-            ids.child_ids[i] =
-                m_children[i]->getNodesMap(node_map, full_nodes, full_ids);
+    Node_ids ids{};
+    for (int i = 0; i < kMaxChildren && m_children[i] != nullptr; i++) {
+        ids.child_ids[i] =
+            m_children[i]->getNodesMap(node_map, full_nodes, full_ids);
+    }
+
+    // A node that performs the same operation on the same children as a node
+    // in the map computes the same values, so it gets the id of that node.
+    // Such nodes have the same hash, so they are in the same bucket, and
+    // their children were already given their ids.
+    const size_t bucket = node_map.bucket(this);
+    for (auto it = node_map.begin(bucket); it != node_map.end(bucket); ++it) {
+        const Node *node = it->first;
+        const int id     = it->second;
+        if (full_nodes[id] != node || node->getHash() != getHash() ||
+            full_ids[id].child_ids != ids.child_ids ||
+            !node->isSameOperation(*this)) {
+            continue;
+        }
+        bool same_children = true;
+        for (int i = 0; i < kMaxChildren; i++) {
+            same_children &=
+                (m_children[i] == nullptr) == (node->m_children[i] == nullptr);
+        }
+        if (same_children) {
+            node_map[this] = id;
+            return id;
         }
-        ids.id         = node_map.size();
-        node_map[this] = ids.id;
-        full_nodes.push_back(this);
-        full_ids.push_back(ids);
-        return ids.id;
     }
-    return iter->second;
+
+    ids.id         = static_cast<int>(full_nodes.size());
+    node_map[this] = ids.id;
+    full_nodes.push_back(this);
+    full_ids.push_back(ids);
+    return ids.id;
 }
 
 std::string getFuncName(const vector<Node *> &output_nodes,
@@ -58,7 +81,7 @@ std::string getFuncName(const vector<Node *> &output_nodes,
 }
 
 bool NodePtr_equalto::operator()(const Node *l, const Node *r) const noexcept {
-    return *l == *r;
+    return l == r;
 }
 
 auto isBuffer(const Node &ptr) -> bool { return ptr.isBuffer(); }
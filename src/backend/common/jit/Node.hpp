@@ -10,6 +10,7 @@
 #pragma once
 #include <backend.hpp>
 #include <common/defines.hpp>
+#include <common/traits.hpp>
 #include <optypes.hpp>
 #include <platform.hpp>
 #include <types.hpp>
@@ -18,17 +19,21 @@
 #include <algorithm>
 #include <array>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <typeinfo>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 enum class kJITHeuristics {
     Pass                = 0, /* no eval necessary */
     TreeHeight          = 1, /* eval due to jit tree height */
     KernelParameterSize = 2, /* eval due to many kernel parameters */
-    MemoryPressure      = 3  /* eval due to memory pressure */
+    MemoryPressure      = 3, /* eval due to memory pressure */
+    WorkingSet          = 4  /* eval due to the memory used while evaluating */
 };
 
 namespace common {
@@ -39,8 +44,7 @@ class Node;
 namespace cpu {
 namespace kernel {
 
-template<typename T>
-void evalMultiple(std::vector<Param<T>> arrays,
+void evalMultiple(std::vector<void *> ptrs, af::dim4 odims, af::dim4 ostrs,
                   std::vector<std::shared_ptr<common::Node>> output_nodes_);
 }
 }  // namespace cpu
@@ -58,7 +62,11 @@ namespace common {
 class Node;
 struct Node_ids;
 
-/// A equal_to class that calls the dereference nodes equality operator
+/// A equal_to class that compares the node pointers
+///
+/// A Node_map_t holds every node visited by getNodesMap. Nodes that compute
+/// the same values share the id of the first of them, so each distinct
+/// subexpression of a tree is evaluated once.
 struct NodePtr_equalto {
     bool operator()(const Node *l, const Node *r) const noexcept;
 };
@@ -69,6 +77,18 @@ using Node_map_iter = Node_map_t::iterator;
 
 using Node_ptr = std::shared_ptr<Node>;
 
+/// Returns \p a + \p b, or the largest size_t if the sum overflows
+inline size_t saturatingAdd(size_t a, size_t b) noexcept {
+    return a > std::numeric_limits<size_t>::max() - b
+               ? std::numeric_limits<size_t>::max()
+               : a + b;
+}
+
+/// Mixes \p value into the hash \p seed
+inline size_t hashCombine(size_t seed, size_t value) noexcept {
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
 static const char *getFullName(af::dtype type) {
     switch (type) {
         case f32: return detail::getFullName<float>();
@@ -111,20 +131,65 @@ class Node {
    public:
     static const int kMaxChildren = 3;
 
+    /// An upper bound of the size of the JIT tree below a node. A subtree
+    /// that several parents share is counted once for each of them, so the
+    /// bound grows exponentially with the depth of a DAG and saturates at
+    /// the largest size_t. The CPU backend only walks the tree to count the
+    /// distinct nodes when this bound exceeds one of its limits.
+    struct SubtreeInfo {
+        /// The number of buffer nodes
+        size_t buffers = 0;
+        /// The bytes of memory held by the buffer nodes
+        size_t buffer_bytes = 0;
+        /// The bytes of one value of every node. Half values are counted as
+        /// float because that is the type they are computed in.
+        size_t value_bytes = 0;
+    };
+
    protected:
    public:
     std::array<Node_ptr, kMaxChildren> m_children;
     af::dtype m_type;
     int m_height;
+    // The hash of the type and the children, computed once because the
+    // children are shared between many trees
+    size_t m_hash = 0;
+    // A bound of the size of the tree below the node, computed once for the
+    // same reason
+    SubtreeInfo m_subtree;
 
     template<typename T>
     friend class NodeIterator;
     Node() = default;
     Node(const af::dtype type, const int height,
          const std::array<Node_ptr, kMaxChildren> children)
-        : m_children(children), m_type(type), m_height(height) {
+        : m_children(children)
+        , m_type(type)
+        , m_height(height)
+        , m_hash(std::hash<int>()(type)) {
         static_assert(std::is_nothrow_move_assignable<Node>::value,
                       "Node is not move assignable");
+        for (const Node_ptr &child : m_children) {
+            if (!child) { continue; }
+            m_hash = hashCombine(m_hash, child->getHash());
+
+            const SubtreeInfo &below = child->m_subtree;
+            const size_t value_bytes =
+                child->m_type == f16 ? sizeof(float) : dtypeSize(child->m_type);
+            m_subtree.value_bytes = saturatingAdd(
+                m_subtree.value_bytes, saturatingAdd(below.value_bytes,
+                                                     value_bytes));
+            if (child->isBuffer()) {
+                m_subtree.buffers = saturatingAdd(m_subtree.buffers, 1);
+                m_subtree.buffer_bytes =
+                    saturatingAdd(m_subtree.buffer_bytes, child->getBytes());
+            } else {
+                m_subtree.buffers =
+                    saturatingAdd(m_subtree.buffers, below.buffers);
+                m_subtree.buffer_bytes =
+                    saturatingAdd(m_subtree.buffer_bytes, below.buffer_bytes);
+            }
+        }
     }
 
     void swap(Node &other) noexcept {
@@ -134,6 +199,8 @@ class Node {
         }
         swap(m_type, other.m_type);
         swap(m_height, other.m_height);
+        swap(m_hash, other.m_hash);
+        swap(m_subtree, other.m_subtree);
     }
 
     /// Default move constructor operator
@@ -260,6 +327,9 @@ class Node {
     /// Returns the height of the JIT tree from this node
     int getHeight() const { return m_height; }
 
+    /// Returns an upper bound of the size of the JIT tree below this node
+    const SubtreeInfo &getSubtree() const { return m_subtree; }
+
     /// Returns the short name for this type
     /// \note For the shift node this is "Sh" appended by the short name of the
     ///       type
@@ -268,32 +338,38 @@ class Node {
     /// Default destructor
     virtual ~Node() noexcept = default;
 
-    /// Returns the hash of the node. For all Nodes other than the Buffer node,
-    /// this is the pointer of the object
+    /// Returns the hash of the node. It is computed from the operation, the
+    /// type and the children, so nodes that compute the same values have the
+    /// same hash. The Buffer node hashes the pointer to its memory.
     virtual size_t getHash() const noexcept {
-        std::hash<const void *> ptr_hash;
-        std::hash<af::dtype> aftype_hash;
-        std::hash<int> int_hash;
-        const void *ptr = this;
-        size_t h =
-            ptr_hash(ptr) ^ (aftype_hash(m_type) << 1) ^ (int_hash(m_height));
-        return h;
+        return hashCombine(m_hash, static_cast<size_t>(getOp()));
     }
 
-    /// A very bad equality operator used only for the hash function.
+    /// Returns true if the node performs the same operation as \p other on
+    /// its children. Nodes with members other than the children compare them
+    /// here.
+    virtual bool isSameOperation(const Node &other) const noexcept {
+        return typeid(*this) == typeid(other) && getOp() == other.getOp() &&
+               m_type == other.m_type;
+    }
+
+    /// Returns true if \p other is the same node
     virtual bool operator==(const Node &other) const noexcept {
         return this == &other;
     }
     virtual std::unique_ptr<Node> clone() = 0;
 
 #ifdef AF_CPU
-    template<typename U>
     friend void cpu::kernel::evalMultiple(
-        std::vector<cpu::Param<U>> arrays,
+        std::vector<void *> ptrs, af::dim4 odims, af::dim4 ostrs,
         std::vector<common::Node_ptr> output_nodes_);
 
     virtual void setShape(af::dim4 new_shape) { UNUSED(new_shape); }
 
+    /// Returns true if the gen* functions of the node produce code that can
+    /// be compiled into a native CPU kernel
+    virtual bool canGenerate() const { return false; }
+
 #endif
 };
 
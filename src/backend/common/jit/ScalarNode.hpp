@@ -10,10 +10,12 @@
 #pragma once
 #include <backend.hpp>
 #include <common/jit/Node.hpp>
+#include <common/util.hpp>
 #include <af/traits.hpp>
 
 #include <math.hpp>
 #include <types.hpp>
+#include <cstring>
 #include <iomanip>
 
 namespace common {
@@ -49,6 +51,18 @@ class ScalarNode : public common::Node {
         return std::make_unique<ScalarNode>(*this);
     }
 
+    size_t getHash() const noexcept final {
+        return hashCombine(Node::getHash(),
+                           deterministicHash(&m_val, sizeof(T)));
+    }
+
+    /// Scalars are compared bit by bit, so 0 and -0 are different values
+    bool isSameOperation(const Node& other) const noexcept final {
+        const ScalarNode& scalar = static_cast<const ScalarNode&>(other);
+        return Node::isSameOperation(other) &&
+               std::memcmp(&m_val, &scalar.m_val, sizeof(T)) == 0;
+    }
+
     // Swap specilization
     void swap(ScalarNode& other) noexcept {
         using std::swap;
@@ -54,6 +54,21 @@ class ShiftNodeBase : public Node {
         return std::make_unique<ShiftNodeBase>(*this);
     }
 
+    size_t getHash() const noexcept final {
+        size_t h = hashCombine(Node::getHash(), m_buffer_node->getHash());
+        for (int shift : m_shifts) {
+            h = hashCombine(h, std::hash<int>()(shift));
+        }
+        return h;
+    }
+
+    bool isSameOperation(const Node &other) const noexcept final {
+        if (!Node::isSameOperation(other)) { return false; }
+        const ShiftNodeBase &shift = static_cast<const ShiftNodeBase &>(other);
+        return m_shifts == shift.m_shifts &&
+               *m_buffer_node == *shift.m_buffer_node;
+    }
+
     // Swap specilization
     void swap(ShiftNodeBase &other) noexcept {
         using std::swap;
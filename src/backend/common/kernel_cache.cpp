@@ -11,22 +11,31 @@
 
 #include <common/compile_module.hpp>
 #include <common/kernel_cache.hpp>
+#include <common/kernel_manifest.hpp>
 #include <common/util.hpp>
 #include <device_manager.hpp>
 #include <platform.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
 #include <shared_mutex>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
 using detail::Kernel;
 using detail::Module;
 
+using std::atomic;
 using std::back_inserter;
+using std::exception_ptr;
+using std::min;
 using std::shared_timed_mutex;
 using std::string;
+using std::thread;
 using std::to_string;
 using std::transform;
 using std::unordered_map;
@@ -55,6 +64,28 @@ Module findModule(const int device, const size_t& key) {
     return Module{};
 }
 
+/// Adds \p module to the cache of \p device unless another thread added a
+/// module for \p key first. Returns the module that is in the cache.
+Module addModule(const int device, const size_t key, Module module) {
+    std::unique_lock<shared_timed_mutex> writeLock(getCacheMutex(device));
+    auto& cache = getCache(device);
+    auto iter   = cache.find(key);
+    if (iter == cache.end()) {
+        // If not found, this thread is the first one to compile
+        // this kernel. Keep the generated module.
+        cache.emplace(key, module);
+        return module;
+    }
+    module.unload();  // dump the current threads extra compilation
+    return iter->second;
+}
+
+vector<string> toStrings(const vector<common::Source>& sources) {
+    vector<string> sources_str;
+    for (const auto& s : sources) { sources_str.push_back({s.ptr, s.length}); }
+    return sources_str;
+}
+
 Kernel getKernel(const string& kernelName,
                  const vector<common::Source>& sources,
                  const vector<TemplateArg>& targs,
@@ -111,31 +142,60 @@ Kernel getKernel(const string& kernelName,
         currModule =
             loadModuleFromDisk(device, to_string(moduleKeyDisk), sourceIsJIT);
         if (!currModule) {
-            vector<string> sources_str;
-            for (const auto& s : sources) {
-                sources_str.push_back({s.ptr, s.length});
-            }
-            currModule = compileModule(to_string(moduleKeyDisk), sources_str,
-                                       options, {tInstance}, sourceIsJIT);
+            currModule =
+                compileModule(to_string(moduleKeyDisk), toStrings(sources),
+                              options, {tInstance}, sourceIsJIT);
         }
-
-        std::unique_lock<shared_timed_mutex> writeLock(getCacheMutex(device));
-        auto& cache = getCache(device);
-        auto iter   = cache.find(moduleKeyCache);
-        if (iter == cache.end()) {
-            // If not found, this thread is the first one to compile
-            // this kernel. Keep the generated module.
-            Module mod = currModule;
-            getCache(device).emplace(moduleKeyCache, mod);
-        } else {
-            currModule.unload();  // dump the current threads extra
-                                  // compilation
-            currModule = iter->second;
+        if (isKernelManifestEnabled()) {
+            recordKernel({tInstance, moduleKeyCache, moduleKeyDisk,
+                          sourceIsJIT, toStrings(sources), options});
         }
+        currModule = addModule(device, moduleKeyCache, currModule);
     }
     return getKernel(currModule, tInstance, sourceIsJIT);
 }
 
+void warmupKernels(const vector<KernelManifestEntry>& entries) {
+    const int device = detail::getActiveDeviceId();
+    atomic<size_t> next{0};
+    std::mutex errorMutex;
+    exception_ptr error;
+
+    // Each worker takes the next entry until all of them are built. The
+    // backend compilers are thread safe, which is what makes this faster
+    // than compiling the kernels on first use.
+    auto worker = [&]() {
+        detail::setDevice(device);
+        for (size_t i = next++; i < entries.size(); i = next++) {
+            const KernelManifestEntry& entry = entries[i];
+            if (findModule(device, entry.moduleKeyCache)) { continue; }
+            try {
+                Module module = loadModuleFromDisk(
+                    device, to_string(entry.moduleKeyDisk), entry.isJIT);
+                if (!module) {
+                    module = compileModule(to_string(entry.moduleKeyDisk),
+                                           entry.sources, entry.options,
+                                           {entry.name}, entry.isJIT);
+                }
+                addModule(device, entry.moduleKeyCache, module);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) { error = std::current_exception(); }
+            }
+        }
+    };
+
+    const size_t workerCount =
+        min<size_t>(std::max(thread::hardware_concurrency(), 1U),
+                    entries.size());
+    vector<thread> workers;
+    for (size_t i = 1; i < workerCount; ++i) { workers.emplace_back(worker); }
+    worker();
+    for (auto& w : workers) { w.join(); }
+
+    if (error) { std::rethrow_exception(error); }
+}
+
 }  // namespace common
 
 #endif
@@ -0,0 +1,171 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <common/kernel_manifest.hpp>
+
+#include <common/Logger.hpp>
+#include <common/err_common.hpp>
+#include <common/util.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+using std::ifstream;
+using std::ios;
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::string;
+using std::uint64_t;
+using std::unordered_set;
+using std::vector;
+
+namespace common {
+
+namespace {
+
+// Every entry starts with this value so a damaged or foreign file is not
+// mistaken for a manifest. The last byte is the version of the format.
+constexpr uint64_t kEntryMagic = 0x01004d4b4e524641ULL;  // "AFRNKM\0\1"
+
+spdlog::logger* getLogger() {
+    static std::shared_ptr<spdlog::logger> logger(loggerFactory("jit"));
+    return logger.get();
+}
+
+// The variable is read every time a kernel is recorded, which only happens
+// after a kernel was compiled or loaded
+string getManifestPath() { return getEnvVar(JIT_KERNEL_MANIFEST_ENV_NAME); }
+
+void writeValue(string& out, uint64_t value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(string& out, const string& value) {
+    writeValue(out, value.size());
+    out.append(value);
+}
+
+void writeStrings(string& out, const vector<string>& values) {
+    writeValue(out, values.size());
+    for (const auto& value : values) { writeString(out, value); }
+}
+
+bool readValue(ifstream& in, uint64_t& value) {
+    return static_cast<bool>(
+        in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+/// Returns the number of bytes between the read position of \p in and the
+/// end of the file
+uint64_t remainingBytes(ifstream& in) {
+    const auto pos = in.tellg();
+    in.seekg(0, ios::end);
+    const auto end = in.tellg();
+    in.seekg(pos);
+    return pos < 0 || end < pos ? 0 : static_cast<uint64_t>(end - pos);
+}
+
+bool readString(ifstream& in, string& value) {
+    uint64_t size = 0;
+    if (!readValue(in, size)) { return false; }
+    // The size of a damaged entry can be anything, so it is checked before
+    // the memory is allocated
+    if (size > remainingBytes(in)) { return false; }
+    value.resize(size);
+    return size == 0 || static_cast<bool>(in.read(&value[0], size));
+}
+
+bool readStrings(ifstream& in, vector<string>& values) {
+    uint64_t count = 0;
+    if (!readValue(in, count)) { return false; }
+    values.clear();
+    for (uint64_t i = 0; i < count; ++i) {
+        string value;
+        if (!readString(in, value)) { return false; }
+        values.push_back(std::move(value));
+    }
+    return true;
+}
+
+}  // namespace
+
+bool isKernelManifestEnabled() { return !getManifestPath().empty(); }
+
+void recordKernel(const KernelManifestEntry& entry) {
+    const string path = getManifestPath();
+    if (path.empty()) { return; }
+
+    string record;
+    writeValue(record, kEntryMagic);
+    writeString(record, entry.name);
+    writeValue(record, entry.moduleKeyCache);
+    writeValue(record, entry.moduleKeyDisk);
+    writeValue(record, entry.isJIT ? 1 : 0);
+    writeStrings(record, entry.sources);
+    writeStrings(record, entry.options);
+
+    static mutex manifestMutex;
+    lock_guard<mutex> lock(manifestMutex);
+    ofstream out(path, ios::binary | ios::app);
+    out.write(record.data(), record.size());
+    if (!out) {
+        AF_TRACE("{{{:<20} : Unable to record in {}}}", entry.name, path);
+    }
+}
+
+vector<KernelManifestEntry> readKernelManifest(const string& path) {
+    ifstream in(path, ios::binary);
+    if (!in) {
+        AF_ERROR("Unable to open the kernel manifest " + path, AF_ERR_ARG);
+    }
+
+    vector<KernelManifestEntry> entries;
+    unordered_set<string> recorded;
+    uint64_t magic = 0;
+    while (readValue(in, magic)) {
+        if (magic != kEntryMagic) {
+            if (entries.empty()) {
+                AF_ERROR(path + " is not a kernel manifest", AF_ERR_ARG);
+            }
+            AF_TRACE("{{Ignoring the damaged end of {}}}", path);
+            break;
+        }
+
+        KernelManifestEntry entry;
+        uint64_t keyCache = 0, keyDisk = 0, isJIT = 0;
+        if (!readString(in, entry.name) || !readValue(in, keyCache) ||
+            !readValue(in, keyDisk) || !readValue(in, isJIT) ||
+            !readStrings(in, entry.sources) ||
+            !readStrings(in, entry.options)) {
+            AF_TRACE("{{Ignoring the truncated end of {}}}", path);
+            break;
+        }
+        entry.moduleKeyCache = static_cast<size_t>(keyCache);
+        entry.moduleKeyDisk  = static_cast<size_t>(keyDisk);
+        entry.isJIT          = isJIT != 0;
+
+        // The CPU backend does not use the keys so the name is needed to
+        // tell its entries apart
+        const string key = entry.name + ':' +
+                           std::to_string(entry.moduleKeyCache) + ':' +
+                           std::to_string(entry.moduleKeyDisk);
+        if (recorded.insert(key).second) {
+            entries.push_back(std::move(entry));
+        }
+    }
+    return entries;
+}
+
+}  // namespace common
@@ -0,0 +1,61 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+/// This file contains the functions that record the kernels compiled at
+/// runtime and compile them again ahead of time in a later run
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// The environment variable that names the file the kernels compiled at
+/// runtime are recorded in
+constexpr const char* JIT_KERNEL_MANIFEST_ENV_NAME = "AF_JIT_KERNEL_MANIFEST";
+
+namespace common {
+
+/// A kernel module compiled at runtime. This holds everything needed to load
+/// the module from the kernel cache directory or to compile it again.
+struct KernelManifestEntry {
+    std::string name;            // Kernel instantiation or JIT function
+    std::size_t moduleKeyCache;  // The key of the module in memory
+    std::size_t moduleKeyDisk;   // The key of the module binary on disk
+    bool isJIT;                  // True if the sources were generated
+    std::vector<std::string> sources;
+    std::vector<std::string> options;
+};
+
+/// Returns true if the kernel modules compiled or loaded by this process are
+/// recorded in the file named by AF_JIT_KERNEL_MANIFEST
+bool isKernelManifestEnabled();
+
+/// Appends \p entry to the file named by AF_JIT_KERNEL_MANIFEST
+///
+/// Each entry is written with a single write so several threads can record
+/// kernels at the same time. Does nothing if the manifest is not enabled.
+void recordKernel(const KernelManifestEntry& entry);
+
+/// Reads the entries of the kernel manifest at \p path
+///
+/// A module that was recorded more than once, either by racing threads or by
+/// several runs appending to the same manifest, is only returned once. A
+/// truncated entry at the end of the file is ignored.
+///
+/// \throws AF_ERR_ARG if the file cannot be opened or is not a manifest
+std::vector<KernelManifestEntry> readKernelManifest(const std::string& path);
+
+/// Loads or compiles the modules in \p entries for the active device
+///
+/// The modules are built concurrently and added to the kernel cache so the
+/// first call to each kernel does not pay for its compilation. This function
+/// has to be implemented separately in each backend.
+void warmupKernels(const std::vector<KernelManifestEntry>& entries);
+
+}  // namespace common
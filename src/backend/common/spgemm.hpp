@@ -0,0 +1,148 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <Array.hpp>
+#include <common/SparseArray.hpp>
+#include <copy.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+namespace common {
+
+// Building blocks of the product C = A * B of two CSR matrices. C is built
+// row by row (Gustavson's algorithm) in two passes: the symbolic pass counts
+// the nonzeros of every row so the output can be allocated exactly, and the
+// numeric pass fills the rows in.
+//
+// The columns of a row of C are gathered in a sparse accumulator: a dense
+// array with one slot per column of C, and a marker array that records which
+// row last touched a slot. Because the marker holds a row number the arrays
+// never need to be cleared between the rows processed by one thread.
+
+/// Returns the number of nonzeros in row \p row of A * B.
+///
+/// \p marker has one entry per column of B. It must not hold \p row before
+/// the call, which is guaranteed when it starts out filled with -1 and the
+/// rows are visited once each.
+inline int spgemmRowNnz(int row, const int *aRowIdx, const int *aColIdx,
+                        const int *bRowIdx, const int *bColIdx, int *marker) {
+    int nnz = 0;
+    for (int k = aRowIdx[row]; k < aRowIdx[row + 1]; k++) {
+        const int j = aColIdx[k];
+        for (int l = bRowIdx[j]; l < bRowIdx[j + 1]; l++) {
+            const int c = bColIdx[l];
+            if (marker[c] != row) {
+                marker[c] = row;
+                nnz++;
+            }
+        }
+    }
+    return nnz;
+}
+
+/// Writes row \p row of A * B to \p cValues and \p cColIdx, which must have
+/// room for the count returned by spgemmRowNnz. The columns are stored in
+/// increasing order.
+///
+/// \p marker follows the rules of spgemmRowNnz and \p acc has one entry per
+/// column of B.
+template<typename T>
+void spgemmRow(T *cValues, int *cColIdx, int row, const T *aValues,
+               const int *aRowIdx, const int *aColIdx, const T *bValues,
+               const int *bRowIdx, const int *bColIdx, int *marker, T *acc) {
+    int nnz = 0;
+    for (int k = aRowIdx[row]; k < aRowIdx[row + 1]; k++) {
+        const int j = aColIdx[k];
+        const T a   = aValues[k];
+        for (int l = bRowIdx[j]; l < bRowIdx[j + 1]; l++) {
+            const int c = bColIdx[l];
+            if (marker[c] != row) {
+                marker[c]      = row;
+                acc[c]         = a * bValues[l];
+                cColIdx[nnz++] = c;
+            } else {
+                acc[c] = acc[c] + a * bValues[l];
+            }
+        }
+    }
+    std::sort(cColIdx, cColIdx + nnz);
+    for (int i = 0; i < nnz; i++) { cValues[i] = acc[cColIdx[i]]; }
+}
+
+/// The host type used to do arithmetic on the values of a backend type
+template<typename T>
+struct spgemm_host_type {
+    using type = T;
+};
+template<>
+struct spgemm_host_type<detail::cfloat> {
+    using type = std::complex<float>;
+};
+template<>
+struct spgemm_host_type<detail::cdouble> {
+    using type = std::complex<double>;
+};
+
+/// Multiplies two CSR matrices on the host. This is the fallback of the
+/// backends that have no device implementation of a sparse-sparse product.
+template<typename T>
+SparseArray<T> spgemmOnHost(const SparseArray<T> &lhs,
+                            const SparseArray<T> &rhs) {
+    using host_t = typename spgemm_host_type<T>::type;
+    static_assert(sizeof(host_t) == sizeof(T),
+                  "The host type must have the layout of the backend type");
+
+    const int M = static_cast<int>(lhs.dims()[0]);
+    const int N = static_cast<int>(rhs.dims()[1]);
+
+    std::vector<T> aValues(lhs.getNNZ()), bValues(rhs.getNNZ());
+    std::vector<int> aRowIdx(M + 1), aColIdx(lhs.getNNZ());
+    std::vector<int> bRowIdx(rhs.dims()[0] + 1), bColIdx(rhs.getNNZ());
+    detail::copyData(aValues.data(), lhs.getValues());
+    detail::copyData(aRowIdx.data(), lhs.getRowIdx());
+    detail::copyData(aColIdx.data(), lhs.getColIdx());
+    detail::copyData(bValues.data(), rhs.getValues());
+    detail::copyData(bRowIdx.data(), rhs.getRowIdx());
+    detail::copyData(bColIdx.data(), rhs.getColIdx());
+
+    std::vector<int> marker(N, -1);
+    std::vector<int> cRowIdx(M + 1, 0);
+    for (int row = 0; row < M; row++) {
+        cRowIdx[row + 1] =
+            cRowIdx[row] + spgemmRowNnz(row, aRowIdx.data(), aColIdx.data(),
+                                        bRowIdx.data(), bColIdx.data(),
+                                        marker.data());
+    }
+
+    const int nnz = cRowIdx[M];
+    std::vector<T> cValues(nnz);
+    std::vector<int> cColIdx(nnz);
+    std::vector<host_t> acc(N);
+    std::fill(marker.begin(), marker.end(), -1);
+    for (int row = 0; row < M; row++) {
+        spgemmRow(reinterpret_cast<host_t *>(cValues.data()) + cRowIdx[row],
+                  cColIdx.data() + cRowIdx[row], row,
+                  reinterpret_cast<const host_t *>(aValues.data()),
+                  aRowIdx.data(), aColIdx.data(),
+                  reinterpret_cast<const host_t *>(bValues.data()),
+                  bRowIdx.data(), bColIdx.data(), marker.data(), acc.data());
+    }
+
+    return createHostDataSparseArray<T>(af::dim4(M, N), nnz, cValues.data(),
+                                        cRowIdx.data(), cColIdx.data(),
+                                        AF_STORAGE_CSR);
+}
+
+}  // namespace common
@@ -0,0 +1,27 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <common/summation.hpp>
+
+#include <atomic>
+
+namespace common {
+
+namespace {
+std::atomic<af_summation_type>& summationType() {
+    static std::atomic<af_summation_type> type{AF_SUMMATION_DEFAULT};
+    return type;
+}
+}  // namespace
+
+af_summation_type getSummationType() { return summationType().load(); }
+
+void setSummationType(af_summation_type type) { summationType() = type; }
+
+}  // namespace common
@@ -0,0 +1,26 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <af/defines.h>
+
+namespace common {
+
+/// Returns the algorithm used to add floating point values in sum and mean.
+/// This is set by af_set_summation_type.
+///
+/// \note Only the CPU backend implements the compensated algorithms. The
+///       other backends always use their tree reductions.
+af_summation_type getSummationType();
+
+/// Sets the algorithm used to add floating point values in sum and mean
+void setSummationType(af_summation_type type);
+
+}  // namespace common
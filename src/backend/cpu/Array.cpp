@@ -20,6 +20,7 @@
 #include <jit/BufferNode.hpp>
 #include <jit/Node.hpp>
 #include <jit/ScalarNode.hpp>
+#include <jit.hpp>
 #include <memory.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
@@ -35,6 +36,7 @@
 #include <cstddef>
 #include <cstring>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 
 using af::dim4;
@@ -46,7 +48,6 @@ using common::NodeIterator;
 using cpu::jit::BufferNode;
 
 using nonstd::span;
-using std::adjacent_find;
 using std::copy;
 using std::is_standard_layout;
 using std::make_shared;
@@ -151,45 +152,109 @@ T *Array<T>::device() {
     return this->get();
 }
 
+/// Returns the memory of a buffer in the tree of \p root that the result of
+/// the tree can be written to, or an empty pointer if there is none.
+///
+/// A buffer can be overwritten when nothing but the tree reads it: the array
+/// that is evaluated is the only holder of \p root, every other node is only
+/// held by its parents in the tree and the memory is only held by buffer
+/// nodes of the tree. The tree must be linear, so each element of the buffer
+/// is read before the same element of the result is written.
 template<typename T>
-void evalMultiple(vector<Array<T> *> array_ptrs) {
-    vector<Array<T> *> outputs;
-    vector<common::Node_ptr> nodes;
-    vector<Param<T>> params;
+shared_ptr<T> findDonatedBuffer(const Node_ptr &root, const dim4 &dims) {
+    if (root.use_count() != 1) { return shared_ptr<T>(); }
+
+    vector<Node *> nodes;
+    std::unordered_map<const Node *, long> parents;
+    for (NodeIterator<> it(root.get()); it != NodeIterator<>(); ++it) {
+        if (!it->isLinear(dims.get())) { return shared_ptr<T>(); }
+        nodes.push_back(&*it);
+        for (const Node_ptr &child : it->m_children) {
+            if (child) { parents[child.get()]++; }
+        }
+    }
+
+    const af::dtype type = static_cast<af::dtype>(dtype_traits<T>::af_type);
+    std::unordered_map<const T *, long> buffers;
+    for (Node *node : nodes) {
+        for (const Node_ptr &child : node->m_children) {
+            if (child && child.use_count() != parents[child.get()]) {
+                return shared_ptr<T>();
+            }
+        }
+        if (node->isBuffer() && node->getType() == type) {
+            buffers[static_cast<BufferNode<T> *>(node)->getData().get()]++;
+        }
+    }
+
+    const size_t bytes = dims.elements() * sizeof(T);
+    for (Node *node : nodes) {
+        if (!node->isBuffer() || node->getType() != type) { continue; }
+        const auto *buffer       = static_cast<BufferNode<T> *>(node);
+        const shared_ptr<T> &ptr = buffer->getData();
+        if (buffer->startsAtData() && buffer->getBytes() == bytes &&
+            ptr.use_count() == buffers[ptr.get()] && !isLocked(ptr.get()) &&
+            memoryManager().allocated(ptr.get()) != 0) {
+            return ptr;
+        }
+    }
+    return shared_ptr<T>();
+}
+
+template<typename T>
+void EvalGroup::add(Array<T> &array) {
     if (getQueue().is_worker()) {
         AF_ERROR("Array not evaluated", AF_ERR_INTERNAL);
     }
+    if (array.isReady()) { return; }
 
-    // Check if all the arrays have the same dimension
-    auto it = adjacent_find(begin(array_ptrs), end(array_ptrs),
-                            [](const Array<T> *l, const Array<T> *r) {
-                                return l->dims() != r->dims();
-                            });
+    // The same array may be passed more than once
+    for (const Output &output : m_outputs) {
+        if (output.array_node == &array.node) { return; }
+    }
 
-    // If they are not the same. eval individually
-    if (it != end(array_ptrs)) {
-        for (auto ptr : array_ptrs) { ptr->eval(); }
-        return;
+    array.setId(getActiveDeviceId());
+    array.data = findDonatedBuffer<T>(array.node, array.dims());
+    if (!array.data) {
+        array.data =
+            shared_ptr<T>(memAlloc<T>(array.elements()).release(), memFree<T>);
     }
 
-    for (Array<T> *array : array_ptrs) {
-        if (array->isReady()) { continue; }
+    m_outputs.push_back({array.getData().get(), array.dims(), array.strides(),
+                         array.node, &array.node});
+}
 
-        array->setId(getActiveDeviceId());
-        array->data =
-            shared_ptr<T>(memAlloc<T>(array->elements()).release(), memFree<T>);
+void EvalGroup::run() {
+    // Arrays with different dimensions can not be written by the same kernel,
+    // so there is one kernel per shape
+    vector<bool> done(m_outputs.size(), false);
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        if (done[i]) { continue; }
+
+        vector<void *> ptrs;
+        vector<Node_ptr> nodes;
+        for (size_t j = i; j < m_outputs.size(); j++) {
+            if (done[j] || m_outputs[j].dims != m_outputs[i].dims) {
+                continue;
+            }
+            ptrs.push_back(m_outputs[j].ptr);
+            nodes.push_back(m_outputs[j].node);
+            done[j] = true;
+        }
 
-        outputs.push_back(array);
-        params.emplace_back(array->getData().get(), array->dims(),
-                            array->strides());
-        nodes.push_back(array->node);
+        getQueue().enqueue(kernel::evalMultiple, ptrs, m_outputs[i].dims,
+                           m_outputs[i].strides, nodes);
     }
 
-    if (params.empty()) return;
-
-    getQueue().enqueue(cpu::kernel::evalMultiple<T>, params, nodes);
+    for (Output &output : m_outputs) { output.array_node->reset(); }
+    m_outputs.clear();
+}
 
-    for (Array<T> *array : outputs) { array->node.reset(); }
+template<typename T>
+void evalMultiple(vector<Array<T> *> array_ptrs) {
+    EvalGroup group;
+    for (Array<T> *array : array_ptrs) { group.add(*array); }
+    group.run();
 }
 
 template<typename T>
@@ -231,30 +296,14 @@ Array<T> createEmptyArray(const dim4 &dims) {
 template<typename T>
 kJITHeuristics passesJitHeuristics(span<Node *> root_nodes) {
     if (!evalFlag()) { return kJITHeuristics::Pass; }
-    size_t bytes = 0;
-    for (Node *n : root_nodes) {
-        if (n->getHeight() > static_cast<int>(getMaxJitSize())) {
-            return kJITHeuristics::TreeHeight;
-        }
-        // Check if approaching the memory limit
-        if (getMemoryPressure() >= getMemoryPressureThreshold()) {
-            NodeIterator<Node> it(n);
-            NodeIterator<Node> end_node;
-            bytes = accumulate(it, end_node, bytes,
-                               [=](const size_t prev, const Node &n) {
-                                   // getBytes returns the size of the data
-                                   // Array. Sub arrays will be represented
-                                   // by their parent size.
-                                   return prev + n.getBytes();
-                               });
-        }
-    }
-
-    if (jitTreeExceedsMemoryPressure(bytes)) {
-        return kJITHeuristics::MemoryPressure;
-    }
+    return checkJitHeuristics(
+        root_nodes, static_cast<af::dtype>(dtype_traits<T>::af_type));
+}
 
-    return kJITHeuristics::Pass;
+template<typename T>
+int selectJitEvalNode(span<Node *> root_nodes) {
+    return selectJitEvalNode(root_nodes,
+                             static_cast<af::dtype>(dtype_traits<T>::af_type));
 }
 
 template<typename T>
@@ -348,7 +397,9 @@ void Array<T>::setDataDims(const dim4 &new_dims) {
     template void writeDeviceDataArray<T>(                                    \
         Array<T> & arr, const void *const data, const size_t bytes);          \
     template void evalMultiple<T>(vector<Array<T> *> arrays);                 \
+    template void EvalGroup::add<T>(Array<T> & array);                        \
     template kJITHeuristics passesJitHeuristics<T>(span<Node *> n);           \
+    template int selectJitEvalNode<T>(span<Node *> n);                        \
     template void Array<T>::setDataDims(const dim4 &new_dims);
 
 INSTANTIATE(float)
@@ -39,8 +39,7 @@ namespace kernel {
 template<typename T>
 void evalArray(Param<T> in, common::Node_ptr node);
 
-template<typename T>
-void evalMultiple(std::vector<Param<T>> arrays,
+void evalMultiple(std::vector<void *> ptrs, af::dim4 odims, af::dim4 ostrs,
                   std::vector<common::Node_ptr> nodes);
 
 }  // namespace kernel
@@ -48,6 +47,31 @@ void evalMultiple(std::vector<Param<T>> arrays,
 template<typename T>
 class Array;
 
+/// Evaluates arrays of different types together. The arrays that have the
+/// same dimensions are written by a single kernel, so the nodes their trees
+/// share are only evaluated once.
+class EvalGroup {
+   public:
+    /// Allocates the buffer of \p array and adds its tree to the group.
+    /// Arrays that are already evaluated are skipped.
+    template<typename T>
+    void add(Array<T> &array);
+
+    /// Evaluates the arrays that were added to the group
+    void run();
+
+   private:
+    struct Output {
+        void *ptr;
+        af::dim4 dims;
+        af::dim4 strides;
+        common::Node_ptr node;
+        // The node of the array, which is released once it is evaluated
+        common::Node_ptr *array_node;
+    };
+    std::vector<Output> m_outputs;
+};
+
 using af::dim4;
 using std::shared_ptr;
 
@@ -103,6 +127,11 @@ void destroyArray(Array<T> *A);
 template<typename T>
 kJITHeuristics passesJitHeuristics(nonstd::span<common::Node *> node);
 
+/// Returns the index of the node in \p node to evaluate when
+/// passesJitHeuristics fails for a node of type T added on top of them
+template<typename T>
+int selectJitEvalNode(nonstd::span<common::Node *> node);
+
 template<typename T>
 void *getDevicePtr(const Array<T> &arr) {
     T *ptr = arr.device();
@@ -264,6 +293,7 @@ class Array {
     common::Node_ptr getNode();
 
     friend void evalMultiple<T>(std::vector<Array<T> *> arrays);
+    friend class EvalGroup;
 
     friend Array<T> createValueArray<T>(const af::dim4 &dims, const T &value);
     friend Array<T> createHostDataArray<T>(const af::dim4 &dims,
@@ -282,8 +312,6 @@ class Array {
                                       bool copy);
 
     friend void kernel::evalArray<T>(Param<T> in, common::Node_ptr node);
-    friend void kernel::evalMultiple<T>(std::vector<Param<T>> arrays,
-                                        std::vector<common::Node_ptr> nodes);
 
     friend void destroyArray<T>(Array<T> *arr);
     friend void *getDevicePtr<T>(const Array<T> &arr);
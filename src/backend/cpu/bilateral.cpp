@@ -21,16 +21,23 @@ namespace cpu {
 
 template<typename inType, typename outType>
 Array<outType> bilateral(const Array<inType> &in, const float &sSigma,
-                         const float &cSigma) {
+                         const float &cSigma,
+                         const af_bilateral_method method) {
     Array<outType> out = createEmptyArray<outType>(in.dims());
-    getQueue().enqueue(kernel::bilateral<outType, inType>, out, in, sSigma,
-                       cSigma);
+    if (method == AF_BILATERAL_GRID) {
+        getQueue().enqueue(kernel::bilateralGrid<outType, inType>, out, in,
+                           sSigma, cSigma);
+    } else {
+        getQueue().enqueue(kernel::bilateral<outType, inType>, out, in,
+                           sSigma, cSigma);
+    }
     return out;
 }
 
-#define INSTANTIATE(inT, outT)                                    \
-    template Array<outT> bilateral<inT, outT>(const Array<inT> &, \
-                                              const float &, const float &);
+#define INSTANTIATE(inT, outT)                                   \
+    template Array<outT> bilateral<inT, outT>(                   \
+        const Array<inT> &, const float &, const float &,        \
+        const af_bilateral_method);
 
 INSTANTIATE(double, double)
 INSTANTIATE(float, float)
@@ -12,5 +12,6 @@
 namespace cpu {
 template<typename inType, typename outType>
 Array<outType> bilateral(const Array<inType> &in, const float &spatialSigma,
-                         const float &chromaticSigma);
+                         const float &chromaticSigma,
+                         const af_bilateral_method method);
 }
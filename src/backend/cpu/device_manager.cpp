@@ -123,6 +123,7 @@ namespace cpu {
 
 DeviceManager::DeviceManager()
     : queues(MAX_QUEUES)
+    , threadPool(new ThreadPool(getNumThreads()))
     , fgMngr(new graphics::ForgeManager())
     , memManager(new common::DefaultMemoryManager(
           getDeviceCount(), common::MAX_BUFFERS,
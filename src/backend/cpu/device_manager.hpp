@@ -11,6 +11,7 @@
 
 #include <platform.hpp>
 #include <queue.hpp>
+#include <thread_pool.hpp>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -102,6 +103,8 @@ class DeviceManager {
 
     friend queue& getQueue(int device);
 
+    friend ThreadPool& getThreadPool();
+
     friend MemoryManagerBase& memoryManager();
 
     friend void setMemoryManager(std::unique_ptr<MemoryManagerBase> mgr);
@@ -136,6 +139,7 @@ class DeviceManager {
 
     // Attributes
     std::vector<queue> queues;
+    std::unique_ptr<ThreadPool> threadPool;
     std::unique_ptr<graphics::ForgeManager> fgMngr;
     const CPUInfo cinfo;
     std::unique_ptr<MemoryManagerBase> memManager;
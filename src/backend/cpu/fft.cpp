@@ -11,12 +11,13 @@
 
 #include <Array.hpp>
 #include <copy.hpp>
-#include <fftw3.h>
+#include <fftw.hpp>
 #include <platform.hpp>
 #include <types.hpp>
 #include <af/dim4.hpp>
 
 #include <array>
+#include <mutex>
 #include <type_traits>
 
 using af::dim4;
@@ -24,55 +25,16 @@ using std::array;
 
 namespace cpu {
 
-template<typename T>
-struct fftw_transform;
-
-#define TRANSFORM(PRE, TY)                                             \
-    template<>                                                         \
-    struct fftw_transform<TY> {                                        \
-        typedef PRE##_plan plan_t;                                     \
-        typedef PRE##_complex ctype_t;                                 \
-                                                                       \
-        template<typename... Args>                                     \
-        plan_t create(Args... args) {                                  \
-            return PRE##_plan_many_dft(args...);                       \
-        }                                                              \
-        void execute(plan_t plan) { return PRE##_execute(plan); }      \
-        void destroy(plan_t plan) { return PRE##_destroy_plan(plan); } \
-    };
-
-TRANSFORM(fftwf, cfloat)
-TRANSFORM(fftw, cdouble)
-
-template<typename To, typename Ti>
-struct fftw_real_transform;
-
-#define TRANSFORM_REAL(PRE, To, Ti, POST)                              \
-    template<>                                                         \
-    struct fftw_real_transform<To, Ti> {                               \
-        typedef PRE##_plan plan_t;                                     \
-        typedef PRE##_complex ctype_t;                                 \
-                                                                       \
-        template<typename... Args>                                     \
-        plan_t create(Args... args) {                                  \
-            return PRE##_plan_many_dft_##POST(args...);                \
-        }                                                              \
-        void execute(plan_t plan) { return PRE##_execute(plan); }      \
-        void destroy(plan_t plan) { return PRE##_destroy_plan(plan); } \
-    };
-
-TRANSFORM_REAL(fftwf, cfloat, float, r2c)
-TRANSFORM_REAL(fftw, cdouble, double, r2c)
-TRANSFORM_REAL(fftwf, float, cfloat, c2r)
-TRANSFORM_REAL(fftw, double, cdouble, c2r)
-
 inline array<int, AF_MAX_DIMS> computeDims(const int rank, const dim4 &idims) {
     array<int, AF_MAX_DIMS> retVal = {};
     for (int i = 0; i < rank; i++) { retVal[i] = idims[(rank - 1) - i]; }
     return retVal;
 }
 
-void setFFTPlanCacheSize(size_t numPlans) { UNUSED(numPlans); }
+void setFFTPlanCacheSize(size_t numPlans) {
+    std::lock_guard<std::recursive_mutex> lock(getFFTWPlannerMutex());
+    fftManager().setMaxCacheSize(numPlans);
+}
 
 template<typename T>
 void fft_inplace(Array<T> &in, const int rank, const bool direction) {
@@ -84,25 +46,13 @@ void fft_inplace(Array<T> &in, const int rank, const bool direction) {
 
         const af::dim4 istrides = in.strides();
 
-        using ctype_t = typename fftw_transform<T>::ctype_t;
-        typename fftw_transform<T>::plan_t plan;
-
-        fftw_transform<T> transform;
-
         int batch = 1;
         for (int i = rank; i < 4; i++) { batch *= idims[i]; }
 
-        plan = transform.create(
-            rank, t_dims.data(), batch, reinterpret_cast<ctype_t *>(in.get()),
-            in_embed.data(), static_cast<int>(istrides[0]),
-            static_cast<int>(istrides[rank]),
-            reinterpret_cast<ctype_t *>(in.get()), in_embed.data(),
-            static_cast<int>(istrides[0]), static_cast<int>(istrides[rank]),
-            direction ? FFTW_FORWARD : FFTW_BACKWARD,
-            FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
-
-        transform.execute(plan);
-        transform.destroy(plan);
+        fftw_inplace<T>(in.get(), rank, t_dims.data(), in_embed.data(),
+                        static_cast<int>(istrides[0]),
+                        static_cast<int>(istrides[rank]), batch,
+                        direction ? FFTW_FORWARD : FFTW_BACKWARD);
     };
     getQueue().enqueue(func, in, in.getDataDims());
 }
@@ -126,23 +76,39 @@ Array<Tc> fft_r2c(const Array<Tr> &in, const int rank) {
 
         using ctype_t = typename fftw_real_transform<Tc, Tr>::ctype_t;
         using plan_t  = typename fftw_real_transform<Tc, Tr>::plan_t;
-        plan_t plan;
 
         fftw_real_transform<Tc, Tr> transform;
 
         int batch = 1;
         for (int i = rank; i < 4; i++) { batch *= idims[i]; }
 
-        plan = transform.create(
-            rank, t_dims.data(), batch, const_cast<Tr *>(in.get()),
-            in_embed.data(), static_cast<int>(istrides[0]),
-            static_cast<int>(istrides[rank]),
-            reinterpret_cast<ctype_t *>(out.get()), out_embed.data(),
-            static_cast<int>(ostrides[0]), static_cast<int>(ostrides[rank]),
-            FFTW_ESTIMATE);
-
-        transform.execute(plan);
-        transform.destroy(plan);
+        auto o_dims         = computeDims(rank, out.dims());
+        const int istride   = static_cast<int>(istrides[0]);
+        const int idist     = static_cast<int>(istrides[rank]);
+        const int ostride   = static_cast<int>(ostrides[0]);
+        const int odist     = static_cast<int>(ostrides[rank]);
+        const size_t ibytes = planExtent<Tr>(rank, t_dims.data(),
+                                             in_embed.data(), istride, idist,
+                                             batch);
+        const size_t obytes = planExtent<Tc>(rank, o_dims.data(),
+                                             out_embed.data(), ostride, odist,
+                                             batch);
+
+        Tr *iptr        = const_cast<Tr *>(in.get());
+        ctype_t *optr   = reinterpret_cast<ctype_t *>(out.get());
+        SharedPlan plan = findPlan<Tr>(
+            planKey("r2c", rank, t_dims.data(), in_embed.data(), istride,
+                    idist, out_embed.data(), ostride, odist, batch),
+            iptr, ibytes, optr, obytes, 0U,
+            [&](Tr *i, ctype_t *o, unsigned flags) {
+                return transform.create(rank, t_dims.data(), batch, i,
+                                        in_embed.data(), istride, idist, o,
+                                        out_embed.data(), ostride, odist,
+                                        flags);
+            },
+            [](plan_t p) { fftw_real_transform<Tc, Tr>().destroy(p); });
+
+        transform.execute(static_cast<plan_t>(plan.get()), iptr, optr);
     };
 
     getQueue().enqueue(func, out, out.getDataDims(), in, in.getDataDims());
@@ -165,7 +131,6 @@ Array<Tr> fft_c2r(const Array<Tc> &in, const dim4 &odims, const int rank) {
 
         using ctype_t = typename fftw_real_transform<Tr, Tc>::ctype_t;
         using plan_t  = typename fftw_real_transform<Tr, Tc>::plan_t;
-        plan_t plan;
 
         fftw_real_transform<Tr, Tc> transform;
 
@@ -178,21 +143,39 @@ Array<Tr> fft_c2r(const Array<Tc> &in, const dim4 &odims, const int rank) {
         // FFTW_PRESERVE_INPUT also. This flag however only works for 1D
         // transforms and for higher level transformations, a copy of input
         // data is passed onto the upstream FFTW calls.
-        unsigned int flags = FFTW_ESTIMATE;  // NOLINT(hicpp-signed-bitwise)
+        unsigned int flags = 0U;
         if (rank == 1) {
             flags |= FFTW_PRESERVE_INPUT;  // NOLINT(hicpp-signed-bitwise)
         }
 
-        plan = transform.create(
-            rank, t_dims.data(), batch,
-            reinterpret_cast<ctype_t *>(const_cast<Tc *>(in.get())),
-            in_embed.data(), static_cast<int>(istrides[0]),
-            static_cast<int>(istrides[rank]), out.get(), out_embed.data(),
-            static_cast<int>(ostrides[0]), static_cast<int>(ostrides[rank]),
-            flags);
-
-        transform.execute(plan);
-        transform.destroy(plan);
+        auto i_dims         = computeDims(rank, in.dims());
+        const int istride   = static_cast<int>(istrides[0]);
+        const int idist     = static_cast<int>(istrides[rank]);
+        const int ostride   = static_cast<int>(ostrides[0]);
+        const int odist     = static_cast<int>(ostrides[rank]);
+        const size_t ibytes = planExtent<Tc>(rank, i_dims.data(),
+                                             in_embed.data(), istride, idist,
+                                             batch);
+        const size_t obytes = planExtent<Tr>(rank, t_dims.data(),
+                                             out_embed.data(), ostride, odist,
+                                             batch);
+
+        ctype_t *iptr =
+            reinterpret_cast<ctype_t *>(const_cast<Tc *>(in.get()));
+        Tr *optr        = out.get();
+        SharedPlan plan = findPlan<Tr>(
+            planKey("c2r", rank, t_dims.data(), in_embed.data(), istride,
+                    idist, out_embed.data(), ostride, odist, batch),
+            iptr, ibytes, optr, obytes, flags,
+            [&](ctype_t *i, Tr *o, unsigned planFlags) {
+                return transform.create(rank, t_dims.data(), batch, i,
+                                        in_embed.data(), istride, idist, o,
+                                        out_embed.data(), ostride, odist,
+                                        planFlags);
+            },
+            [](plan_t p) { fftw_real_transform<Tr, Tc>().destroy(p); });
+
+        transform.execute(static_cast<plan_t>(plan.get()), iptr, optr);
     };
 
 #ifdef USE_MKL
@@ -19,6 +19,8 @@ namespace cpu {
 
 void setFFTPlanCacheSize(size_t numPlans);
 
+void setFFTNumThreads(unsigned numThreads);
+
 template<typename T>
 void fft_inplace(Array<T> &in, const int rank, const bool direction);
 
@@ -11,13 +11,14 @@
 
 #include <Array.hpp>
 #include <common/dispatch.hpp>
-#include <fftw3.h>
+#include <fftw.hpp>
 #include <kernel/fftconvolve.hpp>
 #include <queue.hpp>
 #include <af/dim4.hpp>
 
 #include <array>
 #include <cmath>
+#include <complex>
 #include <functional>
 #include <type_traits>
 
@@ -41,8 +42,6 @@ Array<T> fftconvolve(Array<T> const& signal, Array<T> const& filter,
                                                 std::is_same<T, float>::value,
                                             float, double>::type;
 
-    constexpr bool IsTypeDouble = std::is_same<T, double>::value;
-
     const dim4& sd = signal.dims();
     const dim4& fd = filter.dims();
     dim_t fftScale = 1;
@@ -100,29 +99,11 @@ Array<T> fftconvolve(Array<T> const& signal, Array<T> const& filter,
         const dim4 packedDims     = packed.dims();
         const dim4 packed_strides = packed.strides();
         // Compute forward FFT
-        if (IsTypeDouble) {
-            fftw_plan plan = fftw_plan_many_dft(
-                rank, fftDims.data(), packedDims[rank],
-                reinterpret_cast<fftw_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2,
-                reinterpret_cast<fftw_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2, FFTW_FORWARD,
-                FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
-
-            fftw_execute(plan);
-            fftw_destroy_plan(plan);
-        } else {
-            fftwf_plan plan = fftwf_plan_many_dft(
-                rank, fftDims.data(), packedDims[rank],
-                reinterpret_cast<fftwf_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2,
-                reinterpret_cast<fftwf_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2, FFTW_FORWARD,
-                FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
-
-            fftwf_execute(plan);
-            fftwf_destroy_plan(plan);
-        }
+        fftw_inplace(reinterpret_cast<std::complex<convT>*>(packed.get()), rank,
+                     fftDims.data(), fftDims.data(),
+                     static_cast<int>(packed_strides[0]),
+                     static_cast<int>(packed_strides[rank] / 2),
+                     static_cast<int>(packedDims[rank]), FFTW_FORWARD);
     };
     getQueue().enqueue(upstream_dft, packed, fftDims);
 
@@ -137,29 +118,11 @@ Array<T> fftconvolve(Array<T> const& signal, Array<T> const& filter,
         const dim4 packedDims     = packed.dims();
         const dim4 packed_strides = packed.strides();
         // Compute inverse FFT
-        if (IsTypeDouble) {
-            fftw_plan plan = fftw_plan_many_dft(
-                rank, fftDims.data(), packedDims[rank],
-                reinterpret_cast<fftw_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2,
-                reinterpret_cast<fftw_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2, FFTW_BACKWARD,
-                FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
-
-            fftw_execute(plan);
-            fftw_destroy_plan(plan);
-        } else {
-            fftwf_plan plan = fftwf_plan_many_dft(
-                rank, fftDims.data(), packedDims[rank],
-                reinterpret_cast<fftwf_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2,
-                reinterpret_cast<fftwf_complex*>(packed.get()), nullptr,
-                packed_strides[0], packed_strides[rank] / 2, FFTW_BACKWARD,
-                FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
-
-            fftwf_execute(plan);
-            fftwf_destroy_plan(plan);
-        }
+        fftw_inplace(reinterpret_cast<std::complex<convT>*>(packed.get()), rank,
+                     fftDims.data(), fftDims.data(),
+                     static_cast<int>(packed_strides[0]),
+                     static_cast<int>(packed_strides[rank] / 2),
+                     static_cast<int>(packedDims[rank]), FFTW_BACKWARD);
     };
     getQueue().enqueue(upstream_idft, packed, fftDims);
 
@@ -0,0 +1,95 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <fftw.hpp>
+
+#include <common/util.hpp>
+#include <fft.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
+#include <string>
+
+using std::atomic;
+using std::recursive_mutex;
+using std::string;
+
+namespace cpu {
+
+namespace {
+// The maximum number of threads of a transform. Zero uses the thread pool
+// size.
+atomic<unsigned> fftNumThreads{0};
+}  // namespace
+
+PlanCache &fftManager() {
+    static PlanCache *cache = new PlanCache();
+    return *cache;
+}
+
+recursive_mutex &getFFTWPlannerMutex() {
+    static recursive_mutex *plannerMutex = new recursive_mutex();
+    return *plannerMutex;
+}
+
+unsigned getFFTWPlannerFlags() {
+    static const unsigned flags = [] {
+        string planner = getEnvVar("AF_FFTW_PLANNER");
+        std::transform(planner.begin(), planner.end(), planner.begin(),
+                       ::toupper);
+        // NOLINTNEXTLINE(hicpp-signed-bitwise)
+        if (planner == "MEASURE") { return unsigned(FFTW_MEASURE); }
+        // NOLINTNEXTLINE(hicpp-signed-bitwise)
+        if (planner == "PATIENT") { return unsigned(FFTW_PATIENT); }
+        // NOLINTNEXTLINE(hicpp-signed-bitwise)
+        if (planner == "EXHAUSTIVE") { return unsigned(FFTW_EXHAUSTIVE); }
+        return unsigned(FFTW_ESTIMATE);  // NOLINT(hicpp-signed-bitwise)
+    }();
+    return flags;
+}
+
+void setFFTNumThreads(unsigned numThreads) { fftNumThreads = numThreads; }
+
+int getFFTWNumThreads(size_t elements) {
+#ifdef AF_WITH_FFTW_THREADS
+    unsigned threads = fftNumThreads;
+    if (threads == 0) { threads = getThreadPool().size(); }
+    // A thread needs as much work as a task of the thread pool to pay for
+    // the synchronization
+    const size_t useful = std::max<size_t>(elements / kMinElementsPerTask, 1);
+    return static_cast<int>(std::min<size_t>(threads, useful));
+#else
+    UNUSED(elements);
+    return 1;
+#endif
+}
+
+const string &getFFTWWisdomPath() {
+    static const string path = getEnvVar("AF_FFTW_WISDOM");
+    return path;
+}
+
+string planKey(const char *type, const int rank, const int *n,
+               const int *inembed, const int istride, const int idist,
+               const int *onembed, const int ostride, const int odist,
+               const int batch) {
+    string key(type);
+    for (int r = 0; r < rank; ++r) { key += ':' + std::to_string(n[r]); }
+    for (int r = 0; r < rank; ++r) { key += ':' + std::to_string(inembed[r]); }
+    for (int r = 0; r < rank; ++r) { key += ':' + std::to_string(onembed[r]); }
+    key += ':' + std::to_string(istride) + ':' + std::to_string(idist) + ':' +
+           std::to_string(ostride) + ':' + std::to_string(odist) + ':' +
+           std::to_string(batch);
+    return key;
+}
+
+}  // namespace cpu
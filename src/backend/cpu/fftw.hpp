@@ -0,0 +1,335 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <common/FFTPlanCache.hpp>
+#include <common/err_common.hpp>
+#include <fftw3.h>
+#include <types.hpp>
+#include <af/traits.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace cpu {
+
+typedef void PlanType;
+typedef std::shared_ptr<PlanType> SharedPlan;
+
+/// Caches the FFTW plans of both precisions. The keys hold the type of the
+/// transform so plans of different precisions never collide.
+class PlanCache : public common::FFTPlanCache<PlanCache, PlanType> {};
+
+/// Returns the process wide plan cache. It must only be used while holding
+/// the lock returned by getFFTWPlannerMutex.
+PlanCache &fftManager();
+
+/// The FFTW planner is not thread safe. This mutex guards the creation and
+/// destruction of plans and the wisdom functions. It is recursive because
+/// the cache destroys the plans it evicts while the lock is held.
+std::recursive_mutex &getFFTWPlannerMutex();
+
+/// Returns the planner rigor selected by the AF_FFTW_PLANNER environment
+/// variable. FFTW_ESTIMATE is used by default.
+unsigned getFFTWPlannerFlags();
+
+/// Returns the number of threads used to plan a transform over \p elements
+/// values. Small transforms are executed on a single thread and the others
+/// use at most the number of threads set by setFFTNumThreads.
+int getFFTWNumThreads(size_t elements);
+
+/// Returns the file named by the AF_FFTW_WISDOM environment variable. The
+/// FFTW wisdom is read from this file before the first plan of each
+/// precision is created and is written back after each measured plan.
+const std::string &getFFTWWisdomPath();
+
+template<typename T>
+struct fftw_api;
+
+// MKL implements the plan and execute functions of FFTW but not the wisdom
+// or the alignment queries. MKL does not use measured plans either.
+#ifdef USE_MKL
+#define FFTW_API(PRE, T)                                                    \
+    template<>                                                              \
+    struct fftw_api<T> {                                                    \
+        static void *malloc(size_t bytes) { return PRE##_malloc(bytes); }   \
+        static void free(void *ptr) { PRE##_free(ptr); }                    \
+        static int alignment_of(const void *ptr) {                          \
+            UNUSED(ptr);                                                    \
+            return 0;                                                       \
+        }                                                                   \
+        static bool import_wisdom(const char *path) {                       \
+            UNUSED(path);                                                   \
+            return false;                                                   \
+        }                                                                   \
+        static bool export_wisdom(const char *path) {                       \
+            UNUSED(path);                                                   \
+            return false;                                                   \
+        }                                                                   \
+    };
+#else
+#define FFTW_API(PRE, T)                                                    \
+    template<>                                                              \
+    struct fftw_api<T> {                                                    \
+        static void *malloc(size_t bytes) { return PRE##_malloc(bytes); }   \
+        static void free(void *ptr) { PRE##_free(ptr); }                    \
+        static int alignment_of(const void *ptr) {                          \
+            return PRE##_alignment_of(                                      \
+                static_cast<T *>(const_cast<void *>(ptr)));                 \
+        }                                                                   \
+        static bool import_wisdom(const char *path) {                       \
+            return PRE##_import_wisdom_from_filename(path) != 0;            \
+        }                                                                   \
+        static bool export_wisdom(const char *path) {                       \
+            return PRE##_export_wisdom_to_filename(path) != 0;              \
+        }                                                                   \
+    };
+#endif
+
+FFTW_API(fftwf, float)
+FFTW_API(fftw, double)
+
+#undef FFTW_API
+
+template<typename T>
+struct fftw_threads_api;
+
+#ifdef AF_WITH_FFTW_THREADS
+#define FFTW_THREADS_API(PRE, T)                                      \
+    template<>                                                        \
+    struct fftw_threads_api<T> {                                      \
+        static void plan_with_nthreads(int threads) {                 \
+            static const bool initialized = PRE##_init_threads() != 0; \
+            if (initialized) { PRE##_plan_with_nthreads(threads); }   \
+        }                                                             \
+    };
+#else
+#define FFTW_THREADS_API(PRE, T)                                      \
+    template<>                                                        \
+    struct fftw_threads_api<T> {                                      \
+        static void plan_with_nthreads(int threads) {                 \
+            UNUSED(threads);                                          \
+        }                                                             \
+    };
+#endif
+
+FFTW_THREADS_API(fftwf, float)
+FFTW_THREADS_API(fftw, double)
+
+#undef FFTW_THREADS_API
+
+template<typename T>
+struct fftw_transform;
+
+#define TRANSFORM(PRE, TY)                                             \
+    template<>                                                         \
+    struct fftw_transform<TY> {                                        \
+        typedef PRE##_plan plan_t;                                     \
+        typedef PRE##_complex ctype_t;                                 \
+                                                                       \
+        template<typename... Args>                                     \
+        plan_t create(Args... args) {                                  \
+            return PRE##_plan_many_dft(args...);                       \
+        }                                                              \
+        template<typename... Args>                                     \
+        void execute(Args... args) {                                   \
+            return PRE##_execute_dft(args...);                         \
+        }                                                              \
+        void destroy(plan_t plan) { return PRE##_destroy_plan(plan); } \
+    };
+
+TRANSFORM(fftwf, cfloat)
+TRANSFORM(fftw, cdouble)
+
+#undef TRANSFORM
+
+template<typename To, typename Ti>
+struct fftw_real_transform;
+
+#define TRANSFORM_REAL(PRE, To, Ti, POST)                              \
+    template<>                                                         \
+    struct fftw_real_transform<To, Ti> {                               \
+        typedef PRE##_plan plan_t;                                     \
+        typedef PRE##_complex ctype_t;                                 \
+                                                                       \
+        template<typename... Args>                                     \
+        plan_t create(Args... args) {                                  \
+            return PRE##_plan_many_dft_##POST(args...);                \
+        }                                                              \
+        template<typename... Args>                                     \
+        void execute(Args... args) {                                   \
+            return PRE##_execute_dft_##POST(args...);                  \
+        }                                                              \
+        void destroy(plan_t plan) { return PRE##_destroy_plan(plan); } \
+    };
+
+TRANSFORM_REAL(fftwf, cfloat, float, r2c)
+TRANSFORM_REAL(fftw, cdouble, double, r2c)
+TRANSFORM_REAL(fftwf, float, cfloat, c2r)
+TRANSFORM_REAL(fftw, double, cdouble, c2r)
+
+#undef TRANSFORM_REAL
+
+/// Describes a transform of \p rank dimensions for the plan cache
+std::string planKey(const char *type, const int rank, const int *n,
+                    const int *inembed, const int istride, const int idist,
+                    const int *onembed, const int ostride, const int odist,
+                    const int batch);
+
+/// Returns the number of bytes spanned by a batch of \p batch transforms of
+/// size \p n embedded in arrays of size \p embed
+template<typename T>
+size_t planExtent(const int rank, const int *n, const int *embed,
+                  const int stride, const int dist, const int batch) {
+    size_t last = 0, pitch = 1;
+    for (int r = rank - 1; r >= 0; --r) {
+        last += (n[r] - 1) * pitch;
+        pitch *= embed[r];
+    }
+    return ((batch - 1) * size_t(dist) + last * stride + 1) * sizeof(T);
+}
+
+
+/// Reads the wisdom file of the precision \p T the first time it is called.
+/// Must be called while holding the lock returned by getFFTWPlannerMutex.
+template<typename T>
+void importFFTWWisdom() {
+    static bool imported = false;
+    if (imported) { return; }
+    imported = true;
+
+    const std::string &wisdom = getFFTWWisdomPath();
+    if (!wisdom.empty()) { fftw_api<T>::import_wisdom(wisdom.c_str()); }
+}
+
+/// Returns the cached plan for \p key or creates one with \p create
+///
+/// The plans are executed with the new-array execute functions of FFTW so a
+/// plan is shared by all the buffers that have the same alignment and the
+/// same placement as the buffers it was created for.
+///
+/// \param[in] key     Describes the shape and the type of the transform
+/// \param[in] in      The input buffer of the transform
+/// \param[in] ibytes  The size of the input buffer
+/// \param[in] out     The output buffer of the transform
+/// \param[in] obytes  The size of the output buffer
+/// \param[in] flags   The planner flags other than the planner rigor
+/// \param[in] create  Creates the plan from an input buffer, an output
+///                    buffer and the planner flags. The measuring planners
+///                    overwrite the buffers so it is passed scratch buffers
+///                    unless FFTW_ESTIMATE is used.
+/// \param[in] destroy Destroys a plan returned by \p create
+template<typename T, typename Ti, typename To, typename CreateFunc,
+         typename DestroyFunc>
+SharedPlan findPlan(std::string key, Ti *in, size_t ibytes, To *out,
+                    size_t obytes, unsigned flags, CreateFunc create,
+                    DestroyFunc destroy) {
+    using api = fftw_api<T>;
+    // fftw_malloc returns buffers aligned to at least this many bytes
+    constexpr size_t kScratchPadding = 64;
+
+    const bool inPlace = static_cast<void *>(in) == static_cast<void *>(out);
+    const int ialign   = api::alignment_of(in);
+    const int oalign   = api::alignment_of(out);
+    const int threads =
+        getFFTWNumThreads(std::max(ibytes, obytes) / sizeof(T));
+    flags |= getFFTWPlannerFlags();
+
+    key += sizeof(T) == sizeof(float) ? ":f32:" : ":f64:";
+    key += std::to_string(ialign) + ':' + std::to_string(oalign) + ':' +
+           std::to_string(inPlace) + ':' + std::to_string(flags) + ':' +
+           std::to_string(threads);
+
+    std::lock_guard<std::recursive_mutex> lock(getFFTWPlannerMutex());
+    PlanCache &planner = fftManager();
+    SharedPlan retVal  = planner.find(key);
+    if (retVal) { return retVal; }
+
+    const std::string &wisdom = getFFTWWisdomPath();
+    importFFTWWisdom<T>();
+
+    fftw_threads_api<T>::plan_with_nthreads(threads);
+
+    decltype(create(in, out, flags)) plan;
+    if ((flags & FFTW_ESTIMATE) != 0U) {  // NOLINT(hicpp-signed-bitwise)
+        // The estimating planner does not touch the buffers
+        plan = create(in, out, flags);
+    } else {
+        // Scratch buffers with the alignment of the user's buffers
+        auto allocate = [](size_t bytes) {
+            return std::unique_ptr<char, void (*)(void *)>(
+                static_cast<char *>(api::malloc(bytes + kScratchPadding)),
+                api::free);
+        };
+        auto iscratch = allocate(inPlace ? std::max(ibytes, obytes) : ibytes);
+        auto oscratch = allocate(inPlace ? 0 : obytes);
+        if (!iscratch || !oscratch) {
+            AF_ERROR("Unable to allocate the FFTW planner buffers",
+                     AF_ERR_NO_MEM);
+        }
+        Ti *iptr = reinterpret_cast<Ti *>(iscratch.get() + ialign);
+        To *optr = inPlace ? reinterpret_cast<To *>(iptr)
+                           : reinterpret_cast<To *>(oscratch.get() + oalign);
+        plan     = create(iptr, optr, flags);
+    }
+    if (!plan) { AF_ERROR("Unable to create an FFTW plan", AF_ERR_INTERNAL); }
+
+    if ((flags & FFTW_ESTIMATE) == 0U && !wisdom.empty()) {
+        api::export_wisdom(wisdom.c_str());
+    }
+
+    retVal.reset(static_cast<PlanType *>(plan), [destroy](PlanType *p) {
+        std::lock_guard<std::recursive_mutex> lock(getFFTWPlannerMutex());
+        destroy(static_cast<decltype(plan)>(p));
+    });
+    planner.push(key, retVal);
+
+    return retVal;
+}
+
+/// Executes the batched in place complex transforms of \p data with a
+/// cached plan
+///
+/// \param[in] data  The buffer of the transforms
+/// \param[in] rank  The number of dimensions of a transform
+/// \param[in] n     The sizes of a transform, slowest dimension first
+/// \param[in] embed The sizes of the array each transform is embedded in
+/// \param[in] stride The distance between consecutive values
+/// \param[in] dist  The distance between consecutive transforms
+/// \param[in] batch The number of transforms
+/// \param[in] sign  FFTW_FORWARD or FFTW_BACKWARD
+template<typename T>
+void fftw_inplace(T *data, const int rank, const int *n, const int *embed,
+                  const int stride, const int dist, const int batch,
+                  const int sign) {
+    using ctype_t = typename fftw_transform<T>::ctype_t;
+    using plan_t  = typename fftw_transform<T>::plan_t;
+
+    fftw_transform<T> transform;
+    ctype_t *ptr       = reinterpret_cast<ctype_t *>(data);
+    const size_t bytes = planExtent<T>(rank, n, embed, stride, dist, batch);
+
+    SharedPlan plan = findPlan<typename af::dtype_traits<T>::base_type>(
+        planKey(sign == FFTW_FORWARD ? "c2c:f" : "c2c:b", rank, n, embed,
+                stride, dist, embed, stride, dist, batch),
+        ptr, bytes, ptr, bytes, 0U,
+        [&](ctype_t *iptr, ctype_t *optr, unsigned flags) {
+            return transform.create(rank, n, batch, iptr, embed, stride, dist,
+                                    optr, embed, stride, dist, sign, flags);
+        },
+        [](plan_t p) { fftw_transform<T>().destroy(p); });
+
+    transform.execute(static_cast<plan_t>(plan.get()), ptr, ptr);
+}
+
+}  // namespace cpu
@@ -8,6 +8,7 @@
  ********************************************************/
 #include <ireduce.hpp>
 #include <kernel/ireduce.hpp>
+#include <kernel/reduce_jit.hpp>
 
 #include <Array.hpp>
 #include <common/half.hpp>
@@ -32,6 +33,12 @@ void ireduce(Array<T> &out, Array<uint> &loc, const Array<T> &in,
              const int dim) {
     dim4 odims       = in.dims();
     odims[dim]       = 1;
+    if (kernel::isReadableTree(in, dim)) {
+        getQueue().enqueue(kernel::ireduce_dim_jit<op, T>, out, loc,
+                           in.getNode(), in.dims(), dim);
+        return;
+    }
+
     Array<uint> rlen = createEmptyArray<uint>(af::dim4(0));
     static const ireduce_dim_func<op, T> ireduce_funcs[] = {
         kernel::ireduce_dim<op, T, 1>(), kernel::ireduce_dim<op, T, 2>(),
@@ -57,6 +64,11 @@ void rreduce(Array<T> &out, Array<uint> &loc, const Array<T> &in, const int dim,
 
 template<af_op_t op, typename T>
 T ireduce_all(unsigned *loc, const Array<T> &in) {
+    if (kernel::isReadableTree(in, -1)) {
+        getQueue().sync();
+        return kernel::ireduce_all_jit<op, T>(loc, in.getNode(), in.dims());
+    }
+
     getQueue().sync();
 
     af::dim4 dims    = in.dims();
@@ -0,0 +1,930 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <jit.hpp>
+
+#include <common/DependencyModule.hpp>
+#include <common/Logger.hpp>
+#include <common/jit/Node.hpp>
+#include <common/kernel_manifest.hpp>
+#include <common/traits.hpp>
+#include <common/util.hpp>
+#include <jit/Node.hpp>
+#include <memory.hpp>
+#include <platform.hpp>
+#include <thread_pool.hpp>
+#include <af/version.h>
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if !defined(OS_WIN)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using common::DependencyModule;
+using common::getFuncName;
+using common::Node;
+using common::Node_ids;
+using common::Node_map_t;
+using common::saturatingAdd;
+
+using std::lock_guard;
+using std::mutex;
+using std::ofstream;
+using std::string;
+using std::stringstream;
+using std::to_string;
+using std::unique_ptr;
+using std::unordered_map;
+using std::unordered_set;
+using std::vector;
+
+namespace cpu {
+
+namespace jit {
+
+const char *getOpName(af_op_t op) {
+    switch (op) {
+        case af_add_t: return "__add";
+        case af_sub_t: return "__sub";
+        case af_mul_t: return "__mul";
+        case af_div_t: return "__div";
+        case af_and_t: return "__and";
+        case af_or_t: return "__or";
+        case af_eq_t: return "__eq";
+        case af_neq_t: return "__neq";
+        case af_lt_t: return "__lt";
+        case af_le_t: return "__le";
+        case af_gt_t: return "__gt";
+        case af_ge_t: return "__ge";
+        case af_bitor_t: return "__bitor";
+        case af_bitand_t: return "__bitand";
+        case af_bitxor_t: return "__bitxor";
+        case af_bitshiftl_t: return "__bitshiftl";
+        case af_bitshiftr_t: return "__bitshiftr";
+        case af_bitnot_t: return "__bitnot";
+        case af_min_t: return "__min";
+        case af_max_t: return "__max";
+        case af_atan2_t: return "__atan2";
+        case af_pow_t: return "__pow";
+        case af_hypot_t: return "__hypot";
+        case af_rem_t: return "__rem";
+        case af_mod_t: return "__mod";
+        case af_sin_t: return "std::sin";
+        case af_cos_t: return "std::cos";
+        case af_tan_t: return "std::tan";
+        case af_asin_t: return "std::asin";
+        case af_acos_t: return "std::acos";
+        case af_atan_t: return "std::atan";
+        case af_sinh_t: return "std::sinh";
+        case af_cosh_t: return "std::cosh";
+        case af_tanh_t: return "std::tanh";
+        case af_asinh_t: return "std::asinh";
+        case af_acosh_t: return "std::acosh";
+        case af_atanh_t: return "std::atanh";
+        case af_exp_t: return "std::exp";
+        case af_expm1_t: return "std::expm1";
+        case af_erf_t: return "std::erf";
+        case af_erfc_t: return "std::erfc";
+        case af_log_t: return "std::log";
+        case af_log10_t: return "std::log10";
+        case af_log1p_t: return "std::log1p";
+        case af_log2_t: return "std::log2";
+        case af_sqrt_t: return "std::sqrt";
+        case af_cbrt_t: return "std::cbrt";
+        case af_abs_t: return "__abs";
+        case af_floor_t: return "std::floor";
+        case af_ceil_t: return "std::ceil";
+        case af_round_t: return "std::round";
+        case af_trunc_t: return "std::trunc";
+        case af_signbit_t: return "std::signbit";
+        case af_tgamma_t: return "std::tgamma";
+        case af_lgamma_t: return "std::lgamma";
+        case af_isinf_t: return "std::isinf";
+        case af_isnan_t: return "std::isnan";
+        case af_iszero_t: return "__iszero";
+        case af_sigmoid_t: return "__sigmoid";
+        case af_rsqrt_t: return "__rsqrt";
+        case af_noop_t: return "__noop";
+        case af_cast_t: return "__cast";
+        default: return nullptr;
+    }
+}
+
+bool isGeneratedType(af::dtype type) {
+    switch (type) {
+        case f32:
+        case f64:
+        case s32:
+        case u32:
+        case s64:
+        case u64:
+        case s16:
+        case u16:
+        case u8:
+        case b8: return true;
+        default: return false;
+    }
+}
+
+}  // namespace jit
+
+namespace {
+
+constexpr const char *kLibraryPrefix = "lib";
+#if defined(OS_MAC)
+constexpr const char *kLibrarySuffix = ".dylib";
+#else
+constexpr const char *kLibrarySuffix = ".so";
+#endif
+
+/// The flags passed to the compiler in addition to the ones specified in the
+/// AF_CPU_JIT_COMPILER environment variable. Floating point contraction is
+/// disabled so the results match the interpreter.
+constexpr const char *kCompilerFlags =
+    "-std=c++11 -O3 -fPIC -shared -ffp-contract=off";
+
+/// The functions used by the generated kernels. Each of them implements an
+/// operation the same way as the BinOp and UnOp functors of the interpreter.
+constexpr const char *kKernelPrelude = R"JIT(
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+typedef long long dim_t;
+
+template<typename T>
+struct Param {
+    const T *ptr;
+    dim_t dims[4];
+    dim_t strides[4];
+};
+
+template<typename T>
+static inline const T *readPtr(void *const *&arg) {
+    return *static_cast<T *const *>(*arg++);
+}
+
+template<typename T>
+static inline Param<T> readParam(void *const *&arg) {
+    Param<T> param;
+    param.ptr = readPtr<T>(arg);
+    const dim_t *dims    = static_cast<const dim_t *>(*arg++);
+    const dim_t *strides = static_cast<const dim_t *>(*arg++);
+    for (int i = 0; i < 4; i++) {
+        param.dims[i]    = dims[i];
+        param.strides[i] = strides[i];
+    }
+    return param;
+}
+
+template<typename T>
+static inline T readScalar(void *const *&arg) {
+    return *static_cast<const T *>(*arg++);
+}
+
+#define ARITH_FN(NAME, OP)                          \
+    template<typename T>                            \
+    static inline T NAME(T lhs, T rhs) {            \
+        return lhs OP rhs;                          \
+    }
+
+ARITH_FN(__add, +)
+ARITH_FN(__sub, -)
+ARITH_FN(__mul, *)
+ARITH_FN(__div, /)
+ARITH_FN(__bitor, |)
+ARITH_FN(__bitand, &)
+ARITH_FN(__bitxor, ^)
+ARITH_FN(__bitshiftl, <<)
+ARITH_FN(__bitshiftr, >>)
+
+#define LOGIC_FN(NAME, OP)                          \
+    template<typename T>                            \
+    static inline char NAME(T lhs, T rhs) {         \
+        return lhs OP rhs;                          \
+    }
+
+LOGIC_FN(__eq, ==)
+LOGIC_FN(__neq, !=)
+LOGIC_FN(__lt, <)
+LOGIC_FN(__gt, >)
+LOGIC_FN(__le, <=)
+LOGIC_FN(__ge, >=)
+LOGIC_FN(__and, &&)
+LOGIC_FN(__or, ||)
+
+#define NUMERIC_FN(NAME, FN)                        \
+    template<typename T>                            \
+    static inline T NAME(T lhs, T rhs) {            \
+        return FN(lhs, rhs);                        \
+    }
+
+NUMERIC_FN(__max, std::max)
+NUMERIC_FN(__min, std::min)
+NUMERIC_FN(__pow, pow)
+NUMERIC_FN(__atan2, atan2)
+NUMERIC_FN(__hypot, hypot)
+
+template<typename T>
+static inline T __abs(T val) { return std::abs(val); }
+static inline unsigned __abs(unsigned val) { return val; }
+static inline unsigned char __abs(unsigned char val) { return val; }
+static inline unsigned short __abs(unsigned short val) { return val; }
+static inline unsigned long long __abs(unsigned long long val) { return val; }
+
+template<typename T>
+static inline T __mod(T lhs, T rhs) {
+    T res = lhs % rhs;
+    return (res < 0) ? __abs(rhs - res) : res;
+}
+static inline float __mod(float lhs, float rhs) { return fmod(lhs, rhs); }
+static inline double __mod(double lhs, double rhs) { return fmod(lhs, rhs); }
+
+template<typename T>
+static inline T __rem(T lhs, T rhs) { return lhs % rhs; }
+static inline float __rem(float lhs, float rhs) { return remainder(lhs, rhs); }
+static inline double __rem(double lhs, double rhs) {
+    return remainder(lhs, rhs);
+}
+
+template<typename T>
+static inline T __sigmoid(T in) { return (1.0) / (1 + std::exp(-in)); }
+
+template<typename T>
+static inline T __rsqrt(T in) { return pow(in, -0.5); }
+
+template<typename T>
+static inline T __noop(T in) { return in; }
+
+template<typename T>
+static inline T __bitnot(T in) { return ~in; }
+
+template<typename T>
+static inline char __iszero(T in) { return in == 0; }
+
+template<typename To, typename Ti>
+static inline To __cast(Ti in) { return To(in); }
+
+#define CAST_B8(T)                                  \
+    template<>                                      \
+    inline char __cast<char, T>(T in) {             \
+        return char(in != 0);                       \
+    }
+
+CAST_B8(float)
+CAST_B8(double)
+CAST_B8(int)
+CAST_B8(unsigned char)
+CAST_B8(char)
+
+)JIT";
+
+spdlog::logger *getLogger() {
+    static std::shared_ptr<spdlog::logger> logger(common::loggerFactory("jit"));
+    return logger.get();
+}
+
+const string &getCompiler() {
+    static const string compiler = getEnvVar("AF_CPU_JIT_COMPILER");
+    return compiler;
+}
+
+string getKernelString(const string &funcName, const vector<Node *> &full_nodes,
+                       const vector<Node_ids> &full_ids,
+                       const vector<int> &output_ids, const bool is_linear) {
+    static const char *kernelVoid = "extern \"C\" void\n";
+    static const char *kernelParams =
+        "(void *const *args, void *const *outs, const dim_t *odims,\n"
+        " const dim_t *ostrides, dim_t begin, dim_t end)\n";
+
+    static const char *blockStart = "{\nvoid *const *arg = args;\n";
+    static const char *blockEnd   = "}\n";
+
+    static const char *linearLoopStart = R"JIT(
+    for (dim_t idx = begin; idx < end; idx++) {
+    )JIT";
+    static const char *linearLoopEnd   = "}\n";
+
+    static const char *generalLoopStart = R"JIT(
+    for (dim_t row = begin; row < end; row++) {
+        dim_t id1  = row % odims[1];
+        dim_t id2  = (row / odims[1]) % odims[2];
+        dim_t id3  = row / (odims[1] * odims[2]);
+        dim_t ooff = id3 * ostrides[3] + id2 * ostrides[2] + id1 * ostrides[1];
+        for (dim_t id0 = 0; id0 < odims[0]; id0++) {
+            dim_t idx = ooff + id0;
+    )JIT";
+    static const char *generalLoopEnd   = "}\n}\n";
+
+    stringstream inParamStream;
+    stringstream outParamStream;
+    stringstream outWriteStream;
+    stringstream offsetsStream;
+    stringstream opsStream;
+
+    for (int i = 0; i < static_cast<int>(full_nodes.size()); i++) {
+        const auto &node     = full_nodes[i];
+        const auto &ids_curr = full_ids[i];
+        // Generate input parameters, only needs current id
+        node->genParams(inParamStream, ids_curr.id, is_linear);
+        // Generate input offsets, only needs current id
+        node->genOffsets(offsetsStream, ids_curr.id, is_linear);
+        // Generate the core function body, needs children ids as well
+        node->genFuncs(opsStream, ids_curr);
+    }
+
+    for (int i = 0; i < static_cast<int>(output_ids.size()); i++) {
+        const string typeStr = full_nodes[output_ids[i]]->getTypeStr();
+        // Generate output parameters
+        outParamStream << typeStr << " *out" << i << " = static_cast<"
+                       << typeStr << " *>(outs[" << i << "]);\n";
+        // Generate code to write the output
+        outWriteStream << "out" << i << "[idx] = val" << output_ids[i]
+                       << ";\n";
+    }
+
+    // Put various blocks into a single stream
+    stringstream kerStream;
+    kerStream << kKernelPrelude;
+    kerStream << kernelVoid;
+    kerStream << funcName;
+    kerStream << kernelParams;
+    kerStream << blockStart;
+    kerStream << inParamStream.str();
+    kerStream << outParamStream.str();
+    kerStream << (is_linear ? linearLoopStart : generalLoopStart);
+    kerStream << offsetsStream.str();
+    kerStream << opsStream.str();
+    kerStream << outWriteStream.str();
+    kerStream << (is_linear ? linearLoopEnd : generalLoopEnd);
+    kerStream << blockEnd;
+
+    return kerStream.str();
+}
+
+#if !defined(OS_WIN)
+/// The shared fallback of getCacheDirectory. Any user can create it first,
+/// so native code is never loaded from it.
+constexpr const char *kSharedCacheDirectory = "/tmp/arrayfire";
+
+/// Returns true if \p path is a directory (or a regular file if
+/// \p directory is false) that only the current user can change. Symbolic
+/// links to files are not followed.
+bool isPrivatePath(const string &path, bool directory) {
+    struct stat info {};
+    const int status = directory ? stat(path.c_str(), &info)
+                                 : lstat(path.c_str(), &info);
+    if (status != 0) { return false; }
+    const bool is_type =
+        directory ? S_ISDIR(info.st_mode) : S_ISREG(info.st_mode);
+    return is_type && info.st_uid == geteuid() &&
+           (info.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+/// A directory created by mkdtemp, which only this process uses. It is
+/// removed with the kernels in it when the library is unloaded.
+class PrivateDirectory {
+    string path;
+
+   public:
+    PrivateDirectory() {
+        string temp = getEnvVar("TMPDIR");
+        if (temp.empty()) { temp = "/tmp"; }
+        string pattern = temp + AF_PATH_SEPARATOR + "arrayfire-jit-XXXXXX";
+        if (mkdtemp(&pattern[0])) { path = pattern; }
+    }
+
+    ~PrivateDirectory() {
+        if (path.empty()) { return; }
+        if (DIR *dir = opendir(path.c_str())) {
+            while (const dirent *entry = readdir(dir)) {
+                const string name = entry->d_name;
+                if (name != "." && name != "..") {
+                    removeFile(path + AF_PATH_SEPARATOR + name);
+                }
+            }
+            closedir(dir);
+        }
+        rmdir(path.c_str());
+    }
+
+    PrivateDirectory(const PrivateDirectory &)            = delete;
+    PrivateDirectory &operator=(const PrivateDirectory &) = delete;
+
+    const string &get() const { return path; }
+};
+#endif
+
+/// Returns the directory the native kernels are compiled into and loaded
+/// from. It is the kernel cache directory if no other user can change it.
+/// Otherwise the kernels are compiled into a private temporary directory
+/// and are not kept between runs.
+string getNativeCacheDirectory() {
+#if defined(OS_WIN)
+    return "";
+#else
+    const string cacheDirectory = getCacheDirectory();
+    if (!cacheDirectory.empty() && cacheDirectory != kSharedCacheDirectory &&
+        isPrivatePath(cacheDirectory, true)) {
+        return cacheDirectory;
+    }
+
+    static const PrivateDirectory privateDirectory;
+    AF_TRACE("{{Native kernels are not cached: {} can be changed by others}}",
+             cacheDirectory);
+    return privateDirectory.get();
+#endif
+}
+
+/// Returns true if the library \p libPath can be loaded. Libraries that
+/// another user could have written are compiled again.
+bool isTrustedLibrary(const string &libPath) {
+#if defined(OS_WIN)
+    UNUSED(libPath);
+    return false;
+#else
+    return isPrivatePath(libPath, false);
+#endif
+}
+
+/// Compiles \p source into the shared library \p libPath. The temporary
+/// files are created in \p directory, which holds \p libPath.
+bool compileKernel(const string &funcName, const string &source,
+                   const string &directory, const string &libPath) {
+    const string tempFile =
+        directory + AF_PATH_SEPARATOR + makeTempFilename();
+    const string srcFile = tempFile + ".cpp";
+    const string binFile = tempFile + kLibrarySuffix;
+
+    {
+        ofstream out(srcFile);
+        out << source;
+        if (!out) {
+            AF_TRACE("{{{:<20} : Unable to write {}}}", funcName, srcFile);
+            removeFile(srcFile);
+            return false;
+        }
+    }
+
+    const string command = getCompiler() + " " + kCompilerFlags + " -o '" +
+                           binFile + "' '" + srcFile + "' 2>&1";
+    AF_TRACE("{{{:<20} : {}}}", funcName, command);
+
+    string messages;
+    int status = -1;
+    if (FILE *pipe = popen(command.c_str(), "r")) {
+        char buffer[256];
+        while (fgets(buffer, sizeof(buffer), pipe)) { messages += buffer; }
+        status = pclose(pipe);
+    }
+    removeFile(srcFile);
+
+    if (status != 0) {
+        AF_TRACE("{{{:<20} : Compilation failed({}): {}}}", funcName, status,
+                 messages);
+        removeFile(binFile);
+        return false;
+    }
+
+#if !defined(OS_WIN)
+    // The umask may have made the library writable by the group, and such
+    // libraries are not loaded
+    chmod(binFile.c_str(), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH);
+#endif
+
+    // Another thread or process may have compiled the same kernel. Both
+    // libraries are identical so the last one replaces the others.
+    if (!renameFile(binFile, libPath)) { removeFile(binFile); }
+    return true;
+}
+
+struct NativeModule {
+    unique_ptr<DependencyModule> module;
+    NativeKernel kernel;
+};
+
+/// Loads the kernel \p funcName from the directory of getNativeCacheDirectory.
+/// The kernel is compiled from \p source first if it is not in the
+/// directory.
+NativeModule loadNativeModule(const string &funcName, const string &source) {
+    NativeModule native{nullptr, nullptr};
+
+    const string cacheDirectory = getNativeCacheDirectory();
+    if (cacheDirectory.empty()) { return native; }
+
+    // The compiler is part of the name because the flags in
+    // AF_CPU_JIT_COMPILER change the generated code
+    const string libName = funcName + "_" +
+                           to_string(deterministicHash(getCompiler())) +
+                           "_AF_" + to_string(AF_API_VERSION_CURRENT);
+    const string libPath = cacheDirectory + AF_PATH_SEPARATOR +
+                           kLibraryPrefix + libName + kLibrarySuffix;
+    const char *paths[]  = {cacheDirectory.c_str(), nullptr};
+
+    if (isTrustedLibrary(libPath)) {
+        native.module.reset(new DependencyModule(libName.c_str(), paths));
+    }
+    if (!native.module || !native.module->isLoaded()) {
+        saveKernel(funcName, source, ".cpp");
+
+        if (!compileKernel(funcName, source, cacheDirectory, libPath) ||
+            !isTrustedLibrary(libPath)) {
+            return native;
+        }
+        native.module.reset(new DependencyModule(libName.c_str(), paths));
+        if (!native.module->isLoaded()) {
+            AF_TRACE("{{{:<20} : Unable to load {}: {}}}", funcName, libPath,
+                     DependencyModule::getErrorMessage());
+            return native;
+        }
+    }
+
+    NativeKernel kernel =
+        native.module->getSymbol<NativeKernel>(funcName.c_str());
+    if (!native.module->symbolsLoaded()) {
+        AF_TRACE("{{{:<20} : Kernel not found in {}}}", funcName, libPath);
+        return native;
+    }
+    native.kernel = kernel;
+    return native;
+}
+
+mutex &getCacheMutex() {
+    static mutex cacheMutex;
+    return cacheMutex;
+}
+
+unordered_map<string, NativeModule> &getCache() {
+    static auto *cache = new unordered_map<string, NativeModule>;
+    return *cache;
+}
+
+/// Returns the cached kernel \p funcName in \p kernel. Returns false if the
+/// kernel has not been loaded or compiled yet.
+bool findNativeKernel(const string &funcName, NativeKernel &kernel) {
+    lock_guard<mutex> lock(getCacheMutex());
+    auto entry = getCache().find(funcName);
+    if (entry == getCache().end()) { return false; }
+    kernel = entry->second.kernel;
+    return true;
+}
+
+/// Loads or compiles the kernel \p funcName and adds it to the cache. The
+/// lock is not held while compiling so kernels can be built concurrently.
+/// Failures are cached as well so they are not retried on every call.
+NativeKernel addNativeKernel(const string &funcName, const string &source) {
+    NativeModule native = loadNativeModule(funcName, source);
+    if (native.kernel && common::isKernelManifestEnabled()) {
+        common::recordKernel({funcName, 0, 0, true, {source}, {}});
+    }
+
+    lock_guard<mutex> lock(getCacheMutex());
+    // If another thread added the kernel first this module is dropped
+    auto entry = getCache().emplace(funcName, std::move(native)).first;
+    return entry->second.kernel;
+}
+
+/// The largest number of bytes the values of the nodes of JIT trees may
+/// occupy. Every thread evaluates its own copy of the trees
+/// jit::VECTOR_LENGTH elements at a time, and the values stay in the cache
+/// between the nodes only while they fit in the L2 cache of a core.
+constexpr size_t kMaxJitWorkingSetBytes = 256 * 1024;
+
+/// The largest number of buffers JIT trees that are limited by memory
+/// bandwidth may read. Every buffer is a separate stream of reads, and the
+/// hardware prefetchers only follow a few dozen streams at once.
+constexpr int kMaxJitBuffers = 32;
+
+/// Returns the number of bytes a value of type \p type occupies while a tree
+/// is evaluated
+size_t computeBytes(af::dtype type) {
+    return type == f16 ? sizeof(float) : common::dtypeSize(type);
+}
+
+const char *getHeuristicName(kJITHeuristics heuristic) {
+    switch (heuristic) {
+        case kJITHeuristics::Pass: return "pass";
+        case kJITHeuristics::TreeHeight: return "tree height";
+        case kJITHeuristics::KernelParameterSize: return "buffer count";
+        case kJITHeuristics::MemoryPressure: return "memory pressure";
+        case kJITHeuristics::WorkingSet: return "working set";
+    }
+    return "";
+}
+
+/// The estimated cost of evaluating JIT trees in one kernel. The bytes read
+/// and written and the operations are per element.
+struct JitCost {
+    int height          = 0;
+    size_t nodes        = 0;
+    size_t ops          = 0;
+    size_t buffers      = 0;
+    size_t read_bytes   = 0;
+    size_t write_bytes  = 0;
+    size_t buffer_bytes = 0;
+    /// The bytes of one value of every node
+    size_t value_bytes = 0;
+};
+
+/// Returns true if a kernel with the cost \p cost is limited by memory
+/// bandwidth rather than by its arithmetic. An operation is weighed like a
+/// byte moved, which is roughly the balance of a core that streams from
+/// memory.
+bool isMemoryBound(const JitCost &cost) {
+    return cost.ops < saturatingAdd(cost.read_bytes, cost.write_bytes);
+}
+
+/// Decides if the trees with the cost \p cost need to be evaluated
+kJITHeuristics getHeuristic(const JitCost &cost) {
+    if (cost.height > static_cast<int>(getMaxJitSize())) {
+        return kJITHeuristics::TreeHeight;
+    }
+    if (cost.value_bytes > kMaxJitWorkingSetBytes / jit::VECTOR_LENGTH) {
+        return kJITHeuristics::WorkingSet;
+    }
+    if (cost.buffers > static_cast<size_t>(kMaxJitBuffers) &&
+        isMemoryBound(cost)) {
+        return kJITHeuristics::KernelParameterSize;
+    }
+    if (getMemoryPressure() >= getMemoryPressureThreshold() &&
+        jitTreeExceedsMemoryPressure(cost.buffer_bytes)) {
+        return kJITHeuristics::MemoryPressure;
+    }
+    return kJITHeuristics::Pass;
+}
+
+/// Returns an upper bound of the cost of adding a node of type \p type on
+/// top of \p root_nodes from the estimates cached in the nodes. It does not
+/// walk the trees. The operations are left at zero so the bound is limited
+/// by memory, which is the stricter case.
+JitCost getJitCostBound(nonstd::span<Node *> root_nodes, af::dtype type) {
+    JitCost cost;
+    cost.value_bytes = computeBytes(type);
+    cost.write_bytes = common::dtypeSize(type);
+    for (Node *node : root_nodes) {
+        const Node::SubtreeInfo &below = node->getSubtree();
+        cost.height = std::max(cost.height, node->getHeight());
+        cost.value_bytes =
+            saturatingAdd(cost.value_bytes,
+                          saturatingAdd(below.value_bytes,
+                                        computeBytes(node->getType())));
+        if (node->isBuffer()) {
+            cost.buffers = saturatingAdd(cost.buffers, 1);
+            cost.buffer_bytes =
+                saturatingAdd(cost.buffer_bytes, node->getBytes());
+        } else {
+            cost.buffers = saturatingAdd(cost.buffers, below.buffers);
+            cost.buffer_bytes =
+                saturatingAdd(cost.buffer_bytes, below.buffer_bytes);
+        }
+    }
+    return cost;
+}
+
+/// The distinct nodes of JIT trees in the order getNodesMap numbers them,
+/// so the children come before their parents. Bit i of the mask of a node
+/// is set if the node is part of the tree of the i-th root.
+struct JitTrees {
+    vector<Node *> nodes;
+    vector<Node_ids> ids;
+    vector<unsigned> masks;
+};
+
+JitTrees getJitTrees(nonstd::span<Node *> root_nodes) {
+    JitTrees trees;
+    Node_map_t node_map;
+    vector<int> root_ids;
+    for (Node *node : root_nodes) {
+        root_ids.push_back(node->getNodesMap(node_map, trees.nodes, trees.ids));
+    }
+
+    trees.masks.assign(trees.nodes.size(), 0U);
+    for (size_t i = 0; i < root_ids.size() && i < 32; i++) {
+        trees.masks[root_ids[i]] |= 1U << i;
+    }
+    for (int id = static_cast<int>(trees.nodes.size()) - 1; id >= 0; id--) {
+        const Node *node = trees.nodes[id];
+        for (int i = 0; i < Node::kMaxChildren && node->m_children[i]; i++) {
+            trees.masks[trees.ids[id].child_ids[i]] |= trees.masks[id];
+        }
+    }
+    return trees;
+}
+
+/// Returns the data the buffer node \p buffer reads. It is the first
+/// argument the node passes to the kernels.
+const void *getBufferData(const Node *buffer) {
+    const void *data = nullptr;
+    buffer->setArgs(0, true, [&data](int id, const void *ptr, size_t) {
+        if (id == 0) { data = *static_cast<const void *const *>(ptr); }
+    });
+    return data;
+}
+
+/// Returns the cost of evaluating the nodes of \p trees whose masks have a
+/// bit of \p mask set. Every node is counted once. The buffer nodes that
+/// read the same data, such as the nodes created each time an array is used
+/// in an expression, are counted as one buffer.
+JitCost getJitCost(const JitTrees &trees, unsigned mask) {
+    JitCost cost;
+    unordered_set<const void *> data;
+    for (size_t id = 0; id < trees.nodes.size(); id++) {
+        if ((trees.masks[id] & mask) == 0) { continue; }
+        const Node *node = trees.nodes[id];
+        cost.nodes++;
+        cost.value_bytes += computeBytes(node->getType());
+        if (node->isBuffer()) {
+            if (data.insert(getBufferData(node)).second) {
+                cost.buffers++;
+                cost.read_bytes += common::dtypeSize(node->getType());
+                // Sub arrays are represented by the size of their parent
+                cost.buffer_bytes += node->getBytes();
+            }
+        } else if (!node->isScalar()) {
+            cost.ops++;
+        }
+    }
+    return cost;
+}
+
+/// Adds the cost of a node of type \p type that is evaluated on top of the
+/// trees to \p cost
+void addRootCost(JitCost &cost, af::dtype type) {
+    cost.nodes++;
+    cost.ops++;
+    cost.value_bytes += computeBytes(type);
+    cost.write_bytes += common::dtypeSize(type);
+}
+
+}  // namespace
+
+kJITHeuristics checkJitHeuristics(nonstd::span<Node *> root_nodes,
+                                  af::dtype type) {
+    // Most trees share no nodes, so the bound cached in the nodes is exact
+    // and the trees do not need to be walked every time a node is added
+    if (getHeuristic(getJitCostBound(root_nodes, type)) ==
+        kJITHeuristics::Pass) {
+        return kJITHeuristics::Pass;
+    }
+
+    const JitTrees trees = getJitTrees(root_nodes);
+    JitCost cost         = getJitCost(trees, ~0U);
+    for (Node *node : root_nodes) {
+        cost.height = std::max(cost.height, node->getHeight());
+    }
+    addRootCost(cost, type);
+
+    const kJITHeuristics heuristic = getHeuristic(cost);
+    if (heuristic != kJITHeuristics::Pass) {
+        AF_TRACE(
+            "{{Evaluating due to {:<15} : height {}, nodes {}, ops {}, "
+            "buffers {}, bytes read {}, bytes written {}, buffer memory {}, "
+            "working set {}}}",
+            getHeuristicName(heuristic), cost.height, cost.nodes, cost.ops,
+            cost.buffers, cost.read_bytes, cost.write_bytes,
+            common::bytesToString(cost.buffer_bytes),
+            common::bytesToString(jit::VECTOR_LENGTH * cost.value_bytes));
+    }
+    return heuristic;
+}
+
+int selectJitEvalNode(nonstd::span<Node *> root_nodes, af::dtype type) {
+    const int count = static_cast<int>(root_nodes.size());
+    int tallest     = 0;
+    for (int i = 1; i < count; i++) {
+        if (root_nodes[i]->getHeight() > root_nodes[tallest]->getHeight()) {
+            tallest = i;
+        }
+    }
+    if (count > 32) { return tallest; }
+
+    // Evaluating a tree turns it into a buffer. Its values are written by one
+    // kernel and read back by the next, and the nodes it shares with the
+    // other trees are computed and their buffers read by both kernels.
+    const JitTrees trees = getJitTrees(root_nodes);
+    const JitCost total  = getJitCost(trees, ~0U);
+
+    int selected          = tallest;
+    bool selected_passes  = false;
+    size_t selected_freed = 0;
+    size_t selected_cost  = std::numeric_limits<size_t>::max();
+    for (int i = 0; i < count; i++) {
+        Node *node = root_nodes[i];
+        // Evaluating buffers and scalars does not change the trees
+        if (node->getHeight() == 0) { continue; }
+
+        const unsigned bit = 1U << i;
+        const JitCost own  = getJitCost(trees, bit);
+        JitCost after      = getJitCost(trees, ~bit);
+        const size_t recomputed_ops = own.ops + after.ops - total.ops;
+        const size_t reread_bytes =
+            own.read_bytes + after.read_bytes - total.read_bytes;
+        const size_t bytes = common::dtypeSize(node->getType());
+        const size_t cost  = 2 * bytes + reread_bytes + recomputed_ops;
+
+        // The cost of the trees once this one is a buffer
+        for (int j = 0; j < count; j++) {
+            if (j != i) {
+                after.height = std::max(after.height, root_nodes[j]->getHeight());
+            }
+        }
+        after.nodes++;
+        after.buffers++;
+        after.read_bytes += bytes;
+        after.value_bytes += computeBytes(node->getType());
+        addRootCost(after, type);
+        const bool passes = getHeuristic(after) == kJITHeuristics::Pass;
+        const size_t freed =
+            total.value_bytes - std::min(total.value_bytes, after.value_bytes);
+
+        // Prefer the cheapest evaluation that brings the trees within the
+        // limits. If there is none, free as many values as possible so the
+        // next evaluation has less to do.
+        bool better = false;
+        if (passes != selected_passes) {
+            better = passes;
+        } else if (passes) {
+            better = cost < selected_cost;
+        } else {
+            better = freed > selected_freed ||
+                     (freed == selected_freed && cost < selected_cost);
+        }
+        if (better) {
+            selected        = i;
+            selected_passes = passes;
+            selected_freed  = freed;
+            selected_cost   = cost;
+        }
+    }
+    AF_TRACE("{{Evaluating tree {} of {}, which passes the limits: {}}}",
+             selected, count, selected_passes);
+    return selected;
+}
+
+bool isNativeJitEnabled() {
+#if defined(OS_WIN)
+    return false;
+#else
+    return !getCompiler().empty();
+#endif
+}
+
+NativeKernel getNativeKernel(const vector<Node *> &output_nodes,
+                             const vector<int> &output_ids,
+                             const vector<Node *> &full_nodes,
+                             const vector<Node_ids> &full_ids,
+                             const bool is_linear) {
+    const string funcName =
+        getFuncName(output_nodes, full_nodes, full_ids, is_linear);
+
+    NativeKernel kernel = nullptr;
+    if (findNativeKernel(funcName, kernel)) { return kernel; }
+
+    return addNativeKernel(funcName, getKernelString(funcName, full_nodes,
+                                                     full_ids, output_ids,
+                                                     is_linear));
+}
+
+}  // namespace cpu
+
+namespace common {
+
+void warmupKernels(const vector<KernelManifestEntry> &entries) {
+    if (!cpu::isNativeJitEnabled()) { return; }
+
+    // Only the native JIT kernels are compiled at runtime by this backend
+    vector<const KernelManifestEntry *> kernels;
+    for (const auto &entry : entries) {
+        cpu::NativeKernel kernel = nullptr;
+        if (entry.isJIT && entry.sources.size() == 1 &&
+            !cpu::findNativeKernel(entry.name, kernel)) {
+            kernels.push_back(&entry);
+        }
+    }
+
+    cpu::getThreadPool().run(
+        static_cast<int>(kernels.size()), [&kernels](int i) {
+            cpu::addNativeKernel(kernels[i]->name, kernels[i]->sources[0]);
+        });
+}
+
+}  // namespace common
@@ -0,0 +1,77 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <common/jit/Node.hpp>
+#include <af/defines.h>
+
+#include <nonstd/span.hpp>
+#include <vector>
+
+namespace cpu {
+
+/// The signature of the kernels generated from JIT trees
+///
+/// \param[in] args     The values passed to the setArg function by
+///                     Node::setArgs, in the order of the nodes
+/// \param[in] outs     The buffers of the outputs
+/// \param[in] odims    The dimensions of the outputs
+/// \param[in] ostrides The strides of the outputs
+/// \param[in] begin    The first element (linear kernels) or row (general
+///                     kernels) to evaluate
+/// \param[in] end      One past the last element or row to evaluate
+using NativeKernel = void (*)(void *const *args, void *const *outs,
+                              const dim_t *odims, const dim_t *ostrides,
+                              dim_t begin, dim_t end);
+
+/// Returns true if JIT trees are compiled into native kernels. This is
+/// enabled by setting the AF_CPU_JIT_COMPILER environment variable.
+bool isNativeJitEnabled();
+
+/// Returns the native kernel that evaluates the tree described by
+/// \p full_nodes and \p full_ids
+///
+/// The kernel is generated and compiled the first time it is requested and
+/// is stored in the kernel cache directory so later runs only need to load
+/// it. All of the nodes must return true from Node::canGenerate.
+///
+/// \returns the kernel or nullptr if it could not be compiled or loaded. The
+///          tree must be evaluated by the interpreter in that case.
+NativeKernel getNativeKernel(const std::vector<common::Node *> &output_nodes,
+                             const std::vector<int> &output_ids,
+                             const std::vector<common::Node *> &full_nodes,
+                             const std::vector<common::Node_ids> &full_ids,
+                             const bool is_linear);
+
+/// Decides if the JIT trees of \p root_nodes need to be evaluated before a
+/// node of type \p type is added on top of them.
+///
+/// The decision is based on an estimate of the cost of evaluating the trees
+/// in one kernel: the memory the values of the nodes occupy while a chunk of
+/// elements is evaluated, the bytes read and written and the operations per
+/// element, and the memory held by the buffers when the memory pressure is
+/// high. Nodes shared between the trees and buffers that read the same data
+/// are counted once because they are evaluated and read once. The trees are
+/// only walked when the bound cached in the nodes exceeds a limit. The
+/// decisions that force an evaluation are logged to the jit logger.
+kJITHeuristics checkJitHeuristics(nonstd::span<common::Node *> root_nodes,
+                                  af::dtype type);
+
+/// Returns the index of the tree in \p root_nodes to evaluate when
+/// checkJitHeuristics decided that a node of type \p type cannot be added on
+/// top of them.
+///
+/// It is the cheapest evaluation, counting the values it writes and reads
+/// back and the work it repeats for nodes shared with the other trees, that
+/// brings the trees within the limits. If no single evaluation does, it is
+/// the one that frees the most memory while a chunk is evaluated.
+int selectJitEvalNode(nonstd::span<common::Node *> root_nodes, af::dtype type);
+
+}  // namespace cpu
@@ -15,6 +15,8 @@
 #include <optypes.hpp>
 
 #include <array>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace cpu {
@@ -58,8 +60,15 @@ class BinaryNode : public TNode<compute_t<To>> {
 
     void genKerName(std::string &kerString,
                     const common::Node_ids &ids) const final {
-        UNUSED(kerString);
-        UNUSED(ids);
+        kerString += '_';
+        kerString += this->getNameStr();
+        kerString += std::to_string(op);
+        kerString += ',';
+        kerString += std::to_string(ids.child_ids[0]);
+        kerString += ',';
+        kerString += std::to_string(ids.child_ids[1]);
+        kerString += ',';
+        kerString += std::to_string(ids.id);
     }
 
     void genParams(std::stringstream &kerStream, int id,
@@ -86,8 +95,13 @@ class BinaryNode : public TNode<compute_t<To>> {
 
     void genFuncs(std::stringstream &kerStream,
                   const common::Node_ids &ids) const final {
-        UNUSED(kerStream);
-        UNUSED(ids);
+        kerStream << this->getTypeStr() << " val" << ids.id << " = "
+                  << getOpName(op) << "(val" << ids.child_ids[0] << ", val"
+                  << ids.child_ids[1] << ");\n";
+    }
+
+    bool canGenerate() const final {
+        return getOpName(op) != nullptr && isGeneratedType(this->getType());
     }
 };
 
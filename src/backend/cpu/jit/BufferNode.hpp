@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <jit/kernel_generators.hpp>
 #include <optypes.hpp>
 #include <af/defines.h>
 #include "Node.hpp"
@@ -57,6 +58,12 @@ class BufferNode : public TNode<T> {
         }
     }
 
+    /// Returns the memory read by the node
+    const std::shared_ptr<T> &getData() const { return m_data; }
+
+    /// Returns true if the node reads its memory from the first element
+    bool startsAtData() const { return m_ptr == m_data.get(); }
+
     void setShape(af::dim4 new_shape) final {
         auto new_strides = calcStrides(new_shape);
         m_dims[0]        = new_shape[0];
@@ -106,38 +113,37 @@ class BufferNode : public TNode<T> {
 
     void genKerName(std::string &kerString,
                     const common::Node_ids &ids) const final {
-        UNUSED(kerString);
-        UNUSED(ids);
+        kerString += '_';
+        kerString += this->getNameStr();
+        kerString += ',';
+        kerString += std::to_string(ids.id);
     }
 
     void genParams(std::stringstream &kerStream, int id,
                    bool is_linear) const final {
-        UNUSED(kerStream);
-        UNUSED(id);
-        UNUSED(is_linear);
+        generateParamDeclaration(kerStream, id, is_linear,
+                                 this->getTypeStr());
     }
 
     int setArgs(int start_id, bool is_linear,
                 std::function<void(int id, const void *ptr, size_t arg_size)>
                     setArg) const override {
-        UNUSED(is_linear);
-        UNUSED(setArg);
-        return start_id++;
+        return setKernelArguments(start_id, is_linear, setArg, m_ptr, m_dims,
+                                  m_strides);
     }
 
     void genOffsets(std::stringstream &kerStream, int id,
                     bool is_linear) const final {
-        UNUSED(kerStream);
-        UNUSED(id);
-        UNUSED(is_linear);
+        generateBufferOffsets(kerStream, id, is_linear, this->getTypeStr());
     }
 
     void genFuncs(std::stringstream &kerStream,
                   const common::Node_ids &ids) const final {
-        UNUSED(kerStream);
-        UNUSED(ids);
+        generateBufferRead(kerStream, ids.id, this->getTypeStr());
     }
 
+    bool canGenerate() const final { return isGeneratedType(this->getType()); }
+
     bool isLinear(const dim_t *dims) const final {
         return m_linear_buffer && dims[0] == m_dims[0] &&
                dims[1] == m_dims[1] && dims[2] == m_dims[2] &&
@@ -175,6 +181,10 @@ class BufferNode : public TNode<T> {
         }
         return false;
     }
+
+    bool isSameOperation(const common::Node &other) const noexcept final {
+        return *this == other;
+    }
 };
 
 }  // namespace jit
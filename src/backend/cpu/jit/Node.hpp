@@ -32,6 +32,13 @@ constexpr int VECTOR_LENGTH = 256;
 template<typename T>
 using array = std::array<T, VECTOR_LENGTH>;
 
+/// Returns the name of the function that performs \p op in the generated
+/// kernels. Returns nullptr if the operation is not supported by them.
+const char *getOpName(af_op_t op);
+
+/// Returns true if the generated kernels support values of type \p type
+bool isGeneratedType(af::dtype type);
+
 }  // namespace jit
 
 template<typename T>
@@ -8,7 +8,11 @@
  ********************************************************/
 
 #pragma once
+#include <common/util.hpp>
 #include <optypes.hpp>
+#include <cstring>
+#include <sstream>
+#include <string>
 #include <vector>
 #include "Node.hpp"
 
@@ -25,40 +29,52 @@ class ScalarNode : public TNode<T> {
         return std::make_unique<ScalarNode>(*this);
     }
 
+    size_t getHash() const noexcept final {
+        return common::hashCombine(
+            common::Node::getHash(),
+            deterministicHash(&this->m_val[0], sizeof(compute_t<T>)));
+    }
+
+    /// Scalars are compared bit by bit, so 0 and -0 are different values
+    bool isSameOperation(const common::Node &other) const noexcept final {
+        const ScalarNode &scalar = static_cast<const ScalarNode &>(other);
+        return common::Node::isSameOperation(other) &&
+               std::memcmp(&this->m_val[0], &scalar.m_val[0],
+                           sizeof(compute_t<T>)) == 0;
+    }
+
     void genKerName(std::string &kerString,
                     const common::Node_ids &ids) const final {
-        UNUSED(kerString);
-        UNUSED(ids);
+        kerString += '_';
+        kerString += this->getTypeStr();
+        kerString += ',';
+        kerString += std::to_string(ids.id);
     }
 
     void genParams(std::stringstream &kerStream, int id,
                    bool is_linear) const final {
-        UNUSED(kerStream);
-        UNUSED(id);
         UNUSED(is_linear);
+        kerStream << "const " << this->getTypeStr() << " scalar" << id
+                  << " = readScalar<" << this->getTypeStr() << ">(arg);\n";
     }
 
     int setArgs(int start_id, bool is_linear,
                 std::function<void(int id, const void *ptr, size_t arg_size)>
                     setArg) const override {
         UNUSED(is_linear);
-        UNUSED(setArg);
-        return start_id++;
-    }
-
-    void genOffsets(std::stringstream &kerStream, int id,
-                    bool is_linear) const final {
-        UNUSED(kerStream);
-        UNUSED(id);
-        UNUSED(is_linear);
+        setArg(start_id, static_cast<const void *>(&this->m_val[0]),
+               sizeof(compute_t<T>));
+        return start_id + 1;
     }
 
     void genFuncs(std::stringstream &kerStream,
                   const common::Node_ids &ids) const final {
-        UNUSED(kerStream);
-        UNUSED(ids);
+        kerStream << this->getTypeStr() << " val" << ids.id << " = scalar"
+                  << ids.id << ";\n";
     }
 
+    bool canGenerate() const final { return isGeneratedType(this->getType()); }
+
     bool isScalar() const final { return true; }
 };
 }  // namespace jit
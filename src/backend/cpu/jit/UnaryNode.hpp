@@ -14,6 +14,8 @@
 #include "Node.hpp"
 
 #include <jit/BufferNode.hpp>
+#include <sstream>
+#include <string>
 #include <vector>
 
 namespace cpu {
@@ -58,14 +60,26 @@ class UnaryNode : public TNode<To> {
 
     void genKerName(std::string &kerString,
                     const common::Node_ids &ids) const final {
-        UNUSED(kerString);
-        UNUSED(ids);
+        kerString += '_';
+        kerString += this->getNameStr();
+        kerString += std::to_string(op);
+        kerString += ',';
+        kerString += std::to_string(ids.child_ids[0]);
+        kerString += ',';
+        kerString += std::to_string(ids.id);
     }
 
     void genFuncs(std::stringstream &kerStream,
                   const common::Node_ids &ids) const final {
-        UNUSED(kerStream);
-        UNUSED(ids);
+        kerStream << this->getTypeStr() << " val" << ids.id << " = "
+                  << getOpName(op);
+        // The result of a cast depends on the output type as well
+        if (op == af_cast_t) { kerStream << '<' << this->getTypeStr() << '>'; }
+        kerStream << "(val" << ids.child_ids[0] << ");\n";
+    }
+
+    bool canGenerate() const final {
+        return getOpName(op) != nullptr && isGeneratedType(this->getType());
     }
 };
 
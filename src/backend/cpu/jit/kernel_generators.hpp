@@ -0,0 +1,79 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <common/defines.hpp>
+#include <af/defines.h>
+
+#include <functional>
+#include <sstream>
+#include <string>
+
+namespace cpu {
+
+namespace {
+
+/// Creates the code that reads the parameter of a buffer from the argument
+/// list of the kernel
+void generateParamDeclaration(std::stringstream& kerStream, int id,
+                              bool is_linear, const std::string& m_type_str) {
+    if (is_linear) {
+        kerStream << "const " << m_type_str << " *in" << id
+                  << "_ptr = readPtr<" << m_type_str << ">(arg);\n";
+    } else {
+        kerStream << "const Param<" << m_type_str << "> in" << id
+                  << " = readParam<" << m_type_str << ">(arg);\n";
+    }
+}
+
+/// Calls the setArg function to set the arguments for a kernel call. The
+/// order of the arguments must match the reads generated by
+/// generateParamDeclaration
+template<typename T>
+int setKernelArguments(
+    int start_id, bool is_linear,
+    std::function<void(int id, const void* ptr, size_t arg_size)>& setArg,
+    T* const& ptr, const dim_t (&dims)[4], const dim_t (&strides)[4]) {
+    setArg(start_id++, static_cast<const void*>(&ptr), sizeof(T*));
+    if (!is_linear) {
+        setArg(start_id++, static_cast<const void*>(dims), sizeof(dims));
+        setArg(start_id++, static_cast<const void*>(strides), sizeof(strides));
+    }
+    return start_id;
+}
+
+/// Generates the code to calculate the offsets for a buffer
+void generateBufferOffsets(std::stringstream& kerStream, int id, bool is_linear,
+                           const std::string& type_str) {
+    std::string idx_str = std::string("dim_t idx") + std::to_string(id);
+
+    if (is_linear) {
+        kerStream << idx_str << " = idx;\n";
+    } else {
+        std::string info_str = std::string("in") + std::to_string(id);
+        kerStream << idx_str << " = (id3 < " << info_str << ".dims[3]) * "
+                  << info_str << ".strides[3] * id3 + (id2 < " << info_str
+                  << ".dims[2]) * " << info_str << ".strides[2] * id2 + (id1 < "
+                  << info_str << ".dims[1]) * " << info_str
+                  << ".strides[1] * id1 + (id0 < " << info_str
+                  << ".dims[0]) * id0;\n";
+        kerStream << "const " << type_str << " *in" << id << "_ptr = in" << id
+                  << ".ptr;\n";
+    }
+}
+
+/// Generates the code to read a buffer and store it in a local variable
+void generateBufferRead(std::stringstream& kerStream, int id,
+                        const std::string& type_str) {
+    kerStream << type_str << " val" << id << " = in" << id << "_ptr[idx" << id
+              << "];\n";
+}
+
+}  // namespace
+}  // namespace cpu
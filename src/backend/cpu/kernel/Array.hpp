@@ -9,197 +9,197 @@
 
 #pragma once
 #include <Param.hpp>
-#include <common/jit/ModdimNode.hpp>
 #include <common/jit/Node.hpp>
-#include <common/jit/NodeIterator.hpp>
+#include <err_cpu.hpp>
 #include <jit/BufferNode.hpp>
 #include <jit/Node.hpp>
 #include <jit/UnaryNode.hpp>
+#include <jit.hpp>
+#include <kernel/jit_tree.hpp>
 #include <platform.hpp>
+#include <thread_pool.hpp>
+#include <types.hpp>
+
+#include <algorithm>
 #include <vector>
 
 namespace cpu {
 namespace kernel {
 
-/// Clones node_index_map and update the child pointers
-std::vector<std::shared_ptr<common::Node>> cloneNodes(
-    const std::vector<common::Node *> &node_index_map,
-    const std::vector<common::Node_ids> &ids) {
-    using common::Node;
-    // find all moddims in the tree
-    std::vector<std::shared_ptr<Node>> node_clones;
-    node_clones.reserve(node_index_map.size());
-    transform(begin(node_index_map), end(node_index_map),
-              back_inserter(node_clones), [](Node *n) { return n->clone(); });
-
-    for (common::Node_ids id : ids) {
-        auto &children = node_clones[id.id]->m_children;
-        for (int i = 0; i < Node::kMaxChildren && children[i] != nullptr; i++) {
-            children[i] = node_clones[id.child_ids[i]];
-        }
-    }
-    return node_clones;
+/// Copies the first \p lim values computed by \p node to \p out + \p offset
+template<typename T>
+void writeValues(common::Node *node, void *out, dim_t offset, int lim) {
+    const auto &val = static_cast<TNode<T> *>(node)->m_val;
+    std::copy(val.begin(), val.begin() + lim, static_cast<T *>(out) + offset);
 }
 
-/// Sets the shape of the buffer node_index_map under the moddims node to the
-/// new shape
-void propagateModdimsShape(
-    std::vector<std::shared_ptr<common::Node>> &node_clones) {
-    using common::NodeIterator;
-    for (auto &node : node_clones) {
-        if (node->getOp() == af_moddims_t) {
-            common::ModdimNode *mn =
-                static_cast<common::ModdimNode *>(node.get());
-
-            NodeIterator<> it(node.get());
-            while (it != NodeIterator<>()) {
-                it = find_if(it, NodeIterator<>(), common::isBuffer);
-                if (it == NodeIterator<>()) { break; }
+using WriteValuesFn = void (*)(common::Node *, void *, dim_t, int);
+
+/// Returns the function that writes the values of a node of type \p type
+inline WriteValuesFn getWriteValues(af::dtype type) {
+    switch (type) {
+        case f32: return writeValues<float>;
+        case f64: return writeValues<double>;
+        case c32: return writeValues<cfloat>;
+        case c64: return writeValues<cdouble>;
+        case s32: return writeValues<int>;
+        case u32: return writeValues<uint>;
+        case u8: return writeValues<uchar>;
+        case b8: return writeValues<char>;
+        case s64: return writeValues<intl>;
+        case u64: return writeValues<uintl>;
+        case s16: return writeValues<short>;
+        case u16: return writeValues<ushort>;
+        case f16: return writeValues<common::half>;
+        default: TYPE_ERROR(0, type);
+    }
+}
 
-                it->setShape(mn->m_new_shape);
+/// Evaluates the elements [begin, end) of linear outputs
+void evalLinear(ClonedTree &tree, const std::vector<void *> &ptrs,
+                const std::vector<WriteValuesFn> &writes, dim_t begin,
+                dim_t end) {
+    int num_output_nodes = static_cast<int>(tree.outputs.size());
+    for (dim_t i = begin; i < end; i += jit::VECTOR_LENGTH) {
+        int lim =
+            static_cast<int>(std::min<dim_t>(jit::VECTOR_LENGTH, end - i));
+        for (auto &node : tree.nodes) { node->calc(static_cast<int>(i), lim); }
+        for (int n = 0; n < num_output_nodes; n++) {
+            writes[n](tree.outputs[n], ptrs[n], i, lim);
+        }
+    }
+}
 
-                ++it;
+/// Evaluates the rows [begin, end) of the outputs. A row is the set of
+/// elements along the first dimension for a given (y, z, w) coordinate.
+void evalRows(ClonedTree &tree, const std::vector<void *> &ptrs,
+              const std::vector<WriteValuesFn> &writes, const af::dim4 &odims,
+              const af::dim4 &ostrs, dim_t begin, dim_t end) {
+    int num_output_nodes = static_cast<int>(tree.outputs.size());
+    int dim0             = static_cast<int>(odims[0]);
+    for (dim_t row = begin; row < end; row++) {
+        int y = static_cast<int>(row % odims[1]);
+        int z = static_cast<int>((row / odims[1]) % odims[2]);
+        int w = static_cast<int>(row / (odims[1] * odims[2]));
+
+        dim_t offy = y * ostrs[1] + z * ostrs[2] + w * ostrs[3];
+        for (int x = 0; x < dim0; x += jit::VECTOR_LENGTH) {
+            int lim  = std::min(jit::VECTOR_LENGTH, dim0 - x);
+            dim_t id = x + offy;
+
+            for (auto &node : tree.nodes) { node->calc(x, y, z, w, lim); }
+            for (int n = 0; n < num_output_nodes; n++) {
+                writes[n](tree.outputs[n], ptrs[n], id, lim);
             }
         }
     }
 }
 
-/// Removes node_index_map whos operation matchs a unary operation \p op.
-void removeNodeOfOperation(
-    std::vector<std::shared_ptr<common::Node>> &node_index_map, af_op_t op) {
+/// Evaluates the tree using a native kernel generated from the nodes
+///
+/// \returns false if one of the nodes can not be generated or the kernel
+///          could not be compiled. The tree is not evaluated in that case.
+bool evalNative(ClonedTree &tree, const std::vector<void *> &ptrs,
+                const af::dim4 &odims, const af::dim4 &ostrs,
+                const bool is_linear) {
     using common::Node;
+    for (auto &node : tree.nodes) {
+        if (!node->canGenerate()) { return false; }
+    }
 
-    for (size_t nid = 0; nid < node_index_map.size(); nid++) {
-        auto &node = node_index_map[nid];
-
-        for (int i = 0;
-             i < Node::kMaxChildren && node->m_children[i] != nullptr; i++) {
-            if (node->m_children[i]->getOp() == op) {
-                // replace moddims
-                auto moddim_node    = node->m_children[i];
-                node->m_children[i] = moddim_node->m_children[0];
-            }
-        }
+    common::Node_map_t node_index_map;
+    std::vector<Node *> full_nodes;
+    std::vector<common::Node_ids> ids;
+    std::vector<int> output_ids;
+    for (Node *node : tree.outputs) {
+        output_ids.push_back(
+            node->getNodesMap(node_index_map, full_nodes, ids));
     }
 
-    node_index_map.erase(remove_if(begin(node_index_map), end(node_index_map),
-                                   [op](std::shared_ptr<Node> &node) {
-                                       return node->getOp() == op;
-                                   }),
-                         end(node_index_map));
-}
+    NativeKernel kernel = getNativeKernel(tree.outputs, output_ids,
+                                          full_nodes, ids, is_linear);
+    if (!kernel) { return false; }
 
-/// Returns the cloned output_nodes located in the node_clones array
-///
-/// This function returns the new cloned version of the output_nodes_ from
-/// the node_clones array. If the output node is a moddim node, then it will
-/// set the output node to be its first non-moddim node child
-template<typename T>
-std::vector<TNode<T> *> getClonedOutputNodes(
-    common::Node_map_t &node_index_map,
-    const std::vector<std::shared_ptr<common::Node>> &node_clones,
-    const std::vector<common::Node_ptr> &output_nodes_) {
-    std::vector<TNode<T> *> cloned_output_nodes;
-    cloned_output_nodes.reserve(output_nodes_.size());
-    for (auto &n : output_nodes_) {
-        TNode<T> *ptr;
-        if (n->getOp() == af_moddims_t) {
-            // if the output node is a moddims node, then set the output node
-            // to be the child of the moddims node. This is necessary because
-            // we remove the moddim node_index_map from the tree later
-            int child_index = node_index_map[n->m_children[0].get()];
-            ptr = static_cast<TNode<T> *>(node_clones[child_index].get());
-            while (ptr->getOp() == af_moddims_t) {
-                ptr = static_cast<TNode<T> *>(ptr->m_children[0].get());
-            }
-        } else {
-            int node_index = node_index_map[n.get()];
-            ptr = static_cast<TNode<T> *>(node_clones[node_index].get());
-        }
-        cloned_output_nodes.push_back(ptr);
+    std::vector<void *> args;
+    for (Node *node : full_nodes) {
+        node->setArgs(0, is_linear,
+                      [&](int /*id*/, const void *ptr, size_t /*size*/) {
+                          args.push_back(const_cast<void *>(ptr));
+                      });
+    }
+
+    auto evalRange = [&](dim_t begin, dim_t end) {
+        kernel(args.data(), ptrs.data(), odims.get(), ostrs.get(), begin, end);
+    };
+    if (is_linear) {
+        parallel_for(0, odims.elements(), kMinElementsPerTask, evalRange);
+    } else {
+        parallel_for(0, odims[1] * odims[2] * odims[3], grainFor(odims[0]),
+                     evalRange);
     }
-    return cloned_output_nodes;
+    return true;
 }
 
-template<typename T>
-void evalMultiple(std::vector<Param<T>> arrays,
+/// Evaluates the trees of \p output_nodes_ into \p ptrs with a single sweep
+/// over the elements. The outputs share the dimensions \p odims and the
+/// strides \p ostrs, but each one is written with the type of its node, so
+/// outputs of different types are computed from the nodes they share.
+void evalMultiple(std::vector<void *> ptrs, af::dim4 odims, af::dim4 ostrs,
                   std::vector<common::Node_ptr> output_nodes_) {
-    using common::ModdimNode;
     using common::Node;
     using common::Node_map_t;
-    using common::NodeIterator;
 
-    af::dim4 odims = arrays[0].dims();
-    af::dim4 ostrs = arrays[0].strides();
+    // Minimum number of elements evaluated by a thread. Must be a multiple of
+    // jit::VECTOR_LENGTH so every thread processes the same chunks as the
+    // serial evaluation would.
+    constexpr dim_t kMinElementsPerTask = 64 * jit::VECTOR_LENGTH;
 
     Node_map_t node_index_map;
-    std::vector<T *> ptrs;
     std::vector<common::Node *> full_nodes;
     std::vector<common::Node_ids> ids;
+    std::vector<WriteValuesFn> writes;
 
-    int narrays = static_cast<int>(arrays.size());
-    ptrs.reserve(narrays);
-    for (int i = 0; i < narrays; i++) {
-        ptrs.push_back(arrays[i].get());
-        output_nodes_[i]->getNodesMap(node_index_map, full_nodes, ids);
+    writes.reserve(output_nodes_.size());
+    for (auto &node : output_nodes_) {
+        node->getNodesMap(node_index_map, full_nodes, ids);
+        writes.push_back(getWriteValues(node->getType()));
     }
-    auto node_clones = cloneNodes(full_nodes, ids);
 
-    std::vector<TNode<T> *> cloned_output_nodes =
-        getClonedOutputNodes<T>(node_index_map, node_clones, output_nodes_);
-    propagateModdimsShape(node_clones);
-    removeNodeOfOperation(node_clones, af_moddims_t);
+    // The first clone is used to check the layout of the buffers and is then
+    // reused by the task that starts at the first element or row
+    ClonedTree first_tree =
+        cloneTree(node_index_map, full_nodes, ids, output_nodes_);
 
     bool is_linear = true;
-    for (auto &node : node_clones) { is_linear &= node->isLinear(odims.get()); }
+    for (auto &node : first_tree.nodes) {
+        is_linear &= node->isLinear(odims.get());
+    }
+
+    if (isNativeJitEnabled() &&
+        evalNative(first_tree, ptrs, odims, ostrs, is_linear)) {
+        return;
+    }
+
+    auto treeForTask = [&](dim_t begin) {
+        return begin == 0 ? std::move(first_tree)
+                          : cloneTree(node_index_map, full_nodes, ids,
+                                      output_nodes_);
+    };
 
-    int num_nodes        = node_clones.size();
-    int num_output_nodes = cloned_output_nodes.size();
     if (is_linear) {
-        int num = arrays[0].dims().elements();
-        int cnum =
-            jit::VECTOR_LENGTH * std::ceil(double(num) / jit::VECTOR_LENGTH);
-        for (int i = 0; i < cnum; i += jit::VECTOR_LENGTH) {
-            int lim = std::min(jit::VECTOR_LENGTH, num - i);
-            for (int n = 0; n < num_nodes; n++) {
-                node_clones[n]->calc(i, lim);
-            }
-            for (int n = 0; n < num_output_nodes; n++) {
-                std::copy(cloned_output_nodes[n]->m_val.begin(),
-                          cloned_output_nodes[n]->m_val.begin() + lim,
-                          ptrs[n] + i);
-            }
-        }
+        parallel_for(0, odims.elements(), kMinElementsPerTask,
+                     [&](dim_t begin, dim_t end) {
+                         ClonedTree tree = treeForTask(begin);
+                         evalLinear(tree, ptrs, writes, begin, end);
+                     });
     } else {
-        for (int w = 0; w < (int)odims[3]; w++) {
-            dim_t offw = w * ostrs[3];
-
-            for (int z = 0; z < (int)odims[2]; z++) {
-                dim_t offz = z * ostrs[2] + offw;
-
-                for (int y = 0; y < (int)odims[1]; y++) {
-                    dim_t offy = y * ostrs[1] + offz;
-
-                    int dim0  = odims[0];
-                    int cdim0 = jit::VECTOR_LENGTH *
-                                std::ceil(double(dim0) / jit::VECTOR_LENGTH);
-                    for (int x = 0; x < (int)cdim0; x += jit::VECTOR_LENGTH) {
-                        int lim  = std::min(jit::VECTOR_LENGTH, dim0 - x);
-                        dim_t id = x + offy;
-
-                        for (int n = 0; n < num_nodes; n++) {
-                            node_clones[n]->calc(x, y, z, w, lim);
-                        }
-                        for (int n = 0; n < num_output_nodes; n++) {
-                            std::copy(
-                                cloned_output_nodes[n]->m_val.begin(),
-                                cloned_output_nodes[n]->m_val.begin() + lim,
-                                ptrs[n] + id);
-                        }
-                    }
-                }
-            }
-        }
+        dim_t nrows      = odims[1] * odims[2] * odims[3];
+        dim_t rows_grain = std::max<dim_t>(
+            1, kMinElementsPerTask / std::max<dim_t>(odims[0], 1));
+        parallel_for(0, nrows, rows_grain, [&](dim_t begin, dim_t end) {
+            ClonedTree tree = treeForTask(begin);
+            evalRows(tree, ptrs, writes, odims, ostrs, begin, end);
+        });
     }
 }
 
@@ -10,12 +10,50 @@
 #pragma once
 #include <Param.hpp>
 #include <math.hpp>
+#include <thread_pool.hpp>
 #include <utility.hpp>
+#include <algorithm>
 #include <cmath>
+#include <limits>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
 
+/// The Gaussian weight of a difference in intensity. exp is sampled once per
+/// call and the weights are interpolated linearly between the samples.
+/// Differences larger than kMaxSigmas standard deviations get no weight.
+/// A sigma too small for the scale to be represented in T only gives weight
+/// to equal intensities.
+template<typename T>
+class RangeKernel {
+    static constexpr int kSamples  = 4096;
+    static constexpr T kMaxSigmas = 6;
+
+    std::vector<T> table;
+    T scale;
+    bool exact;
+
+   public:
+    explicit RangeKernel(float sigma) : table(kSamples + 1) {
+        const double s = kSamples / (kMaxSigmas * double(sigma));
+        exact          = !(sigma > 0 && s <= std::numeric_limits<T>::max());
+        scale          = exact ? T(0) : static_cast<T>(s);
+        for (int k = 0; k <= kSamples; ++k) {
+            const T x = k * kMaxSigmas / kSamples;
+            table[k]  = std::exp(-x * x / 2);
+        }
+    }
+
+    T operator()(T diff) const {
+        if (exact) { return T(diff == 0); }
+        const T x = std::abs(diff) * scale;
+        if (!(x < kSamples)) { return T(0); }
+        const int k = static_cast<int>(x);
+        return table[k] + (x - k) * (table[k + 1] - table[k]);
+    }
+};
+
 template<typename OutT, typename InT>
 void bilateral(Param<OutT> out, CParam<InT> in, float const s_sigma,
                float const c_sigma) {
@@ -28,55 +66,243 @@ void bilateral(Param<OutT> out, CParam<InT> in, float const s_sigma,
     float color_       = std::max(c_sigma, 0.f);
     dim_t const radius = std::max((dim_t)(space_ * 1.5f), (dim_t)1);
     float const svar   = space_ * space_;
-    float const cvar   = color_ * color_;
-
-    for (dim_t b3 = 0; b3 < dims[3]; ++b3) {
-        OutT *outData     = out.get() + b3 * ostrides[3];
-        InT const *inData = in.get() + b3 * istrides[3];
-
-        // b3 for loop handles following batch configurations
-        //  - gfor
-        //  - input based batch
-        //      - when input is 4d array for color images
-        for (dim_t b2 = 0; b2 < dims[2]; ++b2) {
-            // b2 for loop handles following batch configurations
-            //  - channels
-            //  - input based batch
-            //      - when input is 3d array for grayscale images
-            for (dim_t j = 0; j < dims[1]; ++j) {
-                // j steps along 2nd dimension
-                for (dim_t i = 0; i < dims[0]; ++i) {
-                    // i steps along 1st dimension
-                    OutT norm         = 0.0;
-                    OutT res          = 0.0;
-                    OutT const center = (OutT)inData[getIdx(istrides, i, j)];
-                    for (dim_t wj = -radius; wj <= radius; ++wj) {
-                        // clamps offsets
-                        dim_t tj = clamp(j + wj, dim_t(0), dims[1] - 1);
-                        for (dim_t wi = -radius; wi <= radius; ++wi) {
-                            // clamps offsets
-                            dim_t ti = clamp(i + wi, dim_t(0), dims[0] - 1);
-                            // proceed
-                            OutT const val =
-                                (OutT)inData[getIdx(istrides, ti, tj)];
-                            OutT const gauss_space =
-                                (wi * wi + wj * wj) / (-2.0 * svar);
-                            OutT const gauss_range =
-                                ((center - val) * (center - val)) /
-                                (-2.0 * cvar);
-                            OutT const weight =
-                                std::exp(gauss_space + gauss_range);
-                            norm += weight;
-                            res += val * weight;
-                        }
-                    }  // filter loop ends here
+    dim_t const wlen   = 2 * radius + 1;
+
+    // The spatial weights of the window and the clamped positions of the
+    // padded rows and columns are the same for every pixel
+    std::vector<OutT> space(wlen * wlen);
+    for (dim_t wj = -radius; wj <= radius; ++wj) {
+        for (dim_t wi = -radius; wi <= radius; ++wi) {
+            OutT const dist2 = wi * wi + wj * wj;
+            space[(wj + radius) * wlen + wi + radius] =
+                svar > 0 ? std::exp(dist2 / (-2.0 * svar))
+                         : OutT(dist2 == 0);
+        }
+    }
+    std::vector<dim_t> rows(dims[0] + 2 * radius);
+    std::vector<dim_t> cols(dims[1] + 2 * radius);
+    for (dim_t p = 0; p < (dim_t)rows.size(); ++p) {
+        rows[p] = clamp(p - radius, dim_t(0), dims[0] - 1) * istrides[0];
+    }
+    for (dim_t p = 0; p < (dim_t)cols.size(); ++p) {
+        cols[p] = clamp(p - radius, dim_t(0), dims[1] - 1) * istrides[1];
+    }
+    RangeKernel<OutT> const range(color_);
 
-                    outData[getIdx(ostrides, i, j)] = res / norm;
-                }  // 1st dimension loop ends here
-            }      // 2nd dimension loop ends here
-            outData += ostrides[2];
-            inData += istrides[2];
+    // Every column of every channel and batch is filtered independently
+    dim_t const ncols = dims[1] * dims[2] * dims[3];
+    parallel_for(0, ncols, grainFor(dims[0] * wlen * wlen), [&](dim_t begin,
+                                                                dim_t end) {
+        for (dim_t c = begin; c < end; ++c) {
+            dim_t const j  = c % dims[1];
+            dim_t const b2 = (c / dims[1]) % dims[2];
+            dim_t const b3 = c / (dims[1] * dims[2]);
+
+            InT const *inData = in.get() + b2 * istrides[2] + b3 * istrides[3];
+            OutT *outData = out.get() + j * ostrides[1] + b2 * ostrides[2] +
+                            b3 * ostrides[3];
+
+            for (dim_t i = 0; i < dims[0]; ++i) {
+                OutT norm         = 0.0;
+                OutT res          = 0.0;
+                OutT const center =
+                    (OutT)inData[rows[i + radius] + cols[j + radius]];
+                for (dim_t wj = 0; wj < wlen; ++wj) {
+                    InT const *col   = inData + cols[j + wj];
+                    OutT const *sRow = space.data() + wj * wlen;
+                    for (dim_t wi = 0; wi < wlen; ++wi) {
+                        OutT const val    = (OutT)col[rows[i + wi]];
+                        OutT const weight = sRow[wi] * range(center - val);
+                        norm += weight;
+                        res += val * weight;
+                    }
+                }
+                outData[i * ostrides[0]] = res / norm;
+            }
         }
+    });
+}
+
+/// Blurs the cells [pad, dims - pad) of a grid along the axis with \p stride
+/// with the binomial filter [1 4 6 4 1] / 16, whose variance is one cell.
+/// The cells within pad = 2 of the edges are zero.
+template<typename T>
+void blurGrid(T *dst, T const *src, af::dim4 const &gdims, dim_t stride) {
+    dim_t const pad = 2;
+    dim_t const gz  = gdims[0];
+    dim_t const gx  = gdims[1];
+    dim_t const gy  = gdims[2];
+
+    parallel_for(pad, gy - pad, grainFor(gx * gz), [&](dim_t begin,
+                                                       dim_t end) {
+        for (dim_t y = begin; y < end; ++y) {
+            for (dim_t x = pad; x < gx - pad; ++x) {
+                T const *s = src + (y * gx + x) * gz;
+                T *d       = dst + (y * gx + x) * gz;
+                for (dim_t z = pad; z < gz - pad; ++z) {
+                    d[z] = (s[z - 2 * stride] + s[z + 2 * stride] +
+                            4 * (s[z - stride] + s[z + stride]) + 6 * s[z]) /
+                           16;
+                }
+            }
+        }
+    });
+}
+
+/// Approximates the bilateral filter on a bilateral grid (Paris and Durand).
+///
+/// Every image is downsampled into a 3D grid whose cells are s_sigma pixels
+/// wide and c_sigma intensities deep. The pixels are splatted into the grid,
+/// the grid is blurred with a Gaussian of one cell along each axis and the
+/// result is interpolated back at every pixel. The cost grows with the number
+/// of pixels and cells and does not depend on the size of the window.
+///
+/// The exact filter is used when the grid would cost more than the window,
+/// which happens for small spatial or chromatic sigmas.
+template<typename OutT, typename InT>
+void bilateralGrid(Param<OutT> out, CParam<InT> in, float const s_sigma,
+                   float const c_sigma) {
+    af::dim4 const dims     = in.dims();
+    af::dim4 const istrides = in.strides();
+    af::dim4 const ostrides = out.strides();
+    dim_t const pad         = 2;
+    dim_t const npixels     = dims[0] * dims[1];
+    dim_t const nimages     = dims[2] * dims[3];
+    if (npixels == 0 || nimages == 0) { return; }
+
+    auto image = [&](dim_t b) {
+        return in.get() + (b % dims[2]) * istrides[2] +
+               (b / dims[2]) * istrides[3];
+    };
+
+    OutT vmin = std::numeric_limits<OutT>::max();
+    OutT vmax = std::numeric_limits<OutT>::lowest();
+    for (dim_t b = 0; b < nimages; ++b) {
+        InT const *inData = image(b);
+        for (dim_t j = 0; j < dims[1]; ++j) {
+            for (dim_t i = 0; i < dims[0]; ++i) {
+                OutT const v = (OutT)inData[i * istrides[0] + j * istrides[1]];
+                vmin         = std::min(vmin, v);
+                vmax         = std::max(vmax, v);
+            }
+        }
+    }
+
+    // Compare the work per image of both filters
+    float const space_    = std::min(11.5f, std::max(s_sigma, 0.f));
+    dim_t const radius    = std::max((dim_t)(space_ * 1.5f), (dim_t)1);
+    double const taps     = double(2 * radius + 1) * (2 * radius + 1);
+    double const gridSize = (std::floor((dims[0] - 1) / s_sigma) + 2 + 2 * pad) *
+                            (std::floor((dims[1] - 1) / s_sigma) + 2 + 2 * pad) *
+                            (std::floor((vmax - vmin) / c_sigma) + 2 + 2 * pad);
+    if (!(s_sigma > 0 && c_sigma > 0) || !std::isfinite(vmax - vmin) ||
+        !(gridSize * 30 + npixels * 32 < npixels * taps * 3)) {
+        bilateral<OutT, InT>(out, in, s_sigma, c_sigma);
+        return;
+    }
+
+    // The grid is stored with the intensity along the first dimension
+    af::dim4 const gdims(
+        static_cast<dim_t>((vmax - vmin) / c_sigma) + 2 + 2 * pad,
+        static_cast<dim_t>((dims[0] - 1) / s_sigma) + 2 + 2 * pad,
+        static_cast<dim_t>((dims[1] - 1) / s_sigma) + 2 + 2 * pad, 1);
+    dim_t const gz = gdims[0], gx = gdims[1];
+    OutT const invS = OutT(1) / s_sigma;
+    OutT const invC = OutT(1) / c_sigma;
+
+    // The weighted intensities and the weights, and a copy of each for the
+    // blur
+    std::vector<OutT> values(gdims.elements()), weights(gdims.elements());
+    std::vector<OutT> tmpValues(gdims.elements()), tmpWeights(gdims.elements());
+
+    // Two chunks of columns two chunks apart never touch the same cells, so
+    // the even chunks and then the odd ones are splatted in parallel
+    dim_t const chunk = std::max<dim_t>(grainFor(dims[0]),
+                                        2 * static_cast<dim_t>(s_sigma) + 2);
+    dim_t const nchunks = (dims[1] + chunk - 1) / chunk;
+
+    for (dim_t b = 0; b < nimages; ++b) {
+        InT const *inData = image(b);
+        OutT *outData     = out.get() + (b % dims[2]) * ostrides[2] +
+                        (b / dims[2]) * ostrides[3];
+
+        // The cell below the position of pixel (i, j) and the offsets of the
+        // position from that cell
+        auto locate = [&](dim_t i, dim_t j, OutT v, dim_t &cell, OutT &fx,
+                          OutT &fy, OutT &fz) {
+            OutT const x = i * invS + pad;
+            OutT const y = j * invS + pad;
+            OutT const z = (v - vmin) * invC + pad;
+            dim_t const ix = static_cast<dim_t>(x);
+            dim_t const iy = static_cast<dim_t>(y);
+            dim_t const iz = static_cast<dim_t>(z);
+            fx             = x - ix;
+            fy             = y - iy;
+            fz             = z - iz;
+            cell           = (iy * gx + ix) * gz + iz;
+        };
+
+        std::fill(values.begin(), values.end(), OutT(0));
+        std::fill(weights.begin(), weights.end(), OutT(0));
+        for (dim_t parity = 0; parity < 2; ++parity) {
+            parallel_for(0, (nchunks + 1 - parity) / 2, 1, [&](dim_t begin,
+                                                               dim_t end) {
+                for (dim_t k = begin; k < end; ++k) {
+                    dim_t const jb = (2 * k + parity) * chunk;
+                    dim_t const je = std::min(jb + chunk, dims[1]);
+                    for (dim_t j = jb; j < je; ++j) {
+                        for (dim_t i = 0; i < dims[0]; ++i) {
+                            OutT const v = (OutT)
+                                inData[i * istrides[0] + j * istrides[1]];
+                            dim_t cell;
+                            OutT fx, fy, fz;
+                            locate(i, j, v, cell, fx, fy, fz);
+                            for (int c = 0; c < 8; ++c) {
+                                OutT const w = ((c & 1) ? fz : 1 - fz) *
+                                               ((c & 2) ? fx : 1 - fx) *
+                                               ((c & 4) ? fy : 1 - fy);
+                                dim_t const n = cell + (c & 1) +
+                                                ((c & 2) ? gz : 0) +
+                                                ((c & 4) ? gx * gz : 0);
+                                values[n] += w * v;
+                                weights[n] += w;
+                            }
+                        }
+                    }
+                }
+            });
+        }
+
+        blurGrid(tmpValues.data(), values.data(), gdims, gz);
+        blurGrid(tmpWeights.data(), weights.data(), gdims, gz);
+        blurGrid(values.data(), tmpValues.data(), gdims, gx * gz);
+        blurGrid(weights.data(), tmpWeights.data(), gdims, gx * gz);
+        blurGrid(tmpValues.data(), values.data(), gdims, 1);
+        blurGrid(tmpWeights.data(), weights.data(), gdims, 1);
+
+        parallel_for(0, dims[1], grainFor(dims[0] * 16), [&](dim_t begin,
+                                                             dim_t end) {
+            for (dim_t j = begin; j < end; ++j) {
+                for (dim_t i = 0; i < dims[0]; ++i) {
+                    OutT const v =
+                        (OutT)inData[i * istrides[0] + j * istrides[1]];
+                    dim_t cell;
+                    OutT fx, fy, fz;
+                    locate(i, j, v, cell, fx, fy, fz);
+                    OutT res = 0, norm = 0;
+                    for (int c = 0; c < 8; ++c) {
+                        OutT const w = ((c & 1) ? fz : 1 - fz) *
+                                       ((c & 2) ? fx : 1 - fx) *
+                                       ((c & 4) ? fy : 1 - fy);
+                        dim_t const n = cell + (c & 1) + ((c & 2) ? gz : 0) +
+                                        ((c & 4) ? gx * gz : 0);
+                        res += w * tmpValues[n];
+                        norm += w * tmpWeights[n];
+                    }
+                    outData[i * ostrides[0] + j * ostrides[1]] = res / norm;
+                }
+            }
+        });
     }
 }
 
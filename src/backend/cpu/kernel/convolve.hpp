@@ -10,6 +10,7 @@
 #pragma once
 #include <Param.hpp>
 #include <math.hpp>
+#include <thread_pool.hpp>
 #include <af/defines.h>
 
 namespace cpu {
@@ -46,31 +47,35 @@ void one2one_2d(InT *optr, InT const *const iptr, AccT const *const fptr,
     dim_t iStart = (expand ? 0 : fDims[0] / 2);
     dim_t iEnd   = (expand ? oDims[0] : iStart + sDims[0]);
 
-    for (dim_t j = jStart; j < jEnd; ++j) {
-        dim_t joff = (j - jStart) * oStrides[1];
-
-        for (dim_t i = iStart; i < iEnd; ++i) {
-            AccT accum = AccT(0);
-            for (dim_t wj = 0; wj < fDims[1]; ++wj) {
-                dim_t jIdx    = j - wj;
-                dim_t w_joff  = wj * fStrides[1];
-                dim_t s_joff  = jIdx * sStrides[1];
-                bool isJValid = (jIdx >= 0 && jIdx < sDims[1]);
+    dim_t work = (iEnd - iStart) * fDims[0] * fDims[1];
+    parallel_for(jStart, jEnd, grainFor(work), [&](dim_t begin, dim_t end) {
+        for (dim_t j = begin; j < end; ++j) {
+            dim_t joff = (j - jStart) * oStrides[1];
 
-                for (dim_t wi = 0; wi < fDims[0]; ++wi) {
-                    dim_t iIdx = i - wi;
+            for (dim_t i = iStart; i < iEnd; ++i) {
+                AccT accum = AccT(0);
+                for (dim_t wj = 0; wj < fDims[1]; ++wj) {
+                    dim_t jIdx    = j - wj;
+                    dim_t w_joff  = wj * fStrides[1];
+                    dim_t s_joff  = jIdx * sStrides[1];
+                    bool isJValid = (jIdx >= 0 && jIdx < sDims[1]);
+
+                    for (dim_t wi = 0; wi < fDims[0]; ++wi) {
+                        dim_t iIdx = i - wi;
+
+                        InT s_val = InT(0);
+                        if (isJValid && (iIdx >= 0 && iIdx < sDims[0])) {
+                            s_val = iptr[s_joff + iIdx * sStrides[0]];
+                        }
 
-                    InT s_val = InT(0);
-                    if (isJValid && (iIdx >= 0 && iIdx < sDims[0])) {
-                        s_val = iptr[s_joff + iIdx * sStrides[0]];
+                        accum +=
+                            AccT(s_val * fptr[w_joff + wi * fStrides[0]]);
                     }
-
-                    accum += AccT(s_val * fptr[w_joff + wi * fStrides[0]]);
                 }
+                optr[joff + i - iStart] = InT(accum);
             }
-            optr[joff + i - iStart] = InT(accum);
         }
-    }
+    });
 }
 
 template<typename InT, typename AccT>
@@ -178,35 +183,41 @@ void convolve_nd(Param<InT> out, CParam<InT> signal, CParam<AccT> filter,
         }
     }
 
-    for (dim_t b3 = 0; b3 < batch[3]; ++b3) {
-        for (dim_t b2 = 0; b2 < batch[2]; ++b2) {
-            for (dim_t b1 = 0; b1 < batch[1]; ++b1) {
-                InT *out = optr + b1 * out_step[1] + b2 * out_step[2] +
-                           b3 * out_step[3];
-                InT const *in =
-                    iptr + b1 * in_step[1] + b2 * in_step[2] + b3 * in_step[3];
-                AccT const *filt = fptr + b1 * filt_step[1] +
-                                   b2 * filt_step[2] + b3 * filt_step[3];
-
-                switch (rank) {
-                    case 1:
-                        one2one_1d<InT, AccT>(out, in, filt, oDims, sDims,
-                                              fDims, sStrides, expand);
-                        break;
-                    case 2:
-                        one2one_2d<InT, AccT>(out, in, filt, oDims, sDims,
-                                              fDims, oStrides, sStrides,
-                                              fStrides, expand);
-                        break;
-                    case 3:
-                        one2one_3d<InT, AccT>(out, in, filt, oDims, sDims,
-                                              fDims, oStrides, sStrides,
-                                              fStrides, expand);
-                        break;
-                }
+    dim_t work = fDims.elements();
+    for (int i = 0; i < rank; ++i) { work *= oDims[i]; }
+
+    dim_t nbatches = batch[1] * batch[2] * batch[3];
+    parallel_for(0, nbatches, grainFor(work), [&](dim_t begin, dim_t end) {
+        for (dim_t b = begin; b < end; ++b) {
+            dim_t b1 = b % batch[1];
+            dim_t b2 = (b / batch[1]) % batch[2];
+            dim_t b3 = b / (batch[1] * batch[2]);
+
+            InT *out = optr + b1 * out_step[1] + b2 * out_step[2] +
+                       b3 * out_step[3];
+            InT const *in =
+                iptr + b1 * in_step[1] + b2 * in_step[2] + b3 * in_step[3];
+            AccT const *filt = fptr + b1 * filt_step[1] + b2 * filt_step[2] +
+                               b3 * filt_step[3];
+
+            switch (rank) {
+                case 1:
+                    one2one_1d<InT, AccT>(out, in, filt, oDims, sDims, fDims,
+                                          sStrides, expand);
+                    break;
+                case 2:
+                    one2one_2d<InT, AccT>(out, in, filt, oDims, sDims, fDims,
+                                          oStrides, sStrides, fStrides,
+                                          expand);
+                    break;
+                case 3:
+                    one2one_3d<InT, AccT>(out, in, filt, oDims, sDims, fDims,
+                                          oStrides, sStrides, fStrides,
+                                          expand);
+                    break;
             }
         }
-    }
+    });
 }
 
 template<typename InT, typename AccT, bool Expand, int ConvDim>
@@ -266,25 +277,27 @@ void convolve2(Param<InT> out, CParam<InT> signal, CParam<AccT> c_filter,
     auto sStrides = signal.strides();
     auto tStrides = temp.strides();
 
-    for (dim_t b3 = 0; b3 < oDims[3]; ++b3) {
-        dim_t i_b3Off = b3 * sStrides[3];
-        dim_t t_b3Off = b3 * tStrides[3];
-        dim_t o_b3Off = b3 * oStrides[3];
-
-        for (dim_t b2 = 0; b2 < oDims[2]; ++b2) {
-            InT const *const iptr = signal.get() + b2 * sStrides[2] + i_b3Off;
-            InT *tptr             = temp.get() + b2 * tStrides[2] + t_b3Off;
-            InT *optr             = out.get() + b2 * oStrides[2] + o_b3Off;
-
-            convolve2_separable<InT, AccT, Expand, 0>(
-                tptr, iptr, c_filter.get(), temp.dims(), sDims, sDims, cflen,
-                tStrides, sStrides, c_filter.strides(0));
-
-            convolve2_separable<InT, AccT, Expand, 1>(
-                optr, tptr, r_filter.get(), oDims, temp.dims(), sDims, rflen,
-                oStrides, tStrides, r_filter.strides(0));
-        }
-    }
+    dim_t work = (cflen + rflen) * oDims[0] * oDims[1];
+    parallel_for(
+        0, oDims[2] * oDims[3], grainFor(work), [&](dim_t begin, dim_t end) {
+            for (dim_t b = begin; b < end; ++b) {
+                dim_t b2 = b % oDims[2];
+                dim_t b3 = b / oDims[2];
+
+                InT const *const iptr =
+                    signal.get() + b2 * sStrides[2] + b3 * sStrides[3];
+                InT *tptr = temp.get() + b2 * tStrides[2] + b3 * tStrides[3];
+                InT *optr = out.get() + b2 * oStrides[2] + b3 * oStrides[3];
+
+                convolve2_separable<InT, AccT, Expand, 0>(
+                    tptr, iptr, c_filter.get(), temp.dims(), sDims, sDims,
+                    cflen, tStrides, sStrides, c_filter.strides(0));
+
+                convolve2_separable<InT, AccT, Expand, 1>(
+                    optr, tptr, r_filter.get(), oDims, temp.dims(), sDims,
+                    rflen, oStrides, tStrides, r_filter.strides(0));
+            }
+        });
 }
 
 }  // namespace kernel
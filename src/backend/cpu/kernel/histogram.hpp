@@ -9,6 +9,7 @@
 
 #pragma once
 #include <Param.hpp>
+#include <thread_pool.hpp>
 #include <types.hpp>
 
 namespace cpu {
@@ -25,24 +26,28 @@ void histogram(Param<uint> out, CParam<T> in, const unsigned nbins,
     dim_t const nElems  = inDims[0] * inDims[1];
 
     auto minValT = compute_t<T>(minval);
-    for (dim_t b3 = 0; b3 < outDims[3]; b3++) {
-        uint* outData   = out.get() + b3 * oStrides[3];
-        const T* inData = in.get() + b3 * iStrides[3];
-        for (dim_t b2 = 0; b2 < outDims[2]; b2++) {
-            for (dim_t i = 0; i < nElems; i++) {
-                int idx =
-                    IsLinear
-                        ? i
-                        : ((i % inDims[0]) + (i / inDims[0]) * iStrides[1]);
-                int bin = (int)((compute_t<T>(inData[idx]) - minValT) / step);
-                bin     = std::max(bin, 0);
-                bin     = std::min(bin, (int)(nbins - 1));
-                outData[bin]++;
+    parallel_for(
+        0, outDims[2] * outDims[3], grainFor(nElems),
+        [&](dim_t begin, dim_t end) {
+            for (dim_t batch = begin; batch < end; batch++) {
+                dim_t b2 = batch % outDims[2];
+                dim_t b3 = batch / outDims[2];
+                uint* outData =
+                    out.get() + b3 * oStrides[3] + b2 * oStrides[2];
+                const T* inData =
+                    in.get() + b3 * iStrides[3] + b2 * iStrides[2];
+                for (dim_t i = 0; i < nElems; i++) {
+                    int idx = IsLinear ? i
+                                       : ((i % inDims[0]) +
+                                          (i / inDims[0]) * iStrides[1]);
+                    int bin =
+                        (int)((compute_t<T>(inData[idx]) - minValT) / step);
+                    bin = std::max(bin, 0);
+                    bin = std::min(bin, (int)(nbins - 1));
+                    outData[bin]++;
+                }
             }
-            inData += iStrides[2];
-            outData += oStrides[2];
-        }
-    }
+        });
 }
 
 }  // namespace kernel
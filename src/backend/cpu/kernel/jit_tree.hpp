@@ -0,0 +1,172 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <common/jit/ModdimNode.hpp>
+#include <common/jit/Node.hpp>
+#include <common/jit/NodeIterator.hpp>
+#include <jit/Node.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// Clones node_index_map and update the child pointers
+inline std::vector<std::shared_ptr<common::Node>> cloneNodes(
+    const std::vector<common::Node *> &node_index_map,
+    const std::vector<common::Node_ids> &ids) {
+    using common::Node;
+    // find all moddims in the tree
+    std::vector<std::shared_ptr<Node>> node_clones;
+    node_clones.reserve(node_index_map.size());
+    transform(begin(node_index_map), end(node_index_map),
+              back_inserter(node_clones), [](Node *n) { return n->clone(); });
+
+    for (common::Node_ids id : ids) {
+        auto &children = node_clones[id.id]->m_children;
+        for (int i = 0; i < Node::kMaxChildren && children[i] != nullptr; i++) {
+            children[i] = node_clones[id.child_ids[i]];
+        }
+    }
+    return node_clones;
+}
+
+/// Sets the shape of the buffer node_index_map under the moddims node to the
+/// new shape
+inline void propagateModdimsShape(
+    std::vector<std::shared_ptr<common::Node>> &node_clones) {
+    using common::NodeIterator;
+    for (auto &node : node_clones) {
+        if (node->getOp() == af_moddims_t) {
+            common::ModdimNode *mn =
+                static_cast<common::ModdimNode *>(node.get());
+
+            NodeIterator<> it(node.get());
+            while (it != NodeIterator<>()) {
+                it = find_if(it, NodeIterator<>(), common::isBuffer);
+                if (it == NodeIterator<>()) { break; }
+
+                it->setShape(mn->m_new_shape);
+
+                ++it;
+            }
+        }
+    }
+}
+
+/// Removes node_index_map whos operation matchs a unary operation \p op.
+inline void removeNodeOfOperation(
+    std::vector<std::shared_ptr<common::Node>> &node_index_map, af_op_t op) {
+    using common::Node;
+
+    for (size_t nid = 0; nid < node_index_map.size(); nid++) {
+        auto &node = node_index_map[nid];
+
+        for (int i = 0;
+             i < Node::kMaxChildren && node->m_children[i] != nullptr; i++) {
+            if (node->m_children[i]->getOp() == op) {
+                // replace moddims
+                auto moddim_node    = node->m_children[i];
+                node->m_children[i] = moddim_node->m_children[0];
+            }
+        }
+    }
+
+    node_index_map.erase(remove_if(begin(node_index_map), end(node_index_map),
+                                   [op](std::shared_ptr<Node> &node) {
+                                       return node->getOp() == op;
+                                   }),
+                         end(node_index_map));
+}
+
+/// Returns the cloned output_nodes located in the node_clones array
+///
+/// This function returns the new cloned version of the output_nodes_ from
+/// the node_clones array. If the output node is a moddim node, then it will
+/// set the output node to be its first non-moddim node child
+inline std::vector<common::Node *> getClonedOutputNodes(
+    const common::Node_map_t &node_index_map,
+    const std::vector<std::shared_ptr<common::Node>> &node_clones,
+    const std::vector<common::Node_ptr> &output_nodes_) {
+    std::vector<common::Node *> cloned_output_nodes;
+    cloned_output_nodes.reserve(output_nodes_.size());
+    for (auto &n : output_nodes_) {
+        common::Node *ptr;
+        if (n->getOp() == af_moddims_t) {
+            // if the output node is a moddims node, then set the output node
+            // to be the child of the moddims node. This is necessary because
+            // we remove the moddim node_index_map from the tree later
+            int child_index = node_index_map.at(n->m_children[0].get());
+            ptr             = node_clones[child_index].get();
+            while (ptr->getOp() == af_moddims_t) {
+                ptr = ptr->m_children[0].get();
+            }
+        } else {
+            int node_index = node_index_map.at(n.get());
+            ptr            = node_clones[node_index].get();
+        }
+        cloned_output_nodes.push_back(ptr);
+    }
+    return cloned_output_nodes;
+}
+
+/// A private copy of the JIT tree. The m_val buffers of the nodes are used as
+/// scratch space so each thread evaluates its own copy of the tree.
+struct ClonedTree {
+    std::vector<std::shared_ptr<common::Node>> nodes;
+    std::vector<common::Node *> outputs;
+};
+
+/// Clones the nodes of the tree, resolves the moddims nodes and returns the
+/// nodes in the order in which they need to be evaluated
+inline ClonedTree cloneTree(
+    const common::Node_map_t &node_index_map,
+    const std::vector<common::Node *> &full_nodes,
+    const std::vector<common::Node_ids> &ids,
+    const std::vector<common::Node_ptr> &output_nodes_) {
+    ClonedTree tree;
+    tree.nodes = cloneNodes(full_nodes, ids);
+    tree.outputs =
+        getClonedOutputNodes(node_index_map, tree.nodes, output_nodes_);
+    propagateModdimsShape(tree.nodes);
+    removeNodeOfOperation(tree.nodes, af_moddims_t);
+    return tree;
+}
+
+/// The nodes of a JIT tree, from which every task clones its own copy with
+/// clone()
+struct TreeNodes {
+    common::Node_map_t node_index_map;
+    std::vector<common::Node *> full_nodes;
+    std::vector<common::Node_ids> ids;
+    std::vector<common::Node_ptr> outputs;
+
+    explicit TreeNodes(const common::Node_ptr &node) : outputs{node} {
+        node->getNodesMap(node_index_map, full_nodes, ids);
+    }
+
+    ClonedTree clone() const {
+        return cloneTree(node_index_map, full_nodes, ids, outputs);
+    }
+};
+
+/// Evaluates the \p lim elements of the linear \p tree that start at \p idx
+/// and returns the values of its first output, which has the type \p T
+template<typename T>
+const compute_t<T> *evalChunk(ClonedTree &tree, dim_t idx, int lim) {
+    for (auto &node : tree.nodes) { node->calc(static_cast<int>(idx), lim); }
+    return static_cast<TNode<T> *>(tree.outputs[0])->m_val.data();
+}
+
+}  // namespace kernel
+}  // namespace cpu
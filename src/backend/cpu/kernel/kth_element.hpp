@@ -0,0 +1,161 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <Param.hpp>
+#include <kernel/radix_sort.hpp>
+#include <kernel/sort.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// Moves the elements of rank [\p rbegin, \p rend) of \p data to their
+/// sorted positions. Every std::nth_element call (introselect) splits the
+/// range at one of the ranks, so the ranks on each side are selected from
+/// the part of the range they are in.
+template<typename U>
+void selectRanks(U *data, dim_t lo, dim_t hi, const dim_t *rbegin,
+                 const dim_t *rend) {
+    while (rbegin != rend) {
+        const dim_t *mid = rbegin + (rend - rbegin) / 2;
+        std::nth_element(data + lo, data + *mid, data + hi);
+        selectRanks(data, lo, *mid, rbegin, mid);
+        lo     = *mid + 1;
+        rbegin = mid + 1;
+    }
+}
+
+/// Columns shorter than this, or with more ranks than kSampleMaxRanks, are
+/// copied and then partitioned around each rank by selectRanks or sorted
+constexpr dim_t kSampleMinSize  = 1 << 12;
+constexpr dim_t kSampleMaxRanks = 8;
+
+/// Floyd-Rivest style selection of the elements of rank \p ranks of the
+/// \p n elements at \p ptr, with a stride of \p stride
+///
+/// A sorted sample of about n^(2/3) elements gives two bounds for each rank
+/// that hold it with a high probability. One pass over the column counts the
+/// elements below each lower bound and keeps the few between the bounds, and
+/// the rank is selected from those. The column is neither copied nor
+/// reordered.
+///
+/// \returns false if a rank was not between its bounds
+template<typename T, typename U>
+bool sampleSelect(U *out, const T *ptr, const dim_t n, const dim_t stride,
+                  const std::vector<dim_t> &ranks,
+                  std::vector<std::vector<U>> &kept) {
+    using key          = radix_key<T>;
+    const dim_t nranks = static_cast<dim_t>(ranks.size());
+    const dim_t nsample =
+        static_cast<dim_t>(std::cbrt(static_cast<double>(n) * n));
+    const dim_t gap =
+        static_cast<dim_t>(2.0 * std::sqrt(static_cast<double>(nsample)));
+
+    std::vector<U> sample(nsample);
+    for (dim_t i = 0; i < nsample; i++) {
+        sample[i] = key::encode(ptr[(i * n / nsample) * stride]);
+    }
+    std::sort(sample.begin(), sample.end());
+
+    // A pass per rank keeps the bounds and the count in registers, which is
+    // several times faster than testing all the bounds in one pass
+    std::array<dim_t, kSampleMaxRanks> below;
+    for (dim_t r = 0; r < nranks; r++) {
+        const dim_t pos = ranks[r] * nsample / n;
+        const U lo      = sample[std::max<dim_t>(pos - gap, 0)];
+        const U hi      = sample[std::min<dim_t>(pos + gap, nsample - 1)];
+
+        std::vector<U> &inside = kept[r];
+        dim_t count            = 0;
+        inside.clear();
+        for (dim_t i = 0; i < n; i++) {
+            const U val = key::encode(ptr[i * stride]);
+            count += val < lo;
+            // A single comparison which is almost always false, unlike
+            // val >= lo which is a coin flip
+            if (U(val - lo) <= U(hi - lo)) { inside.push_back(val); }
+        }
+        below[r] = count;
+    }
+
+    for (dim_t r = 0; r < nranks; r++) {
+        const dim_t k = ranks[r] - below[r];
+        if (k < 0 || k >= static_cast<dim_t>(kept[r].size())) { return false; }
+        std::nth_element(kept[r].begin(), kept[r].begin() + k, kept[r].end());
+        out[r] = kept[r][k];
+    }
+    return true;
+}
+
+/// Writes the elements of rank \p ranks of each column of \p in along \p dim
+/// to the same column of \p out. The values are ordered by their radix keys,
+/// so NaNs are ranked after infinity like in sort.
+template<typename T>
+void kth_element(Param<T> out, CParam<T> in, const std::vector<dim_t> ranks,
+                 const int dim) {
+    using key = radix_key<T>;
+    using U   = typename key::type;
+
+    const af::dim4 idims    = in.dims();
+    const af::dim4 istrides = in.strides();
+    const af::dim4 odims    = out.dims();
+    const af::dim4 ostrides = out.strides();
+    const dim_t len         = idims[dim];
+    const dim_t ncols       = idims.elements() / len;
+    const dim_t nranks      = static_cast<dim_t>(ranks.size());
+
+    const bool sampled = len >= kSampleMinSize && nranks <= kSampleMaxRanks;
+
+    parallel_for(0, ncols, grainFor(len), [&](dim_t begin, dim_t end) {
+        std::vector<U> column;
+        std::vector<std::vector<U>> kept(sampled ? nranks : 0);
+        std::array<U, kSampleMaxRanks> selected;
+        for (dim_t col = begin; col < end; col++) {
+            const T *iptr = in.get() + columnOffset(col, idims, istrides, dim);
+            T *optr       = out.get() + columnOffset(col, odims, ostrides, dim);
+
+            if (sampled && sampleSelect(selected.data(), iptr, len,
+                                        istrides[dim], ranks, kept)) {
+                for (dim_t r = 0; r < nranks; r++) {
+                    optr[r * ostrides[dim]] = key::decode(selected[r]);
+                }
+                continue;
+            }
+
+            column.resize(2 * len);
+            U *keys = column.data();
+            for (dim_t i = 0; i < len; i++) {
+                keys[i] = key::encode(iptr[i * istrides[dim]]);
+            }
+
+            // Sorting the short columns is cheaper than selecting several
+            // ranks from them
+            if (nranks > 1 && len >= kRadixMinSize) {
+                NoValues *none = nullptr;
+                if (radix_sort_encoded(keys, keys + len, none, none, len)) {
+                    keys += len;
+                }
+            } else {
+                selectRanks(keys, 0, len, ranks.data(), ranks.data() + nranks);
+            }
+            for (dim_t r = 0; r < nranks; r++) {
+                optr[r * ostrides[dim]] = key::decode(keys[ranks[r]]);
+            }
+        }
+    });
+}
+
+}  // namespace kernel
+}  // namespace cpu
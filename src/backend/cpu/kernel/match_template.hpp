@@ -9,6 +9,11 @@
 
 #pragma once
 #include <Param.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
@@ -57,6 +62,10 @@ void matchTemplate(Param<OutT> out, CParam<InT> sImg, CParam<InT> tImg) {
 
                 for (dim_t si = 0; si < sDim0; si++) {
                     OutT disparity = OutT(0);
+                    // energies of the window and the template used by the
+                    // normalized cross correlation metrics
+                    OutT sEnergy = OutT(0);
+                    OutT tEnergy = OutT(0);
 
                     // mean for window
                     // this variable will be used based on MatchType value
@@ -85,7 +94,7 @@ void matchTemplate(Param<OutT> out, CParam<InT> sImg, CParam<InT> tImg) {
                                             ? src[jStride + i * sStrides[0]]
                                             : InT(0));
                             InT tVal = tpl[tjStride + ti * tStrides[0]];
-                            OutT temp;
+                            OutT temp, sDiff, tDiff;
                             switch (MatchType) {
                                 case AF_SAD:
                                     disparity += fabs((OutT)sVal - (OutT)tVal);
@@ -114,10 +123,16 @@ void matchTemplate(Param<OutT> out, CParam<InT> sImg, CParam<InT> tImg) {
                                     disparity += temp * temp;
                                     break;
                                 case AF_NCC:
-                                    // TODO: furture implementation
+                                    disparity += (OutT)sVal * (OutT)tVal;
+                                    sEnergy += (OutT)sVal * (OutT)sVal;
+                                    tEnergy += (OutT)tVal * (OutT)tVal;
                                     break;
                                 case AF_ZNCC:
-                                    // TODO: furture implementation
+                                    sDiff = (OutT)sVal - wImgMean;
+                                    tDiff = (OutT)tVal - tImgMean;
+                                    disparity += sDiff * tDiff;
+                                    sEnergy += sDiff * sDiff;
+                                    tEnergy += tDiff * tDiff;
                                     break;
                                 case AF_SHD:
                                     // TODO: furture implementation
@@ -125,6 +140,10 @@ void matchTemplate(Param<OutT> out, CParam<InT> sImg, CParam<InT> tImg) {
                             }
                         }
                     }
+                    if (MatchType == AF_NCC || MatchType == AF_ZNCC) {
+                        OutT norm = std::sqrt(sEnergy * tEnergy);
+                        disparity = norm > OutT(0) ? disparity / norm : OutT(0);
+                    }
                     // output is just created, hence not doing the
                     // extra multiplication for 0th dim stride
                     dst[ojStride + si] = disparity;
@@ -138,5 +157,144 @@ void matchTemplate(Param<OutT> out, CParam<InT> sImg, CParam<InT> tImg) {
     }
 };
 
+/// Writes the template rotated by 180 degrees to \p out so that convolving
+/// the search image with it correlates the image with the template
+template<typename OutT, typename InT>
+void flipTemplate(Param<OutT> out, CParam<InT> tImg) {
+    const af::dim4 tDims    = tImg.dims();
+    const af::dim4 tStrides = tImg.strides();
+    const af::dim4 oStrides = out.strides();
+    const InT* tpl          = tImg.get();
+    OutT* dst               = out.get();
+
+    for (dim_t tj = 0; tj < tDims[1]; tj++) {
+        for (dim_t ti = 0; ti < tDims[0]; ti++) {
+            dst[(tDims[1] - 1 - tj) * oStrides[1] + (tDims[0] - 1 - ti)] =
+                (OutT)tpl[tj * tStrides[1] + ti * tStrides[0]];
+        }
+    }
+}
+
+/// Computes the sum of squares based metrics and the normalized cross
+/// correlations from the cross correlation \p corr of the search image with
+/// the template. \p corr is the expanded convolution of the search image with
+/// the flipped template, so the correlation of the window starting at
+/// (i, j) is found at (i + tDim0 - 1, j + tDim1 - 1).
+///
+/// The sums and energies of the windows are read from summed area tables of
+/// the search image. The tables and \p corr are in double precision because
+/// the energies of the windows are differences of large sums.
+template<typename OutT, typename InT, af::matchType MatchType>
+void matchTemplateFromCorrelation(Param<OutT> out, CParam<double> corr,
+                                  CParam<InT> sImg, CParam<InT> tImg) {
+    const af::dim4 sDims    = sImg.dims();
+    const af::dim4 tDims    = tImg.dims();
+    const af::dim4 sStrides = sImg.strides();
+    const af::dim4 tStrides = tImg.strides();
+    const af::dim4 cStrides = corr.strides();
+    const af::dim4 oStrides = out.strides();
+
+    const dim_t sDim0 = sDims[0];
+    const dim_t sDim1 = sDims[1];
+    const dim_t tDim0 = tDims[0];
+    const dim_t tDim1 = tDims[1];
+
+    double tSum = 0.0, tSqSum = 0.0;
+    const InT* tpl = tImg.get();
+    for (dim_t tj = 0; tj < tDim1; tj++) {
+        for (dim_t ti = 0; ti < tDim0; ti++) {
+            double tVal = (double)tpl[tj * tStrides[1] + ti * tStrides[0]];
+            tSum += tVal;
+            tSqSum += tVal * tVal;
+        }
+    }
+    const double n      = (double)(tDim0 * tDim1);
+    const double tMean  = tSum / n;
+    const double tZeroE = tSqSum - n * tMean * tMean;
+
+    // The tables have a leading row and column of zeros
+    const dim_t satDim0 = sDim0 + 1;
+    std::vector<double> sat(satDim0 * (sDim1 + 1));
+    std::vector<double> sqSat(sat.size());
+
+    for (dim_t b3 = 0; b3 < sDims[3]; ++b3) {
+        for (dim_t b2 = 0; b2 < sDims[2]; ++b2) {
+            const InT* src = sImg.get() + b2 * sStrides[2] + b3 * sStrides[3];
+            const double* cor =
+                corr.get() + b2 * cStrides[2] + b3 * cStrides[3];
+            OutT* dst = out.get() + b2 * oStrides[2] + b3 * oStrides[3];
+
+            for (dim_t j = 0; j < sDim1; j++) {
+                double colSum = 0.0, colSqSum = 0.0;
+                const dim_t prev = j * satDim0;
+                const dim_t curr = prev + satDim0;
+                for (dim_t i = 0; i < sDim0; i++) {
+                    double sVal = (double)src[j * sStrides[1] + i * sStrides[0]];
+                    colSum += sVal;
+                    colSqSum += sVal * sVal;
+                    sat[curr + i + 1]   = sat[prev + i + 1] + colSum;
+                    sqSat[curr + i + 1] = sqSat[prev + i + 1] + colSqSum;
+                }
+            }
+
+            parallel_for(0, sDim1, grainFor(sDim0), [&](dim_t begin,
+                                                        dim_t end) {
+                for (dim_t j = begin; j < end; j++) {
+                    // Windows extending past the image see zeros there
+                    const dim_t j0 = j * satDim0;
+                    const dim_t j1 = std::min(j + tDim1, sDim1) * satDim0;
+                    const double* corCol =
+                        cor + (j + tDim1 - 1) * cStrides[1];
+
+                    for (dim_t i = 0; i < sDim0; i++) {
+                        const dim_t i1 = std::min(i + tDim0, sDim0);
+                        const double sSum =
+                            sat[j1 + i1] - sat[j0 + i1] - sat[j1 + i] +
+                            sat[j0 + i];
+                        const double sSqSum =
+                            sqSat[j1 + i1] - sqSat[j0 + i1] - sqSat[j1 + i] +
+                            sqSat[j0 + i];
+                        const double c     = corCol[i + tDim0 - 1];
+                        const double wMean = sSum / n;
+
+                        double res = 0.0;
+                        switch (MatchType) {
+                            case AF_SSD: res = sSqSum - 2 * c + tSqSum; break;
+                            case AF_ZSSD:
+                                res = (sSqSum - n * wMean * wMean) -
+                                      2 * (c - n * wMean * tMean) + tZeroE;
+                                break;
+                            case AF_LSSD: {
+                                const double k = wMean / tMean;
+                                res = sSqSum - 2 * k * c + k * k * tSqSum;
+                            } break;
+                            case AF_NCC: {
+                                const double norm = std::sqrt(sSqSum * tSqSum);
+                                res = norm > 0.0 ? c / norm : 0.0;
+                            } break;
+                            case AF_ZNCC: {
+                                const double sZeroE =
+                                    sSqSum - n * wMean * wMean;
+                                const double norm =
+                                    std::sqrt(std::max(sZeroE, 0.0) * tZeroE);
+                                res = norm > 0.0
+                                          ? (c - n * wMean * tMean) / norm
+                                          : 0.0;
+                            } break;
+                            default: break;
+                        }
+                        // Rounding can push the sum of squares below zero
+                        if (MatchType == AF_SSD || MatchType == AF_ZSSD ||
+                            MatchType == AF_LSSD) {
+                            res = std::max(res, 0.0);
+                        }
+                        dst[j * oStrides[1] + i] = (OutT)res;
+                    }
+                }
+            });
+        }
+    }
+}
+
 }  // namespace kernel
 }  // namespace cpu
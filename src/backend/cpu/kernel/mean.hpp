@@ -10,6 +10,7 @@
 #pragma once
 #include <Array.hpp>
 #include <common/Transform.hpp>
+#include <kernel/summation.hpp>
 
 namespace cpu {
 namespace kernel {
@@ -87,14 +88,15 @@ template<typename Ti, typename Tw, typename To, int D>
 struct mean_dim {
     void operator()(Param<To> output, const dim_t outOffset,
                     const CParam<Ti> input, const dim_t inOffset,
-                    const int dim) {
+                    const int dim, const af_summation_type summation) {
         const af::dim4 odims    = output.dims();
         const af::dim4 ostrides = output.strides();
         const af::dim4 istrides = input.strides();
         const int D1            = D - 1;
         for (dim_t i = 0; i < odims[D1]; i++) {
             mean_dim<Ti, Tw, To, D1>()(output, outOffset + i * ostrides[D1],
-                                       input, inOffset + i * istrides[D1], dim);
+                                       input, inOffset + i * istrides[D1], dim,
+                                       summation);
         }
     }
 };
@@ -103,7 +105,7 @@ template<typename Ti, typename Tw, typename To>
 struct mean_dim<Ti, Tw, To, 0> {
     void operator()(Param<To> output, const dim_t outOffset,
                     const CParam<Ti> input, const dim_t inOffset,
-                    const int dim) {
+                    const int dim, const af_summation_type summation) {
         const af::dim4 idims    = input.dims();
         const af::dim4 istrides = input.strides();
 
@@ -111,6 +113,13 @@ struct mean_dim<Ti, Tw, To, 0> {
         To* out            = output.get();
 
         dim_t istride = istrides[dim];
+        if (isCompensatedSum<af_add_t, compute_t<To>>(summation)) {
+            compute_t<To> sum = sum_compensated<af_add_t, Ti, To>(
+                in + inOffset, idims[dim], istride, summation, false, 0);
+            out[outOffset] = To(sum / compute_t<To>(idims[dim]));
+            return;
+        }
+
         dim_t end     = inOffset + idims[dim] * istride;
         MeanOp<compute_t<Ti>, compute_t<To>, compute_t<Tw>> Op(0, 0);
         for (dim_t i = inOffset; i < end; i += istride) {
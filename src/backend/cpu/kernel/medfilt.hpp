@@ -10,194 +10,370 @@
 #pragma once
 
 #include <Param.hpp>
+#include <kernel/radix_sort.hpp>
+#include <thread_pool.hpp>
 
 #include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace cpu {
 namespace kernel {
 
-template<typename T, af::borderType Pad>
-void medfilt1(Param<T> out, CParam<T> in, dim_t w_wid) {
+/// Maps the positions of a signal of \p len elements padded for a window of
+/// \p wlen elements to the positions in the signal. The padded position p is
+/// the element p - wlen / 2. The zeros of AF_PAD_ZERO are marked with -1.
+template<af::borderType Pad>
+std::vector<int> medfiltIndices(int len, int wlen) {
     constexpr bool IsValidPadType = (Pad == AF_PAD_ZERO || Pad == AF_PAD_SYM);
+    static_assert(IsValidPadType, "Unsupported padding type");
+
+    std::vector<int> indices(len + wlen - 1);
+    for (int p = 0; p < static_cast<int>(indices.size()); p++) {
+        int i = p - wlen / 2;
+        if (Pad == AF_PAD_ZERO) {
+            indices[p] = (i < 0 || i >= len) ? -1 : i;
+        } else {
+            if (i < 0) { i *= -1; }
+            if (i >= len) { i = 2 * (len - 1) - i; }
+            // Windows larger than twice the signal reflect more than once
+            indices[p] = std::min(std::max(i, 0), len - 1);
+        }
+    }
+    return indices;
+}
+
+/// The median of a window with an even number of elements is the mean of
+/// the two middle ones
+template<typename T>
+T medianOf(T lo, T hi) {
+    return (hi + lo) / 2;
+}
+
+/// The window of an 8 or 16 bit type is kept in a histogram of its values
+/// (Huang et al.) with a coarse level so the median is found in
+/// 2 * 2^(bits / 2) steps. Sliding the window costs one update per element
+/// that enters or leaves it.
+template<typename T>
+class HistogramWindow {
+    using key = radix_key<T>;
+    using U   = typename key::type;
+
+    static constexpr int kBits       = sizeof(T) * 8;
+    static constexpr int kFineShift  = kBits / 2;
+    static constexpr int kFinePerBin = 1 << kFineShift;
+
+    std::vector<int> fine;
+    std::vector<int> coarse;
+    int count;
+
+    void add(T val) {
+        U k = key::encode(val);
+        fine[k]++;
+        coarse[k >> kFineShift]++;
+    }
+
+    void remove(T val) {
+        U k = key::encode(val);
+        fine[k]--;
+        coarse[k >> kFineShift]--;
+    }
+
+    T select(int rank) const {
+        int bin = 0;
+        while (rank >= coarse[bin]) { rank -= coarse[bin++]; }
+        int k = bin * kFinePerBin;
+        while (rank >= fine[k]) { rank -= fine[k++]; }
+        return key::decode(static_cast<U>(k));
+    }
+
+   public:
+    explicit HistogramWindow(int)
+        : fine(1 << kBits, 0), coarse(1 << (kBits - kFineShift), 0), count(0) {}
+
+    void clear() {
+        for (int bin = 0; bin < static_cast<int>(coarse.size()); bin++) {
+            if (coarse[bin] == 0) { continue; }
+            std::fill_n(fine.begin() + bin * kFinePerBin, kFinePerBin, 0);
+            coarse[bin] = 0;
+        }
+        count = 0;
+    }
+
+    void insert(const T* vals, int n) {
+        for (int i = 0; i < n; i++) { add(vals[i]); }
+        count += n;
+    }
+
+    void slide(const T* outgoing, const T* incoming, int n) {
+        for (int i = 0; i < n; i++) {
+            remove(outgoing[i]);
+            add(incoming[i]);
+        }
+    }
+
+    T median() const {
+        int off = count / 2;
+        if (count % 2 == 0) { return medianOf(select(off - 1), select(off)); }
+        return select(off);
+    }
+};
+
+/// The window of the other types is kept sorted. The elements that leave and
+/// enter the window are sorted and merged with it in a single pass, so
+/// sliding a window of n elements by k costs O(n + k log k) instead of the
+/// O(n log n) of sorting it again. The values are compared by their radix
+/// keys, which orders NaNs after infinity.
+template<typename T>
+class SortedWindow {
+    using key = radix_key<T>;
+    using U   = typename key::type;
+
+    std::vector<U> vals;
+    std::vector<U> next;
+    std::vector<U> leaving;
+    std::vector<U> entering;
+
+    static void encode(std::vector<U>& keys, const T* src, int n) {
+        keys.resize(n);
+        for (int i = 0; i < n; i++) { keys[i] = key::encode(src[i]); }
+        std::sort(keys.begin(), keys.end());
+    }
+
+   public:
+    explicit SortedWindow(int size) {
+        vals.reserve(size);
+        next.reserve(size);
+    }
+
+    void clear() { vals.clear(); }
+
+    void insert(const T* src, int n) {
+        encode(entering, src, n);
+        next.clear();
+        std::merge(vals.begin(), vals.end(), entering.begin(), entering.end(),
+                   std::back_inserter(next));
+        std::swap(vals, next);
+    }
+
+    void slide(const T* outgoing, const T* incoming, int n) {
+        encode(leaving, outgoing, n);
+        encode(entering, incoming, n);
+
+        next.clear();
+        auto out = leaving.begin();
+        auto in  = entering.begin();
+        for (U val : vals) {
+            if (out != leaving.end() && *out == val) {
+                ++out;
+                continue;
+            }
+            while (in != entering.end() && *in < val) { next.push_back(*in++); }
+            next.push_back(val);
+        }
+        next.insert(next.end(), in, entering.end());
+        std::swap(vals, next);
+    }
+
+    T median() const {
+        int off = static_cast<int>(vals.size()) / 2;
+        if (vals.size() % 2 == 0) {
+            return medianOf(key::decode(vals[off - 1]), key::decode(vals[off]));
+        }
+        return key::decode(vals[off]);
+    }
+};
+
+template<typename T>
+using MedianWindow =
+    typename std::conditional<(std::is_integral<T>::value && sizeof(T) <= 2),
+                              HistogramWindow<T>, SortedWindow<T>>::type;
+
+/// The comparators of the networks that move the median of 9 and 25 values
+/// to their middle element
+struct MedianNetwork9 {
+    static constexpr int size         = 9;
+    static constexpr int pairs[19][2] = {
+        {1, 2}, {4, 5}, {7, 8}, {0, 1}, {3, 4}, {6, 7}, {1, 2},
+        {4, 5}, {7, 8}, {0, 3}, {5, 8}, {4, 7}, {3, 6}, {1, 4},
+        {2, 5}, {4, 7}, {4, 2}, {6, 4}, {4, 2}};
+};
+
+struct MedianNetwork25 {
+    static constexpr int size         = 25;
+    static constexpr int pairs[99][2] = {
+        {0, 1},   {3, 4},   {2, 4},   {2, 3},   {6, 7},   {5, 7},
+        {5, 6},   {9, 10},  {8, 10},  {8, 9},   {12, 13}, {11, 13},
+        {11, 12}, {15, 16}, {14, 16}, {14, 15}, {18, 19}, {17, 19},
+        {17, 18}, {21, 22}, {20, 22}, {20, 21}, {23, 24}, {2, 5},
+        {3, 6},   {0, 6},   {0, 3},   {4, 7},   {1, 7},   {1, 4},
+        {11, 14}, {8, 14},  {8, 11},  {12, 15}, {9, 15},  {9, 12},
+        {13, 16}, {10, 16}, {10, 13}, {20, 23}, {17, 23}, {17, 20},
+        {21, 24}, {18, 24}, {18, 21}, {19, 22}, {8, 17},  {9, 18},
+        {0, 18},  {0, 9},   {10, 19}, {1, 19},  {1, 10},  {11, 20},
+        {2, 20},  {2, 11},  {12, 21}, {3, 21},  {3, 12},  {13, 22},
+        {4, 22},  {4, 13},  {14, 23}, {5, 23},  {5, 14},  {15, 24},
+        {6, 24},  {6, 15},  {7, 16},  {7, 19},  {13, 21}, {15, 23},
+        {7, 13},  {7, 15},  {1, 9},   {3, 11},  {5, 17},  {11, 17},
+        {9, 17},  {4, 10},  {6, 12},  {7, 14},  {4, 6},   {4, 7},
+        {12, 14}, {10, 14}, {6, 7},   {10, 12}, {6, 10},  {6, 17},
+        {12, 17}, {7, 17},  {7, 10},  {12, 18}, {7, 12},  {10, 18},
+        {12, 20}, {10, 20}, {10, 12}};
+};
+
+/// Orders \p a and \p b without a branch, which would be mispredicted half
+/// of the time on noisy images
+template<typename U>
+void medianSwap(U& a, U& b) {
+    const U swap = (a ^ b) & (U(0) - U(b < a));
+    a ^= swap;
+    b ^= swap;
+}
+
+/// Applies the comparators of \p Network to \p p. The comparators are
+/// expanded at compile time so the values stay in registers.
+template<typename Network, typename U, std::size_t... I>
+U medianNetwork(std::array<U, Network::size>& p, std::index_sequence<I...>) {
+    int expand[] = {(medianSwap(std::get<Network::pairs[I][0]>(p),
+                                std::get<Network::pairs[I][1]>(p)),
+                     0)...};
+    (void)expand;
+    return p[Network::size / 2];
+}
+
+template<typename Network, typename U>
+U medianNetwork(std::array<U, Network::size>& p) {
+    constexpr std::size_t kPairs =
+        sizeof(Network::pairs) / sizeof(Network::pairs[0]);
+    return medianNetwork<Network>(p, std::make_index_sequence<kPairs>());
+}
+
+/// Median filter of the square windows of 3x3 and 5x5 elements, which are
+/// gathered for every pixel and reduced by a comparator network
+template<typename T, typename Network>
+void medfiltNetwork(Param<T> out, CParam<T> in, const std::vector<int>& rows,
+                    const std::vector<int>& cols) {
+    using key       = radix_key<T>;
+    using U         = typename key::type;
+    constexpr int W = Network::size == 9 ? 3 : 5;
 
     const af::dim4 dims     = in.dims();
     const af::dim4 istrides = in.strides();
     const af::dim4 ostrides = out.strides();
+    const dim_t ncols       = dims[1] * dims[2] * dims[3];
 
-    std::vector<T> wind_vals;
-    wind_vals.reserve(w_wid);
-
-    for (int b3 = 0; b3 < (int)dims[3]; b3++) {
-        T const* in_ptr = in.get() + b3 * istrides[3];
-        T* out_ptr      = out.get() + b3 * ostrides[3];
-
-        for (int b2 = 0; b2 < (int)dims[2]; b2++) {
-            for (int col = 0; col < (int)dims[1]; col++) {
-                int ocol_off = col * ostrides[1];
-
-                for (int row = 0; row < (int)dims[0]; row++) {
-                    wind_vals.clear();
-                    for (int wi = 0; wi < (int)w_wid; ++wi) {
-                        int im_row = row + wi - w_wid / 2;
-                        int im_roff;
-                        switch (Pad) {
-                            case AF_PAD_ZERO:
-                                im_roff = im_row * istrides[0];
-                                if (im_row < 0 || im_row >= (int)dims[0])
-                                    wind_vals.push_back(0);
-                                else
-                                    wind_vals.push_back(in_ptr[im_roff]);
-                                break;
-                            case AF_PAD_SYM: {
-                                if (im_row < 0) { im_row *= -1; }
-
-                                if (im_row >= (int)dims[0]) {
-                                    im_row = 2 * ((int)dims[0] - 1) - im_row;
-                                }
-
-                                im_roff = im_row * istrides[0];
-                                wind_vals.push_back(in_ptr[im_roff]);
-                            } break;
-                            default:
-                                static_assert(IsValidPadType,
-                                              "Unsupported padding type");
-                                break;
-                        }
-                    }
+    parallel_for(0, ncols, grainFor(dims[0] * W * W), [&](dim_t begin,
+                                                          dim_t end) {
+        std::array<U, W * W> window;
+        for (dim_t c = begin; c < end; c++) {
+            const int col  = static_cast<int>(c % dims[1]);
+            const dim_t b2 = (c / dims[1]) % dims[2];
+            const dim_t b3 = c / (dims[1] * dims[2]);
 
-                    int off = wind_vals.size() / 2;
-                    std::stable_sort(wind_vals.begin(), wind_vals.end());
-                    if (wind_vals.size() % 2 == 0)
-                        out_ptr[ocol_off + row * ostrides[0]] =
-                            (wind_vals[off] + wind_vals[off - 1]) / 2;
-                    else {
-                        out_ptr[ocol_off + row * ostrides[0]] = wind_vals[off];
+            T const* in_ptr = in.get() + b2 * istrides[2] + b3 * istrides[3];
+            T* out_ptr = out.get() + col * ostrides[1] + b2 * ostrides[2] +
+                         b3 * ostrides[3];
+
+            for (int row = 0; row < static_cast<int>(dims[0]); row++) {
+                for (int wj = 0; wj < W; wj++) {
+                    const int ci = cols[col + wj];
+                    for (int wi = 0; wi < W; wi++) {
+                        const int ri = rows[row + wi];
+                        const T val  = (ri < 0 || ci < 0)
+                                           ? T(0)
+                                           : in_ptr[ri * istrides[0] +
+                                                    ci * istrides[1]];
+                        window[wj * W + wi] = key::encode(val);
                     }
                 }
+                out_ptr[row * ostrides[0]] =
+                    key::decode(medianNetwork<Network>(window));
             }
-            in_ptr += istrides[2];
-            out_ptr += ostrides[2];
         }
-    }
+    });
 }
 
+/// Median filter of windows of \p w_len by \p w_wid elements. The columns are
+/// filtered in parallel and the window slides down each of them.
 template<typename T, af::borderType Pad>
-void medfilt2(Param<T> out, CParam<T> in, dim_t w_len, dim_t w_wid) {
-    constexpr bool IsValidPadType = (Pad == AF_PAD_ZERO || Pad == AF_PAD_SYM);
-
+void medfiltWindow(Param<T> out, CParam<T> in, int w_len, int w_wid) {
     const af::dim4 dims     = in.dims();
     const af::dim4 istrides = in.strides();
     const af::dim4 ostrides = out.strides();
+    const dim_t ncols       = dims[1] * dims[2] * dims[3];
 
-    std::vector<T> wind_vals;
-    wind_vals.reserve(w_len * w_wid);
-
-    for (int b3 = 0; b3 < (int)dims[3]; b3++) {
-        T const* in_ptr = in.get() + b3 * istrides[3];
-        T* out_ptr      = out.get() + b3 * ostrides[3];
-
-        for (int b2 = 0; b2 < (int)dims[2]; b2++) {
-            for (int col = 0; col < (int)dims[1]; col++) {
-                int ocol_off = col * ostrides[1];
-
-                for (int row = 0; row < (int)dims[0]; row++) {
-                    wind_vals.clear();
-
-                    for (int wj = 0; wj < (int)w_wid; ++wj) {
-                        bool isColOff = false;
-
-                        int im_col  = col + wj - w_wid / 2;
-                        int im_coff = 0;
-                        switch (Pad) {
-                            case AF_PAD_ZERO:
-                                im_coff = im_col * istrides[1];
-                                if (im_col < 0 || im_col >= (int)dims[1])
-                                    isColOff = true;
-                                break;
-                            case AF_PAD_SYM: {
-                                if (im_col < 0) {
-                                    im_col *= -1;
-                                    isColOff = true;
-                                }
-
-                                if (im_col >= (int)dims[1]) {
-                                    im_col   = 2 * ((int)dims[1] - 1) - im_col;
-                                    isColOff = true;
-                                }
-
-                                im_coff = im_col * istrides[1];
-                            } break;
-                            default:
-                                static_assert(IsValidPadType,
-                                              "Unsupported padding type");
-                                break;
-                        }
-
-                        for (int wi = 0; wi < (int)w_len; ++wi) {
-                            bool isRowOff = false;
-
-                            int im_row  = row + wi - w_len / 2;
-                            int im_roff = 0;
-                            switch (Pad) {
-                                case AF_PAD_ZERO:
-                                    im_roff = im_row * istrides[0];
-                                    if (im_row < 0 || im_row >= (int)dims[0])
-                                        isRowOff = true;
-                                    break;
-                                case AF_PAD_SYM: {
-                                    if (im_row < 0) {
-                                        im_row *= -1;
-                                        isRowOff = true;
-                                    }
-
-                                    if (im_row >= (int)dims[0]) {
-                                        im_row =
-                                            2 * ((int)dims[0] - 1) - im_row;
-                                        isRowOff = true;
-                                    }
-
-                                    im_roff = im_row * istrides[0];
-                                } break;
-                                default:
-                                    static_assert(IsValidPadType,
-                                                  "Unsupported padding type");
-                                    break;
-                            }
-
-                            if (isRowOff || isColOff) {
-                                switch (Pad) {
-                                    case AF_PAD_ZERO:
-                                        wind_vals.push_back(0);
-                                        break;
-                                    case AF_PAD_SYM:
-                                        wind_vals.push_back(
-                                            in_ptr[im_coff + im_roff]);
-                                        break;
-                                    default:
-                                        static_assert(
-                                            IsValidPadType,
-                                            "Unsupported padding type");
-                                        break;
-                                }
-                            } else
-                                wind_vals.push_back(in_ptr[im_coff + im_roff]);
-                        }
-                    }
+    const std::vector<int> rows = medfiltIndices<Pad>(dims[0], w_len);
+    const std::vector<int> cols = medfiltIndices<Pad>(dims[1], w_wid);
+
+    if (w_len == w_wid && w_len == 3) {
+        medfiltNetwork<T, MedianNetwork9>(out, in, rows, cols);
+        return;
+    }
+    // The histograms of the 8 and 16 bit types are faster than the larger
+    // network
+    constexpr bool isSorted =
+        std::is_same<MedianWindow<T>, SortedWindow<T>>::value;
+    if (isSorted && w_len == w_wid && w_len == 5) {
+        medfiltNetwork<T, MedianNetwork25>(out, in, rows, cols);
+        return;
+    }
+
+    parallel_for(0, ncols, grainFor(dims[0] * w_wid), [&](dim_t begin,
+                                                          dim_t end) {
+        MedianWindow<T> window(w_len * w_wid);
+        std::vector<T> incoming(w_wid);
+        std::vector<T> outgoing(w_wid);
+
+        for (dim_t c = begin; c < end; c++) {
+            const int col  = static_cast<int>(c % dims[1]);
+            const dim_t b2 = (c / dims[1]) % dims[2];
+            const dim_t b3 = c / (dims[1] * dims[2]);
+
+            T const* in_ptr = in.get() + b2 * istrides[2] + b3 * istrides[3];
+            T* out_ptr = out.get() + col * ostrides[1] + b2 * ostrides[2] +
+                         b3 * ostrides[3];
+
+            // Reads the row p of the padded image under the window
+            auto gather = [&](int p, std::vector<T>& vals) {
+                const int ri = rows[p];
+                for (int wj = 0; wj < w_wid; wj++) {
+                    const int ci = cols[col + wj];
+                    vals[wj]     = (ri < 0 || ci < 0)
+                                       ? T(0)
+                                       : in_ptr[ri * istrides[0] +
+                                                ci * istrides[1]];
+                }
+            };
+
+            window.clear();
+            for (int p = 0; p < w_len; p++) {
+                gather(p, incoming);
+                window.insert(incoming.data(), w_wid);
+            }
 
-                    std::stable_sort(wind_vals.begin(), wind_vals.end());
-                    int off = wind_vals.size() / 2;
-                    if (wind_vals.size() % 2 == 0)
-                        out_ptr[ocol_off + row * ostrides[0]] =
-                            (wind_vals[off] + wind_vals[off - 1]) / 2;
-                    else
-                        out_ptr[ocol_off + row * ostrides[0]] = wind_vals[off];
+            for (int row = 0; row < static_cast<int>(dims[0]); row++) {
+                if (row > 0) {
+                    gather(row - 1, outgoing);
+                    gather(row - 1 + w_len, incoming);
+                    window.slide(outgoing.data(), incoming.data(), w_wid);
                 }
+                out_ptr[row * ostrides[0]] = window.median();
             }
-            in_ptr += istrides[2];
-            out_ptr += ostrides[2];
         }
-    }
+    });
+}
+
+template<typename T, af::borderType Pad>
+void medfilt1(Param<T> out, CParam<T> in, dim_t w_wid) {
+    medfiltWindow<T, Pad>(out, in, static_cast<int>(w_wid), 1);
+}
+
+template<typename T, af::borderType Pad>
+void medfilt2(Param<T> out, CParam<T> in, dim_t w_len, dim_t w_wid) {
+    medfiltWindow<T, Pad>(out, in, static_cast<int>(w_len),
+                          static_cast<int>(w_wid));
 }
 
 }  // namespace kernel
@@ -10,8 +10,12 @@
 #pragma once
 #include <Param.hpp>
 #include <common/Binary.hpp>
+#include <memory.hpp>
+#include <thread_pool.hpp>
 #include <utility.hpp>
+#include <algorithm>
 #include <limits>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
@@ -42,8 +46,159 @@ struct MorphFilterOp {
     }
 };
 
+/// The rows [r0, r0 + h) and columns [c0, c0 + w) of a mask
+struct MaskRect {
+    dim_t r0, c0, h, w;
+};
+
+/// Returns true if the nonzero elements of \p mask form a single rectangle,
+/// which is stored in \p rect. Lines and masks padded with zeros count as
+/// rectangles too.
+template<typename T>
+bool getMaskRect(MaskRect& rect, const CParam<T>& mask) {
+    const af::dim4 fstrides = mask.strides();
+    const T* filter         = mask.get();
+    const dim_t dim0 = mask.dims()[0], dim1 = mask.dims()[1];
+
+    dim_t rmin = dim0, rmax = -1, cmin = dim1, cmax = -1, count = 0;
+    for (dim_t j = 0; j < dim1; ++j) {
+        for (dim_t i = 0; i < dim0; ++i) {
+            if (filter[getIdx(fstrides, i, j)] > (T)0) {
+                rmin = std::min(rmin, i);
+                rmax = std::max(rmax, i);
+                cmin = std::min(cmin, j);
+                cmax = std::max(cmax, j);
+                count++;
+            }
+        }
+    }
+
+    rect = MaskRect{rmin, cmin, rmax - rmin + 1, cmax - cmin + 1};
+    return count > 0 && count == rect.h * rect.w;
+}
+
+/// Computes out[k] = op(in[k], ..., in[k + w - 1]) for k in [0, len) with the
+/// van Herk/Gil-Werman algorithm. The input is split into blocks of w
+/// elements. A window covers the end of one block and the start of the next
+/// one, so it is the op of a suffix and a prefix of these blocks. This costs
+/// about three comparisons per element whatever the size of the window.
+///
+/// \p prefix holds len + w - 1 elements.
+template<typename T, bool IsDilation>
+void slidingMorph(T* out, const T* in, dim_t len, dim_t w, T* prefix) {
+    MorphFilterOp<T, IsDilation> filterOp;
+    const dim_t n = len + w - 1;
+
+    for (dim_t q0 = 0; q0 < n; q0 += w) {
+        const dim_t q1 = std::min(q0 + w, n);
+        prefix[q0]     = in[q0];
+        for (dim_t q = q0 + 1; q < q1; ++q) {
+            prefix[q] = filterOp(prefix[q - 1], in[q]);
+        }
+    }
+
+    for (dim_t q0 = ((n - 1) / w) * w; q0 >= 0; q0 -= w) {
+        const dim_t q1 = std::min(q0 + w, n);
+        T suffix       = in[q1 - 1];
+        for (dim_t q = q1 - 1; q >= q0; --q) {
+            suffix = filterOp(suffix, in[q]);
+            if (q < len) { out[q] = filterOp(suffix, prefix[q + w - 1]); }
+        }
+    }
+}
+
+/// Filters a padded image with a rectangular mask as a sliding window along
+/// the first dimension followed by one along the second dimension.
+///
+/// The second pass works on tiles of rows and updates every row of a tile
+/// in the same loop, which the compiler vectorizes.
+template<typename T, bool IsDilation>
+void morphRect(Param<T> paddedOut, CParam<T> paddedIn, const af::dim4& mdims,
+               const MaskRect& rect) {
+    constexpr dim_t kTileRows = 64;
+    MorphFilterOp<T, IsDilation> filterOp;
+
+    const af::dim4 dims     = paddedIn.dims();
+    const af::dim4 istrides = paddedIn.strides();
+    const af::dim4 ostrides = paddedOut.strides();
+    const dim_t R0 = mdims[0] / 2, R1 = mdims[1] / 2;
+    const dim_t odim0 = dims[0] - 2 * R0, odim1 = dims[1] - 2 * R1;
+    const dim_t nbatch = dims[2] * dims[3];
+    const dim_t ntiles = (odim0 + kTileRows - 1) / kTileRows;
+    if (odim0 <= 0 || odim1 <= 0 || nbatch == 0) { return; }
+
+    // The rows of the output filtered along the first dimension, for every
+    // column of the padded input
+    auto rows = memAlloc<T>(odim0 * dims[1] * nbatch);
+
+    parallel_for(0, dims[1] * nbatch, grainFor(dims[0]), [&](dim_t begin,
+                                                              dim_t end) {
+        std::vector<T> prefix(odim0 + rect.h - 1);
+        for (dim_t c = begin; c < end; ++c) {
+            const dim_t b = c / dims[1], j = c % dims[1];
+            const T* in   = paddedIn.get() + (b % dims[2]) * istrides[2] +
+                          (b / dims[2]) * istrides[3] + j * istrides[1];
+            slidingMorph<T, IsDilation>(rows.get() + c * odim0, in + rect.r0,
+                                        odim0, rect.h, prefix.data());
+        }
+    });
+
+    parallel_for(0, ntiles * nbatch, 1, [&](dim_t begin, dim_t end) {
+        const dim_t n = odim1 + rect.w - 1;
+        std::vector<T> prefix(n * kTileRows);
+        std::vector<T> suffix(kTileRows);
+
+        for (dim_t t = begin; t < end; ++t) {
+            const dim_t b  = t / ntiles;
+            const dim_t i0 = (t % ntiles) * kTileRows;
+            const dim_t nr = std::min(kTileRows, odim0 - i0);
+            const T* cols  = rows.get() + (b * dims[1] + rect.c0) * odim0 + i0;
+            T* out = paddedOut.get() + (b % dims[2]) * ostrides[2] +
+                     (b / dims[2]) * ostrides[3] + R1 * ostrides[1] + R0 + i0;
+
+            for (dim_t q = 0; q < n; ++q) {
+                const T* col = cols + q * odim0;
+                T* cur       = prefix.data() + q * kTileRows;
+                if (q % rect.w == 0) {
+                    std::copy(col, col + nr, cur);
+                } else {
+                    const T* prev = cur - kTileRows;
+                    for (dim_t i = 0; i < nr; ++i) {
+                        cur[i] = filterOp(prev[i], col[i]);
+                    }
+                }
+            }
+
+            for (dim_t q = n - 1; q >= 0; --q) {
+                const T* col = cols + q * odim0;
+                if (q % rect.w == rect.w - 1 || q == n - 1) {
+                    std::copy(col, col + nr, suffix.begin());
+                } else {
+                    for (dim_t i = 0; i < nr; ++i) {
+                        suffix[i] = filterOp(suffix[i], col[i]);
+                    }
+                }
+                if (q < odim1) {
+                    const T* pre = prefix.data() + (q + rect.w - 1) * kTileRows;
+                    T* dst       = out + q * ostrides[1];
+                    for (dim_t i = 0; i < nr; ++i) {
+                        dst[i] = filterOp(suffix[i], pre[i]);
+                    }
+                }
+            }
+        }
+    });
+}
+
 template<typename T, bool IsDilation>
 void morph(Param<T> paddedOut, CParam<T> paddedIn, CParam<T> mask) {
+    MaskRect rect;
+    if (paddedIn.strides(0) == 1 && paddedOut.strides(0) == 1 &&
+        getMaskRect(rect, mask)) {
+        morphRect<T, IsDilation>(paddedOut, paddedIn, mask.dims(), rect);
+        return;
+    }
+
     MorphFilterOp<T, IsDilation> filterOp;
     T init = IsDilation ? common::Binary<T, af_max_t>::init()
                         : common::Binary<T, af_min_t>::init();
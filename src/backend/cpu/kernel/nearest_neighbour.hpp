@@ -9,6 +9,14 @@
 
 #pragma once
 #include <Param.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
@@ -16,83 +24,374 @@ namespace kernel {
 #if defined(_WIN32) || defined(_MSC_VER)
 
 #include <intrin.h>
-#define __builtin_popcount __popcnt
+#define __builtin_popcountll __popcnt64
 
 #endif
 
-template<typename T, typename To, af_match_type dist_type>
-struct dist_op {
-    To operator()(T v1, T v2) {
-        return v1 - v2;  // Garbage distance
-    }
-};
+/// Number of set bits in \p x. Without a popcount instruction the builtin
+/// becomes a library call, which is slower than counting the bits inline.
+inline uint popcount64(uintl x) {
+#if defined(__POPCNT__) || defined(_MSC_VER)
+    return static_cast<uint>(__builtin_popcountll(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<uint>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
 
-template<typename T, typename To>
-struct dist_op<T, To, AF_SAD> {
-    To operator()(T v1, T v2) { return std::abs((double)v1 - (double)v2); }
-};
+/// Number of train samples whose distances to the queries are computed
+/// together. The features of the tile are packed so that the distances of the
+/// tile are updated by contiguous, vectorizable loops.
+constexpr unsigned kTrainTile = 256;
 
-template<typename T, typename To>
-struct dist_op<T, To, AF_SSD> {
-    To operator()(T v1, T v2) { return (v1 - v2) * (v1 - v2); }
-};
+/// Number of queries that share one packed tile of train samples
+constexpr unsigned kQueryTile = 32;
 
+/// Number of queries whose distances to a tile are computed in one pass, so
+/// that every feature loaded from the tile is used by several queries
+constexpr unsigned kBlockRows = 4;
+
+/// The type the distances of a tile are computed in. The expanded sum of
+/// squared differences cancels for close floating point samples, so floating
+/// point distances are computed in double. Integer distances are computed in
+/// the unsigned type of \p To, whose overflow wraps around instead of being
+/// undefined.
 template<typename To>
-struct dist_op<uint, To, AF_SHD> {
-    To operator()(uint v1, uint v2) { return __builtin_popcount(v1 ^ v2); }
+struct DistanceAcc {
+    using type = typename std::make_unsigned<To>::type;
+};
+template<>
+struct DistanceAcc<float> {
+    using type = double;
+};
+template<>
+struct DistanceAcc<double> {
+    using type = double;
 };
 
+/// A candidate neighbour. Candidates are ordered by distance and then by the
+/// index of the train sample so that ties always resolve to the same sample.
 template<typename To>
-struct dist_op<uintl, To, AF_SHD> {
-    To operator()(uintl v1, uintl v2) { return __builtin_popcount(v1 ^ v2); }
-};
+using Candidate = std::pair<To, uint>;
 
+/// The k nearest candidates of a query seen so far, kept in a max heap so
+/// that the farthest of them is at the front
 template<typename To>
-struct dist_op<uchar, To, AF_SHD> {
-    To operator()(uchar v1, uchar v2) { return __builtin_popcount(v1 ^ v2); }
+class NeighbourHeap {
+    Candidate<To>* heap;
+    uint k;
+    uint count;
+
+   public:
+    NeighbourHeap(Candidate<To>* storage, uint k_)
+        : heap(storage), k(k_), count(0) {}
+
+    uint size() const { return count; }
+
+    void push(To dist, uint idx) {
+        Candidate<To> c(dist, idx);
+        if (count < k) {
+            heap[count++] = c;
+            std::push_heap(heap, heap + count);
+        } else if (c < heap[0]) {
+            std::pop_heap(heap, heap + k);
+            heap[k - 1] = c;
+            std::push_heap(heap, heap + k);
+        }
+    }
 };
 
-template<typename To>
-struct dist_op<ushort, To, AF_SHD> {
-    To operator()(ushort v1, ushort v2) { return __builtin_popcount(v1 ^ v2); }
+/// Strided view of the samples of a query or train array. Sample \p s,
+/// feature \p f is at s * sampleStride + f * featStride.
+template<typename T>
+struct Samples {
+    const T* ptr;
+    dim_t sampleStride;
+    dim_t featStride;
+
+    T at(dim_t s, dim_t f) const {
+        return ptr[s * sampleStride + f * featStride];
+    }
 };
 
-template<typename T, typename To, af_match_type dist_type>
-void nearest_neighbour(Param<To> dists, CParam<T> query, CParam<T> train,
-                       const uint dist_dim) {
-    uint sample_dim  = (dist_dim == 0) ? 1 : 0;
-    const dim4 qDims = query.dims();
-    const dim4 tDims = train.dims();
-
-    const unsigned distLength = qDims[dist_dim];
-    const unsigned nQuery     = qDims[sample_dim];
-    const unsigned nTrain     = tDims[sample_dim];
-
-    const T* qPtr = query.get();
-    const T* tPtr = train.get();
-    To* dPtr      = dists.get();
-
-    dist_op<T, To, dist_type> op;
-
-    for (unsigned i = 0; i < nQuery; i++) {
-        for (unsigned j = 0; j < nTrain; j++) {
-            To local_dist = 0;
-            for (unsigned k = 0; k < distLength; k++) {
-                size_t qIdx, tIdx;
-                if (sample_dim == 0) {
-                    qIdx = k * qDims[0] + i;
-                    tIdx = k * tDims[0] + j;
+template<typename T>
+Samples<T> samples(CParam<T> in, uint dist_dim) {
+    const uint sample_dim = (dist_dim == 0) ? 1 : 0;
+    return Samples<T>{in.get(), in.strides(sample_dim),
+                      in.strides(dist_dim)};
+}
+
+/// Computes the distances from the queries [\p q0, \p q0 + \p nq) to the
+/// train samples of a tile, using \p qBlock to interleave the query features.
+/// The features of the tile are packed with the samples innermost,
+/// \p tile[f * kTrainTile + j]. The distance to train
+/// sample j of the tile is written to \p dist[r * kTrainTile + j]. The sum of
+/// squared differences is expanded to |q|^2 + |t|^2 - 2 q.t so that the tile
+/// loop is a matrix product.
+template<typename T, typename Acc, af_match_type dist_type>
+void tileDistances(Acc* dist, const Samples<T>& qs, dim_t q0, unsigned nq,
+                   Acc* qBlock, const T* tile, const Acc* tileNorms,
+                   unsigned nt, unsigned len) {
+    // Interleave the features of the queries, qBlock[f * kBlockRows + r]
+    Acc qNorm[kBlockRows] = {};
+    for (unsigned r = 0; r < kBlockRows; r++) {
+        for (unsigned f = 0; f < len; f++) {
+            const Acc qv =
+                r < nq ? static_cast<Acc>(qs.at(q0 + r, f)) : Acc(0);
+            qBlock[f * kBlockRows + r] = qv;
+            qNorm[r] += qv * qv;
+        }
+    }
+
+    std::fill(dist, dist + kBlockRows * kTrainTile, Acc(0));
+    for (unsigned f = 0; f < len; f++) {
+        const T* tFeat = tile + f * kTrainTile;
+        const Acc* qv  = qBlock + f * kBlockRows;
+        for (unsigned r = 0; r < kBlockRows; r++) {
+            Acc* d = dist + r * kTrainTile;
+            for (unsigned j = 0; j < nt; j++) {
+                const Acc tv = static_cast<Acc>(tFeat[j]);
+                if (dist_type == AF_SSD) {
+                    d[j] += qv[r] * tv;
                 } else {
-                    qIdx = i * qDims[0] + k;
-                    tIdx = j * tDims[0] + k;
+                    d[j] += qv[r] > tv ? qv[r] - tv : tv - qv[r];
                 }
+            }
+        }
+    }
 
-                local_dist += op(qPtr[qIdx], tPtr[tIdx]);
+    if (dist_type == AF_SSD) {
+        for (unsigned r = 0; r < nq; r++) {
+            Acc* d = dist + r * kTrainTile;
+            for (unsigned j = 0; j < nt; j++) {
+                const Acc v = qNorm[r] + tileNorms[j] - Acc(2) * d[j];
+                // Rounding can push the distance of close floating point
+                // samples below zero
+                d[j] = std::is_floating_point<Acc>::value && v < Acc(0)
+                           ? Acc(0)
+                           : v;
             }
+        }
+    }
+}
 
-            dPtr[i * nTrain + j] = local_dist;
+/// The distance between query \p q and train sample \p t, summed feature by
+/// feature in \p To. The tiles only rank the candidates, and the distances of
+/// the nearest ones are computed again with this to avoid the rounding of
+/// the expanded form.
+template<typename T, typename To, af_match_type dist_type>
+To exactDistance(const Samples<T>& qs, dim_t q, const Samples<T>& ts,
+                 dim_t t, unsigned len) {
+    To d = To(0);
+    for (unsigned f = 0; f < len; f++) {
+        const T qv = qs.at(q, f);
+        const T tv = ts.at(t, f);
+        if (dist_type == AF_SSD) {
+            d += (qv - tv) * (qv - tv);
+        } else {
+            d += static_cast<To>(std::abs((double)qv - (double)tv));
         }
     }
+    return d;
+}
+
+/// Hamming distances of packed samples. The bits of the features of a sample
+/// are packed into \p words 64 bit words and the samples are stored one after
+/// the other. The popcounts of the queries are independent, which hides their
+/// latency.
+template<typename To>
+void tileHamming(To* dist, const uintl* qBits, unsigned nq,
+                 const uintl* tBits, unsigned nt, unsigned words) {
+    for (unsigned j = 0; j < nt; j++) {
+        const uintl* t         = tBits + j * words;
+        uint bits[kBlockRows] = {};
+        for (unsigned w = 0; w < words; w++) {
+            for (unsigned r = 0; r < kBlockRows; r++) {
+                bits[r] += popcount64(qBits[r * words + w] ^ t[w]);
+            }
+        }
+        for (unsigned r = 0; r < nq; r++) {
+            dist[r * kTrainTile + j] = static_cast<To>(bits[r]);
+        }
+    }
+}
+
+/// Copies the bits of the features of sample \p s to \p words 64 bit words.
+/// The bits past the last feature are zero, so they never differ.
+template<typename T>
+void packBits(uintl* dst, const Samples<T>& in, dim_t s, unsigned len,
+              unsigned words) {
+    std::fill(dst, dst + words, uintl(0));
+    unsigned char* bytes = reinterpret_cast<unsigned char*>(dst);
+    for (unsigned f = 0; f < len; f++) {
+        const T v = in.at(s, f);
+        std::memcpy(bytes + f * sizeof(T), &v, sizeof(T));
+    }
+}
+
+/// Packs the bits of all the samples of \p in
+template<typename T>
+std::vector<uintl> packAllBits(const Samples<T>& in, dim_t n, unsigned len,
+                               unsigned words) {
+    // One extra block of zero samples lets the queries of a partial block
+    // be read like a full one
+    std::vector<uintl> bits((n + kBlockRows) * words);
+    parallel_for(0, n, grainFor(len), [&](dim_t begin, dim_t end) {
+        for (dim_t s = begin; s < end; s++) {
+            packBits(bits.data() + s * words, in, s, len, words);
+        }
+    });
+    return bits;
+}
+
+/// Finds the \p n_dist nearest train samples of every query.
+///
+/// The queries and the train samples are split into tiles. A task packs a
+/// tile of train samples once, computes its distances to a tile of queries
+/// and feeds them to a heap per query, so the full distance matrix is never
+/// stored. The train set is also split into chunks that are searched in
+/// parallel, whose nearest candidates are merged at the end.
+template<typename T, typename To, af_match_type dist_type>
+void nearest_neighbour(Param<uint> idx, Param<To> dist, CParam<T> query,
+                       CParam<T> train, const uint dist_dim,
+                       const uint n_dist) {
+    using Acc             = typename DistanceAcc<To>::type;
+    const uint sample_dim = (dist_dim == 0) ? 1 : 0;
+    const unsigned len    = static_cast<unsigned>(query.dims(dist_dim));
+    const dim_t nQuery    = query.dims(sample_dim);
+    const dim_t nTrain    = train.dims(sample_dim);
+    const uint k          = static_cast<uint>(std::min<dim_t>(n_dist, nTrain));
+    if (nQuery == 0 || k == 0) { return; }
+
+    const Samples<T> qs = samples(query, dist_dim);
+    const Samples<T> ts = samples(train, dist_dim);
+
+    const unsigned words =
+        static_cast<unsigned>((len * sizeof(T) + sizeof(uintl) - 1) /
+                              sizeof(uintl));
+
+    // Split the train set so that there are a few tasks per thread, as long
+    // as the chunks hold several tiles
+    const dim_t nQueryTiles = (nQuery + kQueryTile - 1) / kQueryTile;
+    const dim_t nTrainTiles = (nTrain + kTrainTile - 1) / kTrainTile;
+    const dim_t wanted      = std::max<dim_t>(
+        1, (4 * static_cast<dim_t>(getNumThreads()) + nQueryTiles - 1) /
+               nQueryTiles);
+    const dim_t tilesPerChunk =
+        std::max<dim_t>(4, (nTrainTiles + wanted - 1) / wanted);
+    const dim_t nChunks = (nTrainTiles + tilesPerChunk - 1) / tilesPerChunk;
+
+    // Hamming distances work on the packed bits of all the samples
+    const bool hamming = dist_type == AF_SHD;
+    std::vector<uintl> qBits, tBits;
+    if (hamming) {
+        qBits = packAllBits(qs, nQuery, len, words);
+        tBits = packAllBits(ts, nTrain, len, words);
+    }
+
+    // The nearest candidates of every chunk for every query
+    std::vector<Candidate<To>> cands(nChunks * nQuery * k);
+    std::vector<uint> counts(nChunks * nQuery);
+
+    parallel_for(0, nQueryTiles * nChunks, 1, [&](dim_t begin, dim_t end) {
+        std::vector<T> tile(hamming ? 0 : static_cast<size_t>(len) * kTrainTile);
+        std::vector<Acc> tileNorms(kTrainTile);
+        std::vector<Acc> dists(kBlockRows * kTrainTile);
+        std::vector<Acc> qBlock(hamming ? 0 : static_cast<size_t>(len) *
+                                                  kBlockRows);
+
+        for (dim_t task = begin; task < end; task++) {
+            const dim_t chunk  = task % nChunks;
+            const dim_t q0     = (task / nChunks) * kQueryTile;
+            const unsigned nq  = static_cast<unsigned>(
+                std::min<dim_t>(kQueryTile, nQuery - q0));
+            const dim_t tBegin = chunk * tilesPerChunk * kTrainTile;
+            const dim_t tEnd =
+                std::min(nTrain, tBegin + tilesPerChunk * kTrainTile);
+
+            Candidate<To>* taskCands = cands.data() + (chunk * nQuery + q0) * k;
+            std::vector<NeighbourHeap<To>> heaps;
+            heaps.reserve(nq);
+            for (unsigned i = 0; i < nq; i++) {
+                heaps.emplace_back(taskCands + i * k, k);
+            }
+
+            for (dim_t t0 = tBegin; t0 < tEnd; t0 += kTrainTile) {
+                const unsigned nt = static_cast<unsigned>(
+                    std::min<dim_t>(kTrainTile, tEnd - t0));
+
+                if (!hamming) {
+                    for (unsigned j = 0; j < nt; j++) {
+                        Acc norm = Acc(0);
+                        for (unsigned f = 0; f < len; f++) {
+                            const T v = ts.at(t0 + j, f);
+                            tile[f * kTrainTile + j] = v;
+                            norm += static_cast<Acc>(v) * static_cast<Acc>(v);
+                        }
+                        tileNorms[j] = norm;
+                    }
+                }
+
+                for (unsigned i = 0; i < nq; i += kBlockRows) {
+                    const unsigned nr = std::min(kBlockRows, nq - i);
+                    if (hamming) {
+                        tileHamming(dists.data(),
+                                    qBits.data() + (q0 + i) * words, nr,
+                                    tBits.data() + t0 * words, nt, words);
+                    } else {
+                        tileDistances<T, Acc, dist_type>(
+                            dists.data(), qs, q0 + i, nr, qBlock.data(),
+                            tile.data(), tileNorms.data(), nt, len);
+                    }
+                    for (unsigned r = 0; r < nr; r++) {
+                        const Acc* d = dists.data() + r * kTrainTile;
+                        for (unsigned j = 0; j < nt; j++) {
+                            heaps[i + r].push(static_cast<To>(d[j]),
+                                              static_cast<uint>(t0 + j));
+                        }
+                    }
+                }
+            }
+
+            for (unsigned i = 0; i < nq; i++) {
+                counts[chunk * nQuery + q0 + i] = heaps[i].size();
+            }
+        }
+    });
+
+    // Merge the candidates of the chunks
+    const af::dim4 iStrides = idx.strides();
+    const af::dim4 dStrides = dist.strides();
+    parallel_for(0, nQuery, grainFor(nChunks * k), [&](dim_t begin,
+                                                      dim_t end) {
+        std::vector<Candidate<To>> merged;
+        for (dim_t q = begin; q < end; q++) {
+            merged.clear();
+            for (dim_t c = 0; c < nChunks; c++) {
+                const Candidate<To>* cc = cands.data() + (c * nQuery + q) * k;
+                merged.insert(merged.end(), cc,
+                              cc + counts[c * nQuery + q]);
+            }
+            std::partial_sort(merged.begin(), merged.begin() + k,
+                              merged.end());
+            if (std::is_floating_point<To>::value && !hamming) {
+                for (uint j = 0; j < k; j++) {
+                    merged[j].first = exactDistance<T, To, dist_type>(
+                        qs, q, ts, merged[j].second, len);
+                }
+                std::sort(merged.begin(), merged.begin() + k);
+            }
+
+            uint* iPtr = idx.get() + q * iStrides[1];
+            To* dPtr   = dist.get() + q * dStrides[1];
+            for (uint j = 0; j < k; j++) {
+                dPtr[j] = merged[j].first;
+                iPtr[j] = merged[j].second;
+            }
+        }
+    });
 }
 
 }  // namespace kernel
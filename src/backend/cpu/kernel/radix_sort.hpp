@@ -0,0 +1,265 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <common/half.hpp>
+#include <thread_pool.hpp>
+#include <af/defines.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// Columns shorter than this are sorted by comparison. The histograms of a
+/// radix sort cost more than the sort itself for them.
+constexpr dim_t kRadixMinSize = 256;
+
+/// The number of bits sorted by each pass of the radix sort
+constexpr int kRadixBits    = 8;
+constexpr int kRadixBuckets = 1 << kRadixBits;
+
+/// Maps the keys of type \p T to unsigned integers with the same order
+template<typename T, typename Enable = void>
+struct radix_key {
+    static constexpr bool value = false;
+};
+
+template<typename T>
+struct radix_key<T, typename std::enable_if<std::is_integral<T>::value>::type> {
+    static constexpr bool value = true;
+    using type = typename std::make_unsigned<T>::type;
+
+    // Flipping the sign bit moves the negative values below the positive ones
+    static constexpr type kFlip =
+        std::is_signed<T>::value ? type(type(1) << (sizeof(T) * 8 - 1)) : 0;
+
+    static type encode(T val) { return static_cast<type>(val) ^ kFlip; }
+    static T decode(type key) { return static_cast<T>(key ^ kFlip); }
+    static bool isNegativeZero(T) { return false; }
+};
+
+/// The bits of a float are flipped entirely if it is negative and only its
+/// sign bit otherwise. The negative values are then ordered from the most
+/// negative up and are placed below the positive ones. NaNs are sorted after
+/// infinity, or before -infinity if their sign bit is set. -0 is sorted
+/// before +0 although they compare equal.
+template<typename T, typename U>
+struct radix_float_key {
+    static constexpr bool value = true;
+    using type                  = U;
+
+    static constexpr U kSign = U(1) << (sizeof(U) * 8 - 1);
+
+    static U encode(T val) {
+        U bits;
+        std::memcpy(&bits, &val, sizeof(U));
+        return (bits & kSign) ? U(~bits) : U(bits ^ kSign);
+    }
+    static T decode(U key) {
+        U bits = (key & kSign) ? U(key ^ kSign) : U(~key);
+        T val;
+        std::memcpy(&val, &bits, sizeof(U));
+        return val;
+    }
+    static bool isNegativeZero(T val) { return encode(val) == U(~kSign); }
+};
+
+template<>
+struct radix_key<float> : radix_float_key<float, std::uint32_t> {};
+template<>
+struct radix_key<double> : radix_float_key<double, std::uint64_t> {};
+template<>
+struct radix_key<common::half>
+    : radix_float_key<common::half, std::uint16_t> {};
+
+/// Used in place of the values by the sorts that only move keys
+struct NoValues {};
+
+/// Stable LSD radix sort of the encoded keys in \p keys and of the values in
+/// \p vals, which are moved with their keys
+///
+/// The keys and values are sorted one digit at a time. Each pass counts the
+/// digits of a contiguous chunk of the keys per task, so a task knows where
+/// each of its keys goes, and then moves the keys of its chunk in order. The
+/// passes in which all the keys have the same digit are skipped.
+///
+/// \param[inout] keys     The encoded keys
+/// \param[inout] keys_tmp A buffer of \p n keys
+/// \param[inout] vals     The values or nullptr if there are none
+/// \param[inout] vals_tmp A buffer of \p n values or nullptr
+/// \param[in]    n        The number of keys
+///
+/// \returns true if the sorted keys and values are in the buffers and false
+///          if they are in \p keys and \p vals
+template<typename U, typename Tv>
+bool radix_sort_encoded(U *keys, U *keys_tmp, Tv *vals, Tv *vals_tmp,
+                        const dim_t n) {
+    constexpr int kPasses     = (sizeof(U) * 8) / kRadixBits;
+    constexpr bool kHasValues = !std::is_same<Tv, NoValues>::value;
+    using Histogram           = std::array<dim_t, kRadixBuckets>;
+
+    // The digits of the whole column tell which passes can be skipped
+    std::array<Histogram, kPasses> total{};
+    for (dim_t i = 0; i < n; i++) {
+        for (int p = 0; p < kPasses; p++) {
+            total[p][(keys[i] >> (p * kRadixBits)) & (kRadixBuckets - 1)]++;
+        }
+    }
+
+    ThreadPool &pool = getThreadPool();
+    const int ntasks = static_cast<int>(std::max<dim_t>(
+        1, std::min<dim_t>(pool.size(), n / kMinElementsPerTask)));
+    const dim_t chunk = (n + ntasks - 1) / ntasks;
+    std::vector<Histogram> offsets(ntasks);
+
+    bool swapped = false;
+    for (int p = 0; p < kPasses; p++) {
+        const int shift = p * kRadixBits;
+        const U first   = (keys[0] >> shift) & (kRadixBuckets - 1);
+        if (total[p][first] == n) { continue; }
+
+        auto count = [&](int task) {
+            Histogram &hist = offsets[task];
+            hist.fill(0);
+            const dim_t end = std::min(n, (task + 1) * chunk);
+            for (dim_t i = task * chunk; i < end; i++) {
+                hist[(keys[i] >> shift) & (kRadixBuckets - 1)]++;
+            }
+        };
+        if (ntasks > 1) {
+            pool.run(ntasks, count);
+        } else {
+            count(0);
+        }
+
+        // The keys of a task go after the keys of the same digit of the
+        // tasks before it, which keeps the sort stable
+        dim_t offset = 0;
+        for (int b = 0; b < kRadixBuckets; b++) {
+            for (int t = 0; t < ntasks; t++) {
+                const dim_t cnt = offsets[t][b];
+                offsets[t][b]   = offset;
+                offset += cnt;
+            }
+        }
+
+        auto scatter = [&](int task) {
+            Histogram &next = offsets[task];
+            const dim_t end = std::min(n, (task + 1) * chunk);
+            for (dim_t i = task * chunk; i < end; i++) {
+                const U digit   = (keys[i] >> shift) & (kRadixBuckets - 1);
+                const dim_t dst = next[digit]++;
+                keys_tmp[dst]   = keys[i];
+                if (kHasValues) { vals_tmp[dst] = vals[i]; }
+            }
+        };
+        if (ntasks > 1) {
+            pool.run(ntasks, scatter);
+        } else {
+            scatter(0);
+        }
+
+        std::swap(keys, keys_tmp);
+        if (kHasValues) { std::swap(vals, vals_tmp); }
+        swapped = !swapped;
+    }
+    return swapped;
+}
+
+/// Sorts the \p n values at \p data
+template<typename T>
+typename std::enable_if<radix_key<T>::value>::type radix_sort(
+    T *data, const dim_t n, const bool isAscending) {
+    using key = radix_key<T>;
+    using U   = typename key::type;
+
+    if (n < kRadixMinSize) {
+        if (isAscending) {
+            std::sort(data, data + n, std::less<T>());
+        } else {
+            std::sort(data, data + n, std::greater<T>());
+        }
+        return;
+    }
+
+    // Inverting the keys reverses the order, and keeps equal keys in place
+    const U invert = isAscending ? U(0) : U(~U(0));
+    std::vector<U> buffer(2 * n);
+    U *keys = buffer.data();
+    for (dim_t i = 0; i < n; i++) { keys[i] = key::encode(data[i]) ^ invert; }
+
+    NoValues *none = nullptr;
+    if (radix_sort_encoded(keys, keys + n, none, none, n)) { keys += n; }
+
+    for (dim_t i = 0; i < n; i++) { data[i] = key::decode(keys[i] ^ invert); }
+}
+
+/// Stable comparison sort of the \p n keys at \p keys and of their values
+template<typename Tk, typename Tv>
+void stable_sort_by_key(Tk *keys, Tv *vals, const dim_t n,
+                        const bool isAscending) {
+    std::vector<std::pair<Tk, Tv>> pairs(n);
+    for (dim_t i = 0; i < n; i++) { pairs[i] = {keys[i], vals[i]}; }
+    using Pair = const std::pair<Tk, Tv> &;
+    if (isAscending) {
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](Pair a, Pair b) { return a.first < b.first; });
+    } else {
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](Pair a, Pair b) { return a.first > b.first; });
+    }
+    for (dim_t i = 0; i < n; i++) {
+        keys[i] = pairs[i].first;
+        vals[i] = pairs[i].second;
+    }
+}
+
+/// Sorts the \p n keys at \p keys and moves the values at \p vals with them.
+/// Values with equal keys keep their order.
+template<typename Tk, typename Tv>
+typename std::enable_if<radix_key<Tk>::value>::type radix_sort_by_key(
+    Tk *keys, Tv *vals, const dim_t n, const bool isAscending) {
+    using key = radix_key<Tk>;
+    using U   = typename key::type;
+
+    if (n < kRadixMinSize) {
+        stable_sort_by_key(keys, vals, n, isAscending);
+        return;
+    }
+
+    const U invert = isAscending ? U(0) : U(~U(0));
+    std::vector<U> buffer(2 * n);
+    U *ukeys = buffer.data();
+    for (dim_t i = 0; i < n; i++) {
+        // The values of -0 and +0 have to keep their order
+        if (key::isNegativeZero(keys[i])) {
+            stable_sort_by_key(keys, vals, n, isAscending);
+            return;
+        }
+        ukeys[i] = key::encode(keys[i]) ^ invert;
+    }
+
+    std::vector<Tv> vals_tmp(n);
+    if (radix_sort_encoded(ukeys, ukeys + n, vals, vals_tmp.data(), n)) {
+        ukeys += n;
+        std::copy(vals_tmp.begin(), vals_tmp.end(), vals);
+    }
+
+    for (dim_t i = 0; i < n; i++) { keys[i] = key::decode(ukeys[i] ^ invert); }
+}
+
+}  // namespace kernel
+}  // namespace cpu
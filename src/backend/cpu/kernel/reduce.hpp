@@ -12,27 +12,151 @@
 #include <common/Binary.hpp>
 #include <common/Transform.hpp>
 #include <common/half.hpp>
+#include <kernel/summation.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <type_traits>
 
 namespace cpu {
 namespace kernel {
 
+/// The number of partial results kept when reducing contiguous values. They
+/// break the dependency between consecutive elements so the compiler can
+/// keep the partial results in vector registers.
+constexpr int kReduceLanes = 16;
+
+/// The number of columns accumulated at once when reducing along dimensions
+/// other than the first one
+constexpr dim_t kReduceColumns = 512;
+
+/// True if the contiguous loops can reduce values of type \p T in a
+/// different order. The complex min and max pick between values of equal
+/// magnitude based on the order so they are excluded.
+template<typename T>
+struct is_reorderable
+    : std::integral_constant<bool, !std::is_same<T, cfloat>::value &&
+                                       !std::is_same<T, cdouble>::value> {};
+
+/// Reduces the \p len contiguous values at \p in using kReduceLanes partial
+/// results. The values are usually stored as data_t<Ti>, but the values
+/// computed by a JIT tree are read as compute_t<Ti>.
+template<af_op_t op, typename Ti, typename To, bool change_nan,
+         typename Tv = data_t<Ti>>
+compute_t<To> reduce_contiguous(Tv const *const in, const dim_t len,
+                                const compute_t<To> nanval) {
+    common::Transform<Tv, compute_t<To>, op> transform;
+    common::Binary<compute_t<To>, op> reduce;
+
+    compute_t<To> acc[kReduceLanes];
+    std::fill(acc, acc + kReduceLanes,
+              common::Binary<compute_t<To>, op>::init());
+
+    dim_t i = 0;
+    for (; i + kReduceLanes <= len; i += kReduceLanes) {
+        for (int l = 0; l < kReduceLanes; l++) {
+            compute_t<To> in_val = transform(in[i + l]);
+            if (change_nan) in_val = IS_NAN(in_val) ? nanval : in_val;
+            acc[l] = reduce(in_val, acc[l]);
+        }
+    }
+    for (int l = 0; i < len; i++, l++) {
+        compute_t<To> in_val = transform(in[i]);
+        if (change_nan) in_val = IS_NAN(in_val) ? nanval : in_val;
+        acc[l] = reduce(in_val, acc[l]);
+    }
+
+    for (int width = kReduceLanes / 2; width > 0; width /= 2) {
+        for (int l = 0; l < width; l++) {
+            acc[l] = reduce(acc[l + width], acc[l]);
+        }
+    }
+    return acc[0];
+}
+
+/// Reduces the columns [\p begin, \p end) of the contiguous rows at \p in
+/// along \p dim. Each row is read once and added to a block of partial
+/// results instead of walking every column with a stride.
+template<af_op_t op, typename Ti, typename To, bool change_nan>
+void reduce_rows(data_t<To> *const out, const dim_t ostride,
+                 data_t<Ti> const *const in, const dim_t istride,
+                 const dim_t rows, const dim_t begin, const dim_t end,
+                 const compute_t<To> nanval) {
+    common::Transform<data_t<Ti>, compute_t<To>, op> transform;
+    common::Binary<compute_t<To>, op> reduce;
+
+    compute_t<To> acc[kReduceColumns];
+    for (dim_t cbegin = begin; cbegin < end; cbegin += kReduceColumns) {
+        const dim_t cols = std::min(kReduceColumns, end - cbegin);
+        std::fill(acc, acc + cols, common::Binary<compute_t<To>, op>::init());
+
+        for (dim_t j = 0; j < rows; j++) {
+            data_t<Ti> const *const row = in + j * istride + cbegin;
+            for (dim_t i = 0; i < cols; i++) {
+                compute_t<To> in_val = transform(row[i]);
+                if (change_nan) in_val = IS_NAN(in_val) ? nanval : in_val;
+                acc[i] = reduce(in_val, acc[i]);
+            }
+        }
+
+        for (dim_t i = 0; i < cols; i++) {
+            out[(cbegin + i) * ostride] = data_t<To>(acc[i]);
+        }
+    }
+}
+
 template<af_op_t op, typename Ti, typename To, int D>
 struct reduce_dim {
     void operator()(Param<To> out, const dim_t outOffset, CParam<Ti> in,
                     const dim_t inOffset, const int dim, bool change_nan,
-                    double nanval) {
+                    double nanval, af_summation_type summation) {
         static const int D1 = D - 1;
-        reduce_dim<op, Ti, To, D1> reduce_dim_next;
 
         const af::dim4 ostrides = out.strides();
         const af::dim4 istrides = in.strides();
         const af::dim4 odims    = out.dims();
+        const af::dim4 idims    = in.dims();
 
-        for (dim_t i = 0; i < odims[D1]; i++) {
-            reduce_dim_next(out, outOffset + i * ostrides[D1], in,
-                            inOffset + i * istrides[D1], dim, change_nan,
+        // The first dimension is contiguous so the rows are swept along the
+        // reduced dimension instead of reducing each column separately
+        if (D1 == 0 && dim != 0 && istrides[0] == 1) {
+            data_t<To> *const outPtr      = out.get() + outOffset;
+            data_t<Ti> const *const inPtr = in.get() + inOffset;
+            const compute_t<To> nan       = static_cast<compute_t<To>>(nanval);
+            parallel_for(
+                0, odims[0], grainFor(idims[dim]),
+                [&](dim_t begin, dim_t end) {
+                    if (isCompensatedSum<op, compute_t<To>>(summation)) {
+                        sum_rows_compensated<op, Ti, To>(
+                            outPtr, ostrides[0], inPtr, istrides[dim],
+                            idims[dim], begin, end, summation, change_nan,
                             nanval);
+                    } else if (change_nan) {
+                        reduce_rows<op, Ti, To, true>(
+                            outPtr, ostrides[0], inPtr, istrides[dim],
+                            idims[dim], begin, end, nan);
+                    } else {
+                        reduce_rows<op, Ti, To, false>(
+                            outPtr, ostrides[0], inPtr, istrides[dim],
+                            idims[dim], begin, end, nan);
+                    }
+                });
+            return;
         }
+
+        dim_t elements_per_item = 1;
+        for (int i = 0; i < D1; i++) { elements_per_item *= idims[i]; }
+
+        parallel_for(
+            0, odims[D1], grainFor(elements_per_item),
+            [&](dim_t begin, dim_t end) {
+                reduce_dim<op, Ti, To, D1> reduce_dim_next;
+                for (dim_t i = begin; i < end; i++) {
+                    reduce_dim_next(out, outOffset + i * ostrides[D1], in,
+                                    inOffset + i * istrides[D1], dim,
+                                    change_nan, nanval, summation);
+                }
+            });
     }
 };
 
@@ -42,7 +166,7 @@ struct reduce_dim<op, Ti, To, 0> {
     common::Binary<compute_t<To>, op> reduce;
     void operator()(Param<To> out, const dim_t outOffset, CParam<Ti> in,
                     const dim_t inOffset, const int dim, bool change_nan,
-                    double nanval) {
+                    double nanval, af_summation_type summation) {
         const af::dim4 istrides = in.strides();
         const af::dim4 idims    = in.dims();
 
@@ -50,6 +174,25 @@ struct reduce_dim<op, Ti, To, 0> {
         data_t<Ti> const *const inPtr = in.get() + inOffset;
         dim_t stride                  = istrides[dim];
 
+        if (isCompensatedSum<op, compute_t<To>>(summation)) {
+            *outPtr = data_t<To>(sum_compensated<op, Ti, To>(
+                inPtr, idims[dim], stride, summation, change_nan, nanval));
+            return;
+        }
+
+        if (stride == 1 && is_reorderable<compute_t<To>>::value) {
+            const dim_t len         = idims[dim];
+            const compute_t<To> nan = static_cast<compute_t<To>>(nanval);
+            if (change_nan) {
+                *outPtr = data_t<To>(
+                    reduce_contiguous<op, Ti, To, true>(inPtr, len, nan));
+            } else {
+                *outPtr = data_t<To>(
+                    reduce_contiguous<op, Ti, To, false>(inPtr, len, nan));
+            }
+            return;
+        }
+
         compute_t<To> out_val = common::Binary<compute_t<To>, op>::init();
         for (dim_t i = 0; i < idims[dim]; i++) {
             compute_t<To> in_val = transform(inPtr[i * stride]);
@@ -163,14 +306,23 @@ struct reduce_all {
     common::Transform<data_t<Ti>, compute_t<To>, op> transform;
     common::Binary<compute_t<To>, op> reduce;
     void operator()(Param<To> out, CParam<Ti> in, bool change_nan,
-                    double nanval) {
+                    double nanval, af_summation_type summation) {
         // Decrement dimension of select dimension
         af::dim4 dims            = in.dims();
         af::dim4 strides         = in.strides();
         const data_t<Ti> *inPtr  = in.get();
         data_t<To> *const outPtr = out.get();
 
+        if (isCompensatedSum<op, compute_t<To>>(summation)) {
+            *outPtr = data_t<To>(sum_all_compensated<op, Ti, To>(
+                in, summation, change_nan, nanval));
+            return;
+        }
+
         compute_t<To> out_val = common::Binary<compute_t<To>, op>::init();
+        const bool contiguous =
+            strides[0] == 1 && is_reorderable<compute_t<To>>::value;
+        const compute_t<To> nan = static_cast<compute_t<To>>(nanval);
 
         for (dim_t l = 0; l < dims[3]; l++) {
             dim_t off3 = l * strides[3];
@@ -181,6 +333,17 @@ struct reduce_all {
                 for (dim_t j = 0; j < dims[1]; j++) {
                     dim_t off1 = j * strides[1];
 
+                    if (contiguous) {
+                        const data_t<Ti> *rowPtr = inPtr + off1 + off2 + off3;
+                        compute_t<To> row_val =
+                            change_nan ? reduce_contiguous<op, Ti, To, true>(
+                                             rowPtr, dims[0], nan)
+                                       : reduce_contiguous<op, Ti, To, false>(
+                                             rowPtr, dims[0], nan);
+                        out_val = reduce(row_val, out_val);
+                        continue;
+                    }
+
                     for (dim_t i = 0; i < dims[0]; i++) {
                         dim_t idx = i + off1 + off2 + off3;
 
@@ -0,0 +1,480 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <Array.hpp>
+#include <Param.hpp>
+#include <common/Binary.hpp>
+#include <common/Transform.hpp>
+#include <common/dispatch.hpp>
+#include <common/jit/Node.hpp>
+#include <common/jit/NodeIterator.hpp>
+#include <jit/Node.hpp>
+#include <kernel/ireduce.hpp>
+#include <kernel/jit_tree.hpp>
+#include <kernel/mean.hpp>
+#include <kernel/reduce.hpp>
+#include <thread_pool.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+// The reductions and scans in this file read their input from a JIT tree
+// instead of a buffer. Every task evaluates its own copy of the tree
+// jit::VECTOR_LENGTH elements at a time and uses the values while they are in
+// the cache, so the input is never written to memory. The tree must be linear
+// for the dimensions of the input.
+
+/// The number of elements whose partial result reduce_all_jit keeps. The
+/// partial results are combined in order, so the result does not depend on
+/// the number of threads.
+constexpr dim_t kReduceJitBlock = kMinElementsPerTask;
+
+/// Returns true if the kernels in this file can read \p in from its JIT tree
+/// when it is reduced or scanned along \p dim. \p dim is -1 when all the
+/// values are reduced.
+template<typename T>
+bool isReadableTree(const Array<T> &in, const int dim) {
+    if (in.isReady() || in.elements() == 0) { return false; }
+
+    // The dimensions after the first one are read one block of columns at a
+    // time, which only pays off when the columns fill a chunk
+    const af::dim4 dims = in.dims();
+    if (dim > 0) {
+        dim_t inner = 1;
+        for (int i = 0; i < dim; i++) { inner *= dims[i]; }
+        if (inner < jit::VECTOR_LENGTH) { return false; }
+    }
+
+    common::Node_ptr node = in.getNode();
+    for (common::NodeIterator<> it(node.get()); it != common::NodeIterator<>();
+         ++it) {
+        if (!it->isLinear(dims.get())) { return false; }
+    }
+    return true;
+}
+
+/// Evaluates the rows [\p begin, \p end) of \p tree, whose rows have \p len
+/// values, in order. \p fn is called with the row, the position in the row
+/// of the first value, the values and their number for every part of a row
+/// that lies in one chunk.
+template<typename Ti, typename Fn>
+void sweepRows(ClonedTree &tree, const dim_t len, const dim_t begin,
+               const dim_t end, Fn &&fn) {
+    const dim_t last = end * len;
+    for (dim_t i = begin * len; i < last; i += jit::VECTOR_LENGTH) {
+        const int lim =
+            static_cast<int>(std::min<dim_t>(jit::VECTOR_LENGTH, last - i));
+        const compute_t<Ti> *vals = evalChunk<Ti>(tree, i, lim);
+        for (int pos = 0; pos < lim;) {
+            const dim_t idx = i + pos;
+            const dim_t row = idx / len;
+            const int n     = static_cast<int>(
+                std::min<dim_t>(lim - pos, (row + 1) * len - idx));
+            fn(row, idx - row * len, vals + pos, n);
+            pos += n;
+        }
+    }
+}
+
+/// Reduces the \p len values at \p in, replacing NaNs by \p nanval if
+/// \p change_nan is true
+template<af_op_t op, typename Ti, typename To>
+compute_t<To> reduce_values(const compute_t<Ti> *in, const dim_t len,
+                            bool change_nan, const compute_t<To> nanval) {
+    return change_nan ? reduce_contiguous<op, Ti, To, true>(in, len, nanval)
+                      : reduce_contiguous<op, Ti, To, false>(in, len, nanval);
+}
+
+/// Reduces all the values computed by the tree of \p node, which has the
+/// dimensions \p dims
+template<af_op_t op, typename Ti, typename To>
+void reduce_all_jit(Param<To> out, common::Node_ptr node, af::dim4 dims,
+                    bool change_nan, double nanval) {
+    const TreeNodes tree_nodes(node);
+    const dim_t elements    = dims.elements();
+    const dim_t nblocks     = divup(elements, kReduceJitBlock);
+    const compute_t<To> nan = static_cast<compute_t<To>>(nanval);
+
+    std::vector<compute_t<To>> partials(nblocks);
+    parallel_for(0, nblocks, 1, [&](dim_t begin, dim_t end) {
+        common::Binary<compute_t<To>, op> reduce;
+        ClonedTree tree = tree_nodes.clone();
+        for (dim_t b = begin; b < end; b++) {
+            const dim_t last  = std::min(elements, (b + 1) * kReduceJitBlock);
+            compute_t<To> acc = common::Binary<compute_t<To>, op>::init();
+            for (dim_t i = b * kReduceJitBlock; i < last;
+                 i += jit::VECTOR_LENGTH) {
+                const int lim = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, last - i));
+                const compute_t<Ti> *vals = evalChunk<Ti>(tree, i, lim);
+                acc = reduce(reduce_values<op, Ti, To>(vals, lim, change_nan,
+                                                       nan),
+                             acc);
+            }
+            partials[b] = acc;
+        }
+    });
+
+    common::Binary<compute_t<To>, op> reduce;
+    compute_t<To> out_val = common::Binary<compute_t<To>, op>::init();
+    for (const compute_t<To> &partial : partials) {
+        out_val = reduce(partial, out_val);
+    }
+    *out.get() = data_t<To>(out_val);
+}
+
+/// Reduces the values computed by the tree of \p node, which has the
+/// dimensions \p idims, along \p dim. \p out must be contiguous.
+///
+/// The first dimension is reduced by sweeping the tree linearly, with a chunk
+/// of values spanning several rows when the rows are short. The other
+/// dimensions are reduced one block of jit::VECTOR_LENGTH columns at a time,
+/// like reduce_rows does for buffers.
+template<af_op_t op, typename Ti, typename To>
+void reduce_dim_jit(Param<To> out, common::Node_ptr node, af::dim4 idims,
+                    const int dim, bool change_nan, double nanval) {
+    const TreeNodes tree_nodes(node);
+    data_t<To> *const outPtr = out.get();
+    const compute_t<To> nan  = static_cast<compute_t<To>>(nanval);
+    const dim_t len          = idims[dim];
+
+    if (dim == 0) {
+        const dim_t rows = idims.elements() / len;
+        parallel_for(0, rows, grainFor(len), [&](dim_t begin, dim_t end) {
+            common::Binary<compute_t<To>, op> reduce;
+            ClonedTree tree   = tree_nodes.clone();
+            compute_t<To> acc = common::Binary<compute_t<To>, op>::init();
+            sweepRows<Ti>(tree, len, begin, end,
+                          [&](dim_t row, dim_t col, const compute_t<Ti> *vals,
+                              int n) {
+                              acc = reduce(reduce_values<op, Ti, To>(
+                                               vals, n, change_nan, nan),
+                                           acc);
+                              if (col + n == len) {
+                                  outPtr[row] = data_t<To>(acc);
+                                  acc = common::Binary<compute_t<To>,
+                                                       op>::init();
+                              }
+                          });
+        });
+        return;
+    }
+
+    dim_t inner = 1;
+    for (int i = 0; i < dim; i++) { inner *= idims[i]; }
+    const dim_t outer  = idims.elements() / (inner * len);
+    const dim_t blocks = divup(inner, jit::VECTOR_LENGTH);
+
+    parallel_for(
+        0, outer * blocks, grainFor(len * jit::VECTOR_LENGTH),
+        [&](dim_t begin, dim_t end) {
+            common::Transform<compute_t<Ti>, compute_t<To>, op> transform;
+            common::Binary<compute_t<To>, op> reduce;
+            ClonedTree tree = tree_nodes.clone();
+            compute_t<To> acc[jit::VECTOR_LENGTH];
+            for (dim_t item = begin; item < end; item++) {
+                const dim_t o   = item / blocks;
+                const dim_t col = (item % blocks) * jit::VECTOR_LENGTH;
+                const int lim   = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, inner - col));
+                std::fill(acc, acc + lim,
+                          common::Binary<compute_t<To>, op>::init());
+
+                for (dim_t j = 0; j < len; j++) {
+                    const compute_t<Ti> *vals =
+                        evalChunk<Ti>(tree, (o * len + j) * inner + col, lim);
+                    for (int l = 0; l < lim; l++) {
+                        compute_t<To> in_val = transform(vals[l]);
+                        if (change_nan) {
+                            in_val = IS_NAN(in_val) ? nan : in_val;
+                        }
+                        acc[l] = reduce(in_val, acc[l]);
+                    }
+                }
+
+                data_t<To> *const outBlock = outPtr + o * inner + col;
+                for (int l = 0; l < lim; l++) {
+                    outBlock[l] = data_t<To>(acc[l]);
+                }
+            }
+        });
+}
+
+/// Computes the mean of all the values computed by the tree of \p node, which
+/// has the dimensions \p dims. Like reduce_all_jit, the means of fixed-size
+/// blocks are combined in order.
+template<typename Ti, typename Tw, typename To>
+void mean_all_jit(Param<To> out, common::Node_ptr node, af::dim4 dims) {
+    using MeanOpT = MeanOp<compute_t<Ti>, compute_t<To>, compute_t<Tw>>;
+    const TreeNodes tree_nodes(node);
+    const dim_t elements = dims.elements();
+    const dim_t nblocks  = divup(elements, kReduceJitBlock);
+
+    std::vector<MeanOpT> partials(nblocks, MeanOpT(0, 0));
+    parallel_for(0, nblocks, 1, [&](dim_t begin, dim_t end) {
+        ClonedTree tree = tree_nodes.clone();
+        for (dim_t b = begin; b < end; b++) {
+            const dim_t last = std::min(elements, (b + 1) * kReduceJitBlock);
+            for (dim_t i = b * kReduceJitBlock; i < last;
+                 i += jit::VECTOR_LENGTH) {
+                const int lim = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, last - i));
+                const compute_t<Ti> *vals = evalChunk<Ti>(tree, i, lim);
+                for (int l = 0; l < lim; l++) { partials[b](vals[l], 1); }
+            }
+        }
+    });
+
+    MeanOp<compute_t<To>, compute_t<To>, compute_t<Tw>> total(0, 0);
+    for (const MeanOpT &partial : partials) {
+        total(partial.runningMean, partial.runningCount);
+    }
+    *out.get() = data_t<To>(total.runningMean);
+}
+
+/// Computes the means of the values computed by the tree of \p node, which
+/// has the dimensions \p idims, along \p dim. \p out must be contiguous.
+/// Every mean adds its values in order, like mean_dim.
+template<typename Ti, typename Tw, typename To>
+void mean_dim_jit(Param<To> out, common::Node_ptr node, af::dim4 idims,
+                  const int dim) {
+    using MeanOpT = MeanOp<compute_t<Ti>, compute_t<To>, compute_t<Tw>>;
+    const TreeNodes tree_nodes(node);
+    data_t<To> *const outPtr = out.get();
+    const dim_t len          = idims[dim];
+
+    if (dim == 0) {
+        const dim_t rows = idims.elements() / len;
+        parallel_for(0, rows, grainFor(len), [&](dim_t begin, dim_t end) {
+            ClonedTree tree = tree_nodes.clone();
+            MeanOpT mean(0, 0);
+            sweepRows<Ti>(tree, len, begin, end,
+                          [&](dim_t row, dim_t col, const compute_t<Ti> *vals,
+                              int n) {
+                              if (col == 0) { mean = MeanOpT(0, 0); }
+                              for (int l = 0; l < n; l++) { mean(vals[l], 1); }
+                              if (col + n == len) {
+                                  outPtr[row] = data_t<To>(mean.runningMean);
+                              }
+                          });
+        });
+        return;
+    }
+
+    dim_t inner = 1;
+    for (int i = 0; i < dim; i++) { inner *= idims[i]; }
+    const dim_t outer  = idims.elements() / (inner * len);
+    const dim_t blocks = divup(inner, jit::VECTOR_LENGTH);
+
+    parallel_for(
+        0, outer * blocks, grainFor(len * jit::VECTOR_LENGTH),
+        [&](dim_t begin, dim_t end) {
+            ClonedTree tree = tree_nodes.clone();
+            std::vector<MeanOpT> means(jit::VECTOR_LENGTH, MeanOpT(0, 0));
+            for (dim_t item = begin; item < end; item++) {
+                const dim_t o   = item / blocks;
+                const dim_t col = (item % blocks) * jit::VECTOR_LENGTH;
+                const int lim   = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, inner - col));
+                std::fill(means.begin(), means.begin() + lim, MeanOpT(0, 0));
+
+                for (dim_t j = 0; j < len; j++) {
+                    const compute_t<Ti> *vals =
+                        evalChunk<Ti>(tree, (o * len + j) * inner + col, lim);
+                    for (int l = 0; l < lim; l++) { means[l](vals[l], 1); }
+                }
+
+                data_t<To> *const outBlock = outPtr + o * inner + col;
+                for (int l = 0; l < lim; l++) {
+                    outBlock[l] = data_t<To>(means[l].runningMean);
+                }
+            }
+        });
+}
+
+/// Finds the minimum or maximum of all the values computed by the tree of
+/// \p node, which has the dimensions \p dims, and its index in \p loc. The
+/// values are visited in order on the calling thread, like ireduce_all.
+template<af_op_t op, typename T>
+T ireduce_all_jit(unsigned *loc, common::Node_ptr node, af::dim4 dims) {
+    const TreeNodes tree_nodes(node);
+    ClonedTree tree      = tree_nodes.clone();
+    const dim_t elements = dims.elements();
+
+    MinMaxOp<op, T> minmax(T(0), 0);
+    for (dim_t i = 0; i < elements; i += jit::VECTOR_LENGTH) {
+        const int lim = static_cast<int>(
+            std::min<dim_t>(jit::VECTOR_LENGTH, elements - i));
+        const compute_t<T> *vals = evalChunk<T>(tree, i, lim);
+        if (i == 0) { minmax = MinMaxOp<op, T>(T(vals[0]), 0); }
+        for (int l = 0; l < lim; l++) {
+            minmax(T(vals[l]), static_cast<uint>(i + l));
+        }
+    }
+
+    *loc = minmax.m_idx;
+    return minmax.m_val;
+}
+
+/// Finds the minimums or maximums of the values computed by the tree of
+/// \p node, which has the dimensions \p idims, along \p dim and their
+/// indices. \p out and \p loc must be contiguous. Every output visits its
+/// values in order, like ireduce_dim.
+template<af_op_t op, typename T>
+void ireduce_dim_jit(Param<T> out, Param<uint> loc, common::Node_ptr node,
+                     af::dim4 idims, const int dim) {
+    const TreeNodes tree_nodes(node);
+    T *const outPtr    = out.get();
+    uint *const locPtr = loc.get();
+    const dim_t len    = idims[dim];
+
+    if (dim == 0) {
+        const dim_t rows = idims.elements() / len;
+        parallel_for(0, rows, grainFor(len), [&](dim_t begin, dim_t end) {
+            ClonedTree tree = tree_nodes.clone();
+            MinMaxOp<op, T> minmax(T(0), 0);
+            sweepRows<T>(tree, len, begin, end,
+                         [&](dim_t row, dim_t col, const compute_t<T> *vals,
+                             int n) {
+                             if (col == 0) {
+                                 minmax = MinMaxOp<op, T>(T(vals[0]), 0);
+                             }
+                             for (int l = 0; l < n; l++) {
+                                 minmax(T(vals[l]), static_cast<uint>(col + l));
+                             }
+                             if (col + n == len) {
+                                 outPtr[row] = minmax.m_val;
+                                 locPtr[row] = minmax.m_idx;
+                             }
+                         });
+        });
+        return;
+    }
+
+    dim_t inner = 1;
+    for (int i = 0; i < dim; i++) { inner *= idims[i]; }
+    const dim_t outer  = idims.elements() / (inner * len);
+    const dim_t blocks = divup(inner, jit::VECTOR_LENGTH);
+
+    parallel_for(
+        0, outer * blocks, grainFor(len * jit::VECTOR_LENGTH),
+        [&](dim_t begin, dim_t end) {
+            ClonedTree tree = tree_nodes.clone();
+            std::vector<MinMaxOp<op, T>> minmax(jit::VECTOR_LENGTH,
+                                                MinMaxOp<op, T>(T(0), 0));
+            for (dim_t item = begin; item < end; item++) {
+                const dim_t o   = item / blocks;
+                const dim_t col = (item % blocks) * jit::VECTOR_LENGTH;
+                const int lim   = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, inner - col));
+
+                for (dim_t j = 0; j < len; j++) {
+                    const compute_t<T> *vals =
+                        evalChunk<T>(tree, (o * len + j) * inner + col, lim);
+                    for (int l = 0; l < lim; l++) {
+                        if (j == 0) {
+                            minmax[l] = MinMaxOp<op, T>(T(vals[l]), 0);
+                        }
+                        minmax[l](T(vals[l]), static_cast<uint>(j));
+                    }
+                }
+
+                const dim_t first = o * inner + col;
+                for (int l = 0; l < lim; l++) {
+                    outPtr[first + l] = minmax[l].m_val;
+                    locPtr[first + l] = minmax[l].m_idx;
+                }
+            }
+        });
+}
+
+/// Scans the values computed by the tree of \p node, which has the
+/// dimensions \p idims, along \p dim. \p out must be contiguous. Every scan
+/// visits its values in order, like scan_dim.
+template<af_op_t op, typename Ti, typename To, bool inclusive_scan>
+void scan_dim_jit(Param<To> out, common::Node_ptr node, af::dim4 idims,
+                  const int dim) {
+    const TreeNodes tree_nodes(node);
+    To *const outPtr = out.get();
+    const dim_t len  = idims[dim];
+
+    if (dim == 0) {
+        const dim_t rows = idims.elements() / len;
+        parallel_for(0, rows, grainFor(len), [&](dim_t begin, dim_t end) {
+            common::Transform<Ti, To, op> transform;
+            common::Binary<To, op> scan;
+            ClonedTree tree = tree_nodes.clone();
+            To acc          = common::Binary<To, op>::init();
+            sweepRows<Ti>(
+                tree, len, begin, end,
+                [&](dim_t row, dim_t col, const compute_t<Ti> *vals, int n) {
+                    To *const outRow = outPtr + row * len;
+                    if (col == 0) {
+                        acc = common::Binary<To, op>::init();
+                        if (!inclusive_scan) { outRow[0] = acc; }
+                    }
+                    for (int l = 0; l < n; l++) {
+                        const dim_t i = col + l;
+                        acc           = scan(transform(Ti(vals[l])), acc);
+                        if (inclusive_scan) {
+                            outRow[i] = acc;
+                        } else if (i + 1 < len) {
+                            outRow[i + 1] = acc;
+                        }
+                    }
+                });
+        });
+        return;
+    }
+
+    dim_t inner = 1;
+    for (int i = 0; i < dim; i++) { inner *= idims[i]; }
+    const dim_t outer  = idims.elements() / (inner * len);
+    const dim_t blocks = divup(inner, jit::VECTOR_LENGTH);
+
+    parallel_for(
+        0, outer * blocks, grainFor(len * jit::VECTOR_LENGTH),
+        [&](dim_t begin, dim_t end) {
+            common::Transform<Ti, To, op> transform;
+            common::Binary<To, op> scan;
+            ClonedTree tree = tree_nodes.clone();
+            To acc[jit::VECTOR_LENGTH];
+            for (dim_t item = begin; item < end; item++) {
+                const dim_t o   = item / blocks;
+                const dim_t col = (item % blocks) * jit::VECTOR_LENGTH;
+                const int lim   = static_cast<int>(
+                    std::min<dim_t>(jit::VECTOR_LENGTH, inner - col));
+                std::fill(acc, acc + lim, common::Binary<To, op>::init());
+                if (!inclusive_scan) {
+                    std::copy(acc, acc + lim, outPtr + o * len * inner + col);
+                }
+
+                for (dim_t j = 0; j < len; j++) {
+                    const dim_t first = (o * len + j) * inner + col;
+                    const compute_t<Ti> *vals = evalChunk<Ti>(tree, first, lim);
+                    for (int l = 0; l < lim; l++) {
+                        acc[l] = scan(transform(Ti(vals[l])), acc[l]);
+                    }
+                    if (inclusive_scan) {
+                        std::copy(acc, acc + lim, outPtr + first);
+                    } else if (j + 1 < len) {
+                        std::copy(acc, acc + lim, outPtr + first + inner);
+                    }
+                }
+            }
+        });
+}
+
+}  // namespace kernel
+}  // namespace cpu
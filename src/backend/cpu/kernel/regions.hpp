@@ -8,161 +8,217 @@
  ********************************************************/
 
 #pragma once
+
 #include <Param.hpp>
-#include <memory.hpp>
-#include <map>
-#include <set>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
 
-template<typename T>
-class LabelNode {
-   private:
-    T label;
-    T minLabel;
-    unsigned rank;
-    LabelNode* parent;
-
-   public:
-    LabelNode() : label(0), minLabel(0), rank(0), parent(this) {}
-    LabelNode(T label) : label(label), minLabel(label), rank(0), parent(this) {}
-
-    T getLabel() { return label; }
-
-    T getMinLabel() { return minLabel; }
-
-    LabelNode* getParent() { return parent; }
-
-    unsigned getRank() { return rank; }
-
-    void setMinLabel(T l) { minLabel = l; }
+/// The provisional labels of an image are kept in a flat union-find forest.
+/// The parent of a label is never larger than the label so the root of a
+/// set is its smallest label, which is the label of the set's first pixel.
+using label_t = unsigned;
+
+/// Returns the root of \p l and points every label on the way at it
+inline label_t findRoot(label_t* parent, label_t l) {
+    label_t root = l;
+    while (parent[root] < root) { root = parent[root]; }
+    while (parent[l] < l) {
+        label_t next = parent[l];
+        parent[l]    = root;
+        l            = next;
+    }
+    return root;
+}
 
-    void setParent(LabelNode* p) { parent = p; }
+/// Joins the sets of \p a and \p b and returns the root of the union
+inline label_t merge(label_t* parent, label_t a, label_t b) {
+    label_t ra = findRoot(parent, a);
+    label_t rb = findRoot(parent, b);
+    if (ra < rb) {
+        parent[rb] = ra;
+        return ra;
+    }
+    parent[ra] = rb;
+    return rb;
+}
 
-    void setRank(unsigned r) { rank = r; }
-};
+/// Assigns provisional labels to the columns [\p col_begin, \p col_end) of an
+/// image. The strip is scanned in memory order and a pixel only looks at the
+/// neighbours scanned before it within the strip. The labels of the strip
+/// start after \p base and the number of labels used is returned.
+///
+/// A new label is only created when the pixel above is background, so a
+/// column uses at most (rows + 1) / 2 labels.
+template<bool Conn8>
+label_t labelStrip(label_t* labels, label_t* parent, const char* in,
+                   dim_t istride0, dim_t istride1, int nrows, int col_begin,
+                   int col_end, label_t base) {
+    label_t next = base;
+    for (int j = col_begin; j < col_end; j++) {
+        const char* col    = in + j * istride1;
+        label_t* lcol      = labels + static_cast<dim_t>(j) * nrows;
+        const label_t* llf = lcol - nrows;
+        const bool hasLeft = j > col_begin;
+
+        for (int i = 0; i < nrows; i++) {
+            if (col[i * istride0] == 0) {
+                lcol[i] = 0;
+                continue;
+            }
 
-template<typename T>
-static LabelNode<T>* find(LabelNode<T>* x) {
-    if (x->getParent() != x) x->setParent(find(x->getParent()));
-    return x->getParent();
-}
+            // The neighbours of (i, j) that are scanned before it
+            const label_t up = i > 0 ? lcol[i - 1] : 0;
+            const label_t lf = hasLeft ? llf[i] : 0;
+
+            label_t l = 0;
+            if (Conn8) {
+                const label_t lu = (hasLeft && i > 0) ? llf[i - 1] : 0;
+                const label_t ld =
+                    (hasLeft && i < nrows - 1) ? llf[i + 1] : 0;
+                // The left neighbour touches the three other ones, so they
+                // are in its set already. The pixels up and left-up touch
+                // each other too, but neither touches the left-down one.
+                if (lf) {
+                    l = lf;
+                } else if (up || lu) {
+                    l = up ? up : lu;
+                    if (ld) { l = merge(parent, l, ld); }
+                } else if (ld) {
+                    l = ld;
+                }
+            } else {
+                if (up && lf) {
+                    l = merge(parent, up, lf);
+                } else {
+                    l = up ? up : lf;
+                }
+            }
 
-template<typename T>
-static void setUnion(LabelNode<T>* x, LabelNode<T>* y) {
-    LabelNode<T>* xRoot = find(x);
-    LabelNode<T>* yRoot = find(y);
-    if (xRoot == yRoot) return;
-
-    T xMinLabel = xRoot->getMinLabel();
-    T yMinLabel = yRoot->getMinLabel();
-    xRoot->setMinLabel(std::min(xMinLabel, yMinLabel));
-    yRoot->setMinLabel(std::min(xMinLabel, yMinLabel));
-
-    if (xRoot->getRank() < yRoot->getRank())
-        xRoot->setParent(yRoot);
-    else if (xRoot->getRank() > yRoot->getRank())
-        yRoot->setParent(xRoot);
-    else {
-        yRoot->setParent(xRoot);
-        xRoot->setRank(xRoot->getRank() + 1);
+            if (l == 0) {
+                l         = ++next;
+                parent[l] = l;
+            }
+            lcol[i] = l;
+        }
     }
+    return next - base;
 }
 
+/// Labels the connected components of every image in \p in. The labels are
+/// numbered from 1 in the order of the first pixel of each component.
+///
+/// The columns of an image are split into strips which are labelled in
+/// parallel with disjoint ranges of labels. The sets that meet at the border
+/// of two strips are then merged and the forest is flattened into the final
+/// labels.
 template<typename T>
 void regions(Param<T> out, CParam<char> in, af_connectivity connectivity) {
-    const af::dim4 inDims = in.dims();
-    const char* inPtr     = in.get();
-    T* outPtr             = out.get();
-
-    // Map labels
-    typedef typename std::unique_ptr<LabelNode<T>> UnqLabelPtr;
-    typedef typename std::map<T, UnqLabelPtr> LabelMap;
-    typedef typename LabelMap::iterator LabelMapIterator;
-
-    LabelMap lmap;
-
-    // Initial label
-    T label = (T)1;
-
-    for (int j = 0; j < (int)inDims[1]; j++) {
-        for (int i = 0; i < (int)inDims[0]; i++) {
-            int idx = j * inDims[0] + i;
-            if (inPtr[idx] != 0) {
-                std::vector<T> l;
-
-                // Test neighbors
-                if (i > 0 && outPtr[j * (int)inDims[0] + i - 1] > 0)
-                    l.push_back(outPtr[j * inDims[0] + i - 1]);
-                if (j > 0 && outPtr[(j - 1) * (int)inDims[0] + i] > 0)
-                    l.push_back(outPtr[(j - 1) * inDims[0] + i]);
-                if (connectivity == AF_CONNECTIVITY_8 && i > 0 && j > 0 &&
-                    outPtr[(j - 1) * inDims[0] + i - 1] > 0)
-                    l.push_back(outPtr[(j - 1) * inDims[0] + i - 1]);
-                if (connectivity == AF_CONNECTIVITY_8 &&
-                    i < (int)inDims[0] - 1 && j > 0 &&
-                    outPtr[(j - 1) * inDims[0] + i + 1] != 0)
-                    l.push_back(outPtr[(j - 1) * inDims[0] + i + 1]);
-
-                if (!l.empty()) {
-                    T minl = l[0];
-                    for (size_t k = 0; k < l.size(); k++) {
-                        minl                        = std::min(l[k], minl);
-                        LabelMapIterator currentMap = lmap.find(l[k]);
-                        LabelNode<T>* node          = currentMap->second.get();
-                        // Group labels of the same region under a disjoint set
-                        for (size_t m = k + 1; m < l.size(); m++)
-                            setUnion(node, lmap.find(l[m])->second.get());
+    const af::dim4 dims     = in.dims();
+    const af::dim4 istrides = in.strides();
+    const af::dim4 ostrides = out.strides();
+
+    const int nrows      = static_cast<int>(dims[0]);
+    const int ncols      = static_cast<int>(dims[1]);
+    const dim_t nimages  = dims[2] * dims[3];
+    const dim_t npixels  = dims[0] * dims[1];
+    const bool conn8     = connectivity == AF_CONNECTIVITY_8;
+    const label_t perCol = static_cast<label_t>((nrows + 1) / 2);
+    const dim_t nlabels  = static_cast<dim_t>(perCol) * ncols + 1;
+    if (npixels == 0 || nimages == 0) { return; }
+
+    // One strip per thread, unless the strips get too small to be worth it
+    const dim_t nthreads = getNumThreads();
+    const int stripCols  = static_cast<int>(std::max<dim_t>(
+        grainFor(nrows), (ncols + nthreads - 1) / nthreads));
+    const int nstrips = (ncols + stripCols - 1) / stripCols;
+
+    std::vector<label_t> labels(npixels * nimages);
+    std::vector<label_t> parents(nlabels * nimages);
+    std::vector<label_t> used(nstrips * nimages);
+
+    auto image = [&](dim_t b) {
+        return in.get() + (b % dims[2]) * istrides[2] +
+               (b / dims[2]) * istrides[3];
+    };
+
+    parallel_for(0, nstrips * nimages, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t t = begin; t < end; t++) {
+            const dim_t b       = t / nstrips;
+            const int s         = static_cast<int>(t % nstrips);
+            const int col_begin = s * stripCols;
+            const int col_end   = std::min(col_begin + stripCols, ncols);
+            const label_t base  = perCol * col_begin;
+            label_t* labelsPtr  = labels.data() + b * npixels;
+            label_t* parentPtr  = parents.data() + b * nlabels;
+            const char* inPtr   = image(b);
+
+            used[t] = conn8 ? labelStrip<true>(labelsPtr, parentPtr, inPtr,
+                                               istrides[0], istrides[1], nrows,
+                                               col_begin, col_end, base)
+                            : labelStrip<false>(labelsPtr, parentPtr, inPtr,
+                                                istrides[0], istrides[1],
+                                                nrows, col_begin, col_end,
+                                                base);
+        }
+    });
+
+    // Merge the strips and number the sets in the order of their roots
+    parallel_for(0, nimages, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t b = begin; b < end; b++) {
+            const label_t* labelsPtr = labels.data() + b * npixels;
+            label_t* parentPtr       = parents.data() + b * nlabels;
+
+            for (int s = 1; s < nstrips; s++) {
+                const label_t* cur  = labelsPtr + dim_t(s) * stripCols * nrows;
+                const label_t* prev = cur - nrows;
+                for (int i = 0; i < nrows; i++) {
+                    if (cur[i] == 0) { continue; }
+                    if (prev[i]) { merge(parentPtr, cur[i], prev[i]); }
+                    if (conn8 && i > 0 && prev[i - 1]) {
+                        merge(parentPtr, cur[i], prev[i - 1]);
+                    }
+                    if (conn8 && i < nrows - 1 && prev[i + 1]) {
+                        merge(parentPtr, cur[i], prev[i + 1]);
                     }
-                    // Set label to smallest neighbor label
-                    outPtr[idx] = minl;
-                } else {
-                    // Insert new label in map
-                    lmap.insert(std::make_pair(
-                        label, UnqLabelPtr(new LabelNode<T>(label))));
-                    outPtr[idx] = label++;
                 }
             }
-        }
-    }
-
-    std::set<T> removed;
-
-    for (int j = 0; j < (int)inDims[1]; j++) {
-        for (int i = 0; i < (int)inDims[0]; i++) {
-            int idx = j * (int)inDims[0] + i;
-            if (inPtr[idx] != 0) {
-                T l                         = outPtr[idx];
-                LabelMapIterator currentMap = lmap.find(l);
-
-                if (currentMap != lmap.end()) {
-                    LabelNode<T>* node = currentMap->second.get();
 
-                    LabelNode<T>* nodeRoot = find(node);
-                    outPtr[idx]            = nodeRoot->getMinLabel();
-
-                    // Mark removed labels (those that are part of a region
-                    // that contains a smaller label)
-                    if (node->getMinLabel() < l || nodeRoot->getMinLabel() < l)
-                        removed.insert(l);
-                    if (node->getLabel() > node->getMinLabel())
-                        removed.insert(node->getLabel());
+            // The parent of a label is smaller than the label and has been
+            // renumbered already, unless the label is a root.
+            label_t count = 0;
+            parentPtr[0]  = 0;
+            for (int s = 0; s < nstrips; s++) {
+                const label_t first = perCol * s * stripCols + 1;
+                const label_t last  = first + used[b * nstrips + s];
+                for (label_t l = first; l < last; l++) {
+                    parentPtr[l] = parentPtr[l] == l ? ++count
+                                                     : parentPtr[parentPtr[l]];
                 }
             }
         }
-    }
-
-    // Calculate final neighbors (ensure final labels are sequential)
-    for (int j = 0; j < (int)inDims[1]; j++) {
-        for (int i = 0; i < (int)inDims[0]; i++) {
-            int idx = j * (int)inDims[0] + i;
-            if (outPtr[idx] > 0) {
-                outPtr[idx] -=
-                    distance(removed.begin(), removed.lower_bound(outPtr[idx]));
+    });
+
+    parallel_for(0, ncols * nimages, grainFor(nrows), [&](dim_t begin,
+                                                         dim_t end) {
+        for (dim_t c = begin; c < end; c++) {
+            const dim_t b              = c / ncols;
+            const dim_t j              = c % ncols;
+            const label_t* finalLabels = parents.data() + b * nlabels;
+            const label_t* colLabels = labels.data() + b * npixels + j * nrows;
+            T* outPtr = out.get() + j * ostrides[1] +
+                        (b % dims[2]) * ostrides[2] +
+                        (b / dims[2]) * ostrides[3];
+            for (int i = 0; i < nrows; i++) {
+                outPtr[i * ostrides[0]] =
+                    static_cast<T>(finalLabels[colLabels[i]]);
             }
         }
-    }
+    });
 }
 
 }  // namespace kernel
@@ -11,6 +11,7 @@
 #include <Param.hpp>
 #include <common/Binary.hpp>
 #include <common/Transform.hpp>
+#include <thread_pool.hpp>
 
 namespace cpu {
 namespace kernel {
@@ -24,12 +25,22 @@ struct scan_dim {
         const af::dim4 istrides = in.strides();
 
         const int D1 = D - 1;
-        for (dim_t i = 0; i < odims[D1]; i++) {
-            scan_dim<op, Ti, To, D1, inclusive_scan> func;
-            func(out, outOffset + i * ostrides[D1], in,
-                 inOffset + i * istrides[D1], dim);
-            if (D1 == dim) break;
+        scan_dim<op, Ti, To, D1, inclusive_scan> func;
+        if (D1 == dim) {
+            func(out, outOffset, in, inOffset, dim);
+            return;
         }
+
+        dim_t elements_per_item = 1;
+        for (int i = 0; i < D1; i++) { elements_per_item *= odims[i]; }
+
+        parallel_for(0, odims[D1], grainFor(elements_per_item),
+                     [&](dim_t begin, dim_t end) {
+                         for (dim_t i = begin; i < end; i++) {
+                             func(out, outOffset + i * ostrides[D1], in,
+                                  inOffset + i * istrides[D1], dim);
+                         }
+                     });
     }
 };
 
@@ -10,37 +10,64 @@
 #pragma once
 #include <Param.hpp>
 #include <err_cpu.hpp>
+#include <kernel/radix_sort.hpp>
 #include <math.hpp>
+#include <thread_pool.hpp>
 #include <algorithm>
 #include <functional>
 #include <numeric>
+#include <vector>
 
 namespace cpu {
 namespace kernel {
 
-// Based off of http://stackoverflow.com/a/12399290
 template<typename T>
-void sort0Iterative(Param<T> val, bool isAscending) {
-    // initialize original index locations
-    T *val_ptr = val.get();
+typename std::enable_if<!radix_key<T>::value>::type radix_sort(
+    T *data, const dim_t n, const bool isAscending) {
+    if (isAscending) {
+        std::sort(data, data + n, std::less<T>());
+    } else {
+        std::sort(data, data + n, std::greater<T>());
+    }
+}
 
-    std::function<bool(T, T)> op = std::greater<T>();
-    if (isAscending) { op = std::less<T>(); }
+/// Returns the offset of the column \p col of the columns along \p dim of an
+/// array of size \p dims and strides \p strides
+inline dim_t columnOffset(dim_t col, const af::dim4 &dims,
+                          const af::dim4 &strides, const int dim) {
+    dim_t offset = 0;
+    for (int d = 0; d < 4; d++) {
+        if (d == dim) { continue; }
+        offset += (col % dims[d]) * strides[d];
+        col /= dims[d];
+    }
+    return offset;
+}
 
-    T *comp_ptr = nullptr;
-    for (dim_t w = 0; w < val.dims(3); w++) {
-        dim_t valW = w * val.strides(3);
-        for (dim_t z = 0; z < val.dims(2); z++) {
-            dim_t valWZ = valW + z * val.strides(2);
-            for (dim_t y = 0; y < val.dims(1); y++) {
-                dim_t valOffset = valWZ + y * val.strides(1);
+/// Sorts the values of \p val along \p dim. The columns are sorted in
+/// parallel and the columns that are not contiguous are copied to a buffer.
+template<typename T>
+void sortBatched(Param<T> val, const int dim, bool isAscending) {
+    T *val_ptr             = val.get();
+    const af::dim4 dims    = val.dims();
+    const af::dim4 strides = val.strides();
+    const dim_t len        = dims[dim];
+    const dim_t stride     = strides[dim];
+    const dim_t ncols      = dims.elements() / std::max<dim_t>(len, 1);
 
-                comp_ptr = val_ptr + valOffset;
-                std::sort(comp_ptr, comp_ptr + val.dims(0), op);
+    parallel_for(0, ncols, grainFor(len), [&](dim_t begin, dim_t end) {
+        std::vector<T> column(stride == 1 ? 0 : len);
+        for (dim_t col = begin; col < end; col++) {
+            T *col_ptr = val_ptr + columnOffset(col, dims, strides, dim);
+            if (stride == 1) {
+                radix_sort(col_ptr, len, isAscending);
+                continue;
             }
+            for (dim_t i = 0; i < len; i++) { column[i] = col_ptr[i * stride]; }
+            radix_sort(column.data(), len, isAscending);
+            for (dim_t i = 0; i < len; i++) { col_ptr[i * stride] = column[i]; }
         }
-    }
-    return;
+    });
 }
 
 }  // namespace kernel
@@ -0,0 +1,282 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <Param.hpp>
+#include <common/dispatch.hpp>
+#include <math.hpp>
+#include <thread_pool.hpp>
+#include <types.hpp>
+
+#include <algorithm>
+#include <complex>
+#include <type_traits>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// The largest number of dense columns a sparse-dense product accumulates
+/// together
+constexpr int kCsrmmColumns = 8;
+
+/// The dense columns a sparse-dense product reads together are kept smaller
+/// than this many bytes, so they stay in the cache
+constexpr dim_t kCsrmmCacheBytes = 512 * 1024;
+
+template<typename T>
+T getConjugate(const T &in) {
+    // For non-complex types return same
+    return in;
+}
+
+template<>
+inline cfloat getConjugate(const cfloat &in) {
+    return std::conj(in);
+}
+
+template<>
+inline cdouble getConjugate(const cdouble &in) {
+    return std::conj(in);
+}
+
+/// A point on the merge path of a CSR matrix: the number of rows completed
+/// and the number of nonzeros consumed.
+struct MergeCoord {
+    int row;
+    int nz;
+};
+
+/// Returns the point where the diagonal \p diag crosses the merge path of a
+/// CSR matrix with \p M rows.
+///
+/// The merge path merges the row end offsets rowPtr[1..M] with the indices of
+/// the nonzeros. Each step either consumes a nonzero or completes a row, so
+/// cutting the path into equal pieces splits the rows and the nonzeros evenly
+/// between the pieces, however the nonzeros are spread over the rows.
+inline MergeCoord mergePathSearch(dim_t diag, const int *rowPtr, int M) {
+    const int nnz = rowPtr[M];
+    dim_t lo      = std::max<dim_t>(0, diag - nnz);
+    dim_t hi      = std::min<dim_t>(diag, M);
+    while (lo < hi) {
+        const dim_t mid = (lo + hi) / 2;
+        if (rowPtr[mid + 1] <= diag - mid - 1) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return {static_cast<int>(lo), static_cast<int>(diag - lo)};
+}
+
+/// Multiplies the part of a CSR matrix between the merge path points \p s
+/// and \p e with W columns of a dense matrix B, whose columns are \p ldb
+/// apart. The rows completed in the part are written to C, whose columns are
+/// \p ldc apart. The sums of the row the part stops in go to \p carry.
+///
+/// The W sums of a row are kept in registers, so each nonzero is loaded once
+/// for the W columns.
+template<int W, typename T>
+void csrmmPart(T *c, int ldc, T *carry, const T *val, const int *rowPtr,
+               const int *col, const T *b, int ldb, MergeCoord s,
+               MergeCoord e) {
+    T acc[W];
+    int j = s.nz;
+    for (int i = s.row; i < e.row; i++) {
+        for (int w = 0; w < W; w++) { acc[w] = scalar<T>(0); }
+        for (; j < rowPtr[i + 1]; j++) {
+            const T v   = val[j];
+            const T *br = b + col[j];
+            for (int w = 0; w < W; w++) { acc[w] += v * br[dim_t(w) * ldb]; }
+        }
+        for (int w = 0; w < W; w++) { c[i + dim_t(w) * ldc] = acc[w]; }
+    }
+
+    for (int w = 0; w < W; w++) { acc[w] = scalar<T>(0); }
+    for (; j < e.nz; j++) {
+        const T v   = val[j];
+        const T *br = b + col[j];
+        for (int w = 0; w < W; w++) { acc[w] += v * br[dim_t(w) * ldb]; }
+    }
+    for (int w = 0; w < W; w++) { carry[w] = acc[w]; }
+}
+
+/// Computes C = A * B for a CSR matrix A with \p M rows and a dense \p K x
+/// \p N matrix B. \p ldb and \p ldc are the column strides of B and C.
+///
+/// The merge path of A is cut into one piece per thread. Every piece writes
+/// the rows it completes, and the partial sums of the row it stops in are
+/// added to that row once all the pieces are done.
+///
+/// The columns of B are processed in groups. A group is only as wide as lets
+/// its K rows stay in the cache, because the nonzeros of A can read any of
+/// them.
+template<typename T>
+void csrmmRows(T *c, const T *val, const int *rowPtr, const int *col, int M,
+               const T *b, int K, int N, int ldb, int ldc) {
+    int width = kCsrmmColumns;
+    while (width > 1 && dim_t(K) * width * sizeof(T) > kCsrmmCacheBytes) {
+        width /= 2;
+    }
+
+    const dim_t items  = dim_t(M) + rowPtr[M];
+    const dim_t nparts = std::max<dim_t>(
+        1, std::min<dim_t>(getNumThreads(), divup(items, kMinElementsPerTask)));
+    const dim_t step = divup(items, nparts);
+
+    std::vector<int> carryRow(nparts);
+    std::vector<T> carry(nparts * N);
+
+    parallel_for(0, nparts, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t p = begin; p < end; p++) {
+            const MergeCoord s =
+                mergePathSearch(std::min(p * step, items), rowPtr, M);
+            const MergeCoord e =
+                mergePathSearch(std::min((p + 1) * step, items), rowPtr, M);
+            T *carryPart = carry.data() + p * N;
+
+            auto part = [&](auto group, int n) {
+                csrmmPart<decltype(group)::value>(
+                    c + dim_t(n) * ldc, ldc, carryPart + n, val, rowPtr, col,
+                    b + dim_t(n) * ldb, ldb, s, e);
+            };
+
+            int n = 0;
+            for (; width >= 8 && n + 8 <= N; n += 8) {
+                part(std::integral_constant<int, 8>(), n);
+            }
+            for (; width >= 4 && n + 4 <= N; n += 4) {
+                part(std::integral_constant<int, 4>(), n);
+            }
+            for (; width >= 2 && n + 2 <= N; n += 2) {
+                part(std::integral_constant<int, 2>(), n);
+            }
+            for (; n < N; n++) { part(std::integral_constant<int, 1>(), n); }
+            carryRow[p] = e.row;
+        }
+    });
+
+    for (dim_t p = 0; p < nparts; p++) {
+        if (carryRow[p] >= M) { continue; }
+        for (int n = 0; n < N; n++) {
+            c[carryRow[p] + dim_t(n) * ldc] += carry[p * N + n];
+        }
+    }
+}
+
+/// The CSR arrays of a matrix held on the host
+template<typename T>
+struct CsrMatrix {
+    std::vector<T> values;
+    std::vector<int> rowPtr;
+    std::vector<int> colIdx;
+};
+
+/// Returns the transpose, or the conjugate transpose, of the CSR matrix with
+/// \p M rows and \p K columns.
+///
+/// The rows are split into pieces with about the same number of nonzeros.
+/// Each piece counts its nonzeros per column, so every piece knows where its
+/// part of each transposed row starts and can scatter without atomics. The
+/// transposed rows keep their columns sorted because the pieces are laid out
+/// in row order.
+template<typename T>
+CsrMatrix<T> csrTranspose(const T *val, const int *rowPtr, const int *col,
+                          int M, int K, bool conjugate) {
+    const int nnz = rowPtr[M];
+
+    // Every piece keeps a count per column, so the pieces together may not
+    // need more scratch memory than the nonzeros of A
+    const dim_t nparts = std::max<dim_t>(
+        1, std::min<dim_t>({dim_t(getNumThreads()),
+                            divup(nnz, kMinElementsPerTask),
+                            dim_t(nnz) / std::max(K, 1)}));
+    std::vector<int> firstRow(nparts + 1);
+    for (dim_t p = 0; p <= nparts; p++) {
+        const int target = static_cast<int>(dim_t(nnz) * p / nparts);
+        firstRow[p] = static_cast<int>(
+            std::lower_bound(rowPtr, rowPtr + M, target) - rowPtr);
+    }
+    firstRow[nparts] = M;
+
+    // offsets[p * K + k] counts and then locates the nonzeros of piece p in
+    // column k
+    std::vector<int> offsets(nparts * K, 0);
+    parallel_for(0, nparts, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t p = begin; p < end; p++) {
+            int *count = offsets.data() + p * K;
+            for (int j = rowPtr[firstRow[p]]; j < rowPtr[firstRow[p + 1]];
+                 j++) {
+                count[col[j]]++;
+            }
+        }
+    });
+
+    CsrMatrix<T> t;
+    t.values.resize(nnz);
+    t.colIdx.resize(nnz);
+    t.rowPtr.resize(K + 1);
+    int running = 0;
+    for (int k = 0; k < K; k++) {
+        t.rowPtr[k] = running;
+        for (dim_t p = 0; p < nparts; p++) {
+            const int count    = offsets[p * K + k];
+            offsets[p * K + k] = running;
+            running += count;
+        }
+    }
+    t.rowPtr[K] = running;
+
+    parallel_for(0, nparts, 1, [&](dim_t begin, dim_t end) {
+        for (dim_t p = begin; p < end; p++) {
+            int *offset = offsets.data() + p * K;
+            for (int i = firstRow[p]; i < firstRow[p + 1]; i++) {
+                for (int j = rowPtr[i]; j < rowPtr[i + 1]; j++) {
+                    const int pos = offset[col[j]]++;
+                    t.colIdx[pos] = i;
+                    t.values[pos] = conjugate ? getConjugate(val[j]) : val[j];
+                }
+            }
+        }
+    });
+    return t;
+}
+
+/// Computes out = op(A) * rhs for a sparse CSR matrix A and a dense rhs.
+///
+/// The transposed products run on an explicit transpose of A. Multiplying
+/// by A directly would scatter into the rows of out, which the threads could
+/// only share with atomics.
+template<typename T>
+void csrmm(Param<T> out, CParam<T> values, CParam<int> rowIdx,
+           CParam<int> colIdx, CParam<T> rhs, af_mat_prop optLhs) {
+    const int M = static_cast<int>(out.dims(0));
+    const int K = static_cast<int>(rhs.dims(0));
+    const int N = static_cast<int>(out.dims(1));
+
+    auto multiply = [&](const T *val, const int *rowPtr, const int *col) {
+        csrmmRows(out.get(), val, rowPtr, col, M, rhs.get(), K, N,
+                  static_cast<int>(rhs.strides(1)),
+                  static_cast<int>(out.strides(1)));
+    };
+
+    if (optLhs == AF_MAT_NONE) {
+        multiply(values.get(), rowIdx.get(), colIdx.get());
+    } else {
+        const CsrMatrix<T> t =
+            csrTranspose(values.get(), rowIdx.get(), colIdx.get(),
+                         static_cast<int>(rowIdx.dims(0) - 1), M,
+                         optLhs == AF_MAT_CTRANS);
+        multiply(t.values.data(), t.rowPtr.data(), t.colIdx.data());
+    }
+}
+
+}  // namespace kernel
+}  // namespace cpu
@@ -0,0 +1,90 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <Param.hpp>
+#include <common/spgemm.hpp>
+#include <thread_pool.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// Returns the number of rows of A * B a task processes. Every task clears a
+/// sparse accumulator with one entry per column of B, so a task gets at least
+/// as many multiplications as the accumulator has entries.
+inline dim_t spgemmGrain(CParam<int> aRowIdx, CParam<int> bRowIdx,
+                         const int N) {
+    const dim_t M    = aRowIdx.dims(0) - 1;
+    const dim_t K    = bRowIdx.dims(0) - 1;
+    const dim_t aNnz = aRowIdx.get()[M];
+    const dim_t bNnz = bRowIdx.get()[K];
+    const dim_t work =
+        std::max<dim_t>(1, (aNnz * bNnz) / std::max<dim_t>(1, M * K));
+    return std::max(grainFor(work), N / work);
+}
+
+/// Computes the row offsets of A * B. The rows are counted in parallel and
+/// then summed up.
+inline void spgemmNnz(Param<int> cRowIdx, CParam<int> aRowIdx,
+                      CParam<int> aColIdx, CParam<int> bRowIdx,
+                      CParam<int> bColIdx, const int N) {
+    const int M      = static_cast<int>(aRowIdx.dims(0) - 1);
+    int *cRowPtr     = cRowIdx.get();
+    const int *aRows = aRowIdx.get();
+    const int *aCols = aColIdx.get();
+    const int *bRows = bRowIdx.get();
+    const int *bCols = bColIdx.get();
+
+    parallel_for(0, M, spgemmGrain(aRowIdx, bRowIdx, N),
+                 [&](dim_t begin, dim_t end) {
+                     std::vector<int> marker(N, -1);
+                     for (dim_t row = begin; row < end; row++) {
+                         cRowPtr[row + 1] = common::spgemmRowNnz(
+                             static_cast<int>(row), aRows, aCols, bRows, bCols,
+                             marker.data());
+                     }
+                 });
+
+    cRowPtr[0] = 0;
+    for (int row = 0; row < M; row++) { cRowPtr[row + 1] += cRowPtr[row]; }
+}
+
+/// Fills the values and column indices of A * B for the row offsets computed
+/// by spgemmNnz
+template<typename T>
+void spgemm(Param<T> cValues, Param<int> cColIdx, CParam<int> cRowIdx,
+            CParam<T> aValues, CParam<int> aRowIdx, CParam<int> aColIdx,
+            CParam<T> bValues, CParam<int> bRowIdx, CParam<int> bColIdx,
+            const int N) {
+    const int M        = static_cast<int>(aRowIdx.dims(0) - 1);
+    T *cVals           = cValues.get();
+    int *cCols         = cColIdx.get();
+    const int *cRowPtr = cRowIdx.get();
+
+    parallel_for(
+        0, M, spgemmGrain(aRowIdx, bRowIdx, N), [&](dim_t begin, dim_t end) {
+            std::vector<int> marker(N, -1);
+            std::vector<T> acc(N);
+            for (dim_t row = begin; row < end; row++) {
+                const int offset = cRowPtr[row];
+                common::spgemmRow(cVals + offset, cCols + offset,
+                                  static_cast<int>(row), aValues.get(),
+                                  aRowIdx.get(), aColIdx.get(), bValues.get(),
+                                  bRowIdx.get(), bColIdx.get(), marker.data(),
+                                  acc.data());
+            }
+        });
+}
+
+}  // namespace kernel
+}  // namespace cpu
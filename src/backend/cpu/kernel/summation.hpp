@@ -0,0 +1,349 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <Param.hpp>
+#include <common/Binary.hpp>
+#include <common/Transform.hpp>
+#include <common/half.hpp>
+#include <af/defines.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace cpu {
+namespace kernel {
+
+/// The number of partial sums kept by the compensated loops. These are
+/// independent so the compiler can keep them in vector registers.
+constexpr int kSumLanes = 8;
+
+/// The number of values added directly before the pairwise summation splits
+/// the range in half
+constexpr dim_t kPairwiseBlock = 128;
+
+/// The number of columns summed at once along dimensions other than the first
+constexpr dim_t kSumColumns = 256;
+
+/// True if reductions of \p op on values of type \p T can use the
+/// compensated summation algorithms
+template<af_op_t op, typename T>
+struct is_compensable
+    : std::integral_constant<bool, op == af_add_t &&
+                                       std::is_floating_point<T>::value> {};
+
+template<af_op_t op, typename T, typename R = void>
+using if_compensable_t =
+    typename std::enable_if<is_compensable<op, T>::value, R>::type;
+
+template<af_op_t op, typename T, typename R = void>
+using if_not_compensable_t =
+    typename std::enable_if<!is_compensable<op, T>::value, R>::type;
+
+/// Returns true if the reduction \p op on values of type \p T uses the
+/// compensated algorithm \p summation instead of the default one
+template<af_op_t op, typename T>
+bool isCompensatedSum(af_summation_type summation) {
+    return is_compensable<op, T>::value && summation != AF_SUMMATION_DEFAULT;
+}
+
+/// Converts an input value to the type of the sum and replaces NaNs
+template<typename Ti, typename To, bool change_nan>
+struct SumInput {
+    common::Transform<data_t<Ti>, compute_t<To>, af_add_t> transform;
+    compute_t<To> nanval;
+
+    compute_t<To> operator()(data_t<Ti> in) {
+        compute_t<To> val = transform(in);
+        if (change_nan) val = IS_NAN(val) ? nanval : val;
+        return val;
+    }
+};
+
+/// Adds \p val to \p sum and the rounding error of the addition to \p comp
+template<typename T>
+inline void neumaierAdd(T &sum, T &comp, T val) {
+    const T total = sum + val;
+    comp += (std::abs(sum) >= std::abs(val)) ? (sum - total) + val
+                                             : (val - total) + sum;
+    sum = total;
+}
+
+/// Moves the part of \p comp that \p sum can represent into \p sum. The
+/// compensation is rounded too so it loses the errors it collects once it
+/// grows, which it does when many values of the same sign are added.
+template<typename T>
+inline void renormalize(T &sum, T &comp) {
+    const T total = sum + comp;
+    comp -= total - sum;
+    sum = total;
+}
+
+/// Kahan-Neumaier sum of the \p len values at \p in that are \p stride apart
+template<typename Ti, typename To, bool change_nan>
+compute_t<To> sum_kahan(data_t<Ti> const *const in, const dim_t len,
+                        const dim_t stride, const compute_t<To> nanval) {
+    using T = compute_t<To>;
+    SumInput<Ti, To, change_nan> input{{}, nanval};
+
+    T sum[kSumLanes]  = {};
+    T comp[kSumLanes] = {};
+
+    dim_t i = 0;
+    for (; i + kSumLanes <= len; i += kSumLanes) {
+        for (int l = 0; l < kSumLanes; l++) {
+            neumaierAdd(sum[l], comp[l], input(in[(i + l) * stride]));
+        }
+        if ((i / kSumLanes) % kPairwiseBlock == kPairwiseBlock - 1) {
+            for (int l = 0; l < kSumLanes; l++) {
+                renormalize(sum[l], comp[l]);
+            }
+        }
+    }
+    for (int l = 0; i < len; i++, l++) {
+        neumaierAdd(sum[l], comp[l], input(in[i * stride]));
+    }
+
+    T total = 0, error = 0;
+    for (int l = 0; l < kSumLanes; l++) {
+        neumaierAdd(total, error, sum[l]);
+        error += comp[l];
+    }
+    return total + error;
+}
+
+/// Pairwise sum of the \p len values at \p in that are \p stride apart
+template<typename Ti, typename To, bool change_nan>
+compute_t<To> sum_pairwise(data_t<Ti> const *const in, const dim_t len,
+                           const dim_t stride, const compute_t<To> nanval) {
+    using T = compute_t<To>;
+    if (len > kPairwiseBlock) {
+        const dim_t half = len / 2;
+        return sum_pairwise<Ti, To, change_nan>(in, half, stride, nanval) +
+               sum_pairwise<Ti, To, change_nan>(in + half * stride, len - half,
+                                                stride, nanval);
+    }
+
+    SumInput<Ti, To, change_nan> input{{}, nanval};
+    T sum[kSumLanes] = {};
+
+    dim_t i = 0;
+    for (; i + kSumLanes <= len; i += kSumLanes) {
+        for (int l = 0; l < kSumLanes; l++) {
+            sum[l] += input(in[(i + l) * stride]);
+        }
+    }
+    for (int l = 0; i < len; i++, l++) { sum[l] += input(in[i * stride]); }
+
+    for (int width = kSumLanes / 2; width > 0; width /= 2) {
+        for (int l = 0; l < width; l++) { sum[l] += sum[l + width]; }
+    }
+    return sum[0];
+}
+
+/// Sums the \p len values at \p in that are \p stride apart using the
+/// compensated algorithm \p summation
+template<af_op_t op, typename Ti, typename To>
+if_compensable_t<op, compute_t<To>, compute_t<To>> sum_compensated(
+    data_t<Ti> const *const in, const dim_t len, const dim_t stride,
+    const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    const compute_t<To> nan = static_cast<compute_t<To>>(nanval);
+    if (summation == AF_SUMMATION_KAHAN) {
+        return change_nan ? sum_kahan<Ti, To, true>(in, len, stride, nan)
+                          : sum_kahan<Ti, To, false>(in, len, stride, nan);
+    }
+    return change_nan ? sum_pairwise<Ti, To, true>(in, len, stride, nan)
+                      : sum_pairwise<Ti, To, false>(in, len, stride, nan);
+}
+
+/// Only floating point sums are compensated, see isCompensatedSum. Other
+/// reductions are performed in order.
+template<af_op_t op, typename Ti, typename To>
+if_not_compensable_t<op, compute_t<To>, compute_t<To>> sum_compensated(
+    data_t<Ti> const *const in, const dim_t len, const dim_t stride,
+    const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    UNUSED(summation);
+    common::Transform<data_t<Ti>, compute_t<To>, op> transform;
+    common::Binary<compute_t<To>, op> reduce;
+
+    compute_t<To> out_val = common::Binary<compute_t<To>, op>::init();
+    for (dim_t i = 0; i < len; i++) {
+        compute_t<To> in_val = transform(in[i * stride]);
+        if (change_nan) in_val = IS_NAN(in_val) ? nanval : in_val;
+        out_val = reduce(in_val, out_val);
+    }
+    return out_val;
+}
+
+/// Kahan-Neumaier sum of \p rows contiguous rows of \p cols values
+template<typename Ti, typename To, bool change_nan>
+void sum_rows_kahan(compute_t<To> *const out, data_t<Ti> const *const in,
+                    const dim_t istride, const dim_t rows, const dim_t cols,
+                    const compute_t<To> nanval) {
+    using T = compute_t<To>;
+    SumInput<Ti, To, change_nan> input{{}, nanval};
+
+    T comp[kSumColumns] = {};
+    std::fill(out, out + cols, T(0));
+    for (dim_t j = 0; j < rows; j++) {
+        data_t<Ti> const *const row = in + j * istride;
+        for (dim_t i = 0; i < cols; i++) {
+            neumaierAdd(out[i], comp[i], input(row[i]));
+        }
+        if (j % kPairwiseBlock == kPairwiseBlock - 1) {
+            for (dim_t i = 0; i < cols; i++) { renormalize(out[i], comp[i]); }
+        }
+    }
+    for (dim_t i = 0; i < cols; i++) { out[i] += comp[i]; }
+}
+
+/// Pairwise sum of \p rows contiguous rows of \p cols values. Each level of
+/// the recursion stores the sum of its second half in \p scratch.
+template<typename Ti, typename To, bool change_nan>
+void sum_rows_pairwise(compute_t<To> *const out, compute_t<To> *const scratch,
+                       data_t<Ti> const *const in, const dim_t istride,
+                       const dim_t rows, const dim_t cols,
+                       const compute_t<To> nanval) {
+    using T = compute_t<To>;
+    if (rows > kPairwiseBlock) {
+        const dim_t half = rows / 2;
+        sum_rows_pairwise<Ti, To, change_nan>(out, scratch + cols, in, istride,
+                                              half, cols, nanval);
+        sum_rows_pairwise<Ti, To, change_nan>(scratch, scratch + cols,
+                                              in + half * istride, istride,
+                                              rows - half, cols, nanval);
+        for (dim_t i = 0; i < cols; i++) { out[i] += scratch[i]; }
+        return;
+    }
+
+    SumInput<Ti, To, change_nan> input{{}, nanval};
+    std::fill(out, out + cols, T(0));
+    for (dim_t j = 0; j < rows; j++) {
+        data_t<Ti> const *const row = in + j * istride;
+        for (dim_t i = 0; i < cols; i++) { out[i] += input(row[i]); }
+    }
+}
+
+/// Sums the columns [\p begin, \p end) of \p rows contiguous rows using the
+/// compensated algorithm \p summation
+template<af_op_t op, typename Ti, typename To>
+if_compensable_t<op, compute_t<To>> sum_rows_compensated(
+    data_t<To> *const out, const dim_t ostride, data_t<Ti> const *const in,
+    const dim_t istride, const dim_t rows, const dim_t begin, const dim_t end,
+    const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    using T     = compute_t<To>;
+    const T nan = static_cast<T>(nanval);
+
+    // One block of scratch space for each level of the pairwise recursion
+    dim_t levels = 1;
+    for (dim_t r = rows; r > kPairwiseBlock; r = r - r / 2) { levels++; }
+    std::vector<T> sums(kSumColumns * (levels + 1));
+
+    for (dim_t cbegin = begin; cbegin < end; cbegin += kSumColumns) {
+        const dim_t cols               = std::min(kSumColumns, end - cbegin);
+        data_t<Ti> const *const inCols = in + cbegin;
+        T *const acc                   = sums.data();
+        T *const scratch               = sums.data() + cols;
+
+        if (summation == AF_SUMMATION_KAHAN) {
+            if (change_nan) {
+                sum_rows_kahan<Ti, To, true>(acc, inCols, istride, rows, cols,
+                                             nan);
+            } else {
+                sum_rows_kahan<Ti, To, false>(acc, inCols, istride, rows, cols,
+                                              nan);
+            }
+        } else {
+            if (change_nan) {
+                sum_rows_pairwise<Ti, To, true>(acc, scratch, inCols, istride,
+                                                rows, cols, nan);
+            } else {
+                sum_rows_pairwise<Ti, To, false>(acc, scratch, inCols, istride,
+                                                 rows, cols, nan);
+            }
+        }
+
+        for (dim_t i = 0; i < cols; i++) {
+            out[(cbegin + i) * ostride] = data_t<To>(acc[i]);
+        }
+    }
+}
+
+/// Only floating point sums are compensated, see isCompensatedSum
+template<af_op_t op, typename Ti, typename To>
+if_not_compensable_t<op, compute_t<To>> sum_rows_compensated(
+    data_t<To> *const out, const dim_t ostride, data_t<Ti> const *const in,
+    const dim_t istride, const dim_t rows, const dim_t begin, const dim_t end,
+    const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    for (dim_t i = begin; i < end; i++) {
+        out[i * ostride] = data_t<To>(sum_compensated<op, Ti, To>(
+            in + i, rows, istride, summation, change_nan, nanval));
+    }
+}
+
+/// Sums all of the values of \p in using the compensated algorithm
+/// \p summation. The sums of the rows are added with Neumaier's algorithm.
+template<af_op_t op, typename Ti, typename To>
+if_compensable_t<op, compute_t<To>, compute_t<To>> sum_all_compensated(
+    CParam<Ti> in, const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    const af::dim4 dims     = in.dims();
+    const af::dim4 strides  = in.strides();
+    data_t<Ti> const *inPtr = in.get();
+
+    compute_t<To> total = 0, error = 0;
+    for (dim_t l = 0; l < dims[3]; l++) {
+        for (dim_t k = 0; k < dims[2]; k++) {
+            for (dim_t j = 0; j < dims[1]; j++) {
+                const dim_t off =
+                    j * strides[1] + k * strides[2] + l * strides[3];
+                neumaierAdd(total, error,
+                            sum_compensated<op, Ti, To>(
+                                inPtr + off, dims[0], strides[0], summation,
+                                change_nan, nanval));
+            }
+        }
+    }
+    return total + error;
+}
+
+/// Only floating point sums are compensated, see isCompensatedSum
+template<af_op_t op, typename Ti, typename To>
+if_not_compensable_t<op, compute_t<To>, compute_t<To>> sum_all_compensated(
+    CParam<Ti> in, const af_summation_type summation, const bool change_nan,
+    const double nanval) {
+    const af::dim4 dims     = in.dims();
+    const af::dim4 strides  = in.strides();
+    data_t<Ti> const *inPtr = in.get();
+    common::Binary<compute_t<To>, op> reduce;
+
+    compute_t<To> out_val = common::Binary<compute_t<To>, op>::init();
+    for (dim_t l = 0; l < dims[3]; l++) {
+        for (dim_t k = 0; k < dims[2]; k++) {
+            for (dim_t j = 0; j < dims[1]; j++) {
+                const dim_t off =
+                    j * strides[1] + k * strides[2] + l * strides[3];
+                out_val = reduce(sum_compensated<op, Ti, To>(
+                                     inPtr + off, dims[0], strides[0],
+                                     summation, change_nan, nanval),
+                                 out_val);
+            }
+        }
+    }
+    return out_val;
+}
+
+}  // namespace kernel
+}  // namespace cpu
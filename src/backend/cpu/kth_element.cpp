@@ -0,0 +1,48 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <kth_element.hpp>
+
+#include <Array.hpp>
+#include <kernel/kth_element.hpp>
+#include <platform.hpp>
+#include <queue.hpp>
+#include <af/dim4.hpp>
+
+using af::dim4;
+using std::vector;
+
+namespace cpu {
+
+template<typename T>
+Array<T> kth_element(const Array<T> &in, const vector<dim_t> &ranks,
+                     const unsigned dim) {
+    dim4 odims = in.dims();
+    odims[dim] = static_cast<dim_t>(ranks.size());
+
+    Array<T> out = createEmptyArray<T>(odims);
+    getQueue().enqueue(kernel::kth_element<T>, out, in, ranks,
+                       static_cast<int>(dim));
+    return out;
+}
+
+#define INSTANTIATE(T)                                                    \
+    template Array<T> kth_element<T>(const Array<T> &in,                  \
+                                     const vector<dim_t> &ranks,          \
+                                     const unsigned dim);
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+INSTANTIATE(int)
+INSTANTIATE(uint)
+INSTANTIATE(short)
+INSTANTIATE(ushort)
+INSTANTIATE(uchar)
+
+}  // namespace cpu
@@ -9,11 +9,15 @@
 
 #include <match_template.hpp>
 
+#include <common/cast.hpp>
+#include <common/dispatch.hpp>
+#include <fftconvolve.hpp>
 #include <kernel/match_template.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
 #include <af/dim4.hpp>
 
+#include <cmath>
 #include <functional>
 
 using af::dim4;
@@ -23,21 +27,74 @@ namespace cpu {
 template<typename To, typename Ti>
 using matchFunc = std::function<void(Param<To>, CParam<Ti>, CParam<Ti>)>;
 
+template<typename To, typename Ti>
+using corrMatchFunc =
+    std::function<void(Param<To>, CParam<double>, CParam<Ti>, CParam<Ti>)>;
+
+/// Returns true if the metric is cheaper to compute from an FFT based cross
+/// correlation than by visiting every template pixel for every window. The
+/// absolute difference metrics cannot be written in terms of a correlation.
+static bool useCorrelation(const af::matchType mType, const dim4 &sDims,
+                           const dim4 &tDims) {
+    if (mType == AF_SAD || mType == AF_ZSAD || mType == AF_LSAD) {
+        return false;
+    }
+    // The padded size of the FFT used by fftconvolve
+    const double fftDim0 = nextpow2(static_cast<unsigned>(
+        divup(sDims[0], 2) + tDims[0] - 1));
+    const double fftDim1 =
+        nextpow2(static_cast<unsigned>(sDims[1] + tDims[1] - 1));
+    const double fftSize = fftDim0 * fftDim1;
+
+    // A few transforms and passes over the padded data against a multiply
+    // add per template pixel per window
+    const double directCost =
+        static_cast<double>(sDims[0] * sDims[1]) * tDims.elements();
+    const double fftCost = 8.0 * fftSize * std::log2(fftSize);
+    return fftCost < directCost;
+}
+
 template<typename inType, typename outType>
 Array<outType> match_template(const Array<inType> &sImg,
                               const Array<inType> &tImg,
                               const af::matchType mType) {
-    static const matchFunc<outType, inType> funcs[6] = {
+    static const matchFunc<outType, inType> funcs[8] = {
         kernel::matchTemplate<outType, inType, AF_SAD>,
         kernel::matchTemplate<outType, inType, AF_ZSAD>,
         kernel::matchTemplate<outType, inType, AF_LSAD>,
         kernel::matchTemplate<outType, inType, AF_SSD>,
         kernel::matchTemplate<outType, inType, AF_ZSSD>,
         kernel::matchTemplate<outType, inType, AF_LSSD>,
+        kernel::matchTemplate<outType, inType, AF_NCC>,
+        kernel::matchTemplate<outType, inType, AF_ZNCC>,
+    };
+    static const corrMatchFunc<outType, inType> corrFuncs[8] = {
+        nullptr,
+        nullptr,
+        nullptr,
+        kernel::matchTemplateFromCorrelation<outType, inType, AF_SSD>,
+        kernel::matchTemplateFromCorrelation<outType, inType, AF_ZSSD>,
+        kernel::matchTemplateFromCorrelation<outType, inType, AF_LSSD>,
+        kernel::matchTemplateFromCorrelation<outType, inType, AF_NCC>,
+        kernel::matchTemplateFromCorrelation<outType, inType, AF_ZNCC>,
     };
 
     Array<outType> out = createEmptyArray<outType>(sImg.dims());
-    getQueue().enqueue(funcs[static_cast<int>(mType)], out, sImg, tImg);
+    if (useCorrelation(mType, sImg.dims(), tImg.dims())) {
+        // The sums of squares are differences of values much larger than the
+        // metric at a good match, so the correlation is computed in double
+        // even for float outputs
+        Array<double> flipped = createEmptyArray<double>(tImg.dims());
+        getQueue().enqueue(kernel::flipTemplate<double, inType>, flipped,
+                           tImg);
+        Array<double> corr =
+            fftconvolve<double>(common::cast<double>(sImg), flipped, true,
+                                AF_BATCH_LHS, 2);
+        getQueue().enqueue(corrFuncs[static_cast<int>(mType)], out, corr,
+                           sImg, tImg);
+    } else {
+        getQueue().enqueue(funcs[static_cast<int>(mType)], out, sImg, tImg);
+    }
     return out;
 }
 
@@ -9,7 +9,10 @@
 
 #include <Array.hpp>
 #include <common/half.hpp>
+#include <common/summation.hpp>
+#include <copy.hpp>
 #include <kernel/mean.hpp>
+#include <kernel/reduce_jit.hpp>
 #include <mean.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
@@ -23,20 +26,40 @@ using common::half;
 
 namespace cpu {
 
+/// Returns true if the mean of \p in along \p dim can read the values from
+/// the JIT tree of \p in instead of evaluating it to a buffer first. \p dim
+/// is -1 when the mean of all the values is computed.
+template<typename Ti, typename To>
+bool isFusable(const Array<Ti> &in, const int dim) {
+    if (kernel::isCompensatedSum<af_add_t, compute_t<To>>(
+            common::getSummationType())) {
+        return false;
+    }
+    return kernel::isReadableTree(in, dim);
+}
+
 template<typename Ti, typename Tw, typename To>
 using mean_dim_func = std::function<void(
-    Param<To>, const dim_t, const CParam<Ti>, const dim_t, const int)>;
+    Param<To>, const dim_t, const CParam<Ti>, const dim_t, const int,
+    const af_summation_type)>;
 
 template<typename Ti, typename Tw, typename To>
 Array<To> mean(const Array<Ti> &in, const int dim) {
     dim4 odims    = in.dims();
     odims[dim]    = 1;
     Array<To> out = createEmptyArray<To>(odims);
+    if (isFusable<Ti, To>(in, dim)) {
+        getQueue().enqueue(kernel::mean_dim_jit<Ti, Tw, To>, out, in.getNode(),
+                           in.dims(), dim);
+        return out;
+    }
+
     static const mean_dim_func<Ti, Tw, To> mean_funcs[] = {
         kernel::mean_dim<Ti, Tw, To, 1>(), kernel::mean_dim<Ti, Tw, To, 2>(),
         kernel::mean_dim<Ti, Tw, To, 3>(), kernel::mean_dim<Ti, Tw, To, 4>()};
 
-    getQueue().enqueue(mean_funcs[in.ndims() - 1], out, 0, in, 0, dim);
+    getQueue().enqueue(mean_funcs[in.ndims() - 1], out, 0, in, 0, dim,
+                       common::getSummationType());
     return out;
 }
 
@@ -99,9 +122,24 @@ T mean(const Array<T> &in, const Array<Tw> &wt) {
 template<typename Ti, typename Tw, typename To>
 To mean(const Array<Ti> &in) {
     using MeanOpT = kernel::MeanOp<compute_t<Ti>, compute_t<To>, compute_t<Tw>>;
+    if (isFusable<Ti, To>(in, -1)) {
+        Array<To> out = createEmptyArray<To>(1);
+        getQueue().enqueue(kernel::mean_all_jit<Ti, Tw, To>, out, in.getNode(),
+                           in.dims());
+        return getScalar<To>(out);
+    }
+
     in.eval();
     getQueue().sync();
 
+    const af_summation_type summation = common::getSummationType();
+    if (kernel::isCompensatedSum<af_add_t, compute_t<To>>(summation)) {
+        compute_t<To> sum =
+            kernel::sum_all_compensated<af_add_t, Ti, To>(in, summation,
+                                                          false, 0);
+        return To(sum / compute_t<To>(in.elements()));
+    }
+
     af::dim4 dims    = in.dims();
     af::dim4 strides = in.strides();
     const Ti *inPtr  = in.get();
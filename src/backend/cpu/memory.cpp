@@ -11,7 +11,9 @@
 
 #include <common/DefaultMemoryManager.hpp>
 #include <common/Logger.hpp>
+#include <common/defines.hpp>
 #include <common/half.hpp>
+#include <common/util.hpp>
 #include <err_cpu.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
@@ -19,8 +21,21 @@
 #include <types.hpp>
 #include <af/dim4.hpp>
 
+#include <cstdlib>
+#include <string>
 #include <utility>
 
+#if defined(OS_WIN)
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(OS_LNX)
+#include <sys/syscall.h>
+#endif
+
 using af::dim4;
 using common::bytesToString;
 using common::half;
@@ -86,6 +101,13 @@ void deviceMemoryInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                               lock_buffers);
 }
 
+void deviceMemoryFragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                   size_t *free_buffers,
+                                   size_t *largest_free_bytes) {
+    memoryManager().fragmentationInfo(unused_bytes, free_bytes, free_buffers,
+                                      largest_free_bytes);
+}
+
 template<typename T>
 T *pinnedAlloc(const size_t &elements) {
     // TODO: make pinnedAlloc aware of array shapes
@@ -127,6 +149,8 @@ void Allocator::shutdown() {
         try {
             cpu::setDevice(n);
             shutdownMemoryManager();
+            // Release the memory freed on the queue before it goes away
+            getQueue().sync();
         } catch (const AfError &err) {
             continue;  // Do not throw any errors while shutting down
         }
@@ -141,18 +165,110 @@ size_t Allocator::getMaxMemorySize(int id) {
     return cpu::getDeviceMemorySize(id);
 }
 
+namespace {
+/// Every buffer is aligned to a cache line, so the kernels can use aligned
+/// vector loads on the first element
+constexpr size_t kCacheLineBytes = 64;
+
+/// Buffers of at least a huge page are aligned to a huge page, so the kernel
+/// can back them with transparent huge pages
+constexpr size_t kHugePageBytes = size_t(2) << 20;
+
+bool useHugePages() {
+    static const bool enabled = getEnvVar("AF_CPU_HUGE_PAGES") == "1";
+    return enabled;
+}
+
+void *alignedAlloc(size_t alignment, size_t bytes) {
+#if defined(OS_WIN)
+    return _aligned_malloc(bytes, alignment);
+#else
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, alignment, bytes) != 0) { return nullptr; }
+    return ptr;
+#endif
+}
+
+void alignedFree(void *ptr) {
+#if defined(OS_WIN)
+    _aligned_free(ptr);
+#else
+    free(ptr);  // NOLINT(hicpp-no-malloc)
+#endif
+}
+
+/// Asks the kernel to place the pages of a large buffer on the NUMA node of
+/// the calling thread. The pages are only placed when they are first
+/// touched, and without a preference they would land on the nodes of the
+/// worker threads that happen to touch them first. This is only a hint, so
+/// failures, for example on kernels without NUMA support, are ignored.
+void preferLocalNode(void *ptr, size_t bytes) {
+#if defined(OS_LNX) && defined(SYS_mbind) && defined(SYS_getcpu)
+    constexpr int kMpolPreferred = 1;  // MPOL_PREFERRED of linux/mempolicy.h
+    constexpr unsigned long kMaxNodes = 8 * sizeof(unsigned long);
+
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) != 0 || node >= kMaxNodes) {
+        return;
+    }
+    unsigned long nodemask = 1UL << node;
+    syscall(SYS_mbind, ptr, bytes, kMpolPreferred, &nodemask, kMaxNodes + 1,
+            0U);
+#else
+    UNUSED(ptr);
+    UNUSED(bytes);
+#endif
+}
+
+void releaseNative(void *ptr) { alignedFree(ptr); }
+}  // namespace
+
 void *Allocator::nativeAlloc(const size_t bytes) {
-    void *ptr = malloc(bytes);  // NOLINT(hicpp-no-malloc)
+    const bool large       = bytes >= kHugePageBytes;
+    const size_t alignment = large ? kHugePageBytes : kCacheLineBytes;
+    void *ptr              = alignedAlloc(alignment, bytes);
+    if (!ptr) {
+        // The buffers freed by nativeFree, including the ones the memory
+        // manager just released to make room for this one, are only returned
+        // to the system when the queue reaches them
+        queue &q = getQueue();
+        if (!q.is_worker()) {
+            q.sync();
+            ptr = alignedAlloc(alignment, bytes);
+        }
+    }
     AF_TRACE("nativeAlloc: {:>7} {}", bytesToString(bytes), ptr);
     if (!ptr) { AF_ERROR("Unable to allocate memory", AF_ERR_NO_MEM); }
+
+    if (large) {
+        // The range handed to the kernel must be page aligned. The start
+        // already is, and only the whole pages of the buffer are advised.
+        const size_t pages = bytes & ~(kHugePageBytes - 1);
+#if defined(MADV_HUGEPAGE)
+        if (useHugePages()) { madvise(ptr, pages, MADV_HUGEPAGE); }
+#endif
+        preferLocalNode(ptr, pages);
+    }
     return ptr;
 }
 
 void Allocator::nativeFree(void *ptr) {
     AF_TRACE("nativeFree: {: >8} {}", " ", ptr);
-    // Make sure this pointer is not being used on the queue before freeing the
-    // memory.
-    getQueue().sync();
-    free(ptr);  // NOLINT(hicpp-no-malloc)
+    // The functions already on the queue may still use this pointer. Instead
+    // of waiting for them, the memory is released on the queue once they are
+    // done. A worker thread frees right away because the queue is blocked on
+    // it, and it only frees the memory of the function it is running.
+    queue &q = getQueue();
+    if (q.is_worker()) {
+        alignedFree(ptr);
+    } else {
+        q.enqueue(releaseNative, ptr);
+    }
+}
+
+size_t Allocator::getSplitAlignment() {
+    // The pieces of a split buffer keep the cache line alignment, but not the
+    // huge page alignment of a large buffer
+    return kCacheLineBytes;
 }
 }  // namespace cpu
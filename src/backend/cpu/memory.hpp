@@ -40,6 +40,9 @@ void pinnedFree(T *ptr);
 
 void deviceMemoryInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                       size_t *lock_bytes, size_t *lock_buffers);
+void deviceMemoryFragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                   size_t *free_buffers,
+                                   size_t *largest_free_bytes);
 void signalMemoryCleanup();
 void shutdownMemoryManager();
 void pinnedGarbageCollect();
@@ -61,6 +64,7 @@ class Allocator final : public common::memory::AllocatorInterface {
     size_t getMaxMemorySize(int id) override;
     void *nativeAlloc(const size_t bytes) override;
     void nativeFree(void *ptr) override;
+    size_t getSplitAlignment() override;
 };
 
 }  // namespace cpu
@@ -15,6 +15,7 @@
 #include <queue.hpp>
 #include <af/dim4.hpp>
 #include <algorithm>
+#include <vector>
 
 using af::dim4;
 
@@ -57,9 +58,20 @@ Array<T> morph3d(const Array<T> &in, const Array<T> &mask, bool isDilation) {
     return out;
 }
 
-#define INSTANTIATE(T)                                                    \
-    template Array<T> morph<T>(const Array<T> &, const Array<T> &, bool); \
-    template Array<T> morph3d<T>(const Array<T> &, const Array<T> &, bool);
+template<typename T>
+bool isRectangularMask(const Array<T> &mask) {
+    std::vector<T> data(mask.elements());
+    copyData(data.data(), mask);
+
+    kernel::MaskRect rect;
+    return kernel::getMaskRect(
+        rect, CParam<T>(data.data(), mask.dims(), calcStrides(mask.dims())));
+}
+
+#define INSTANTIATE(T)                                                      \
+    template Array<T> morph<T>(const Array<T> &, const Array<T> &, bool);   \
+    template Array<T> morph3d<T>(const Array<T> &, const Array<T> &, bool); \
+    template bool isRectangularMask<T>(const Array<T> &);
 
 INSTANTIATE(float)
 INSTANTIATE(double)
@@ -15,4 +15,9 @@ Array<T> morph(const Array<T> &in, const Array<T> &mask, bool isDilation);
 
 template<typename T>
 Array<T> morph3d(const Array<T> &in, const Array<T> &mask, bool isDilation);
+
+/// Returns true if the nonzero elements of \p mask form a single rectangle.
+/// morph filters these masks in time independent of their size.
+template<typename T>
+bool isRectangularMask(const Array<T> &mask);
 }  // namespace cpu
@@ -13,9 +13,10 @@
 #include <math.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
-#include <topk.hpp>
 #include <af/dim4.hpp>
 
+#include <algorithm>
+
 using af::dim4;
 
 namespace cpu {
@@ -27,31 +28,27 @@ void nearest_neighbour(Array<uint>& idx, Array<To>& dist, const Array<T>& query,
     uint sample_dim   = (dist_dim == 0) ? 1 : 0;
     const dim4& qDims = query.dims();
     const dim4& tDims = train.dims();
-    const dim4 outDims(n_dist, qDims[sample_dim]);
-    const dim4 distDims(tDims[sample_dim], qDims[sample_dim]);
-
-    Array<To> tmp_dists = createEmptyArray<To>(distDims);
+    const dim4 outDims(std::min<dim_t>(n_dist, tDims[sample_dim]),
+                       qDims[sample_dim]);
 
     idx  = createEmptyArray<uint>(outDims);
     dist = createEmptyArray<To>(outDims);
 
     switch (dist_type) {
         case AF_SAD:
-            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SAD>,
-                               tmp_dists, query, train, dist_dim);
+            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SAD>, idx,
+                               dist, query, train, dist_dim, n_dist);
             break;
         case AF_SSD:
-            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SSD>,
-                               tmp_dists, query, train, dist_dim);
+            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SSD>, idx,
+                               dist, query, train, dist_dim, n_dist);
             break;
         case AF_SHD:
-            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SHD>,
-                               tmp_dists, query, train, dist_dim);
+            getQueue().enqueue(kernel::nearest_neighbour<T, To, AF_SHD>, idx,
+                               dist, query, train, dist_dim, n_dist);
             break;
         default: AF_ERROR("Unsupported dist_type", AF_ERR_NOT_CONFIGURED);
     }
-
-    cpu::topk(dist, idx, tmp_dists, n_dist, 0, AF_TOPK_MIN);
 }
 
 #define INSTANTIATE(T, To)                                             \
@@ -144,6 +144,10 @@ queue& getQueue(int device) {
     return DeviceManager::getInstance().queues[device];
 }
 
+ThreadPool& getThreadPool() {
+    return *DeviceManager::getInstance().threadPool;
+}
+
 void sync(int device) { getQueue(device).sync(); }
 
 bool& evalFlag() {
@@ -11,7 +11,9 @@
 #include <common/Binary.hpp>
 #include <common/Transform.hpp>
 #include <common/half.hpp>
+#include <common/summation.hpp>
 #include <kernel/reduce.hpp>
+#include <kernel/reduce_jit.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
 #include <reduce.hpp>
@@ -41,9 +43,25 @@ struct Binary<cdouble, af_add_t> {
 
 namespace cpu {
 
+/// Returns true if the reduction of \p in along \p dim can read the values
+/// from the JIT tree of \p in instead of evaluating it to a buffer first.
+/// \p dim is -1 when all the values are reduced.
 template<af_op_t op, typename Ti, typename To>
-using reduce_dim_func = std::function<void(
-    Param<To>, const dim_t, CParam<Ti>, const dim_t, const int, bool, double)>;
+bool isFusable(const Array<Ti> &in, const int dim) {
+    // The fused kernels reduce the values in chunks, which changes the order
+    // of the operations
+    if (!kernel::is_reorderable<compute_t<To>>::value ||
+        kernel::isCompensatedSum<op, compute_t<To>>(
+            common::getSummationType())) {
+        return false;
+    }
+    return kernel::isReadableTree(in, dim);
+}
+
+template<af_op_t op, typename Ti, typename To>
+using reduce_dim_func =
+    std::function<void(Param<To>, const dim_t, CParam<Ti>, const dim_t,
+                       const int, bool, double, af_summation_type)>;
 
 template<af_op_t op, typename Ti, typename To>
 Array<To> reduce(const Array<Ti> &in, const int dim, bool change_nan,
@@ -52,6 +70,12 @@ Array<To> reduce(const Array<Ti> &in, const int dim, bool change_nan,
     odims[dim] = 1;
 
     Array<To> out = createEmptyArray<To>(odims);
+    if (isFusable<op, Ti, To>(in, dim)) {
+        getQueue().enqueue(kernel::reduce_dim_jit<op, Ti, To>, out,
+                           in.getNode(), in.dims(), dim, change_nan, nanval);
+        return out;
+    }
+
     static const reduce_dim_func<op, Ti, To> reduce_funcs[4] = {
         kernel::reduce_dim<op, Ti, To, 1>(),
         kernel::reduce_dim<op, Ti, To, 2>(),
@@ -59,7 +83,7 @@ Array<To> reduce(const Array<Ti> &in, const int dim, bool change_nan,
         kernel::reduce_dim<op, Ti, To, 4>()};
 
     getQueue().enqueue(reduce_funcs[in.ndims() - 1], out, 0, in, 0, dim,
-                       change_nan, nanval);
+                       change_nan, nanval, common::getSummationType());
 
     return out;
 }
@@ -108,17 +132,24 @@ void reduce_by_key(Array<Tk> &keys_out, Array<To> &vals_out,
 }
 
 template<af_op_t op, typename Ti, typename To>
-using reduce_all_func =
-    std::function<void(Param<To>, CParam<Ti>, bool, double)>;
+using reduce_all_func = std::function<void(Param<To>, CParam<Ti>, bool,
+                                           double, af_summation_type)>;
 
 template<af_op_t op, typename Ti, typename To>
 Array<To> reduce_all(const Array<Ti> &in, bool change_nan, double nanval) {
-    in.eval();
-
     Array<To> out = createEmptyArray<To>(1);
+    if (isFusable<op, Ti, To>(in, -1)) {
+        getQueue().enqueue(kernel::reduce_all_jit<op, Ti, To>, out,
+                           in.getNode(), in.dims(), change_nan, nanval);
+        getQueue().sync();
+        return out;
+    }
+
+    in.eval();
     static const reduce_all_func<op, Ti, To> reduce_all_kernel =
         kernel::reduce_all<op, Ti, To>();
-    getQueue().enqueue(reduce_all_kernel, out, in, change_nan, nanval);
+    getQueue().enqueue(reduce_all_kernel, out, in, change_nan, nanval,
+                       common::getSummationType());
     getQueue().sync();
     return out;
 }
@@ -15,9 +15,6 @@
 #include <queue.hpp>
 #include <regions.hpp>
 #include <af/dim4.hpp>
-#include <algorithm>
-#include <map>
-#include <set>
 
 using af::dim4;
 
@@ -25,7 +22,7 @@ namespace cpu {
 
 template<typename T>
 Array<T> regions(const Array<char> &in, af_connectivity connectivity) {
-    Array<T> out = createValueArray(in.dims(), static_cast<T>(0));
+    Array<T> out = createEmptyArray<T>(in.dims());
     getQueue().enqueue(kernel::regions<T>, out, in, connectivity);
 
     return out;
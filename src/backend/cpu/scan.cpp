@@ -8,6 +8,7 @@
  ********************************************************/
 
 #include <Array.hpp>
+#include <kernel/reduce_jit.hpp>
 #include <kernel/scan.hpp>
 #include <optypes.hpp>
 #include <platform.hpp>
@@ -25,6 +26,17 @@ Array<To> scan(const Array<Ti>& in, const int dim, bool inclusive_scan) {
     const dim4& dims = in.dims();
     Array<To> out    = createEmptyArray<To>(dims);
 
+    if (kernel::isReadableTree(in, dim)) {
+        if (inclusive_scan) {
+            getQueue().enqueue(kernel::scan_dim_jit<op, Ti, To, true>, out,
+                               in.getNode(), dims, dim);
+        } else {
+            getQueue().enqueue(kernel::scan_dim_jit<op, Ti, To, false>, out,
+                               in.getNode(), dims, dim);
+        }
+        return out;
+    }
+
     if (inclusive_scan) {
         switch (in.ndims()) {
             case 1:
@@ -14,7 +14,6 @@
 #include <platform.hpp>
 #include <queue.hpp>
 #include <range.hpp>
-#include <reorder.hpp>
 #include <sort_by_key.hpp>
 
 namespace cpu {
@@ -25,36 +24,10 @@ void sort_by_key(Array<Tk> &okey, Array<Tv> &oval, const Array<Tk> &ikey,
     okey = copyArray<Tk>(ikey);
     oval = copyArray<Tv>(ival);
 
-    switch (dim) {
-        case 0:
-            getQueue().enqueue(kernel::sort0ByKey<Tk, Tv>, okey, oval,
-                               isAscending);
-            break;
-        case 1:
-        case 2:
-        case 3:
-            getQueue().enqueue(kernel::sortByKeyBatched<Tk, Tv>, okey, oval,
-                               dim, isAscending);
-            break;
-        default: AF_ERROR("Not Supported", AF_ERR_NOT_SUPPORTED);
-    }
+    if (dim > 3) { AF_ERROR("Not Supported", AF_ERR_NOT_SUPPORTED); }
 
-    if (dim != 0) {
-        af::dim4 preorderDims = okey.dims();
-        af::dim4 reorderDims(0, 1, 2, 3);
-        reorderDims[dim] = 0;
-        preorderDims[0]  = okey.dims()[dim];
-        for (int i = 1; i <= static_cast<int>(dim); i++) {
-            reorderDims[i - 1] = i;
-            preorderDims[i]    = okey.dims()[i - 1];
-        }
-
-        okey.setDataDims(preorderDims);
-        oval.setDataDims(preorderDims);
-
-        okey = reorder<Tk>(okey, reorderDims);
-        oval = reorder<Tv>(oval, reorderDims);
-    }
+    getQueue().enqueue(kernel::sortByKeyBatched<Tk, Tv>, okey, oval,
+                       static_cast<int>(dim), isAscending);
 }
 
 #define INSTANTIATE(Tk, Tv)                                        \
@@ -16,6 +16,8 @@
 #include <common/complex.hpp>
 #include <common/err_common.hpp>
 #include <complex.hpp>
+#include <kernel/sparse_blas.hpp>
+#include <kernel/spgemm.hpp>
 #include <math.hpp>
 #include <platform.hpp>
 #include <queue.hpp>
@@ -274,126 +276,6 @@ Array<T> matmul(const common::SparseArray<T> &lhs, const Array<T> &rhs,
 
 #else  // #if USE_MKL
 
-template<typename T>
-T getConjugate(const T &in) {
-    // For non-complex types return same
-    return in;
-}
-
-template<>
-cfloat getConjugate(const cfloat &in) {
-    return std::conj(in);
-}
-
-template<>
-cdouble getConjugate(const cdouble &in) {
-    return std::conj(in);
-}
-
-template<typename T, bool conjugate>
-void mv(Param<T> output, CParam<T> values, CParam<int> rowIdx,
-        CParam<int> colIdx, CParam<T> right, int M) {
-    const T *valPtr   = values.get();
-    const int *rowPtr = rowIdx.get();
-    const int *colPtr = colIdx.get();
-    const T *rightPtr = right.get();
-
-    T *outPtr = output.get();
-
-    // Output Array Created is a zero value Array
-    // Hence, no need to initialize to zero here
-    for (int i = 0; i < M; ++i) {
-        for (int j = rowPtr[i]; j < rowPtr[i + 1]; ++j) {
-            // If stride[0] of right is not 1 then rightPtr[colPtr[j]*stride]
-            if (conjugate) {
-                outPtr[i] += getConjugate(valPtr[j]) * rightPtr[colPtr[j]];
-            } else {
-                outPtr[i] += valPtr[j] * rightPtr[colPtr[j]];
-            }
-        }
-    }
-}
-
-template<typename T, bool conjugate>
-void mtv(Param<T> output, CParam<T> values, CParam<int> rowIdx,
-         CParam<int> colIdx, CParam<T> right, int M) {
-    UNUSED(M);
-
-    const T *valPtr   = values.get();
-    const int *rowPtr = rowIdx.get();
-    const int *colPtr = colIdx.get();
-    const T *rightPtr = right.get();
-    T *outPtr         = output.get();
-
-    // Output Array Created is a zero value Array
-    // Hence, no need to initialize to zero here
-    for (int i = 0; i < rowIdx.dims(0) - 1; ++i) {
-        for (int j = rowPtr[i]; j < rowPtr[i + 1]; ++j) {
-            // If stride[0] of right is not 1 then rightPtr[i*stride]
-            if (conjugate) {
-                outPtr[colPtr[j]] += getConjugate(valPtr[j]) * rightPtr[i];
-            } else {
-                outPtr[colPtr[j]] += valPtr[j] * rightPtr[i];
-            }
-        }
-    }
-}
-
-template<typename T, bool conjugate>
-void mm(Param<T> output, CParam<T> values, CParam<int> rowIdx,
-        CParam<int> colIdx, CParam<T> right, int M, int N, int ldb, int ldc) {
-    UNUSED(M);
-    const T *valPtr   = values.get();
-    const int *rowPtr = rowIdx.get();
-    const int *colPtr = colIdx.get();
-    const T *rightPtr = right.get();
-    T *outPtr         = output.get();
-
-    for (int o = 0; o < N; ++o) {
-        for (int i = 0; i < rowIdx.dims(0) - 1; ++i) {
-            outPtr[i] = scalar<T>(0);
-            for (int j = rowPtr[i]; j < rowPtr[i + 1]; ++j) {
-                // If stride[0] of right is not 1 then
-                // rightPtr[colPtr[j]*stride]
-                if (conjugate) {
-                    outPtr[i] += getConjugate(valPtr[j]) * rightPtr[colPtr[j]];
-                } else {
-                    outPtr[i] += valPtr[j] * rightPtr[colPtr[j]];
-                }
-            }
-        }
-        rightPtr += ldb;
-        outPtr += ldc;
-    }
-}
-
-template<typename T, bool conjugate>
-void mtm(Param<T> output, CParam<T> values, CParam<int> rowIdx,
-         CParam<int> colIdx, CParam<T> right, int M, int N, int ldb, int ldc) {
-    const T *valPtr   = values.get();
-    const int *rowPtr = rowIdx.get();
-    const int *colPtr = colIdx.get();
-    const T *rightPtr = right.get();
-    T *outPtr         = output.get();
-
-    for (int o = 0; o < N; ++o) {
-        for (int i = 0; i < M; ++i) { outPtr[i] = scalar<T>(0); }
-
-        for (int i = 0; i < rowIdx.dims(0) - 1; ++i) {
-            for (int j = rowPtr[i]; j < rowPtr[i + 1]; ++j) {
-                // If stride[0] of right is not 1 then rightPtr[i*stride]
-                if (conjugate) {
-                    outPtr[colPtr[j]] += getConjugate(valPtr[j]) * rightPtr[i];
-                } else {
-                    outPtr[colPtr[j]] += valPtr[j] * rightPtr[i];
-                }
-            }
-        }
-        rightPtr += ldb;
-        outPtr += ldc;
-    }
-}
-
 template<typename T>
 Array<T> matmul(const common::SparseArray<T> &lhs, const Array<T> &rhs,
                 af_mat_prop optLhs, af_mat_prop optRhs) {
@@ -411,50 +293,56 @@ Array<T> matmul(const common::SparseArray<T> &lhs, const Array<T> &rhs,
     int M             = lDims[lRowDim];
     int N             = rDims[rColDim];
 
-    Array<T> out = createValueArray<T>(af::dim4(M, N, 1, 1), scalar<T>(0));
-
-    auto func = [=](Param<T> output, CParam<T> values, CParam<int> rowIdx,
-                    CParam<int> colIdx, CParam<T> right) {
-        int ldb = right.strides(1);
-        int ldc = output.strides(1);
-
-        if (rDims[rColDim] == 1) {
-            if (lOpts == SPARSE_OPERATION_NON_TRANSPOSE) {
-                mv<T, false>(output, values, rowIdx, colIdx, right, M);
-            } else if (lOpts == SPARSE_OPERATION_TRANSPOSE) {
-                mtv<T, false>(output, values, rowIdx, colIdx, right, M);
-            } else if (lOpts == SPARSE_OPERATION_CONJUGATE_TRANSPOSE) {
-                mtv<T, true>(output, values, rowIdx, colIdx, right, M);
-            }
-        } else {
-            if (lOpts == SPARSE_OPERATION_NON_TRANSPOSE) {
-                mm<T, false>(output, values, rowIdx, colIdx, right, M, N, ldb,
-                             ldc);
-            } else if (lOpts == SPARSE_OPERATION_TRANSPOSE) {
-                mtm<T, false>(output, values, rowIdx, colIdx, right, M, N, ldb,
-                              ldc);
-            } else if (lOpts == SPARSE_OPERATION_CONJUGATE_TRANSPOSE) {
-                mtm<T, true>(output, values, rowIdx, colIdx, right, M, N, ldb,
-                             ldc);
-            }
-        }
-    };
+    // Every element of the output is written by the kernel
+    Array<T> out = createEmptyArray<T>(af::dim4(M, N, 1, 1));
 
     const Array<T> values   = lhs.getValues();
     const Array<int> rowIdx = lhs.getRowIdx();
     const Array<int> colIdx = lhs.getColIdx();
 
-    getQueue().enqueue(func, out, values, rowIdx, colIdx, rhs);
+    getQueue().enqueue(kernel::csrmm<T>, out, values, rowIdx, colIdx, rhs,
+                       optLhs);
 
     return out;
 }
 
 #endif  // #if USE_MKL
 
+template<typename T>
+common::SparseArray<T> matmul(const common::SparseArray<T> &lhs,
+                              const common::SparseArray<T> &rhs) {
+    const int M = static_cast<int>(lhs.dims()[0]);
+    const int N = static_cast<int>(rhs.dims()[1]);
+
+    const Array<int> lRowIdx = lhs.getRowIdx();
+    const Array<int> lColIdx = lhs.getColIdx();
+    const Array<int> rRowIdx = rhs.getRowIdx();
+    const Array<int> rColIdx = rhs.getColIdx();
+
+    // The symbolic pass sizes the output, so it has to finish first
+    auto rowIdx = createEmptyArray<int>(dim4(M + 1));
+    getQueue().enqueue(kernel::spgemmNnz, rowIdx, lRowIdx, lColIdx, rRowIdx,
+                       rColIdx, N);
+    getQueue().sync();
+
+    const dim_t nnz = rowIdx.get()[M];
+    auto values     = createEmptyArray<T>(dim4(nnz));
+    auto colIdx     = createEmptyArray<int>(dim4(nnz));
+
+    getQueue().enqueue(kernel::spgemm<T>, values, colIdx, rowIdx,
+                       lhs.getValues(), lRowIdx, lColIdx, rhs.getValues(),
+                       rRowIdx, rColIdx, N);
+
+    return common::createArrayDataSparseArray<T>(dim4(M, N), values, rowIdx,
+                                                 colIdx, AF_STORAGE_CSR);
+}
+
 #define INSTANTIATE_SPARSE(T)                                            \
     template Array<T> matmul<T>(const common::SparseArray<T> &lhs,       \
                                 const Array<T> &rhs, af_mat_prop optLhs, \
-                                af_mat_prop optRhs);
+                                af_mat_prop optRhs);                     \
+    template common::SparseArray<T> matmul<T>(                           \
+        const common::SparseArray<T> &lhs, const common::SparseArray<T> &rhs);
 
 INSTANTIATE_SPARSE(float)
 INSTANTIATE_SPARSE(double)
@@ -0,0 +1,187 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <thread_pool.hpp>
+
+#include <common/util.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+using std::function;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::thread;
+using std::try_to_lock;
+using std::unique_lock;
+
+namespace cpu {
+
+namespace {
+/// Set while the thread is executing the tasks of a job
+thread_local bool executing_tasks = false;
+
+class ExecutingGuard {
+   public:
+    ExecutingGuard() { executing_tasks = true; }
+    ~ExecutingGuard() { executing_tasks = false; }
+};
+}  // namespace
+
+unsigned getNumThreads() {
+    string env_var = getEnvVar("AF_CPU_NUM_THREADS");
+    if (!env_var.empty()) {
+        // Values that are not a positive thread count are ignored
+        char *end        = nullptr;
+        errno            = 0;
+        long num_threads = std::strtol(env_var.c_str(), &end, 10);
+        if (errno == 0 && *end == '\0' && num_threads > 0 &&
+            num_threads <= std::numeric_limits<int>::max()) {
+            return static_cast<unsigned>(num_threads);
+        }
+    }
+    return std::max(thread::hardware_concurrency(), 1U);
+}
+
+ThreadPool::ThreadPool(unsigned num_threads) : generation(0), stop(false) {
+    unsigned nworkers = std::max(num_threads, 1U) - 1;
+    workers.reserve(nworkers);
+    for (unsigned i = 0; i < nworkers; i++) {
+        // Id 0 is reserved for the thread calling run
+        workers.emplace_back([this, i] { work(i + 1); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(jobMutex);
+        stop = true;
+    }
+    jobAvailable.notify_all();
+    for (thread &worker : workers) { worker.join(); }
+}
+
+bool ThreadPool::is_worker() noexcept { return executing_tasks; }
+
+bool ThreadPool::steal(Job &job, unsigned id) {
+    for (unsigned i = 1; i < job.num_ranges; i++) {
+        TaskRange &victim = job.ranges[(id + i) % job.num_ranges];
+        int begin, end;
+        {
+            lock_guard<mutex> lock(victim.lock);
+            int remaining = victim.end - victim.begin;
+            if (remaining <= 0) { continue; }
+            end        = victim.end;
+            begin      = end - (remaining + 1) / 2;
+            victim.end = begin;
+        }
+        TaskRange &own = job.ranges[id];
+        lock_guard<mutex> lock(own.lock);
+        own.begin = begin;
+        own.end   = end;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::execute(Job &job, unsigned id) {
+    ExecutingGuard guard;
+    TaskRange &own = job.ranges[id];
+    do {
+        while (true) {
+            int task;
+            {
+                lock_guard<mutex> lock(own.lock);
+                if (own.begin >= own.end) { break; }
+                task = own.begin++;
+            }
+            try {
+                (*job.func)(task);
+            } catch (...) {
+                lock_guard<mutex> lock(job.error_mutex);
+                if (!job.error) { job.error = std::current_exception(); }
+            }
+            job.done.fetch_add(1);
+        }
+    } while (steal(job, id));
+}
+
+void ThreadPool::work(unsigned id) {
+    unsigned long seen = 0;
+    while (true) {
+        shared_ptr<Job> job;
+        {
+            unique_lock<mutex> lock(jobMutex);
+            jobAvailable.wait(lock,
+                              [&] { return stop || generation != seen; });
+            if (stop) { return; }
+            seen = generation;
+            job  = current;
+        }
+        // The job may have been completed by the other threads before this
+        // one woke up
+        if (!job) { continue; }
+        execute(*job, id);
+        if (job->done.load() == job->num_tasks) {
+            lock_guard<mutex> lock(jobMutex);
+            jobFinished.notify_all();
+        }
+    }
+}
+
+void ThreadPool::run(int num_tasks, const function<void(int)> &func) {
+    if (num_tasks <= 0) { return; }
+
+    if (workers.empty() || num_tasks == 1 || is_worker()) {
+        for (int i = 0; i < num_tasks; i++) { func(i); }
+        return;
+    }
+    unique_lock<mutex> run_lock(runMutex, try_to_lock);
+    if (!run_lock.owns_lock()) {
+        for (int i = 0; i < num_tasks; i++) { func(i); }
+        return;
+    }
+
+    auto job        = make_shared<Job>();
+    job->func       = &func;
+    job->num_ranges = size();
+    job->num_tasks  = num_tasks;
+    job->done       = 0;
+    job->ranges.reset(new TaskRange[job->num_ranges]);
+    for (unsigned i = 0; i < job->num_ranges; i++) {
+        job->ranges[i].begin = static_cast<int>(
+            static_cast<long long>(num_tasks) * i / job->num_ranges);
+        job->ranges[i].end = static_cast<int>(
+            static_cast<long long>(num_tasks) * (i + 1) / job->num_ranges);
+    }
+    {
+        lock_guard<mutex> lock(jobMutex);
+        current = job;
+        generation++;
+    }
+    jobAvailable.notify_all();
+
+    execute(*job, 0);
+    {
+        unique_lock<mutex> lock(jobMutex);
+        jobFinished.wait(lock,
+                         [&] { return job->done.load() == job->num_tasks; });
+        current.reset();
+    }
+
+    if (job->error) { std::rethrow_exception(job->error); }
+}
+
+}  // namespace cpu
@@ -0,0 +1,147 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+
+#include <af/defines.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cpu {
+
+/// A fixed size pool of threads used to split a single kernel across the
+/// cores of the host.
+///
+/// Kernels are still enqueued on cpu::queue, which decides the order in which
+/// they execute. A kernel running on the queue thread can hand independent
+/// pieces of its work to this pool through ThreadPool::run or parallel_for.
+/// The calling thread takes part in the work and returns only after every
+/// task has finished.
+///
+/// The tasks of a job are split evenly between the threads up front. A thread
+/// that runs out of tasks steals half of the remaining tasks of another
+/// thread, so uneven tasks do not leave cores idle.
+class ThreadPool {
+   public:
+    /// Creates a pool that executes tasks on \p num_threads threads. One of
+    /// these is always the thread calling run so num_threads - 1 workers are
+    /// spawned.
+    explicit ThreadPool(unsigned num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Returns the number of threads executing tasks, including the caller
+    unsigned size() const noexcept {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    /// Calls \p func once for every index in [0, num_tasks) and blocks until
+    /// all of the calls have returned.
+    ///
+    /// The tasks are executed serially on the calling thread if the pool is
+    /// already executing a job for another thread or if it is called from
+    /// within a task. The first exception thrown by a task is rethrown here.
+    void run(int num_tasks, const std::function<void(int)> &func);
+
+    /// Returns true if the calling thread is currently executing a task
+    static bool is_worker() noexcept;
+
+   private:
+    /// The tasks [begin, end) owned by one of the threads
+    struct TaskRange {
+        std::mutex lock;
+        int begin = 0;
+        int end   = 0;
+    };
+
+    struct Job {
+        const std::function<void(int)> *func;
+        std::unique_ptr<TaskRange[]> ranges;
+        unsigned num_ranges;
+        int num_tasks;
+        std::atomic<int> done;
+        std::exception_ptr error;
+        std::mutex error_mutex;
+    };
+
+    void work(unsigned id);
+    static void execute(Job &job, unsigned id);
+    static bool steal(Job &job, unsigned id);
+
+    std::vector<std::thread> workers;
+    std::shared_ptr<Job> current;
+    unsigned long generation;
+    bool stop;
+    std::mutex jobMutex;
+    std::mutex runMutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobFinished;
+};
+
+/// Returns the number of threads used by the thread pool. This is the value
+/// of the AF_CPU_NUM_THREADS environment variable if it is set and the
+/// number of hardware threads otherwise.
+unsigned getNumThreads();
+
+ThreadPool &getThreadPool();
+
+/// The number of elements a task should process at least for the parallel
+/// execution to be worth the synchronization
+constexpr dim_t kMinElementsPerTask = 1 << 14;
+
+/// Returns the grain for parallel_for over items which each process
+/// \p elements_per_item elements
+inline dim_t grainFor(dim_t elements_per_item) {
+    return std::max<dim_t>(
+        1, kMinElementsPerTask / std::max<dim_t>(elements_per_item, 1));
+}
+
+/// Splits the range [\p begin, \p end) into chunks and calls
+/// func(chunk_begin, chunk_end) for each of them on the thread pool.
+///
+/// Every chunk except the last one is a multiple of \p grain elements long and
+/// starts at begin + k * grain. Small ranges are processed on the calling
+/// thread without involving the pool.
+template<typename F>
+void parallel_for(dim_t begin, dim_t end, dim_t grain, F &&func) {
+    constexpr dim_t kTasksPerThread = 8;
+
+    const dim_t len = end - begin;
+    if (len <= 0) { return; }
+    grain = std::max<dim_t>(grain, 1);
+
+    ThreadPool &pool = getThreadPool();
+    dim_t ngrains    = (len + grain - 1) / grain;
+    if (ngrains < 2 || pool.size() < 2 || ThreadPool::is_worker()) {
+        func(begin, end);
+        return;
+    }
+
+    dim_t ntasks = std::min<dim_t>(ngrains, pool.size() * kTasksPerThread);
+    dim_t chunk  = ((ngrains + ntasks - 1) / ntasks) * grain;
+    ntasks       = (len + chunk - 1) / chunk;
+
+    pool.run(static_cast<int>(ntasks), [&](int task) {
+        dim_t cbegin = begin + task * chunk;
+        dim_t cend   = std::min(cbegin + chunk, end);
+        func(cbegin, cend);
+    });
+}
+
+}  // namespace cpu
@@ -11,20 +11,11 @@
 #include <common/kernel_type.hpp>
 #include <complex>
 
-namespace cpu {
-
-namespace {
-template<typename T>
-const char *shortname(bool caps = false) {
-    return caps ? "?" : "?";
-}
-
-template<typename T>
-const char *getFullName() {
-    return "N/A";
+namespace common {
+class half;
 }
 
-}  // namespace
+namespace cpu {
 
 using cdouble = std::complex<double>;
 using cfloat  = std::complex<float>;
@@ -40,6 +31,74 @@ using compute_t = typename common::kernel_type<T>::compute;
 template<typename T>
 using data_t = typename common::kernel_type<T>::data;
 
+namespace {
+template<typename T>
+inline const char *shortname(bool caps = false) {
+    return caps ? "?" : "?";
+}
+
+#define SHORTNAME(T, NAME, CAPS_NAME)            \
+    template<>                                   \
+    inline const char *shortname<T>(bool caps) { \
+        return caps ? CAPS_NAME : NAME;          \
+    }
+
+SHORTNAME(float, "s", "S")
+SHORTNAME(double, "d", "D")
+SHORTNAME(cfloat, "c", "C")
+SHORTNAME(cdouble, "z", "Z")
+SHORTNAME(int, "i", "I")
+SHORTNAME(uint, "u", "U")
+SHORTNAME(char, "j", "J")
+SHORTNAME(uchar, "v", "V")
+SHORTNAME(intl, "x", "X")
+SHORTNAME(uintl, "y", "Y")
+SHORTNAME(short, "p", "P")
+SHORTNAME(ushort, "q", "Q")
+SHORTNAME(common::half, "h", "H")
+
+#undef SHORTNAME
+
+template<typename T>
+inline const char *getFullName() {
+    return "N/A";
+}
+
+#define SPECIALIZE(T)                     \
+    template<>                            \
+    inline const char *getFullName<T>() { \
+        return #T;                        \
+    }
+
+SPECIALIZE(float)
+SPECIALIZE(double)
+SPECIALIZE(char)
+SPECIALIZE(unsigned char)
+SPECIALIZE(short)
+SPECIALIZE(unsigned short)
+SPECIALIZE(int)
+SPECIALIZE(unsigned int)
+SPECIALIZE(unsigned long long)
+SPECIALIZE(long long)
+
+template<>
+inline const char *getFullName<cfloat>() {
+    return "cfloat";
+}
+
+template<>
+inline const char *getFullName<cdouble>() {
+    return "cdouble";
+}
+
+template<>
+inline const char *getFullName<common::half>() {
+    return "half";
+}
+
+#undef SPECIALIZE
+}  // namespace
+
 }  // namespace cpu
 
 namespace common {
@@ -10,13 +10,17 @@
 #include <Array.hpp>
 #include <common/Binary.hpp>
 #include <common/Transform.hpp>
+#include <common/dispatch.hpp>
 #include <math.hpp>
 #include <memory.hpp>
 #include <platform.hpp>
+#include <thread_pool.hpp>
 #include <where.hpp>
 #include <af/dim4.hpp>
 
+#include <algorithm>
 #include <complex>
+#include <numeric>
 #include <vector>
 
 using af::dim4;
@@ -33,28 +37,45 @@ Array<uint> where(const Array<T> &in) {
     auto out_vec  = memAlloc<uint>(in.elements());
     getQueue().sync();
 
-    dim_t count = 0;
-    dim_t idx   = 0;
-    for (dim_t w = 0; w < dims[3]; w++) {
-        uint offw = w * strides[3];
+    // The rows are split into chunks. The first pass counts the non zero
+    // elements of each chunk and the second one writes their indices starting
+    // at the offset of the chunk.
+    ThreadPool &pool    = getThreadPool();
+    const dim_t nrows   = dims[1] * dims[2] * dims[3];
+    const dim_t nchunks = std::max<dim_t>(
+        1, std::min<dim_t>(divup(nrows, grainFor(dims[0])), pool.size() * 8));
+    const dim_t rows_per_chunk = divup(nrows, nchunks);
 
-        for (dim_t z = 0; z < dims[2]; z++) {
-            uint offz = offw + z * strides[2];
+    auto visitChunk = [&](dim_t chunk, auto &&func) {
+        dim_t rbegin = chunk * rows_per_chunk;
+        dim_t rend   = std::min(rbegin + rows_per_chunk, nrows);
+        for (dim_t row = rbegin; row < rend; row++) {
+            dim_t y = row % dims[1];
+            dim_t z = (row / dims[1]) % dims[2];
+            dim_t w = row / (dims[1] * dims[2]);
 
-            for (dim_t y = 0; y < dims[1]; y++) {
-                uint offy = y * strides[1] + offz;
-
-                for (dim_t x = 0; x < dims[0]; x++) {
-                    T val = iptr[offy + x];
-                    if (val != zero) {
-                        out_vec[count] = idx;
-                        count++;
-                    }
-                    idx++;
-                }
+            const T *rptr =
+                iptr + y * strides[1] + z * strides[2] + w * strides[3];
+            for (dim_t x = 0; x < dims[0]; x++) {
+                if (rptr[x] != zero) { func(row * dims[0] + x); }
             }
         }
-    }
+    };
+
+    std::vector<dim_t> offsets(nchunks + 1, 0);
+    pool.run(static_cast<int>(nchunks), [&](int chunk) {
+        dim_t chunk_count = 0;
+        visitChunk(chunk, [&](dim_t) { chunk_count++; });
+        offsets[chunk + 1] = chunk_count;
+    });
+    std::partial_sum(begin(offsets), end(offsets), begin(offsets));
+
+    pool.run(static_cast<int>(nchunks), [&](int chunk) {
+        uint *optr = out_vec.get() + offsets[chunk];
+        visitChunk(chunk,
+                   [&](dim_t idx) { *optr++ = static_cast<uint>(idx); });
+    });
+    dim_t count = offsets[nchunks];
 
     Array<uint> out = createDeviceDataArray<uint>(dim4(count), out_vec.get());
     out_vec.release();
@@ -18,6 +18,7 @@
 #include <scalar.hpp>
 #include <af/dim4.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
 #include <numeric>
@@ -181,41 +182,58 @@ T *Array<T>::device() {
 }
 
 template<typename T>
-void evalMultiple(std::vector<Array<T> *> arrays) {
-    vector<Param<T>> output_params;
-    vector<Array<T> *> output_arrays;
-    vector<Node *> nodes;
-
-    // Check if all the arrays have the same dimension
-    auto it = std::adjacent_find(begin(arrays), end(arrays),
-                                 [](const Array<T> *l, const Array<T> *r) {
-                                     return l->dims() != r->dims();
-                                 });
-
-    // If they are not the same. eval individually
-    if (it != end(arrays)) {
-        for (auto ptr : arrays) { ptr->eval(); }
-        return;
+void EvalGroup::add(Array<T> &array) {
+    if (array.isReady()) { return; }
+
+    // The same array may be passed more than once
+    for (const Output &output : m_outputs) {
+        if (output.array_node == &array.node) { return; }
     }
 
-    for (Array<T> *array : arrays) {
-        if (array->isReady()) { continue; }
+    array.setId(getActiveDeviceId());
+    array.data =
+        shared_ptr<T>(memAlloc<T>(array.elements()).release(), memFree<T>);
+
+    m_outputs.push_back({Param<void>(array.getData().get(),
+                                     array.dims().get(),
+                                     array.strides().get()),
+                         array.node, &array.node});
+}
 
-        array->setId(getActiveDeviceId());
-        array->data =
-            shared_ptr<T>(memAlloc<T>(array->elements()).release(), memFree<T>);
+void EvalGroup::run() {
+    // Arrays with different dimensions can not be written by the same kernel,
+    // so there is one kernel per shape
+    auto sameDims = [](const Param<void> &l, const Param<void> &r) {
+        return std::equal(l.dims, l.dims + 4, r.dims);
+    };
+
+    vector<bool> done(m_outputs.size(), false);
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        if (done[i]) { continue; }
+
+        vector<Param<void>> outputs;
+        vector<Node *> nodes;
+        for (size_t j = i; j < m_outputs.size(); j++) {
+            if (done[j] || !sameDims(m_outputs[j].param, m_outputs[i].param)) {
+                continue;
+            }
+            outputs.push_back(m_outputs[j].param);
+            nodes.push_back(m_outputs[j].node.get());
+            done[j] = true;
+        }
 
-        output_params.emplace_back(array->getData().get(), array->dims().get(),
-                                   array->strides().get());
-        output_arrays.push_back(array);
-        nodes.push_back(array->getNode().get());
+        evalNodes(outputs, nodes);
     }
 
-    if (output_params.empty()) return;
-
-    evalNodes(output_params, nodes);
+    for (Output &output : m_outputs) { output.array_node->reset(); }
+    m_outputs.clear();
+}
 
-    for (Array<T> *array : output_arrays) { array->node.reset(); }
+template<typename T>
+void evalMultiple(std::vector<Array<T> *> arrays) {
+    EvalGroup group;
+    for (Array<T> *array : arrays) { group.add(*array); }
+    group.run();
 }
 
 template<typename T>
@@ -321,6 +339,14 @@ kJITHeuristics passesJitHeuristics(span<Node *> root_nodes) {
     return kJITHeuristics::Pass;
 }
 
+template<typename T>
+int selectJitEvalNode(span<Node *> root_nodes) {
+    auto tallest = std::max_element(
+        std::begin(root_nodes), std::end(root_nodes),
+        [](Node *l, Node *r) { return l->getHeight() < r->getHeight(); });
+    return static_cast<int>(tallest - std::begin(root_nodes));
+}
+
 template<typename T>
 Array<T> createNodeArray(const dim4 &dims, Node_ptr node) {
     verifyTypeSupport<T>();
@@ -455,7 +481,9 @@ void Array<T>::setDataDims(const dim4 &new_dims) {
     template void writeDeviceDataArray<T>(                                    \
         Array<T> & arr, const void *const data, const size_t bytes);          \
     template void evalMultiple<T>(std::vector<Array<T> *> arrays);            \
+    template void EvalGroup::add<T>(Array<T> & array);                        \
     template kJITHeuristics passesJitHeuristics<T>(span<Node *> n);           \
+    template int selectJitEvalNode<T>(span<Node *> n);                        \
     template void Array<T>::setDataDims(const dim4 &new_dims);
 
 INSTANTIATE(float)
@@ -41,6 +41,29 @@ void evalNodes(std::vector<Param<T>> &out,
 template<typename T>
 void evalMultiple(std::vector<Array<T> *> arrays);
 
+/// Evaluates arrays of different types together. The arrays that have the
+/// same dimensions are written by a single kernel, so the nodes their trees
+/// share are only evaluated once.
+class EvalGroup {
+   public:
+    /// Allocates the buffer of \p array and adds its tree to the group.
+    /// Arrays that are already evaluated are skipped.
+    template<typename T>
+    void add(Array<T> &array);
+
+    /// Evaluates the arrays that were added to the group
+    void run();
+
+   private:
+    struct Output {
+        Param<void> param;
+        common::Node_ptr node;
+        // The node of the array, which is released once it is evaluated
+        common::Node_ptr *array_node;
+    };
+    std::vector<Output> m_outputs;
+};
+
 template<typename T>
 Array<T> createNodeArray(const af::dim4 &dims, common::Node_ptr node);
 
@@ -106,6 +129,14 @@ void destroyArray(Array<T> *A);
 template<typename T>
 kJITHeuristics passesJitHeuristics(nonstd::span<common::Node *> node);
 
+/// \brief Selects the node to evaluate when passesJitHeuristics fails
+///
+/// \param [in] node The root nodes which were checked
+///
+/// \returns the index of the tallest node
+template<typename T>
+int selectJitEvalNode(nonstd::span<common::Node *> node);
+
 template<typename T>
 void *getDevicePtr(const Array<T> &arr) {
     T *ptr = arr.device();
@@ -263,6 +294,7 @@ class Array {
     common::Node_ptr getNode() const;
 
     friend void evalMultiple<T>(std::vector<Array<T> *> arrays);
+    friend class EvalGroup;
     friend Array<T> createValueArray<T>(const af::dim4 &size, const T &value);
     friend Array<T> createHostDataArray<T>(const af::dim4 &dims,
                                            const T *const data);
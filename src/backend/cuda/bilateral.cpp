@@ -18,15 +18,19 @@ namespace cuda {
 
 template<typename inType, typename outType>
 Array<outType> bilateral(const Array<inType> &in, const float &sSigma,
-                         const float &cSigma) {
+                         const float &cSigma,
+                         const af_bilateral_method method) {
+    // The bilateral grid is only implemented by the CPU backend
+    UNUSED(method);
     Array<outType> out = createEmptyArray<outType>(in.dims());
     kernel::bilateral<inType, outType>(out, in, sSigma, cSigma);
     return out;
 }
 
-#define INSTANTIATE(inT, outT)                                    \
-    template Array<outT> bilateral<inT, outT>(const Array<inT> &, \
-                                              const float &, const float &);
+#define INSTANTIATE(inT, outT)                                   \
+    template Array<outT> bilateral<inT, outT>(                   \
+        const Array<inT> &, const float &, const float &,        \
+        const af_bilateral_method);
 
 INSTANTIATE(double, double)
 INSTANTIATE(float, float)
@@ -22,6 +22,9 @@ DEFINE_HANDLER(cusparseMatDescr_t, cuda::getCusparsePlugin().cusparseCreateMatDe
 DEFINE_HANDLER(cusparseSpMatDescr_t, cuda::getCusparsePlugin().cusparseCreateCsr, cuda::getCusparsePlugin().cusparseDestroySpMat);
 DEFINE_HANDLER(cusparseDnVecDescr_t, cuda::getCusparsePlugin().cusparseCreateDnVec, cuda::getCusparsePlugin().cusparseDestroyDnVec);
 DEFINE_HANDLER(cusparseDnMatDescr_t, cuda::getCusparsePlugin().cusparseCreateDnMat, cuda::getCusparsePlugin().cusparseDestroyDnMat);
+#if CUDA_VERSION >= 11000
+DEFINE_HANDLER(cusparseSpGEMMDescr_t, cuda::getCusparsePlugin().cusparseSpGEMM_createDescr, cuda::getCusparsePlugin().cusparseSpGEMM_destroyDescr);
+#endif
 #endif
 // clang-format on
 
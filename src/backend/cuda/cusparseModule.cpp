@@ -100,6 +100,13 @@ cusparseModule::cusparseModule()
     MODULE_FUNCTION_INIT(cusparseCcsrgeam2);
     MODULE_FUNCTION_INIT(cusparseZcsrgeam2_bufferSizeExt);
     MODULE_FUNCTION_INIT(cusparseZcsrgeam2);
+    MODULE_FUNCTION_INIT(cusparseCsrSetPointers);
+    MODULE_FUNCTION_INIT(cusparseSpGEMM_compute);
+    MODULE_FUNCTION_INIT(cusparseSpGEMM_copy);
+    MODULE_FUNCTION_INIT(cusparseSpGEMM_createDescr);
+    MODULE_FUNCTION_INIT(cusparseSpGEMM_destroyDescr);
+    MODULE_FUNCTION_INIT(cusparseSpGEMM_workEstimation);
+    MODULE_FUNCTION_INIT(cusparseSpMatGetSize);
 #else
     MODULE_FUNCTION_INIT(cusparseScsrgeam);
     MODULE_FUNCTION_INIT(cusparseDcsrgeam);
@@ -75,6 +75,13 @@ class cusparseModule {
     MODULE_MEMBER(cusparseScsrgeam2);
     MODULE_MEMBER(cusparseZcsrgeam2_bufferSizeExt);
     MODULE_MEMBER(cusparseZcsrgeam2);
+    MODULE_MEMBER(cusparseCsrSetPointers);
+    MODULE_MEMBER(cusparseSpGEMM_compute);
+    MODULE_MEMBER(cusparseSpGEMM_copy);
+    MODULE_MEMBER(cusparseSpGEMM_createDescr);
+    MODULE_MEMBER(cusparseSpGEMM_destroyDescr);
+    MODULE_MEMBER(cusparseSpGEMM_workEstimation);
+    MODULE_MEMBER(cusparseSpMatGetSize);
 #else
     MODULE_MEMBER(cusparseXcsrgeamNnz);
     MODULE_MEMBER(cusparseCcsrgeam);
@@ -28,6 +28,8 @@ void setFFTPlanCacheSize(size_t numPlans) {
     fftManager().setMaxCacheSize(numPlans);
 }
 
+void setFFTNumThreads(unsigned numThreads) { UNUSED(numThreads); }
+
 template<typename T>
 struct cufft_transform;
 
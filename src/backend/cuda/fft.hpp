@@ -13,6 +13,8 @@ namespace cuda {
 
 void setFFTPlanCacheSize(size_t numPlans);
 
+void setFFTNumThreads(unsigned numThreads);
+
 template<typename T>
 void fft_inplace(Array<T> &out, const int rank, const bool direction);
 
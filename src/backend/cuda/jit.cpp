@@ -205,6 +205,38 @@ static CUfunction getKernel(const vector<Node *> &output_nodes,
     return common::getKernel(entry, funcName, true).get();
 }
 
+/// Sets the shape of the buffer node \p node, whose type can differ from the
+/// types of the outputs of the tree
+template<typename T>
+static void setBufferShape(Node *node, const af::dim4 &dims,
+                           const af::dim4 &strides) {
+    jit::BufferNode<T> *buf = static_cast<jit::BufferNode<T> *>(node);
+    for (int i = 0; i < 4; i++) {
+        buf->m_param.dims[i]    = dims[i];
+        buf->m_param.strides[i] = strides[i];
+    }
+}
+
+static void setBufferShape(Node *node, const af::dim4 &dims,
+                           const af::dim4 &strides) {
+    switch (node->getType()) {
+        case f32: setBufferShape<float>(node, dims, strides); break;
+        case f64: setBufferShape<double>(node, dims, strides); break;
+        case c32: setBufferShape<cfloat>(node, dims, strides); break;
+        case c64: setBufferShape<cdouble>(node, dims, strides); break;
+        case s32: setBufferShape<int>(node, dims, strides); break;
+        case u32: setBufferShape<uint>(node, dims, strides); break;
+        case u8: setBufferShape<uchar>(node, dims, strides); break;
+        case b8: setBufferShape<char>(node, dims, strides); break;
+        case s64: setBufferShape<intl>(node, dims, strides); break;
+        case u64: setBufferShape<uintl>(node, dims, strides); break;
+        case s16: setBufferShape<short>(node, dims, strides); break;
+        case u16: setBufferShape<ushort>(node, dims, strides); break;
+        case f16: setBufferShape<half>(node, dims, strides); break;
+        default: TYPE_ERROR(0, node->getType());
+    }
+}
+
 template<typename T>
 void evalNodes(vector<Param<T>> &outputs, const vector<Node *> &output_nodes) {
     size_t num_outputs = outputs.size();
@@ -236,7 +268,6 @@ void evalNodes(vector<Param<T>> &outputs, const vector<Node *> &output_nodes) {
 
     using common::ModdimNode;
     using common::NodeIterator;
-    using jit::BufferNode;
 
     // find all moddims in the tree
     vector<std::shared_ptr<Node>> node_clones;
@@ -260,16 +291,7 @@ void evalNodes(vector<Param<T>> &outputs, const vector<Node *> &output_nodes) {
                 it = find_if(it, NodeIterator<>(), isBuffer);
                 if (it == NodeIterator<>()) { break; }
 
-                BufferNode<T> *buf = static_cast<BufferNode<T> *>(&(*it));
-
-                buf->m_param.dims[0]    = mn->m_new_shape[0];
-                buf->m_param.dims[1]    = mn->m_new_shape[1];
-                buf->m_param.dims[2]    = mn->m_new_shape[2];
-                buf->m_param.dims[3]    = mn->m_new_shape[3];
-                buf->m_param.strides[0] = new_strides[0];
-                buf->m_param.strides[1] = new_strides[1];
-                buf->m_param.strides[2] = new_strides[2];
-                buf->m_param.strides[3] = new_strides[3];
+                setBufferShape(&(*it), mn->m_new_shape, new_strides);
 
                 ++it;
             }
@@ -416,4 +438,8 @@ template void evalNodes<ushort>(vector<Param<ushort>> &out,
                                 const vector<Node *> &node);
 template void evalNodes<half>(vector<Param<half>> &out,
                               const vector<Node *> &node);
+// The outputs of the kernels that evaluate arrays of different types. The
+// kernels write each output with the type of its node.
+template void evalNodes<void>(vector<Param<void>> &out,
+                              const vector<Node *> &node);
 }  // namespace cuda
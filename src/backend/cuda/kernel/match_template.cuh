@@ -65,6 +65,10 @@ void matchTemplate(Param<outType> out, CParam<inType> srch,
 
         // run the window match metric
         outType disparity = outType(0);
+        // energies of the window and the template used by the normalized
+        // cross correlation metrics
+        outType sEnergy = outType(0);
+        outType tEnergy = outType(0);
 
         for (int tj = 0, j = gy; tj < tDim1; tj++, j++) {
             int jStride  = j * srch.strides[1];
@@ -76,7 +80,7 @@ void matchTemplate(Param<outType> out, CParam<inType> srch,
                                    : inType(0));
                 inType tVal = tptr[tjStride + ti * tmplt.strides[0]];
 
-                outType temp;
+                outType temp, sDiff, tDiff;
                 switch (mType) {
                     case AF_SAD:
                         disparity += fabs((outType)sVal - (outType)tVal);
@@ -103,10 +107,16 @@ void matchTemplate(Param<outType> out, CParam<inType> srch,
                         disparity += temp * temp;
                         break;
                     case AF_NCC:
-                        // TODO: furture implementation
+                        disparity += (outType)sVal * (outType)tVal;
+                        sEnergy += (outType)sVal * (outType)sVal;
+                        tEnergy += (outType)tVal * (outType)tVal;
                         break;
                     case AF_ZNCC:
-                        // TODO: furture implementation
+                        sDiff = (outType)sVal - wImgMean;
+                        tDiff = (outType)tVal - tImgMean;
+                        disparity += sDiff * tDiff;
+                        sEnergy += sDiff * sDiff;
+                        tEnergy += tDiff * tDiff;
                         break;
                     case AF_SHD:
                         // TODO: furture implementation
@@ -114,6 +124,10 @@ void matchTemplate(Param<outType> out, CParam<inType> srch,
                 }
             }
         }
+        if (mType == AF_NCC || mType == AF_ZNCC) {
+            outType norm = sqrt(sEnergy * tEnergy);
+            disparity    = norm > outType(0) ? disparity / norm : outType(0);
+        }
         optr[gy * out.strides[1] + gx] = disparity;
     }
 }
@@ -0,0 +1,49 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <kth_element.hpp>
+
+#include <Array.hpp>
+#include <lookup.hpp>
+#include <sort.hpp>
+#include <af/dim4.hpp>
+
+using af::dim4;
+using std::vector;
+
+namespace cuda {
+
+// The selection is done with the batched sort of the backend, so it costs a
+// full sort of every column unlike the selection of the CPU backend. The ranks
+// are gathered from the sorted columns with one lookup, so any number of ranks
+// costs a single sort.
+template<typename T>
+Array<T> kth_element(const Array<T> &in, const vector<dim_t> &ranks,
+                     const unsigned dim) {
+    vector<uint> hranks(ranks.begin(), ranks.end());
+    Array<uint> idx =
+        createHostDataArray<uint>(dim4(static_cast<dim_t>(hranks.size())),
+                                  hranks.data());
+    return lookup<T, uint>(sort<T>(in, dim, true), idx, dim);
+}
+
+#define INSTANTIATE(T)                                                    \
+    template Array<T> kth_element<T>(const Array<T> &in,                  \
+                                     const vector<dim_t> &ranks,          \
+                                     const unsigned dim);
+
+INSTANTIATE(float)
+INSTANTIATE(double)
+INSTANTIATE(int)
+INSTANTIATE(uint)
+INSTANTIATE(short)
+INSTANTIATE(ushort)
+INSTANTIATE(uchar)
+
+}  // namespace cuda
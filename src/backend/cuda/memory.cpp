@@ -98,6 +98,13 @@ void deviceMemoryInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                               lock_buffers);
 }
 
+void deviceMemoryFragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                   size_t *free_buffers,
+                                   size_t *largest_free_bytes) {
+    memoryManager().fragmentationInfo(unused_bytes, free_bytes, free_buffers,
+                                      largest_free_bytes);
+}
+
 template<typename T>
 T *pinnedAlloc(const size_t &elements) {
     // TODO: make pinnedAlloc aware of array shapes
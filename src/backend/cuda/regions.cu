@@ -8,17 +8,46 @@
  ********************************************************/
 
 #include <Array.hpp>
+#include <common/moddims.hpp>
+#include <copy.hpp>
 #include <err_cuda.hpp>
+#include <join.hpp>
 #include <kernel/regions.hpp>
 #include <regions.hpp>
 #include <af/dim4.hpp>
+#include <af/seq.h>
+
+#include <vector>
 
 using af::dim4;
+using common::modDims;
+using std::vector;
 
 namespace cuda {
 
 template<typename T>
 Array<T> regions(const Array<char> &in, af_connectivity connectivity) {
+    const dim_t nimages = in.dims()[2] * in.dims()[3];
+    if (nimages > 1) {
+        // The kernel labels a single image, so a batch is labelled one image
+        // at a time and the labels are joined along the third dimension
+        const dim4 idims = in.dims();
+        Array<char> images = modDims(in, dim4(idims[0], idims[1], nimages));
+
+        vector<Array<T>> labels;
+        labels.reserve(nimages);
+        for (dim_t b = 0; b < nimages; b++) {
+            const double i = static_cast<double>(b);
+            vector<af_seq> index{af_span, af_span, {i, i, 1}, af_span};
+            labels.push_back(regions<T>(
+                copyArray(createSubArray(images, index)), connectivity));
+        }
+
+        Array<T> out = createEmptyArray<T>(dim4(idims[0], idims[1], nimages));
+        join<T>(out, 2, labels);
+        return modDims(out, idims);
+    }
+
     const dim4 dims = in.dims();
 
     Array<T> out = createEmptyArray<T>(dims);
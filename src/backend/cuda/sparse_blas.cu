@@ -10,6 +10,7 @@
 #include <sparse_blas.hpp>
 
 #include <common/err_common.hpp>
+#include <common/spgemm.hpp>
 #include <complex.hpp>
 #include <cudaDataType.hpp>
 #include <cuda_runtime.h>
@@ -211,10 +212,73 @@ Array<T> matmul(const common::SparseArray<T> &lhs, const Array<T> &rhs,
     return out;
 }
 
+template<typename T>
+common::SparseArray<T> matmul(const common::SparseArray<T> &lhs,
+                              const common::SparseArray<T> &rhs) {
+#if defined(AF_USE_NEW_CUSPARSE_API) && CUDA_VERSION >= 11000
+    const int M = static_cast<int>(lhs.dims()[0]);
+    const int N = static_cast<int>(rhs.dims()[1]);
+
+    cusparseModule &_ = getCusparsePlugin();
+    const cusparseOperation_t op = CUSPARSE_OPERATION_NON_TRANSPOSE;
+    const cudaDataType_t computeType = getComputeType<T>();
+    T alpha = scalar<T>(1);
+    T beta  = scalar<T>(0);
+
+    auto matA = csrMatDescriptor<T>(lhs);
+    auto matB = csrMatDescriptor<T>(rhs);
+
+    // The nonzeros of C are only known once the product has been computed,
+    // so C starts out with row offsets alone.
+    auto rowIdx = createEmptyArray<int>(dim4(M + 1));
+    auto matC   = common::make_handle<cusparseSpMatDescr_t>(
+        M, N, 0, (void *)rowIdx.get(), nullptr, nullptr, CUSPARSE_INDEX_32I,
+        CUSPARSE_INDEX_32I, CUSPARSE_INDEX_BASE_ZERO, getType<T>());
+    auto desc = common::make_handle<cusparseSpGEMMDescr_t>();
+
+    size_t bufferSize1 = 0;
+    CUSPARSE_CHECK(_.cusparseSpGEMM_workEstimation(
+        sparseHandle(), op, op, &alpha, matA, matB, &beta, matC, computeType,
+        CUSPARSE_SPGEMM_DEFAULT, desc, &bufferSize1, nullptr));
+    auto buffer1 = createEmptyArray<char>(dim4(bufferSize1));
+    CUSPARSE_CHECK(_.cusparseSpGEMM_workEstimation(
+        sparseHandle(), op, op, &alpha, matA, matB, &beta, matC, computeType,
+        CUSPARSE_SPGEMM_DEFAULT, desc, &bufferSize1, buffer1.get()));
+
+    size_t bufferSize2 = 0;
+    CUSPARSE_CHECK(_.cusparseSpGEMM_compute(
+        sparseHandle(), op, op, &alpha, matA, matB, &beta, matC, computeType,
+        CUSPARSE_SPGEMM_DEFAULT, desc, &bufferSize2, nullptr));
+    auto buffer2 = createEmptyArray<char>(dim4(bufferSize2));
+    CUSPARSE_CHECK(_.cusparseSpGEMM_compute(
+        sparseHandle(), op, op, &alpha, matA, matB, &beta, matC, computeType,
+        CUSPARSE_SPGEMM_DEFAULT, desc, &bufferSize2, buffer2.get()));
+
+    int64_t rows = 0, cols = 0, nnz = 0;
+    CUSPARSE_CHECK(_.cusparseSpMatGetSize(matC, &rows, &cols, &nnz));
+
+    auto values = createEmptyArray<T>(dim4(nnz));
+    auto colIdx = createEmptyArray<int>(dim4(nnz));
+    CUSPARSE_CHECK(_.cusparseCsrSetPointers(matC, rowIdx.get(), colIdx.get(),
+                                            values.get()));
+    CUSPARSE_CHECK(_.cusparseSpGEMM_copy(sparseHandle(), op, op, &alpha, matA,
+                                         matB, &beta, matC, computeType,
+                                         CUSPARSE_SPGEMM_DEFAULT, desc));
+
+    return common::createArrayDataSparseArray<T>(dim4(M, N), values, rowIdx,
+                                                 colIdx, AF_STORAGE_CSR);
+#else
+    // cuSparse has no generic SpGEMM before CUDA 11
+    return common::spgemmOnHost<T>(lhs, rhs);
+#endif
+}
+
 #define INSTANTIATE_SPARSE(T)                                            \
     template Array<T> matmul<T>(const common::SparseArray<T> &lhs,       \
                                 const Array<T> &rhs, af_mat_prop optLhs, \
-                                af_mat_prop optRhs);
+                                af_mat_prop optRhs);                     \
+    template common::SparseArray<T> matmul<T>(                           \
+        const common::SparseArray<T> &lhs, const common::SparseArray<T> &rhs);
 
 INSTANTIATE_SPARSE(float)
 INSTANTIATE_SPARSE(double)
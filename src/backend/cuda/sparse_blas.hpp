@@ -16,4 +16,9 @@ template<typename T>
 Array<T> matmul(const common::SparseArray<T>& lhs, const Array<T>& rhs,
                 af_mat_prop optLhs, af_mat_prop optRhs);
 
+/// Multiplies two sparse matrices stored as CSR. The result is CSR too.
+template<typename T>
+common::SparseArray<T> matmul(const common::SparseArray<T>& lhs,
+                              const common::SparseArray<T>& rhs);
+
 }
@@ -23,6 +23,7 @@
 #include <af/dim4.hpp>
 #include <af/opencl.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdlib>
 #include <memory>
@@ -223,47 +224,61 @@ Buffer *Array<T>::device() {
 }
 
 template<typename T>
-void evalMultiple(vector<Array<T> *> arrays) {
-    vector<Param> outputs;
-    vector<Array<T> *> output_arrays;
-    vector<Node *> nodes;
-
-    // Check if all the arrays have the same dimension
-    auto it = std::adjacent_find(begin(arrays), end(arrays),
-                                 [](const Array<T> *l, const Array<T> *r) {
-                                     return l->dims() != r->dims();
-                                 });
-
-    // If they are not the same. eval individually
-    if (it != end(arrays)) {
-        for (auto ptr : arrays) { ptr->eval(); }
-        return;
+void EvalGroup::add(Array<T> &array) {
+    if (array.isReady()) { return; }
+
+    // The same array may be passed more than once
+    for (const Output &output : m_outputs) {
+        if (output.array_node == &array.node) { return; }
     }
 
-    for (Array<T> *array : arrays) {
-        if (array->isReady()) { continue; }
+    const ArrayInfo info = array.info;
 
-        const ArrayInfo info = array->info;
+    array.setId(getActiveDeviceId());
+    array.data = std::shared_ptr<cl::Buffer>(
+        memAlloc<T>(info.elements()).release(), bufferFree);
 
-        array->setId(getActiveDeviceId());
-        array->data = std::shared_ptr<cl::Buffer>(
-            memAlloc<T>(info.elements()).release(), bufferFree);
+    // Do not replace this with cast operator
+    KParam kInfo = {
+        {info.dims()[0], info.dims()[1], info.dims()[2], info.dims()[3]},
+        {info.strides()[0], info.strides()[1], info.strides()[2],
+         info.strides()[3]},
+        0};
+
+    m_outputs.push_back({Param(array.data.get(), kInfo), info.dims(),
+                         array.node, &array.node});
+}
 
-        // Do not replace this with cast operator
-        KParam kInfo = {
-            {info.dims()[0], info.dims()[1], info.dims()[2], info.dims()[3]},
-            {info.strides()[0], info.strides()[1], info.strides()[2],
-             info.strides()[3]},
-            0};
+void EvalGroup::run() {
+    // Arrays with different dimensions can not be written by the same kernel,
+    // so there is one kernel per shape
+    vector<bool> done(m_outputs.size(), false);
+    for (size_t i = 0; i < m_outputs.size(); i++) {
+        if (done[i]) { continue; }
+
+        vector<Param> outputs;
+        vector<Node *> nodes;
+        for (size_t j = i; j < m_outputs.size(); j++) {
+            if (done[j] || m_outputs[j].dims != m_outputs[i].dims) {
+                continue;
+            }
+            outputs.push_back(m_outputs[j].param);
+            nodes.push_back(m_outputs[j].node.get());
+            done[j] = true;
+        }
 
-        outputs.emplace_back(array->data.get(), kInfo);
-        output_arrays.push_back(array);
-        nodes.push_back(array->getNode().get());
+        evalNodes(outputs, nodes);
     }
 
-    evalNodes(outputs, nodes);
+    for (Output &output : m_outputs) { output.array_node->reset(); }
+    m_outputs.clear();
+}
 
-    for (Array<T> *array : output_arrays) { array->node.reset(); }
+template<typename T>
+void evalMultiple(vector<Array<T> *> arrays) {
+    EvalGroup group;
+    for (Array<T> *array : arrays) { group.add(*array); }
+    group.run();
 }
 
 template<typename T>
@@ -377,6 +392,14 @@ kJITHeuristics passesJitHeuristics(span<Node *> root_nodes) {
     return kJITHeuristics::Pass;
 }
 
+template<typename T>
+int selectJitEvalNode(span<Node *> root_nodes) {
+    auto tallest = std::max_element(
+        std::begin(root_nodes), std::end(root_nodes),
+        [](Node *l, Node *r) { return l->getHeight() < r->getHeight(); });
+    return static_cast<int>(tallest - std::begin(root_nodes));
+}
+
 template<typename T>
 void *getDevicePtr(const Array<T> &arr) {
     const cl::Buffer *buf = arr.device();
@@ -529,7 +552,9 @@ size_t Array<T>::getAllocatedBytes() const {
     template void writeDeviceDataArray<T>(                                    \
         Array<T> & arr, const void *const data, const size_t bytes);          \
     template void evalMultiple<T>(vector<Array<T> *> arrays);                 \
+    template void EvalGroup::add<T>(Array<T> & array);                        \
     template kJITHeuristics passesJitHeuristics<T>(span<Node *> node);        \
+    template int selectJitEvalNode<T>(span<Node *> node);                     \
     template void *getDevicePtr<T>(const Array<T> &arr);                      \
     template void Array<T>::setDataDims(const dim4 &new_dims);                \
     template size_t Array<T>::getAllocatedBytes() const;
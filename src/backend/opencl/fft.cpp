@@ -24,6 +24,8 @@ void setFFTPlanCacheSize(size_t numPlans) {
     fftManager().setMaxCacheSize(numPlans);
 }
 
+void setFFTNumThreads(unsigned numThreads) { UNUSED(numThreads); }
+
 template<typename T>
 struct Precision;
 template<>
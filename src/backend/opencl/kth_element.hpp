@@ -0,0 +1,28 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#pragma once
+#include <Array.hpp>
+
+#include <vector>
+
+namespace opencl {
+/// Returns the elements of rank \p ranks along \p dim, which are the
+/// elements at \p ranks of \p in sorted in ascending order along \p dim
+///
+/// \param[in] in    The input array
+/// \param[in] ranks The sorted ranks in [0, in.dims()[dim])
+/// \param[in] dim   The dimension along which the elements are ranked
+///
+/// \returns an array of the size of \p in but with ranks.size() elements
+///          along \p dim
+template<typename T>
+Array<T> kth_element(const Array<T> &in, const std::vector<dim_t> &ranks,
+                     const unsigned dim);
+}  // namespace opencl
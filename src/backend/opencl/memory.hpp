@@ -48,6 +48,9 @@ void pinnedFree(T *ptr);
 
 void deviceMemoryInfo(size_t *alloc_bytes, size_t *alloc_buffers,
                       size_t *lock_bytes, size_t *lock_buffers);
+void deviceMemoryFragmentationInfo(size_t *unused_bytes, size_t *free_bytes,
+                                   size_t *free_buffers,
+                                   size_t *largest_free_bytes);
 void signalMemoryCleanup();
 void shutdownMemoryManager();
 void pinnedGarbageCollect();
@@ -19,6 +19,7 @@
 #include <string>
 
 #include <common/err_common.hpp>
+#include <common/spgemm.hpp>
 #include <complex.hpp>
 #include <err_opencl.hpp>
 #include <math.hpp>
@@ -85,10 +86,19 @@ Array<T> matmul(const common::SparseArray<T>& lhs, const Array<T>& rhsIn,
     return out;
 }
 
+template<typename T>
+common::SparseArray<T> matmul(const common::SparseArray<T>& lhs,
+                              const common::SparseArray<T>& rhs) {
+    // There is no device kernel for the sparse-sparse product yet
+    return common::spgemmOnHost<T>(lhs, rhs);
+}
+
 #define INSTANTIATE_SPARSE(T)                                            \
     template Array<T> matmul<T>(const common::SparseArray<T>& lhs,       \
                                 const Array<T>& rhs, af_mat_prop optLhs, \
-                                af_mat_prop optRhs);
+                                af_mat_prop optRhs);                     \
+    template common::SparseArray<T> matmul<T>(                           \
+        const common::SparseArray<T>& lhs, const common::SparseArray<T>& rhs);
 
 INSTANTIATE_SPARSE(float)
 INSTANTIATE_SPARSE(double)
@@ -799,6 +799,44 @@ void cleanSlate() {
     ASSERT_EQ(af::getMemStepSize(), step_bytes);
 }
 
+std::vector<JitInput> jitInputs(af::dtype ty) {
+    using af::array;
+    using af::dim4;
+    using af::seq;
+    using af::span;
+
+    auto values = [ty](const dim4 &dims) {
+        array out = af::floor(af::randu(dims) * 16).as(ty);
+        out.eval();
+        return out;
+    };
+    auto input = [](const std::string &name,
+                    const std::function<array()> &jit) {
+        array gold = jit();
+        gold.eval();
+        return JitInput{name, gold, jit};
+    };
+
+    std::vector<JitInput> inputs;
+    for (const dim4 &dims :
+         {dim4(300, 7, 5, 3), dim4(100, 7, 5, 3), dim4(1, 300, 7, 5)}) {
+        const array a = values(dims);
+        const array b = values(dims);
+        inputs.push_back(input("dims " + minimalDim4(dims, dims),
+                               [=] { return a * b - 3; }));
+    }
+
+    const array a = values(dim4(600, 7, 5, 3));
+    const array b = values(dim4(600, 7, 5, 3));
+    const array c = a(seq(300), span, span, span);
+    const array d = b(seq(300), span, span, span);
+    inputs.push_back(input("sub-array", [=] { return c * d - 3; }));
+    inputs.push_back(input("moddims", [=] {
+        return af::moddims(a * b - 3, dim4(600, 35, 3));
+    }));
+    return inputs;
+}
+
 bool noImageIOTests() {
     bool ret = !af::isImageIOAvailable();
     if (ret) printf("Image IO Not Configured. Test will exit\n");
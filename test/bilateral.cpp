@@ -193,3 +193,43 @@ TEST(bilateral, GFOR) {
         ASSERT_EQ(max<double>(abs(c_ii - b_ii)) < 1E-5, true);
     }
 }
+
+TEST(bilateral, GridMatchesExact) {
+    const int nx = 256;
+    const int ny = 256;
+    array x      = iota(dim4(nx, 1), dim4(1, ny)).as(f32);
+    array y      = iota(dim4(1, ny), dim4(nx, 1)).as(f32);
+    // A smooth ramp with a sharp step through the middle of the image
+    array img = 0.25f * x + 0.25f * y + 100.f * (x > nx / 2).as(f32);
+
+    array exact = bilateral(img, 8.f, 20.f, false, AF_BILATERAL_EXACT);
+    array grid  = bilateral(img, 8.f, 20.f, false, AF_BILATERAL_GRID);
+
+    vector<float> exactData(img.elements());
+    vector<float> gridData(img.elements());
+    exact.host(exactData.data());
+    grid.host(gridData.data());
+
+    ASSERT_EQ(true, compareArraysRMSD(exactData.size(), exactData.data(),
+                                      gridData.data(), 0.02f));
+}
+
+TEST(bilateral, InvalidMethod) {
+    af_array in  = 0;
+    af_array out = 0;
+    dim_t dims[] = {10, 10};
+    ASSERT_SUCCESS(af_randu(&in, 2, dims, f32));
+    ASSERT_EQ(AF_ERR_ARG, af_bilateral_v2(&out, in, 2.f, 10.f, false,
+                                          (af_bilateral_method)2));
+    ASSERT_SUCCESS(af_release_array(in));
+}
+
+TEST(bilateral, ZeroChromaticSigma) {
+    // Only the centre pixel has the same intensity, so it is returned as is
+    for (af::dtype type : {f32, f64}) {
+        if (noDoubleTests(type)) { continue; }
+        array img = af::randu(32, 32, type);
+        array out = bilateral(img, 2.f, 0.f);
+        ASSERT_ARRAYS_EQ(img, out);
+    }
+}
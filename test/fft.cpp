@@ -685,6 +685,36 @@ TEST(fft3, GFOR) {
     freeHost(h_c);
 }
 
+TEST(fft, RepeatedShapesWithDifferentAlignments) {
+    // The transforms have the same shape but the subarrays start at offsets
+    // that change the alignment of the data
+    array a = randu(1027, 8, c32);
+    for (int offset = 0; offset < 3; offset++) {
+        array sub  = a(seq(offset, 1023 + offset), span);
+        array gold = fft(sub.copy());
+        ASSERT_ARRAYS_NEAR(gold, fft(sub), 1e-3);
+
+        array real = randu(1027, 8);
+        array rsub = real(seq(offset, 1023 + offset), span);
+        ASSERT_ARRAYS_NEAR(af::fftR2C<1>(rsub.copy()), af::fftR2C<1>(rsub),
+                           1e-3);
+    }
+}
+
+TEST(fft, NumThreadsDoesNotChangeResults) {
+    array a = randu(256, 4096, c32);
+    array b = randu(512, 512, 4, c32);
+    af::setFFTNumThreads(1);
+    array gold_a = fft(a);
+    array gold_b = fft2(b);
+
+    for (unsigned threads : {2u, 0u}) {
+        af::setFFTNumThreads(threads);
+        ASSERT_ARRAYS_NEAR(gold_a, fft(a), 1e-3);
+        ASSERT_ARRAYS_NEAR(gold_b, fft2(b), 1e-2);
+    }
+}
+
 void fft2InPlaceFunc() {
     array a = randu(1024, 1024, c32);
     array b = fft2(a);
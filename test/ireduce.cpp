@@ -411,3 +411,29 @@ TEST(IndexedReduce, MaxCplxPreferSmallerIdxIfEqual) {
 
     ASSERT_EQ(h_max_idx[0], gold_max_idx);
 }
+
+TEST(IndexedReduce, JitInput) {
+    // The values are small integers, so there are many ties
+    for (const JitInput &in : jitInputs(f32)) {
+        SCOPED_TRACE(in.name);
+        for (int dim = 0; dim < 4; dim++) {
+            array gold_val, gold_idx, val, idx;
+            min(gold_val, gold_idx, in.gold, dim);
+            min(val, idx, in.jit(), dim);
+            ASSERT_ARRAYS_EQ(gold_val, val);
+            ASSERT_ARRAYS_EQ(gold_idx, idx);
+
+            max(gold_val, gold_idx, in.gold, dim);
+            max(val, idx, in.jit(), dim);
+            ASSERT_ARRAYS_EQ(gold_val, val);
+            ASSERT_ARRAYS_EQ(gold_idx, idx);
+        }
+
+        float gold_val, val;
+        unsigned gold_idx, idx;
+        max(&gold_val, &gold_idx, in.gold);
+        max(&val, &idx, in.jit());
+        ASSERT_EQ(gold_val, val);
+        ASSERT_EQ(gold_idx, idx);
+    }
+}
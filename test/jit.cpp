@@ -11,12 +11,18 @@
 #include <testHelpers.hpp>
 #include <af/algorithm.h>
 #include <af/arith.h>
+#include <af/backend.h>
 #include <af/array.h>
 #include <af/data.h>
 #include <af/device.h>
 #include <af/gfor.h>
 #include <af/random.h>
 
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <numeric>
 #include <tuple>
 
@@ -231,6 +237,177 @@ TEST(JIT, CPP_Multi_pre_eval) {
     }
 }
 
+TEST(JIT, CPP_Multi_types) {
+    const int num = 1 << 16;
+    array a       = randu(num);
+    array b       = randu(num);
+    array mask    = (a > b).as(f32);
+    array bins    = (a * 10).as(s32);
+    array accum   = (a + b).as(f64);
+
+    array *arrays[] = {&mask, &bins, &accum};
+    eval(3, arrays);
+
+    vector<float> ha(num);
+    vector<float> hb(num);
+    a.host(&ha[0]);
+    b.host(&hb[0]);
+
+    vector<float> gold_mask(num);
+    vector<int> gold_bins(num);
+    vector<double> gold_accum(num);
+    for (int i = 0; i < num; i++) {
+        gold_mask[i]  = ha[i] > hb[i] ? 1.f : 0.f;
+        gold_bins[i]  = static_cast<int>(ha[i] * 10);
+        gold_accum[i] = static_cast<double>(ha[i] + hb[i]);
+    }
+
+    ASSERT_VEC_ARRAY_EQ(gold_mask, dim4(num), mask);
+    ASSERT_VEC_ARRAY_EQ(gold_bins, dim4(num), bins);
+    ASSERT_VEC_ARRAY_NEAR(gold_accum, dim4(num), accum, 1e-6);
+}
+
+TEST(JIT, CPP_Multi_dims) {
+    const int num = 1024;
+    array a       = randu(num, s32);
+    array b       = randu(num, s32);
+    array x       = a + b;
+    array y       = a(seq(num / 2)) - b(seq(num / 2));
+    array z       = (a - b).as(f32);
+
+    array *arrays[] = {&x, &y, &z};
+    eval(3, arrays);
+
+    vector<int> ha(num);
+    vector<int> hb(num);
+    a.host(&ha[0]);
+    b.host(&hb[0]);
+
+    vector<int> goldx(num);
+    vector<int> goldy(num / 2);
+    vector<float> goldz(num);
+    for (int i = 0; i < num; i++) {
+        goldx[i] = ha[i] + hb[i];
+        goldz[i] = static_cast<float>(ha[i] - hb[i]);
+        if (i < num / 2) { goldy[i] = ha[i] - hb[i]; }
+    }
+
+    ASSERT_VEC_ARRAY_EQ(goldx, dim4(num), x);
+    ASSERT_VEC_ARRAY_EQ(goldy, dim4(num / 2), y);
+    ASSERT_VEC_ARRAY_EQ(goldz, dim4(num), z);
+}
+
+namespace af {
+int getJitNodeCount(const array &in);
+}  // namespace af
+
+TEST(JIT, EquivalentSubexpressions) {
+    const int num = 1024;
+    array a       = randu(num);
+
+    // The three sin(a) nodes are built separately and merged when the tree
+    // is evaluated. The scalars and the shifts differ, so they are not.
+    array x = af::sin(a) * af::sin(a) + af::sin(a);
+    array y = (a + 1) * (a + 2) - (a + 1);
+    array z = af::shift(a, 1) - af::shift(a, 2);
+
+    // x is a, sin, * and +. y is a, 1, 2, a + 1, a + 2, * and -.
+    ASSERT_EQ(4, af::getJitNodeCount(x));
+    ASSERT_EQ(7, af::getJitNodeCount(y));
+
+    array *arrays[] = {&x, &y, &z};
+    eval(3, arrays);
+
+    vector<float> ha(num);
+    a.host(&ha[0]);
+
+    vector<float> goldx(num);
+    vector<float> goldy(num);
+    vector<float> goldz(num);
+    for (int i = 0; i < num; i++) {
+        const float s = std::sin(ha[i]);
+        goldx[i]      = s * s + s;
+        goldy[i]      = (ha[i] + 1) * (ha[i] + 2) - (ha[i] + 1);
+        goldz[i]      = ha[(i + num - 1) % num] - ha[(i + num - 2) % num];
+    }
+
+    ASSERT_VEC_ARRAY_NEAR(goldx, dim4(num), x, 1e-6);
+    ASSERT_VEC_ARRAY_NEAR(goldy, dim4(num), y, 1e-6);
+    ASSERT_VEC_ARRAY_NEAR(goldz, dim4(num), z, 1e-6);
+}
+
+TEST(JIT, SharedSubtrees) {
+    // The CPU backend evaluates trees based on the cost of their distinct
+    // nodes and buffers
+    if (af::getActiveBackend() != AF_BACKEND_CPU) { return; }
+
+    const int num   = 1024;
+    const int steps = 30;
+    array a         = randu(num);
+
+    // Every step uses the previous tree twice, so it has 2^steps paths but
+    // only a and one * node per step
+    array x = a;
+    for (int i = 0; i < steps; i++) { x = x * x; }
+    ASSERT_EQ(steps + 1, af::getJitNodeCount(x));
+
+    // Every use of a creates a new buffer node for the same data
+    array y = a;
+    for (int i = 0; i < 2 * steps; i++) { y = y + a; }
+    ASSERT_EQ(2 * steps + 1, af::getJitNodeCount(y));
+
+    vector<float> ha(num);
+    a.host(&ha[0]);
+
+    vector<float> goldx(ha);
+    vector<float> goldy(ha);
+    for (int i = 0; i < num; i++) {
+        for (int j = 0; j < steps; j++) { goldx[i] = goldx[i] * goldx[i]; }
+        for (int j = 0; j < 2 * steps; j++) { goldy[i] = goldy[i] + ha[i]; }
+    }
+
+    ASSERT_VEC_ARRAY_NEAR(goldx, dim4(num), x, 1e-6);
+    ASSERT_VEC_ARRAY_NEAR(goldy, dim4(num), y, 1e-6);
+}
+
+TEST(JIT, UpdateInPlace) {
+    const int num = 1 << 16;
+    array a       = randu(num);
+    array b       = a;
+    array c       = a(seq(num / 2));
+
+    vector<float> gold(num);
+    a.host(&gold[0]);
+
+    // The buffer of a may only be overwritten once b and c stop reading it
+    a = a * 2 + 1;
+    a.eval();
+    ASSERT_VEC_ARRAY_EQ(gold, dim4(num), b);
+    ASSERT_VEC_ARRAY_EQ(vector<float>(gold.begin(), gold.begin() + num / 2),
+                        dim4(num / 2), c);
+
+    b = array();
+    c = array();
+
+    // device() locks the buffer, which would stop it from being reused
+    const float *before = a.device<float>();
+    a.unlock();
+    for (int i = 0; i < 4; i++) {
+        a = a * 2 + 1;
+        a.eval();
+    }
+    const float *after = a.device<float>();
+    a.unlock();
+
+    // Only the CPU backend writes the results into the buffer of a
+    if (af::getActiveBackend() == AF_BACKEND_CPU) { ASSERT_EQ(before, after); }
+
+    for (int i = 0; i < num; i++) {
+        for (int j = 0; j < 5; j++) { gold[i] = gold[i] * 2 + 1; }
+    }
+    ASSERT_VEC_ARRAY_NEAR(gold, dim4(num), a, 1e-4);
+}
+
 TEST(JIT, CPP_common_node) {
     array r = seq(-3, 3, 0.5);
 
@@ -379,6 +556,27 @@ TEST(JIT, LinearLarge) {
     for (size_t i = 0; i < hc.size(); i++) { ASSERT_EQ(hc[i], v3); }
 }
 
+TEST(JIT, MultiLinearLargeUneven) {
+    // Not a multiple of the chunk sizes used to split the evaluation
+    const int num = (1 << 22) + 123;
+    array a       = randu(num);
+    array b       = randu(num);
+    array c       = a * b + a;
+    array d       = a - b * 2.0f;
+    eval(c, d);
+
+    vector<float> ha(num), hb(num), hc(num), hd(num);
+    a.host(ha.data());
+    b.host(hb.data());
+    c.host(hc.data());
+    d.host(hd.data());
+
+    for (int i = 0; i < num; i++) {
+        ASSERT_EQ(hc[i], ha[i] * hb[i] + ha[i]) << " at " << i;
+        ASSERT_EQ(hd[i], ha[i] - hb[i] * 2.0f) << " at " << i;
+    }
+}
+
 TEST(JIT, NonLinearBuffers1) {
     array a  = randu(5, 5);
     array a0 = a;
@@ -827,3 +1025,74 @@ TEST(JIT, setKernelCacheDirectory) {
   // Reset to the old path
   ASSERT_SUCCESS(af_set_kernel_cache_directory(old_path.c_str(), false));
 }
+
+TEST(JIT, warmupKernelsInvalidManifest) {
+  ASSERT_EQ(AF_ERR_ARG, af_warmup_kernels(NULL));
+  ASSERT_EQ(AF_ERR_ARG, af_warmup_kernels("missing_kernel_manifest.bin"));
+
+  std::string path = "invalid_kernel_manifest.bin";
+  std::ofstream(path) << "This is not a kernel manifest";
+  ASSERT_EQ(AF_ERR_ARG, af_warmup_kernels(path.c_str()));
+  std::remove(path.c_str());
+}
+
+TEST(JIT, warmupKernelsEmptyManifest) {
+  std::string path = "empty_kernel_manifest.bin";
+  std::ofstream(path).close();
+  ASSERT_SUCCESS(af_warmup_kernels(path.c_str()));
+  std::remove(path.c_str());
+}
+
+// Appends the start of an entry whose name claims to be 2^60 bytes long
+static void appendDamagedManifestEntry(const std::string &path) {
+  const uint64_t magic = 0x01004d4b4e524641ULL;
+  const uint64_t size  = 1ULL << 60;
+  std::ofstream out(path, std::ios::binary | std::ios::app);
+  out.write(reinterpret_cast<const char *>(&magic), sizeof(magic));
+  out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+  out << "name";
+}
+
+static void setKernelManifestPath(const char *path) {
+#if defined(_WIN32)
+  _putenv_s("AF_JIT_KERNEL_MANIFEST", path);
+#else
+  if (path[0]) {
+    setenv("AF_JIT_KERNEL_MANIFEST", path, 1);
+  } else {
+    unsetenv("AF_JIT_KERNEL_MANIFEST");
+  }
+#endif
+}
+
+TEST(JIT, warmupKernelsDamagedLength) {
+  std::string path = "damaged_kernel_manifest.bin";
+  std::remove(path.c_str());
+  appendDamagedManifestEntry(path);
+  ASSERT_SUCCESS(af_warmup_kernels(path.c_str()));
+  std::remove(path.c_str());
+}
+
+TEST(JIT, warmupKernelsRoundTrip) {
+  std::string path = "roundtrip_kernel_manifest.bin";
+  std::remove(path.c_str());
+
+  setKernelManifestPath(path.c_str());
+  array a = randu(10, 10);
+  array b = randu(10, 10) + 1;
+  array c = af::atan2(af::sinh(a), af::cbrt(b)) * af::hypot(a, b);
+  c.eval();
+  af::sync();
+  setKernelManifestPath("");
+
+  // The CPU backend records nothing when it has no compiler for its JIT
+  // kernels
+  if (!std::ifstream(path).good()) { return; }
+
+  ASSERT_SUCCESS(af_warmup_kernels(path.c_str()));
+
+  // The entries before a damaged one are still built
+  appendDamagedManifestEntry(path);
+  ASSERT_SUCCESS(af_warmup_kernels(path.c_str()));
+  std::remove(path.c_str());
+}
@@ -12,6 +12,7 @@
 #include <testHelpers.hpp>
 #include <af/dim4.hpp>
 #include <af/traits.hpp>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -140,3 +141,136 @@ TEST(MatchTemplate, CPP) {
         cout << "Invalid Match test: " << e.what() << endl;
     }
 }
+
+// Computes the metric of every window by visiting every template pixel. The
+// pixels of a window outside the search image are zero.
+static vector<double> matchTemplateReference(const vector<float> &srch,
+                                             const dim4 &sDims,
+                                             const vector<float> &tmplt,
+                                             const dim4 &tDims,
+                                             af_match_type mType) {
+    const dim_t n = tDims[0] * tDims[1];
+    double tSum   = 0;
+    for (dim_t k = 0; k < n; ++k) { tSum += tmplt[k]; }
+    const double tMean = tSum / n;
+
+    vector<double> out(sDims.elements());
+    for (dim_t b = 0; b < sDims[2] * sDims[3]; ++b) {
+        const float *img = srch.data() + b * sDims[0] * sDims[1];
+        for (dim_t j = 0; j < sDims[1]; ++j) {
+            for (dim_t i = 0; i < sDims[0]; ++i) {
+                vector<double> win(n);
+                double wSum = 0;
+                for (dim_t tj = 0; tj < tDims[1]; ++tj) {
+                    for (dim_t ti = 0; ti < tDims[0]; ++ti) {
+                        bool inside = i + ti < sDims[0] && j + tj < sDims[1];
+                        double v    = inside
+                                          ? img[(j + tj) * sDims[0] + i + ti]
+                                          : 0.0;
+                        win[tj * tDims[0] + ti] = v;
+                        wSum += v;
+                    }
+                }
+                const double wMean = wSum / n;
+
+                double res = 0, sE = 0, tE = 0;
+                for (dim_t k = 0; k < n; ++k) {
+                    const double s = win[k];
+                    const double t = tmplt[k];
+                    switch (mType) {
+                        case AF_SSD: res += (s - t) * (s - t); break;
+                        case AF_ZSSD:
+                            res += (s - wMean - t + tMean) *
+                                   (s - wMean - t + tMean);
+                            break;
+                        case AF_LSSD:
+                            res += (s - wMean / tMean * t) *
+                                   (s - wMean / tMean * t);
+                            break;
+                        case AF_NCC:
+                            res += s * t;
+                            sE += s * s;
+                            tE += t * t;
+                            break;
+                        case AF_ZNCC:
+                            res += (s - wMean) * (t - tMean);
+                            sE += (s - wMean) * (s - wMean);
+                            tE += (t - tMean) * (t - tMean);
+                            break;
+                        default: break;
+                    }
+                }
+                if (mType == AF_NCC || mType == AF_ZNCC) {
+                    double norm = sqrt(sE * tE);
+                    res         = norm > 0 ? res / norm : 0;
+                }
+                out[b * sDims[0] * sDims[1] + j * sDims[0] + i] = res;
+            }
+        }
+    }
+    return out;
+}
+
+static void matchTemplateCompare(const array &srch, const array &tmplt) {
+    const af_match_type types[] = {AF_SSD, AF_ZSSD, AF_LSSD, AF_NCC, AF_ZNCC};
+    const dim4 sDims            = srch.dims();
+    const dim4 tDims            = tmplt.dims();
+
+    vector<float> hSrch(sDims.elements());
+    vector<float> hTmplt(tDims.elements());
+    srch.as(f32).host(hSrch.data());
+    tmplt.as(f32).host(hTmplt.data());
+
+    for (af_match_type mType : types) {
+        array out = matchTemplate(srch, tmplt, mType);
+        vector<float> hOut(sDims.elements());
+        out.host(hOut.data());
+
+        vector<double> gold =
+            matchTemplateReference(hSrch, sDims, hTmplt, tDims, mType);
+        for (size_t k = 0; k < gold.size(); ++k) {
+            ASSERT_NEAR(gold[k], hOut[k], 1.0e-3 * (1.0 + fabs(gold[k])))
+                << "metric: " << mType << " at: " << k;
+        }
+    }
+}
+
+static void matchTemplateRandomTest(const dim4 &sDims, const dim4 &tDims) {
+    af::setSeed(4);
+    matchTemplateCompare(af::randu(sDims), af::randu(tDims));
+}
+
+TEST(MatchTemplate, SmallTemplateMetrics) {
+    matchTemplateRandomTest(dim4(17, 13), dim4(4, 3));
+}
+
+TEST(MatchTemplate, LargeTemplateMetrics) {
+    matchTemplateRandomTest(dim4(96, 80), dim4(40, 36));
+}
+
+TEST(MatchTemplate, LargeTemplateBatch) {
+    matchTemplateRandomTest(dim4(64, 48, 2), dim4(32, 32));
+}
+
+TEST(MatchTemplate, LargeTemplateBytes) {
+    // The sums of squares of 8 bit images are large, and the template is cut
+    // from the image so some metrics are zero at the match
+    af::setSeed(2);
+    array srch  = af::randu(96, 80, u8);
+    array tmplt = srch(af::seq(30, 69), af::seq(20, 55)).copy();
+    matchTemplateCompare(srch, tmplt);
+}
+
+TEST(MatchTemplate, ZNCCFindsTemplate) {
+    af::setSeed(1);
+    array srch  = af::randu(128, 96);
+    array tmplt = srch(af::seq(40, 79), af::seq(20, 51));
+
+    array out = matchTemplate(srch, tmplt, AF_ZNCC);
+
+    float maxVal    = 0.f;
+    unsigned maxIdx = 0;
+    af::max(&maxVal, &maxIdx, out);
+    ASSERT_NEAR(1.f, maxVal, 1.0e-4);
+    ASSERT_EQ(20u * 128u + 40u, maxIdx);
+}
@@ -379,3 +379,14 @@ TEST(MeanHalf, dim0) {
     // 0.506836
     ASSERT_ARRAYS_NEAR(m16.as(f32), m32, 0.001f);
 }
+
+TEST(Mean, JitInput) {
+    for (const JitInput &in : jitInputs(f32)) {
+        SCOPED_TRACE(in.name);
+        for (int dim = 0; dim < 4; dim++) {
+            ASSERT_ARRAYS_NEAR(af::mean(in.gold, dim), af::mean(in.jit(), dim),
+                               1e-3);
+        }
+        ASSERT_NEAR(af::mean<float>(in.gold), af::mean<float>(in.jit()), 1e-3);
+    }
+}
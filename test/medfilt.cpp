@@ -12,6 +12,7 @@
 #include <testHelpers.hpp>
 #include <af/dim4.hpp>
 #include <af/traits.hpp>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -103,6 +104,60 @@ TYPED_TEST(MedianFilter, BATCH_SYMMETRIC_PAD_3x3) {
         3, AF_PAD_SYM);
 }
 
+template<typename T>
+void medfiltLargeWindowTest(dim_t w_len, dim_t w_wid) {
+    SUPPORTED_TYPE_CHECK(T);
+
+    const int nx = 37;
+    const int ny = 29;
+
+    vector<T> in(nx * ny);
+    for (size_t i = 0; i < in.size(); ++i) {
+        in[i] = static_cast<T>((i * 7919) % 101);
+    }
+
+    // The median of each window with the zeros of AF_PAD_ZERO around it
+    vector<T> gold(in.size());
+    vector<T> window;
+    for (int y = 0; y < ny; ++y) {
+        for (int x = 0; x < nx; ++x) {
+            window.clear();
+            for (int wj = 0; wj < w_wid; ++wj) {
+                for (int wi = 0; wi < w_len; ++wi) {
+                    int ix = x + wi - (int)w_len / 2;
+                    int iy = y + wj - (int)w_wid / 2;
+                    bool inside = ix >= 0 && ix < nx && iy >= 0 && iy < ny;
+                    window.push_back(inside ? in[ix + iy * nx] : T(0));
+                }
+            }
+            std::nth_element(window.begin(),
+                             window.begin() + window.size() / 2, window.end());
+            gold[x + y * nx] = window[window.size() / 2];
+        }
+    }
+
+    af_array inArray  = 0;
+    af_array outArray = 0;
+    dim4 dims(nx, ny);
+    ASSERT_SUCCESS(af_create_array(&inArray, &in.front(), dims.ndims(),
+                                   dims.get(),
+                                   (af_dtype)dtype_traits<T>::af_type));
+    ASSERT_SUCCESS(af_medfilt2(&outArray, inArray, w_len, w_wid, AF_PAD_ZERO));
+
+    ASSERT_VEC_ARRAY_EQ(gold, dims, outArray);
+
+    ASSERT_SUCCESS(af_release_array(inArray));
+    ASSERT_SUCCESS(af_release_array(outArray));
+}
+
+TYPED_TEST(MedianFilter, ZERO_PAD_5x5) {
+    medfiltLargeWindowTest<TypeParam>(5, 5);
+}
+
+TYPED_TEST(MedianFilter, ZERO_PAD_15x15) {
+    medfiltLargeWindowTest<TypeParam>(15, 15);
+}
+
 template<typename T>
 void medfilt1_Test(string pTestFile, dim_t w_wid, af_border_type pad) {
     SUPPORTED_TYPE_CHECK(T);
@@ -457,3 +512,13 @@ TEST(MedianFilter1d, GFOR) {
         ASSERT_EQ(max<double>(abs(c_ii - b_ii)) < 1E-5, true);
     }
 }
+
+TEST(MedianFilter1d, FiltersEachColumn) {
+    float input[] = {1, 5, 3, 2, 9, 4, 8, 6, 7, 0, 3, 1};
+    float gold[]  = {1, 3, 3, 2, 4, 8, 6, 6, 0, 3, 1, 1};
+
+    array a = array(4, 3, input);
+    array b = medfilt1(a, 3, AF_PAD_ZERO);
+
+    ASSERT_VEC_ARRAY_EQ(vector<float>(gold, gold + 12), dim4(4, 3), b);
+}
@@ -169,3 +169,9 @@ TEST(Median, TwoElements) {
     af::array gold = mean(in);
     ASSERT_ARRAYS_EQ(gold, out);
 }
+
+TEST(Median, LongColumns) {
+    median_test<float, float, 0>(20001, 3);
+    median_test<float, float, 1>(3, 20000);
+    median_test<float, int, 0>(50000);
+}
@@ -15,12 +15,19 @@
 #include <af/memory.h>
 #include <af/traits.hpp>
 
+#include <cstdint>
+#include <fstream>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
 using af::alloc;
 using af::allocV2;
 using af::array;
@@ -272,6 +279,145 @@ TEST(Memory, LargeLoop) {
     ASSERT_EQ(lock_bytes, 1 * step_bytes);
 }
 
+TEST(Memory, BestFitReuse) {
+    size_t alloc_bytes, alloc_buffers;
+    size_t lock_bytes, lock_buffers;
+
+    cleanSlate();  // Clean up everything done so far
+
+    const int num = step_bytes / sizeof(float);
+
+    { array a = randu(4 * num); }
+
+    {
+        // A cached buffer that is a little too large is reused
+        array b = randu(7 * num / 2);
+
+        deviceMemInfo(&alloc_bytes, &alloc_buffers, &lock_bytes, &lock_buffers);
+
+        ASSERT_EQ(alloc_buffers, 1u);
+        ASSERT_EQ(lock_buffers, 1u);
+        ASSERT_EQ(alloc_bytes, 4 * step_bytes);
+        ASSERT_EQ(lock_bytes, 4 * step_bytes);
+    }
+
+    af_backend active_backend;
+    ASSERT_SUCCESS(af_get_active_backend(&active_backend));
+
+    {
+        // A cached buffer that would mostly go unused is not, unless it can
+        // be split as on the CPU
+        array c = randu(num);
+
+        deviceMemInfo(&alloc_bytes, &alloc_buffers, &lock_bytes, &lock_buffers);
+
+        ASSERT_EQ(alloc_buffers, 2u);
+        ASSERT_EQ(lock_buffers, 1u);
+        if (active_backend == AF_BACKEND_CPU) {
+            ASSERT_EQ(alloc_bytes, 4 * step_bytes);
+        } else {
+            ASSERT_EQ(alloc_bytes, 5 * step_bytes);
+        }
+        ASSERT_EQ(lock_bytes, 1 * step_bytes);
+    }
+}
+
+TEST(Memory, FragmentationInfo) {
+    size_t unused_bytes, free_bytes, free_buffers, largest_free_bytes;
+
+    cleanSlate();  // Clean up everything done so far
+
+    const int num = step_bytes / sizeof(float);
+
+    { array a = randu(4 * num); }
+
+    af::deviceMemFragmentationInfo(&unused_bytes, &free_bytes, &free_buffers,
+                                   &largest_free_bytes);
+
+    ASSERT_EQ(unused_bytes, 0u);
+    ASSERT_EQ(free_bytes, 4 * step_bytes);
+    ASSERT_EQ(free_buffers, 1u);
+    ASSERT_EQ(largest_free_bytes, 4 * step_bytes);
+
+    {
+        array b = randu(7 * num / 2);
+
+        af::deviceMemFragmentationInfo(&unused_bytes, &free_bytes,
+                                       &free_buffers, &largest_free_bytes);
+
+        ASSERT_EQ(unused_bytes, step_bytes / 2);
+        ASSERT_EQ(free_bytes, 0u);
+        ASSERT_EQ(free_buffers, 0u);
+        ASSERT_EQ(largest_free_bytes, 0u);
+    }
+}
+
+TEST(Memory, CPUSplitAndMerge) {
+    af_backend active_backend;
+    ASSERT_SUCCESS(af_get_active_backend(&active_backend));
+
+    if (active_backend == AF_BACKEND_CPU) {
+        size_t alloc_bytes, alloc_buffers;
+        size_t lock_bytes, lock_buffers;
+        size_t unused_bytes, free_bytes, free_buffers, largest_free_bytes;
+
+        cleanSlate();  // Clean up everything done so far
+
+        const int num = step_bytes / sizeof(float);
+
+        { array a = randu(4 * num); }
+
+        {
+            // Both arrays are cut from the front of the cached buffer
+            array b = randu(num);
+            array c = randu(num);
+
+            const uintptr_t b_ptr =
+                reinterpret_cast<uintptr_t>(b.device<float>());
+            const uintptr_t c_ptr =
+                reinterpret_cast<uintptr_t>(c.device<float>());
+            b.unlock();
+            c.unlock();
+            ASSERT_EQ(b_ptr + step_bytes, c_ptr);
+
+            // The rest of the buffer is cached, but can not be freed while
+            // the other pieces are in use
+            deviceGC();
+
+            deviceMemInfo(&alloc_bytes, &alloc_buffers, &lock_bytes,
+                          &lock_buffers);
+
+            ASSERT_EQ(alloc_buffers, 3u);
+            ASSERT_EQ(lock_buffers, 2u);
+            ASSERT_EQ(alloc_bytes, 4 * step_bytes);
+            ASSERT_EQ(lock_bytes, 2 * step_bytes);
+
+            af::deviceMemFragmentationInfo(&unused_bytes, &free_bytes,
+                                           &free_buffers, &largest_free_bytes);
+
+            ASSERT_EQ(unused_bytes, 0u);
+            ASSERT_EQ(free_bytes, 2 * step_bytes);
+            ASSERT_EQ(free_buffers, 1u);
+            ASSERT_EQ(largest_free_bytes, 2 * step_bytes);
+        }
+
+        // The pieces are merged back into the whole buffer
+        deviceMemInfo(&alloc_bytes, &alloc_buffers, &lock_bytes, &lock_buffers);
+
+        ASSERT_EQ(alloc_buffers, 1u);
+        ASSERT_EQ(lock_buffers, 0u);
+        ASSERT_EQ(alloc_bytes, 4 * step_bytes);
+        ASSERT_EQ(lock_bytes, 0u);
+
+        deviceGC();
+
+        deviceMemInfo(&alloc_bytes, &alloc_buffers, &lock_bytes, &lock_buffers);
+
+        ASSERT_EQ(alloc_buffers, 0u);
+        ASSERT_EQ(alloc_bytes, 0u);
+    }
+}
+
 TEST(Memory, IndexingOffset) {
     size_t alloc_bytes, alloc_buffers;
     size_t lock_bytes, lock_buffers;
@@ -1110,3 +1256,95 @@ TEST(Memory, SNIPPET_AllocCPU) {
         ASSERT_EQ(*dptr, 5.0f);
     }
 }
+
+TEST(Memory, CPUAlignment) {
+    af_backend active_backend;
+    ASSERT_SUCCESS(af_get_active_backend(&active_backend));
+
+    if (active_backend == AF_BACKEND_CPU) {
+        cleanSlate();  // Clean up everything done so far
+
+        // Buffers start on a cache line, and buffers of 2 MB and more on a
+        // huge page
+        const size_t huge_page_bytes = size_t(2) << 20;
+        for (dim_t num : {dim_t(1), dim_t(1000), dim_t(1) << 20}) {
+            array a = randu(num);
+            const uintptr_t ptr =
+                reinterpret_cast<uintptr_t>(a.device<float>());
+            a.unlock();
+
+            ASSERT_EQ(0u, ptr % 64) << "num: " << num;
+            if (num * sizeof(float) >= huge_page_bytes) {
+                ASSERT_EQ(0u, ptr % huge_page_bytes) << "num: " << num;
+            }
+        }
+    }
+}
+
+TEST(Memory, CPUDeferredFree) {
+    af_backend active_backend;
+    ASSERT_SUCCESS(af_get_active_backend(&active_backend));
+
+    if (active_backend == AF_BACKEND_CPU) {
+        const int num = 1 << 20;
+        array a       = randu(num);
+
+        vector<float> gold(num);
+        a.host(&gold[0]);
+        for (float &val : gold) { val *= 2; }
+
+        // The buffer of a is released while the queue may still be reading
+        // it to compute b
+        array b = a * 2;
+        b.eval();
+        a = array();
+        deviceGC();
+
+        ASSERT_VEC_ARRAY_EQ(gold, dim4(num), b);
+    }
+}
+
+#if defined(__linux__)
+TEST(Memory, CPUAllocateAfterCacheIsReleased) {
+    af_backend active_backend;
+    ASSERT_SUCCESS(af_get_active_backend(&active_backend));
+
+    if (active_backend == AF_BACKEND_CPU) {
+        cleanSlate();  // Clean up everything done so far
+
+        const size_t mb = size_t(1) << 20;
+
+        // Fill the cache with a buffer that is too small to be reused
+        { array a = randu(64 * mb / sizeof(float)); }
+        af::sync();
+
+        // Leave room for the larger buffer only once the cached buffer is
+        // returned to the system. The memory manager releases the cache when
+        // the allocation fails, and the allocation has to wait for the queue
+        // to free it before it is retried.
+        long pages = 0;
+        std::ifstream("/proc/self/statm") >> pages;
+        const rlim_t used = static_cast<rlim_t>(pages) * sysconf(_SC_PAGESIZE);
+
+        rlimit old_limit{};
+        ASSERT_EQ(0, getrlimit(RLIMIT_AS, &old_limit));
+        rlimit limit   = old_limit;
+        limit.rlim_cur = used + 48 * mb;
+        if (pages == 0 || (old_limit.rlim_cur != RLIM_INFINITY &&
+                           old_limit.rlim_cur < limit.rlim_cur)) {
+            return;
+        }
+        ASSERT_EQ(0, setrlimit(RLIMIT_AS, &limit));
+
+        bool allocated = true;
+        try {
+            array b = randu(80 * mb / sizeof(float));
+            b.eval();
+            af::sync();
+        } catch (const af::exception &) { allocated = false; }
+        setrlimit(RLIMIT_AS, &old_limit);
+
+        ASSERT_TRUE(allocated);
+    }
+}
+#endif
@@ -13,6 +13,8 @@
 #include <af/data.h>
 #include <af/dim4.hpp>
 #include <af/traits.hpp>
+#include <algorithm>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -496,3 +498,85 @@ TEST(Morph, UnsupportedKernel2D) {
     ASSERT_SUCCESS(af_release_array(in));
     ASSERT_SUCCESS(af_release_array(mask));
 }
+
+// Filters a 2D image with a mask the way af_dilate and af_erode do. Dilation
+// pads the image with zeros and erosion repeats the edges.
+template<typename T>
+vector<T> morphReference(const vector<T>& in, dim4 dims, const vector<T>& mask,
+                         dim4 mdims, bool isDilation) {
+    vector<T> out(in.size());
+    const int R0 = mdims[0] / 2;
+    const int R1 = mdims[1] / 2;
+    for (int j = 0; j < (int)dims[1]; ++j) {
+        for (int i = 0; i < (int)dims[0]; ++i) {
+            T res = isDilation ? std::numeric_limits<T>::lowest()
+                               : std::numeric_limits<T>::max();
+            for (int wj = 0; wj < (int)mdims[1]; ++wj) {
+                for (int wi = 0; wi < (int)mdims[0]; ++wi) {
+                    if (!(mask[wj * mdims[0] + wi] > 0)) continue;
+                    int y = i + wi - R0, x = j + wj - R1;
+                    T val;
+                    if (isDilation) {
+                        bool inside = y >= 0 && x >= 0 && y < (int)dims[0] &&
+                                      x < (int)dims[1];
+                        val = inside ? in[x * dims[0] + y] : T(0);
+                    } else {
+                        y   = std::min(std::max(y, 0), (int)dims[0] - 1);
+                        x   = std::min(std::max(x, 0), (int)dims[1] - 1);
+                        val = in[x * dims[0] + y];
+                    }
+                    res = isDilation ? std::max(res, val) : std::min(res, val);
+                }
+            }
+            out[j * dims[0] + i] = res;
+        }
+    }
+    return out;
+}
+
+TEST(Morph, RectangularMasks) {
+    const dim4 dims(67, 45);
+    array in = af::round(randu(dims) * 100);
+    vector<float> h_in(dims.elements());
+    in.host(h_in.data());
+
+    // A full mask, lines, and rectangles padded with zeros
+    const int rects[][6] = {{9, 7, 0, 0, 9, 7}, {1, 9, 0, 0, 1, 9},
+                            {9, 1, 0, 0, 9, 1}, {8, 6, 2, 1, 3, 4},
+                            {7, 7, 0, 3, 7, 1}, {5, 4, 4, 3, 1, 1}};
+
+    for (const auto& r : rects) {
+        const dim4 mdims(r[0], r[1]);
+        vector<float> h_mask(mdims.elements(), 0.0f);
+        for (int j = r[3]; j < r[3] + r[5]; ++j) {
+            for (int i = r[2]; i < r[2] + r[4]; ++i) {
+                h_mask[j * r[0] + i] = 1.0f;
+            }
+        }
+        array mask(mdims, h_mask.data());
+
+        for (bool isDilation : {true, false}) {
+            vector<float> gold =
+                morphReference(h_in, dims, h_mask, mdims, isDilation);
+            array out = isDilation ? dilate(in, mask) : erode(in, mask);
+            ASSERT_VEC_ARRAY_EQ(gold, dims, out);
+        }
+    }
+}
+
+TEST(Morph, BinaryImageBy31x31Rectangle) {
+    const dim4 dims(120, 90);
+    const dim4 mdims(31, 31);
+    array in = randu(dims) > 0.97;
+    vector<char> h_in(dims.elements());
+    in.host(h_in.data());
+    vector<char> h_mask(mdims.elements(), 1);
+    array mask = constant(1, mdims, b8);
+
+    for (bool isDilation : {true, false}) {
+        vector<char> gold =
+            morphReference(h_in, dims, h_mask, mdims, isDilation);
+        array out = isDilation ? dilate(in, mask) : erode(in, mask);
+        ASSERT_VEC_ARRAY_EQ(gold, dims, out);
+    }
+}
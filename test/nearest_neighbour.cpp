@@ -12,6 +12,7 @@
 #include <testHelpers.hpp>
 #include <af/dim4.hpp>
 #include <af/traits.hpp>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -572,3 +573,116 @@ TEST(NearestNeighbour, DocSnippet2) {
     ASSERT_ARRAYS_EQ(gold_idx, idx);
     ASSERT_ARRAYS_EQ(gold_dist, dist);
 }
+
+// Returns the k smallest distances from every query to the train samples,
+// with the samples along dim1. \p op is the distance of one feature.
+template<typename T, typename To, typename Op>
+static vector<To> knnReferenceDistances(const vector<T> &query,
+                                        const vector<T> &train, int nfeat,
+                                        int nquery, int ntrain, int k, Op op) {
+    vector<To> out;
+    for (int q = 0; q < nquery; ++q) {
+        vector<To> dists(ntrain);
+        for (int t = 0; t < ntrain; ++t) {
+            To d = 0;
+            for (int f = 0; f < nfeat; ++f) {
+                d += op(query[q * nfeat + f], train[t * nfeat + f]);
+            }
+            dists[t] = d;
+        }
+        std::partial_sort(dists.begin(), dists.begin() + k, dists.end());
+        out.insert(out.end(), dists.begin(), dists.begin() + k);
+    }
+    return out;
+}
+
+TEST(NearestNeighbour, HammingOnByteDescriptors) {
+    const int nfeat  = 32;
+    const int nquery = 37;
+    const int ntrain = 3000;
+    const int k      = 3;
+
+    af::setSeed(7);
+    array query = randu(nfeat, nquery, u8);
+    array train = randu(nfeat, ntrain, u8);
+    vector<uchar> hQuery(query.elements());
+    vector<uchar> hTrain(train.elements());
+    query.host(hQuery.data());
+    train.host(hTrain.data());
+
+    array idx, dist;
+    nearestNeighbour(idx, dist, query, train, 0, k, AF_SHD);
+
+    vector<uint> gold = knnReferenceDistances<uchar, uint>(
+        hQuery, hTrain, nfeat, nquery, ntrain, k, [](uchar a, uchar b) {
+            uint bits = 0;
+            for (uint x = a ^ b; x; x >>= 1) { bits += x & 1; }
+            return bits;
+        });
+    ASSERT_VEC_ARRAY_EQ(gold, dim4(k, nquery), dist);
+}
+
+TEST(KNearestNeighbourSSD, LargeTrainSet) {
+    const int nfeat  = 8;
+    const int nquery = 50;
+    const int ntrain = 20000;
+    const int k      = 5;
+
+    // Integer values keep the float distances exact on every backend, so they
+    // can be compared for equality
+    af::setSeed(3);
+    array query = af::floor(randu(nfeat, nquery) * 16.f);
+    array train = af::floor(randu(nfeat, ntrain) * 16.f);
+    vector<float> hQuery(query.elements());
+    vector<float> hTrain(train.elements());
+    query.host(hQuery.data());
+    train.host(hTrain.data());
+
+    array idx, dist;
+    nearestNeighbour(idx, dist, query, train, 0, k, AF_SSD);
+
+    vector<float> gold = knnReferenceDistances<float, float>(
+        hQuery, hTrain, nfeat, nquery, ntrain, k,
+        [](float a, float b) { return (a - b) * (a - b); });
+    ASSERT_VEC_ARRAY_EQ(gold, dim4(k, nquery), dist);
+}
+
+TEST(KNearestNeighbourSSD, NearDuplicates) {
+    const int nfeat  = 128;
+    const int nquery = 20;
+    const int ntrain = 4000;
+    const int k      = 2;
+
+    af::setSeed(5);
+    array query = randu(nfeat, nquery) * 255.f;
+    array train = randu(nfeat, ntrain) * 255.f;
+    vector<float> hQuery(query.elements());
+    vector<float> hTrain(train.elements());
+    query.host(hQuery.data());
+    train.host(hTrain.data());
+
+    // Every query has two train samples that differ from it in one feature.
+    // Their distances are much smaller than the norms of the samples.
+    vector<uint> goldIdx;
+    for (int q = 0; q < nquery; ++q) {
+        for (int d = 0; d < 2; ++d) {
+            const int t = 2 * q + d;
+            std::copy(hQuery.begin() + q * nfeat,
+                      hQuery.begin() + (q + 1) * nfeat,
+                      hTrain.begin() + t * nfeat);
+            hTrain[t * nfeat + (q + d) % nfeat] += d ? 0.01f : 0.05f;
+        }
+        goldIdx.push_back(2 * q + 1);
+        goldIdx.push_back(2 * q);
+    }
+    train = array(nfeat, ntrain, hTrain.data());
+
+    array idx, dist;
+    nearestNeighbour(idx, dist, query, train, 0, k, AF_SSD);
+
+    vector<float> gold = knnReferenceDistances<float, float>(
+        hQuery, hTrain, nfeat, nquery, ntrain, k,
+        [](float a, float b) { return (a - b) * (a - b); });
+    ASSERT_VEC_ARRAY_EQ(goldIdx, dim4(k, nquery), idx);
+    ASSERT_VEC_ARRAY_NEAR(gold, dim4(k, nquery), dist, 1e-6);
+}
@@ -0,0 +1,142 @@
+/*******************************************************
+ * Copyright (c) 2023, ArrayFire
+ * All rights reserved.
+ *
+ * This file is distributed under 3-clause BSD license.
+ * The complete license agreement can be obtained at:
+ * http://arrayfire.com/licenses/BSD-3-Clause
+ ********************************************************/
+
+#include <gtest/gtest.h>
+#include <testHelpers.hpp>
+#include <af/algorithm.h>
+#include <af/arith.h>
+#include <af/array.h>
+#include <af/data.h>
+#include <af/random.h>
+#include <af/statistics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using af::array;
+using af::dim4;
+using af::dtype_traits;
+using af::quantile;
+using af::randu;
+using std::vector;
+
+// The quantiles of each column of the sorted values, computed the same way
+// as numpy.quantile
+template<typename T>
+vector<float> goldQuantiles(const vector<T>& in, dim_t len, dim_t ncols,
+                            const vector<float>& probs,
+                            af_quantile_method method) {
+    vector<float> gold(probs.size() * ncols);
+    for (dim_t c = 0; c < ncols; ++c) {
+        vector<double> col(in.begin() + c * len, in.begin() + (c + 1) * len);
+        std::sort(col.begin(), col.end());
+        for (size_t p = 0; p < probs.size(); ++p) {
+            double h  = (len - 1) * static_cast<double>(probs[p]);
+            dim_t lo  = static_cast<dim_t>(std::floor(h));
+            dim_t hi  = std::min<dim_t>(lo + 1, len - 1);
+            double val = 0;
+            switch (method) {
+                case AF_QUANTILE_LINEAR:
+                    val = col[lo] + (col[hi] - col[lo]) * (h - lo);
+                    break;
+                case AF_QUANTILE_LOWER: val = col[lo]; break;
+                case AF_QUANTILE_HIGHER:
+                    val = col[h == lo ? lo : hi];
+                    break;
+                case AF_QUANTILE_NEAREST:
+                    val = col[static_cast<dim_t>(std::nearbyint(h))];
+                    break;
+                case AF_QUANTILE_MIDPOINT:
+                    val = h == lo ? col[lo] : (col[lo] + col[hi]) / 2;
+                    break;
+            }
+            gold[c * probs.size() + p] = static_cast<float>(val);
+        }
+    }
+    return gold;
+}
+
+template<typename T>
+void quantileTest(dim_t len, dim_t ncols, af_quantile_method method,
+                  const vector<float>& probs = {0.f, 0.25f, 0.5f, 0.95f,
+                                                0.99f, 1.f}) {
+    SUPPORTED_TYPE_CHECK(T);
+
+    vector<T> hin(len * ncols);
+    for (size_t i = 0; i < hin.size(); ++i) {
+        hin[i] = static_cast<T>((i * 7919) % 1009);
+    }
+
+    array in(len, ncols, hin.data());
+    array p(static_cast<dim_t>(probs.size()), probs.data());
+    array out = quantile(in, p, 0, method);
+
+    ASSERT_EQ(f32, out.type());
+    ASSERT_VEC_ARRAY_NEAR(
+        goldQuantiles(hin, len, ncols, probs, method),
+        dim4(static_cast<dim_t>(probs.size()), ncols), out, 1e-3);
+}
+
+#define QUANTILE_TEST(T)                                                   \
+    TEST(Quantile, T##_Linear) {                                           \
+        quantileTest<T>(1001, 7, AF_QUANTILE_LINEAR);                      \
+    }                                                                      \
+    TEST(Quantile, T##_Lower) { quantileTest<T>(1000, 7, AF_QUANTILE_LOWER); } \
+    TEST(Quantile, T##_Higher) {                                           \
+        quantileTest<T>(1000, 7, AF_QUANTILE_HIGHER);                      \
+    }                                                                      \
+    TEST(Quantile, T##_Nearest) {                                          \
+        quantileTest<T>(999, 7, AF_QUANTILE_NEAREST);                      \
+    }                                                                      \
+    TEST(Quantile, T##_Midpoint) {                                         \
+        quantileTest<T>(1000, 7, AF_QUANTILE_MIDPOINT);                    \
+    }                                                                      \
+    TEST(Quantile, T##_LongColumns) {                                      \
+        quantileTest<T>(50000, 2, AF_QUANTILE_LINEAR);                     \
+    }                                                                      \
+    /* Few enough ranks for the CPU to select them from a sample */        \
+    TEST(Quantile, T##_LongColumnsLower) {                                 \
+        quantileTest<T>(50000, 2, AF_QUANTILE_LOWER);                      \
+    }                                                                      \
+    TEST(Quantile, T##_LongColumnsFewProbs) {                              \
+        quantileTest<T>(50000, 2, AF_QUANTILE_LINEAR, {0.1f, 0.5f, 0.9f}); \
+    }
+
+QUANTILE_TEST(float)
+QUANTILE_TEST(int)
+QUANTILE_TEST(ushort)
+
+TEST(Quantile, Dim1) {
+    array in   = randu(5, 300);
+    float p[]  = {0.5f, 0.9f};
+    array out  = quantile(in, array(2, p), 1);
+    array gold = quantile(in.T(), array(2, p), 0).T();
+    ASSERT_ARRAYS_EQ(gold, out);
+}
+
+TEST(Quantile, MedianOfDouble) {
+    array in  = randu(100, 10, f64);
+    double p  = 0.5;
+    array out = quantile(in, array(1, &p), 0);
+    ASSERT_EQ(f64, out.type());
+    ASSERT_ARRAYS_NEAR(median(in, 0), out, 1e-12);
+}
+
+TEST(Quantile, InvalidProbabilities) {
+    array in  = randu(10);
+    float p[] = {0.5f, 1.5f};
+    af_array out = 0;
+    ASSERT_EQ(AF_ERR_ARG,
+              af_quantile(&out, in.get(), array(2, p).get(), 0,
+                          AF_QUANTILE_LINEAR));
+    ASSERT_EQ(AF_ERR_ARG,
+              af_quantile(&out, in.get(), array(1, p).get(), 0,
+                          (af_quantile_method)7));
+}
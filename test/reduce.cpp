@@ -1186,6 +1186,122 @@ TEST(Sum, NaN) {
     freeHost(h_A);
 }
 
+TEST(Sum, NaNSubstitutedAlongDims) {
+    const int rows   = 1003;
+    const int cols   = 37;
+    array A          = round(10 * randu(rows, cols));
+    A(where(A == 3)) = NaN;
+
+    // The subarray starts at an offset and its rows are not multiples of
+    // the vector width
+    const int brows = rows - 2;
+    array B         = A(seq(1, brows), span);
+    vector<float> h_B(B.elements());
+    B.host(h_B.data());
+
+    vector<float> gold0(cols, 0.f), gold1(brows, 0.f);
+    for (int j = 0; j < cols; j++) {
+        for (int i = 0; i < brows; i++) {
+            float val = h_B[j * brows + i];
+            if (std::isnan(val)) { val = 1.f; }
+            gold0[j] += val;
+            gold1[i] += val;
+        }
+    }
+
+    ASSERT_VEC_ARRAY_EQ(gold0, dim4(1, cols), sum(B, 0, 1.0));
+    ASSERT_VEC_ARRAY_EQ(gold1, dim4(brows), sum(B, 1, 1.0));
+}
+
+// Restores the default summation type when a test ends, even if one of its
+// assertions failed
+struct SummationTypeGuard {
+    ~SummationTypeGuard() { af::setSummationType(AF_SUMMATION_DEFAULT); }
+};
+
+TEST(Sum, SummationType) {
+    af_summation_type type;
+    ASSERT_SUCCESS(af_get_summation_type(&type));
+    ASSERT_EQ(AF_SUMMATION_DEFAULT, type);
+    ASSERT_EQ(AF_ERR_ARG,
+              af_set_summation_type(static_cast<af_summation_type>(3)));
+
+    // 0.1 is not representable so the error of a naive float sum grows with
+    // the number of values
+    const int num = 1 << 22;
+    array A       = constant(0.1f, num, 2);
+    double gold   = 0;
+    for (int i = 0; i < num; i++) { gold += 0.1f; }
+
+    af_backend backend;
+    ASSERT_SUCCESS(af_get_active_backend(&backend));
+    SummationTypeGuard guard;
+    for (af_summation_type sumType :
+         {AF_SUMMATION_PAIRWISE, AF_SUMMATION_KAHAN}) {
+        af::setSummationType(sumType);
+        ASSERT_EQ(sumType, af::getSummationType());
+        if (backend != AF_BACKEND_CPU) { continue; }
+
+        vector<float> h_sum(2);
+        sum(A, 0).host(h_sum.data());
+        EXPECT_NEAR(gold, h_sum[0], gold * 1e-6);
+        EXPECT_NEAR(gold, h_sum[1], gold * 1e-6);
+        EXPECT_NEAR(2 * gold, sum<float>(A), gold * 2e-6);
+        EXPECT_NEAR(gold / num, af::mean<float>(A), 1e-6);
+        array means = af::mean(A, 0);
+        EXPECT_NEAR(gold / num, means(0).scalar<float>(), 1e-6);
+    }
+}
+
+TEST(Sum, SummationTypeDim) {
+    af_backend backend;
+    ASSERT_SUCCESS(af_get_active_backend(&backend));
+    if (backend != AF_BACKEND_CPU) { return; }
+
+    // The sums along the other dimensions walk the rows of the input
+    const int num = 1 << 20;
+    array A       = constant(0.1f, 2, num);
+    array B       = constant(0.1f, 2, 1, num);
+    A.eval();
+    B.eval();
+    double gold = 0;
+    for (int i = 0; i < num; i++) { gold += 0.1f; }
+
+    // Each group of 1, 1e8, 1 and -1e8 sums to 2, but the ones are lost in a
+    // float sum of the large values unless the sum is compensated
+    const int groups = 1 << 12;
+    vector<float> h_ill(2 * 4 * groups);
+    for (int i = 0; i < 4 * groups; i++) {
+        const float vals[] = {1.f, 1e8f, 1.f, -1e8f};
+        h_ill[2 * i]       = vals[i % 4];
+        h_ill[2 * i + 1]   = -vals[i % 4];
+    }
+    array ill(2, 4 * groups, h_ill.data());
+
+    SummationTypeGuard guard;
+    for (af_summation_type sumType :
+         {AF_SUMMATION_PAIRWISE, AF_SUMMATION_KAHAN}) {
+        af::setSummationType(sumType);
+
+        vector<float> h_sum(2);
+        sum(A, 1).host(h_sum.data());
+        EXPECT_NEAR(gold, h_sum[0], gold * 1e-6);
+        EXPECT_NEAR(gold, h_sum[1], gold * 1e-6);
+        sum(B, 2).host(h_sum.data());
+        EXPECT_NEAR(gold, h_sum[0], gold * 1e-6);
+        EXPECT_NEAR(gold, h_sum[1], gold * 1e-6);
+        vector<float> h_mean(2);
+        af::mean(A, 1).host(h_mean.data());
+        EXPECT_NEAR(gold / num, h_mean[0], 1e-6);
+    }
+
+    af::setSummationType(AF_SUMMATION_KAHAN);
+    vector<float> h_sum(2);
+    sum(ill, 1).host(h_sum.data());
+    EXPECT_EQ(2.f * groups, h_sum[0]);
+    EXPECT_EQ(-2.f * groups, h_sum[1]);
+}
+
 TEST(Product, NaN) {
     const int num = 5;
     array A       = randu(num);
@@ -2314,3 +2430,18 @@ TEST(Reduce, nanval_issue_3255) {
     }
     ASSERT_SUCCESS(af_release_array(ikeys));
 }
+
+TEST(Reduce, JitInput) {
+    // The values are small integers, so the float sums are exact in any order
+    for (const JitInput &in : jitInputs(f32)) {
+        SCOPED_TRACE(in.name);
+        for (int dim = 0; dim < 4; dim++) {
+            ASSERT_ARRAYS_EQ(af::sum(in.gold, dim), af::sum(in.jit(), dim));
+            ASSERT_ARRAYS_EQ(af::max(in.gold, dim), af::max(in.jit(), dim));
+            ASSERT_ARRAYS_EQ(af::count(in.gold > 0, dim),
+                             af::count(in.jit() > 0, dim));
+        }
+        ASSERT_EQ(af::sum<float>(in.gold), af::sum<float>(in.jit()));
+        ASSERT_EQ(af::min<float>(in.gold), af::min<float>(in.jit()));
+    }
+}
@@ -266,3 +266,69 @@ TEST(Regions, NoComponentImage) {
     for (int i = 0; i < sz; ++i)
         ASSERT_FLOAT_EQ(gold[i], output[i]) << " mismatch at i=" << i << endl;
 }
+
+TEST(Regions, Batch) {
+    const dim4 dims(64, 48, 3, 2);
+    array in = af::randu(dims) > 0.6;
+
+    for (af_connectivity conn : {AF_CONNECTIVITY_4, AF_CONNECTIVITY_8}) {
+        array out = regions(in, conn);
+        ASSERT_EQ(dims, out.dims());
+
+        for (int l = 0; l < (int)dims[3]; ++l) {
+            for (int k = 0; k < (int)dims[2]; ++k) {
+                array gold = regions(in(af::span, af::span, k, l), conn);
+                ASSERT_ARRAYS_EQ(gold, out(af::span, af::span, k, l));
+            }
+        }
+    }
+}
+
+// Labels a binary image by flood filling the components in the order of their
+// first pixel
+static vector<float> regionsReference(const vector<char>& in, int nrows,
+                                      int ncols, af_connectivity conn) {
+    vector<float> out(in.size(), 0.0f);
+    vector<int> stack;
+    float label = 0.0f;
+    for (int p = 0; p < (int)in.size(); ++p) {
+        if (!in[p] || out[p] != 0.0f) continue;
+        out[p] = ++label;
+        stack.push_back(p);
+        while (!stack.empty()) {
+            int q = stack.back();
+            stack.pop_back();
+            int i = q % nrows, j = q / nrows;
+            for (int dj = -1; dj <= 1; ++dj) {
+                for (int di = -1; di <= 1; ++di) {
+                    if (conn == AF_CONNECTIVITY_4 && di != 0 && dj != 0)
+                        continue;
+                    int ni = i + di, nj = j + dj;
+                    if (ni < 0 || nj < 0 || ni >= nrows || nj >= ncols)
+                        continue;
+                    int n = nj * nrows + ni;
+                    if (in[n] && out[n] == 0.0f) {
+                        out[n] = label;
+                        stack.push_back(n);
+                    }
+                }
+            }
+        }
+    }
+    return out;
+}
+
+TEST(Regions, RandomImage) {
+    const int nrows = 300;
+    const int ncols = 1000;
+    array in        = af::randu(nrows, ncols) > 0.45;
+
+    vector<char> h_in(nrows * ncols);
+    in.as(b8).host(h_in.data());
+
+    for (af_connectivity conn : {AF_CONNECTIVITY_4, AF_CONNECTIVITY_8}) {
+        vector<float> gold = regionsReference(h_in, nrows, ncols, conn);
+        array out          = regions(in, conn);
+        ASSERT_VEC_ARRAY_EQ(gold, dim4(nrows, ncols), out);
+    }
+}
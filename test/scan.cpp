@@ -345,3 +345,17 @@ TEST(Scan, ExclusiveSum2D_Dim3) {
 
     ASSERT_ARRAYS_EQ(gold, out);
 }
+
+TEST(Scan, JitInput) {
+    for (const JitInput &in : jitInputs(s32)) {
+        SCOPED_TRACE(in.name);
+        for (int dim = 0; dim < 4; dim++) {
+            ASSERT_ARRAYS_EQ(scan(in.gold, dim, AF_BINARY_ADD, true),
+                             scan(in.jit(), dim, AF_BINARY_ADD, true));
+            ASSERT_ARRAYS_EQ(scan(in.gold, dim, AF_BINARY_ADD, false),
+                             scan(in.jit(), dim, AF_BINARY_ADD, false));
+            ASSERT_ARRAYS_EQ(scan(in.gold, dim, AF_BINARY_MAX, true),
+                             scan(in.jit(), dim, AF_BINARY_MAX, true));
+        }
+    }
+}
@@ -13,6 +13,7 @@
 #include <af/defines.h>
 #include <af/dim4.hpp>
 #include <af/traits.hpp>
+#include <algorithm>
 #include <complex>
 #include <iostream>
 #include <string>
@@ -202,3 +203,42 @@ TEST(SortIndex, CPPDim2) {
     vector<unsigned> ixTest(tests[resultIdx1].begin(), tests[resultIdx1].end());
     ASSERT_VEC_ARRAY_EQ(ixTest, idims, outIndices);
 }
+
+TEST(SortIndex, LargeStableWithDuplicates) {
+    const int nx = 3;
+    const int ny = 50000;
+
+    // Few distinct keys, negative values and both signs of zero
+    vector<float> h_in(nx * ny);
+    for (size_t i = 0; i < h_in.size(); i++) {
+        h_in[i] = static_cast<float>(static_cast<int>((i * 7919) % 37) - 18);
+        h_in[i] *= 0.25f;
+    }
+    h_in[4] = -0.0f;
+
+    for (int dir = 0; dir < 2; dir++) {
+        array in(nx, ny, &h_in.front());
+        array outValues, outIndices;
+        sort(outValues, outIndices, in, 1, dir == 0);
+
+        vector<float> gold(h_in.size());
+        vector<unsigned> goldIdx(h_in.size());
+        for (int x = 0; x < nx; x++) {
+            vector<unsigned> idx(ny);
+            for (int y = 0; y < ny; y++) { idx[y] = y; }
+            auto cmp = [&](unsigned a, unsigned b) {
+                float va = h_in[x + a * nx];
+                float vb = h_in[x + b * nx];
+                return dir == 0 ? va < vb : va > vb;
+            };
+            std::stable_sort(idx.begin(), idx.end(), cmp);
+            for (int y = 0; y < ny; y++) {
+                gold[x + y * nx]    = h_in[x + idx[y] * nx];
+                goldIdx[x + y * nx] = idx[y];
+            }
+        }
+
+        ASSERT_VEC_ARRAY_EQ(gold, dim4(nx, ny), outValues);
+        ASSERT_VEC_ARRAY_EQ(goldIdx, dim4(nx, ny), outIndices);
+    }
+}
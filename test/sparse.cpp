@@ -39,7 +39,13 @@ using af::span;
     TEST(Sparse, Transpose_##T##RectDense) {                                \
         sparseTransposeTester<T>(453, 751, 397, 1, eps);                    \
     }                                                                       \
-    TEST(Sparse, T##ConvertCSR) { convertCSR<T>(2345, 5678, 0.5); }
+    TEST(Sparse, T##ConvertCSR) { convertCSR<T>(2345, 5678, 0.5); }         \
+    TEST(Sparse, SparseSparse_##T##Square) {                                \
+        sparseSparseTester<T>(1000, 1000, 1000, 50, eps);                   \
+    }                                                                       \
+    TEST(Sparse, SparseSparse_##T##Rect) {                                  \
+        sparseSparseTester<T>(711, 1331, 453, 20, eps);                     \
+    }
 
 SPARSE_TESTS(float, 1E-3)
 SPARSE_TESTS(double, 1E-5)
@@ -416,3 +422,47 @@ TEST(Sparse, CPPDenseToSparseToDenseUsage) {
     ASSERT_ARRAYS_EQ(in, gold);
     ASSERT_ARRAYS_EQ(dense, gold);
 }
+
+TEST(Sparse, SparseSparseMatmulGraph) {
+    // Adjacency matrix of the cycle 0 - 1 - 2 - 3 - 0
+    const int N   = 4;
+    float v[]     = {1, 1, 1, 1, 1, 1, 1, 1};
+    int r[]       = {0, 2, 4, 6, 8};
+    int c[]       = {1, 3, 0, 2, 1, 3, 0, 2};
+    const int nnz = 8;
+    array A = af::sparse(N, N, array(dim4(nnz), v), array(dim4(N + 1), r),
+                         array(dim4(nnz), c), AF_STORAGE_CSR);
+
+    // A^2 counts the walks of length two. A node reaches itself and the
+    // opposite node in two ways each.
+    array A2 = matmul(A, A);
+    ASSERT_TRUE(A2.issparse());
+
+    float gold_v[] = {2, 2, 2, 2, 2, 2, 2, 2};
+    int gold_r[]   = {0, 2, 4, 6, 8};
+    int gold_c[]   = {0, 2, 1, 3, 0, 2, 1, 3};
+
+    array vals, rowIdx, colIdx;
+    af::storage storage;
+    sparseGetInfo(vals, rowIdx, colIdx, storage, A2);
+
+    ASSERT_EQ(AF_STORAGE_CSR, storage);
+    ASSERT_ARRAYS_EQ(array(dim4(nnz), gold_v), vals);
+    ASSERT_ARRAYS_EQ(array(dim4(N + 1), gold_r), rowIdx);
+    ASSERT_ARRAYS_EQ(array(dim4(nnz), gold_c), colIdx);
+}
+
+TEST(Sparse, SparseSparseMatmulInvalid) {
+    array A = af::sparse(identity(4, 5), AF_STORAGE_CSR);
+    array B = af::sparse(identity(5, 3), AF_STORAGE_CSR);
+
+    af_array out = 0;
+    ASSERT_EQ(AF_ERR_NOT_SUPPORTED,
+              af_matmul(&out, A.get(), B.get(), AF_MAT_TRANS, AF_MAT_NONE));
+    ASSERT_EQ(AF_ERR_SIZE,
+              af_matmul(&out, B.get(), B.get(), AF_MAT_NONE, AF_MAT_NONE));
+
+    array coo = af::sparse(identity(5, 3), AF_STORAGE_COO);
+    ASSERT_EQ(AF_ERR_ARG,
+              af_matmul(&out, A.get(), coo.get(), AF_MAT_NONE, AF_MAT_NONE));
+}
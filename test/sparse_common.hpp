@@ -98,6 +98,33 @@ static void sparseTester(const int m, const int n, const int k, int factor,
     ASSERT_NEAR(0, calc_norm(imag(dRes1), imag(sRes1)), eps);
 }
 
+template<typename T>
+static void sparseSparseTester(const int m, const int n, const int k,
+                               int factor, double eps) {
+    af::deviceGC();
+
+    SUPPORTED_TYPE_CHECK(T);
+
+    af::array A = makeSparse<T>(cpu_randu<T>(af::dim4(m, n)), factor);
+    af::array B = makeSparse<T>(cpu_randu<T>(af::dim4(n, k)), factor);
+
+    // Result of GEMM
+    af::array dRes = matmul(A, B);
+
+    // Sparse-Sparse Matmul
+    af::array sRes = matmul(af::sparse(A, AF_STORAGE_CSR),
+                            af::sparse(B, AF_STORAGE_CSR));
+
+    ASSERT_TRUE(sRes.issparse());
+    ASSERT_EQ(AF_STORAGE_CSR, af::sparseGetStorage(sRes));
+    ASSERT_EQ(dRes.dims(), sRes.dims());
+
+    // Verify Results
+    af::array res = af::dense(sRes);
+    ASSERT_NEAR(0, calc_norm(real(dRes), real(res)), eps);
+    ASSERT_NEAR(0, calc_norm(imag(dRes), imag(res)), eps);
+}
+
 template<typename T>
 static void sparseTransposeTester(const int m, const int n, const int k,
                                   int factor, double eps,
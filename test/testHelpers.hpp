@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 
 #include <cfloat>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -235,6 +236,21 @@ af::array cpu_randu(const af::dim4 dims);
 
 void cleanSlate();
 
+/// An unevaluated JIT expression and its values evaluated to a buffer
+struct JitInput {
+    std::string name;
+    af::array gold;
+    /// Creates the expression again, because evaluating an array also
+    /// evaluates the arrays that share its tree
+    std::function<af::array()> jit;
+};
+
+/// Returns JIT expressions of type \p ty with small integer values. They
+/// cover the inputs the CPU reductions and scans read from the tree and the
+/// ones they evaluate first: wide and narrow columns, a first dimension of
+/// length 1, a tree that reads a sub-array and a moddims tree.
+std::vector<JitInput> jitInputs(af::dtype ty);
+
 //********** arrayfire custom test asserts ***********
 
 // Overloading unary + op is needed to make unsigned char values printable